@@ -0,0 +1,240 @@
+/*
+ * asrc.c — Asynchronous sample-rate converter kernel and control loop
+ *
+ * Pure module: no Pico SDK dependencies, no hardware access.  The caller
+ * (rate_lock.c, usb_sof_irq) owns the state and the threading.
+ *
+ * Position bookkeeping: output n reads hist[pos .. pos + ASRC_TAPS - 1]
+ * and sits frac past hist[pos + ASRC_TAPS / 2 - 1].  After each block the
+ * consumed history (everything before pos) is shifted out, leaving fewer
+ * than ASRC_TAPS samples, so a full block of input always fits.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "asrc.h"
+#include "dsp_math.h"
+
+// ---------------------------------------------------------------------------
+// Kernel design
+// ---------------------------------------------------------------------------
+
+// Zeroth-order modified Bessel function, power series
+static float bessel_i0(float x) {
+    float sum = 1.0f, term = 1.0f, half = 0.5f * x;
+    for (int k = 1; k < 32; k++) {
+        term *= half / (float)k;
+        float t2 = term * term;
+        sum += t2;
+        if (t2 < sum * 1e-9f) break;
+    }
+    return sum;
+}
+
+void asrc_kernel_design(AsrcKernel *k, uint32_t in_rate, uint32_t out_rate) {
+    // Cutoff in cycles per input sample
+    float fc = 0.5f * ASRC_CUTOFF;
+    if (out_rate < in_rate) fc *= (float)out_rate / (float)in_rate;
+
+    const float half = (float)(ASRC_TAPS / 2);
+    const float inv_i0_beta = 1.0f / bessel_i0(ASRC_KAISER_BETA);
+
+    for (uint32_t p = 0; p <= ASRC_PHASES; p++) {
+        float sum = 0.0f;
+        for (int j = 0; j < ASRC_TAPS; j++) {
+            // Distance from tap j to the output position
+            float t = half - 1.0f + (float)p / (float)ASRC_PHASES - (float)j;
+            float x = t / half;
+            float w = (x * x < 1.0f) ? bessel_i0(ASRC_KAISER_BETA * sqrtf(1.0f - x * x)) * inv_i0_beta : 0.0f;
+            float s = (t == 0.0f) ? 2.0f * fc : sinf(2.0f * PI_F * fc * t) / (PI_F * t);
+            k->coef[p][j] = w * s;
+            sum += w * s;
+        }
+        float norm = 1.0f / sum;
+        for (int j = 0; j < ASRC_TAPS; j++) k->coef[p][j] *= norm;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Kernel processing
+// ---------------------------------------------------------------------------
+
+void asrc_reset(AsrcState *s) {
+    memset(s->hist, 0, sizeof(s->hist));
+    s->fill = ASRC_TAPS - 1;
+    s->pos = 0;
+    s->frac = 0;
+    s->ratio_q30 = ASRC_RATIO_ONE;
+    s->dropped = 0;
+}
+
+static inline uint32_t accepted_input(const AsrcState *s, uint32_t n_in) {
+    uint32_t space = ASRC_HIST - s->fill;
+    return n_in < space ? n_in : space;
+}
+
+uint32_t asrc_begin_block(AsrcState *s, uint32_t n_in, uint32_t ratio_q30) {
+    s->ratio_q30 = ratio_q30;
+    if (ratio_q30 == 0) return 0;
+    uint32_t avail = s->fill + accepted_input(s, n_in);
+    if (avail < ASRC_TAPS) return 0;
+
+    // Outputs n = 0, 1, ... while the position stays below `limit`
+    uint64_t at = ((uint64_t)s->pos << 32) | s->frac;
+    uint64_t limit = (uint64_t)(avail - ASRC_TAPS + 1) << 32;
+    if (at >= limit) return 0;
+    uint64_t step = (uint64_t)ratio_q30 << 2;
+    uint64_t n = (limit - at - 1) / step + 1;
+    return n > ASRC_MAX_BLOCK ? ASRC_MAX_BLOCK : (uint32_t)n;
+}
+
+void asrc_process(const AsrcKernel *k, AsrcState *s,
+                  const float *in_l, const float *in_r, uint32_t n_in,
+                  float *out_l, float *out_r, uint32_t n_out) {
+    uint32_t take = accepted_input(s, n_in);
+    s->dropped += n_in - take;
+    memcpy(&s->hist[0][s->fill], in_l, take * sizeof(float));
+    memcpy(&s->hist[1][s->fill], in_r, take * sizeof(float));
+    s->fill += take;
+
+    uint64_t at = ((uint64_t)s->pos << 32) | s->frac;
+    const uint64_t step = (uint64_t)s->ratio_q30 << 2;
+    const float frac_scale = 1.0f / (float)(1u << (32 - ASRC_PHASE_BITS));
+
+    for (uint32_t n = 0; n < n_out; n++) {
+        uint32_t ip = (uint32_t)(at >> 32);
+        uint32_t fr = (uint32_t)at;
+        uint32_t p = fr >> (32 - ASRC_PHASE_BITS);
+        float a = (float)(fr & ((1u << (32 - ASRC_PHASE_BITS)) - 1)) * frac_scale;
+
+        const float *c0 = k->coef[p];
+        const float *c1 = k->coef[p + 1];
+        const float *xl = &s->hist[0][ip];
+        const float *xr = &s->hist[1][ip];
+        float acc_l = 0.0f, acc_r = 0.0f;
+        for (int j = 0; j < ASRC_TAPS; j++) {
+            float c = c0[j] + a * (c1[j] - c0[j]);
+            acc_l += xl[j] * c;
+            acc_r += xr[j] * c;
+        }
+        out_l[n] = acc_l;
+        out_r[n] = acc_r;
+        at += step;
+    }
+
+    // Shift out what no later output will read
+    uint32_t ip = (uint32_t)(at >> 32);
+    if (ip > s->fill) ip = s->fill;
+    uint32_t keep = s->fill - ip;
+    memmove(&s->hist[0][0], &s->hist[0][ip], keep * sizeof(float));
+    memmove(&s->hist[1][0], &s->hist[1][ip], keep * sizeof(float));
+    s->fill = keep;
+    s->pos = (uint32_t)(at >> 32) - ip;
+    s->frac = (uint32_t)at;
+}
+
+// ---------------------------------------------------------------------------
+// Control loop
+// ---------------------------------------------------------------------------
+
+// Signed nearest-integer division by 2^n (half-away-from-zero).
+static inline int32_t round_shift(int32_t x, uint32_t n) {
+    int64_t xi = x;
+    int64_t bias = 1ll << (n - 1);
+    return xi >= 0 ? (int32_t)((xi + bias) >> n)
+                   : (int32_t)(-(((-xi) + bias) >> n));
+}
+
+// Saturates just below 4: a wrapped ratio would stall the read position.
+static uint32_t ratio_for(uint32_t in_q16, uint32_t out_q16) {
+    if (out_q16 == 0) return ASRC_RATIO_ONE;
+    uint64_t r = ((uint64_t)in_q16 << 30) / out_q16;
+    return r > UINT32_MAX ? UINT32_MAX : (uint32_t)r;
+}
+
+void asrc_ctrl_init(asrc_ctrl_t *ctrl) {
+    memset(ctrl, 0, sizeof(*ctrl));
+    ctrl->fill_target = 8;
+    ctrl->ratio_q30 = ASRC_RATIO_ONE;
+}
+
+void asrc_ctrl_reset(asrc_ctrl_t *ctrl, uint32_t in_rate, uint32_t out_rate) {
+    ctrl->in_per_frame_q16    = (uint32_t)(((uint64_t)in_rate << 16) / 1000);
+    ctrl->nominal_out_q16     = (uint32_t)(((uint64_t)out_rate << 16) / 1000);
+    ctrl->out_rate_q16        = ctrl->nominal_out_q16;
+    ctrl->window_words        = 0;
+    ctrl->window_updates      = 0;
+    ctrl->fill_error_filtered = 0;
+    ctrl->holdoff_remaining   = ASRC_HOLDOFF_UPDATES;
+    ctrl->active              = true;
+    ctrl->need_baseline       = true;
+    ctrl->sof_count           = 0;
+    ctrl->ratio_q30           = ratio_for(ctrl->in_per_frame_q16, ctrl->nominal_out_q16);
+}
+
+void asrc_ctrl_set_fill_target(asrc_ctrl_t *ctrl, uint8_t target) {
+    ctrl->fill_target = target;
+}
+
+void asrc_ctrl_stop(asrc_ctrl_t *ctrl) {
+    ctrl->active = false;
+}
+
+void asrc_ctrl_sof_update(asrc_ctrl_t *ctrl,
+                          uint32_t current_total_words,
+                          uint32_t rate_shift,
+                          uint8_t consumer_fill) {
+    if (!ctrl->active) return;
+
+    ctrl->sof_count++;
+    if ((ctrl->sof_count & 0x3) != 0) return;     // Every 4 SOFs
+
+    if (ctrl->need_baseline) {
+        ctrl->last_total_words = current_total_words;
+        ctrl->need_baseline = false;
+        return;
+    }
+
+    // Loop A: output samples consumed per host frame, per window
+    uint32_t delta_words = current_total_words - ctrl->last_total_words;
+    ctrl->last_total_words = current_total_words;
+    if (delta_words == 0) return;                   // DMA stalled
+
+    ctrl->window_words += delta_words;
+    if (++ctrl->window_updates == (1u << ASRC_WINDOW_SHIFT)) {
+        uint32_t rate_raw_q16 = (uint32_t)((ctrl->window_words << rate_shift) >> ASRC_WINDOW_SHIFT);
+        int32_t rate_error = (int32_t)(rate_raw_q16 - ctrl->out_rate_q16);
+        ctrl->out_rate_q16 += (uint32_t)round_shift(rate_error, ASRC_RATE_IIR_SHIFT);
+        ctrl->window_words = 0;
+        ctrl->window_updates = 0;
+    }
+
+    // Loop B: overfull → produce less per frame → larger ratio
+    int32_t servo_q16 = 0;
+    if (ctrl->holdoff_remaining > 0) {
+        ctrl->holdoff_remaining--;
+    } else {
+        int32_t fill_error_q16 = ((int32_t)consumer_fill - (int32_t)ctrl->fill_target) << 16;
+        ctrl->fill_error_filtered += round_shift(fill_error_q16 - ctrl->fill_error_filtered, ASRC_FILL_IIR_SHIFT);
+        servo_q16 = -(int32_t)(((int64_t)ASRC_FILL_KP_Q16 * ctrl->fill_error_filtered) >> 16);
+        if (servo_q16 > ASRC_SERVO_CLAMP_Q16) servo_q16 = ASRC_SERVO_CLAMP_Q16;
+        if (servo_q16 < -ASRC_SERVO_CLAMP_Q16) servo_q16 = -ASRC_SERVO_CLAMP_Q16;
+    }
+
+    int32_t produce = (int32_t)ctrl->out_rate_q16 + servo_q16;
+    if (produce <= 0) return;
+    ctrl->ratio_q30 = ratio_for(ctrl->in_per_frame_q16, (uint32_t)produce);
+}
+
+bool asrc_ctrl_locked(const asrc_ctrl_t *ctrl) {
+    if (!ctrl->active || ctrl->need_baseline || ctrl->holdoff_remaining > 0) return false;
+    int32_t e = ctrl->fill_error_filtered;
+    return (e < 0 ? -e : e) < ASRC_LOCK_FILL_Q16;
+}
+
+int32_t asrc_ctrl_ratio_ppm(const asrc_ctrl_t *ctrl) {
+    if (ctrl->in_per_frame_q16 == 0) return 0;
+    // ratio / nominal ratio, Q30
+    int64_t rel = (int64_t)(((uint64_t)ctrl->ratio_q30 * ctrl->nominal_out_q16) / ctrl->in_per_frame_q16);
+    return (int32_t)(((rel - (int64_t)ASRC_RATIO_ONE) * 1000000) >> 30);
+}
@@ -0,0 +1,140 @@
+/*
+ * asrc.h — Asynchronous sample-rate converter kernel and control loop
+ *
+ * Pure module with no Pico SDK dependencies, so both halves build and run
+ * on a host.
+ *
+ * Kernel: polyphase windowed sinc.  ASRC_PHASES + 1 rows of ASRC_TAPS
+ * Kaiser-windowed taps per input sample, rows normalized to unity DC gain,
+ * linearly interpolated between adjacent rows at the output's fractional
+ * input position (Q0.32).  The cutoff is set below the lower of the two
+ * Nyquist frequencies, so one table serves up- and downsampling.  The
+ * read position advances by a Q2.30 ratio, input samples per output
+ * sample.  Group delay is ASRC_TAPS / 2 - 1 input samples.
+ *
+ * Control loop: fed from the USB SOF like the feedback controller, with
+ * the same two measurements — output samples consumed per frame and the
+ * consumer buffer fill — but it steers the ratio instead of the host:
+ *   Loop A: output samples consumed per host frame, counted over ~1 s
+ *           windows (one DMA word of SOF timing jitter is ~20 ppm of a
+ *           window at 48 kHz, before the IIR) and
+ *           IIR-filtered across windows (α = 1/8)
+ *   Loop B: proportional fill servo on the IIR-filtered fill error
+ *           (α = 1/256 per 4 ms update, τ ≈ 1 s), about 80 ppm per buffer
+ *           of error at 48 kHz, clamped to ±1/64 sample per frame
+ * ratio = nominal input per frame / (Loop A + Loop B).  The slow loops keep
+ * USB timing jitter and the whole-buffer fill quantization out of the
+ * ratio; changes land at block boundaries only.
+ */
+
+#ifndef ASRC_H
+#define ASRC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ASRC_TAPS               48      // Per phase, even
+#define ASRC_PHASE_BITS         6       // 12.2 KB kernel; 7 doubles it for < 0.1 dB THD+N
+#define ASRC_PHASES             (1u << ASRC_PHASE_BITS)
+#define ASRC_KAISER_BETA        8.0f    // ~80 dB stopband
+#define ASRC_CUTOFF             0.92f   // Fraction of the lower Nyquist
+#define ASRC_MAX_BLOCK          196     // Input or output samples per block (AUDIO_BUFFER_SAMPLES)
+#define ASRC_HIST               (ASRC_TAPS + ASRC_MAX_BLOCK)
+
+// Q2.30 ratio, input samples per output sample
+#define ASRC_RATIO_ONE          (1u << 30)
+
+// Input rate must stay below ASRC_MAX_RATIO × output rate: the Q2.30 ratio
+// holds less than 4, and the kernel's passband would be gone well before.
+#define ASRC_MAX_RATIO          4
+
+static inline bool asrc_ratio_supported(uint32_t in_rate, uint32_t out_rate) {
+    return out_rate != 0 && (uint64_t)in_rate < (uint64_t)out_rate * ASRC_MAX_RATIO;
+}
+
+// ---------------------------------------------------------------------------
+// Kernel
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    float coef[ASRC_PHASES + 1][ASRC_TAPS];    // Row p: fractional position p / ASRC_PHASES
+} AsrcKernel;
+
+typedef struct {
+    float hist[2][ASRC_HIST];   // Input history, L and R
+    uint32_t fill;              // Valid samples in hist
+    uint32_t pos;               // First tap of the next output
+    uint32_t frac;              // Fractional position, Q0.32
+    uint32_t ratio_q30;         // Latched for the current block
+    uint32_t dropped;           // Input samples discarded for lack of history space
+} AsrcState;
+
+// Design the table for in_rate → out_rate.  Not real-time: runs sinf and
+// a Bessel series per tap.
+void asrc_kernel_design(AsrcKernel *k, uint32_t in_rate, uint32_t out_rate);
+
+// Empty the history (ASRC_TAPS - 1 zeros) and rewind the position.
+void asrc_reset(AsrcState *s);
+
+// Output samples the next asrc_process() of n_in inputs will produce at
+// ratio_q30 (at most ASRC_MAX_BLOCK).  Latches the ratio for that call.
+uint32_t asrc_begin_block(AsrcState *s, uint32_t n_in, uint32_t ratio_q30);
+
+// Append n_in samples per channel and produce the count asrc_begin_block()
+// returned.  In place: out_l / out_r may be in_l / in_r.
+void asrc_process(const AsrcKernel *k, AsrcState *s,
+                  const float *in_l, const float *in_r, uint32_t n_in,
+                  float *out_l, float *out_r, uint32_t n_out);
+
+// ---------------------------------------------------------------------------
+// Control loop
+// ---------------------------------------------------------------------------
+
+#define ASRC_WINDOW_SHIFT       8       // Loop A window: 256 updates of 4 SOFs
+#define ASRC_RATE_IIR_SHIFT     3       // Loop A: α = 1/8 per window
+#define ASRC_FILL_IIR_SHIFT     8       // Loop B: α = 1/256 per update
+#define ASRC_FILL_KP_Q16        256     // 1/256 sample/frame per buffer of fill error
+#define ASRC_SERVO_CLAMP_Q16    1024    // ±1/64 sample/frame
+#define ASRC_HOLDOFF_UPDATES    4
+#define ASRC_LOCK_FILL_Q16      (1 << 15)   // Locked while |filtered fill error| < 1/2 buffer
+
+typedef struct {
+    uint32_t in_per_frame_q16;      // Nominal input samples per host frame
+    uint32_t nominal_out_q16;       // Nominal output samples per host frame
+    uint32_t out_rate_q16;          // Loop A estimate
+    uint64_t window_words;          // Loop A: DMA words in the current window
+    uint32_t window_updates;
+    int32_t  fill_error_filtered;   // Loop B, buffer counts Q16.16
+    uint8_t  fill_target;           // Consumer buffers held (latency set point)
+    uint8_t  holdoff_remaining;
+    bool     active;
+    bool     need_baseline;
+    uint32_t sof_count;
+    uint32_t last_total_words;
+    volatile uint32_t ratio_q30;    // Published to the audio path
+} asrc_ctrl_t;
+
+void asrc_ctrl_init(asrc_ctrl_t *ctrl);
+
+// Start tracking at the nominal ratio for in_rate → out_rate.  The pair
+// must pass asrc_ratio_supported(); the ratio saturates otherwise.
+void asrc_ctrl_reset(asrc_ctrl_t *ctrl, uint32_t in_rate, uint32_t out_rate);
+
+// Move the fill set point; survives asrc_ctrl_reset().
+void asrc_ctrl_set_fill_target(asrc_ctrl_t *ctrl, uint8_t target);
+
+void asrc_ctrl_stop(asrc_ctrl_t *ctrl);
+
+// Every SOF, with the same arguments as fb_ctrl_sof_update().
+void asrc_ctrl_sof_update(asrc_ctrl_t *ctrl,
+                          uint32_t current_total_words,
+                          uint32_t rate_shift,
+                          uint8_t consumer_fill);
+
+// Filtered fill error within ASRC_LOCK_FILL_Q16, servo armed.
+bool asrc_ctrl_locked(const asrc_ctrl_t *ctrl);
+
+// Ratio deviation from nominal in ppm (positive: consuming input faster).
+int32_t asrc_ctrl_ratio_ppm(const asrc_ctrl_t *ctrl);
+
+#endif // ASRC_H
@@ -12,6 +12,7 @@
 #include "bulk_params.h"
 #include "config.h"
 #include "dsp_pipeline.h"
+#include "filter_cascade.h"
 #include "usb_audio.h"
 #include "crossfeed.h"
 #include "leveller.h"
@@ -42,6 +43,10 @@ extern volatile bool leveller_reset_pending;
 extern MatrixMixer matrix_mixer;
 extern uint8_t output_pins[NUM_PIN_OUTPUTS];
 
+_Static_assert(NUM_INPUT_CHANNELS <= WIRE_MAX_INPUT_CHANNELS + WIRE_MAX_AUX_INPUTS,
+               "matrix inputs must fit the wire format");
+_Static_assert(sizeof(WireBulkParams) <= WIRE_BULK_BUF_SIZE, "bulk buffer too small");
+
 // ============================================================================
 // dB-TO-LINEAR CONVERSION (duplicated from flash_storage.c — it's static there)
 // ============================================================================
@@ -102,8 +107,8 @@ void bulk_params_collect(WireBulkParams *out) {
         out->delays.delay_ms[i] = channel_delays_ms[i];
     }
 
-    // Matrix crosspoints
-    for (int in = 0; in < NUM_INPUT_CHANNELS; in++) {
+    // Matrix crosspoints (master pair; inputs 2+ in the V8 section)
+    for (int in = 0; in < WIRE_MAX_INPUT_CHANNELS; in++) {
         for (int o = 0; o < NUM_OUTPUT_CHANNELS; o++) {
             out->crosspoints[in][o].enabled = matrix_mixer.crosspoints[in][o].enabled;
             out->crosspoints[in][o].phase_invert = matrix_mixer.crosspoints[in][o].phase_invert;
@@ -129,6 +134,7 @@ void bulk_params_collect(WireBulkParams *out) {
     for (int ch = 0; ch < NUM_CHANNELS; ch++) {
         for (int b = 0; b < MAX_BANDS; b++) {
             out->eq[ch][b].type = filter_recipes[ch][b].type;
+            out->eq[ch][b].order = filter_recipes[ch][b].order;
             out->eq[ch][b].freq = filter_recipes[ch][b].freq;
             out->eq[ch][b].q = filter_recipes[ch][b].Q;
             out->eq[ch][b].gain_db = filter_recipes[ch][b].gain_db;
@@ -169,6 +175,17 @@ void bulk_params_collect(WireBulkParams *out) {
 
     // Master volume (V6+)
     out->master_volume.master_volume_db = master_volume_db;
+
+    // Multichannel inputs (V8+)
+    for (int a = 0; a < NUM_INPUT_CHANNELS - WIRE_MAX_INPUT_CHANNELS; a++) {
+        int in = WIRE_MAX_INPUT_CHANNELS + a;
+        out->aux_inputs.preamp_db[a] = global_preamp_db[in];
+        for (int o = 0; o < NUM_OUTPUT_CHANNELS; o++) {
+            out->aux_inputs.crosspoints[a][o].enabled = matrix_mixer.crosspoints[in][o].enabled;
+            out->aux_inputs.crosspoints[a][o].phase_invert = matrix_mixer.crosspoints[in][o].phase_invert;
+            out->aux_inputs.crosspoints[a][o].gain_db = matrix_mixer.crosspoints[in][o].gain_db;
+        }
+    }
 }
 
 // ============================================================================
@@ -176,8 +193,9 @@ void bulk_params_collect(WireBulkParams *out) {
 // ============================================================================
 
 int bulk_params_apply(const WireBulkParams *in, bool apply_pins) {
-    // Validate header (accept V2-V6 for backward compat)
-    // V2: no I2S/leveller/preamp/master.  V3-V4: no preamp/master.  V5: no preamp/master.  V6: current.
+    // Validate header (accept V2-V8 for backward compat)
+    // V2: no I2S/leveller/preamp/master.  V3-V4: no preamp/master.  V5: no preamp/master.
+    // V6-V7: no multichannel inputs.  V8: current.
     if (in->header.format_version < 2 || in->header.format_version > WIRE_FORMAT_VERSION)
         return -1;
 
@@ -195,8 +213,9 @@ int bulk_params_apply(const WireBulkParams *in, bool apply_pins) {
         return -3;
     // Accept payload sizes from V2 through current.
     // V2: no I2S, no leveller, no preamp/master.  V3/V4: no preamp/master.
-    // V5: no preamp/master sections.  V6: current full size.
-    uint16_t v5_size = sizeof(WireBulkParams) - sizeof(WirePreampConfig) - sizeof(WireMasterVolume);
+    // V5: no preamp/master sections.  V6/V7: no multichannel inputs.  V8: current full size.
+    uint16_t v7_size = sizeof(WireBulkParams) - sizeof(WireAuxInputs);
+    uint16_t v5_size = v7_size - sizeof(WirePreampConfig) - sizeof(WireMasterVolume);
     uint16_t v2_size = v5_size - sizeof(WireI2SConfig) - sizeof(WireLevellerConfig);
     if (in->header.payload_length < v2_size ||
         in->header.payload_length > sizeof(WireBulkParams))
@@ -242,8 +261,8 @@ int bulk_params_apply(const WireBulkParams *in, bool apply_pins) {
         channel_delays_ms[i] = in->delays.delay_ms[i];
     }
 
-    // Matrix crosspoints
-    for (int inp = 0; inp < NUM_INPUT_CHANNELS; inp++) {
+    // Matrix crosspoints (master pair)
+    for (int inp = 0; inp < WIRE_MAX_INPUT_CHANNELS; inp++) {
         for (int o = 0; o < NUM_OUTPUT_CHANNELS; o++) {
             matrix_mixer.crosspoints[inp][o].enabled = in->crosspoints[inp][o].enabled;
             matrix_mixer.crosspoints[inp][o].phase_invert = in->crosspoints[inp][o].phase_invert;
@@ -293,7 +312,9 @@ int bulk_params_apply(const WireBulkParams *in, bool apply_pins) {
             filter_recipes[ch][b].freq = in->eq[ch][b].freq;
             filter_recipes[ch][b].Q = in->eq[ch][b].q;
             filter_recipes[ch][b].gain_db = in->eq[ch][b].gain_db;
+            filter_recipes[ch][b].order = (in->header.format_version >= 7) ? in->eq[ch][b].order : 0;
         }
+        cascade_normalize_row(filter_recipes[ch], channel_band_counts[ch]);
     }
 
     // Channel names
@@ -373,5 +394,31 @@ int bulk_params_apply(const WireBulkParams *in, bool apply_pins) {
         }
     }
 
+    // Multichannel inputs (V8+ payloads).  Older payloads know only the
+    // master pair: inputs 2+ go back to unrouted at 0 dB.
+    bool has_aux = in->header.format_version >= 8 &&
+                   in->header.payload_length >= sizeof(WireBulkParams);
+    for (int a = 0; a < NUM_INPUT_CHANNELS - WIRE_MAX_INPUT_CHANNELS; a++) {
+        int inp = WIRE_MAX_INPUT_CHANNELS + a;
+        float db = has_aux ? in->aux_inputs.preamp_db[a] : 0.0f;
+        float linear = db_to_linear(db);
+        global_preamp_db[inp]     = db;
+        global_preamp_mul[inp]    = (int32_t)(linear * (float)(1 << 28));
+        global_preamp_linear[inp] = linear;
+        for (int o = 0; o < NUM_OUTPUT_CHANNELS; o++) {
+            MatrixCrosspoint *xp = &matrix_mixer.crosspoints[inp][o];
+            if (has_aux) {
+                xp->enabled = in->aux_inputs.crosspoints[a][o].enabled;
+                xp->phase_invert = in->aux_inputs.crosspoints[a][o].phase_invert;
+                xp->gain_db = in->aux_inputs.crosspoints[a][o].gain_db;
+            } else {
+                xp->enabled = 0;
+                xp->phase_invert = 0;
+                xp->gain_db = 0.0f;
+            }
+            xp->gain_linear = db_to_linear(xp->gain_db);
+        }
+    }
+
     return 0;
 }
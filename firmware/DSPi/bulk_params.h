@@ -24,12 +24,13 @@
 // Fixed maximums for the wire format (sized for the largest platform)
 #define WIRE_MAX_CHANNELS        11   // RP2350 max
 #define WIRE_MAX_OUTPUT_CHANNELS  9   // RP2350 max
-#define WIRE_MAX_INPUT_CHANNELS   2   // Same on both
+#define WIRE_MAX_INPUT_CHANNELS   2   // Master pair, same on both
+#define WIRE_MAX_AUX_INPUTS       6   // RP2350 multichannel inputs 2-7
 #define WIRE_MAX_BANDS           12   // Same on both
 #define WIRE_MAX_PIN_OUTPUTS      5   // RP2350 max (4 SPDIF + 1 PDM)
 #define WIRE_NAME_LEN            32   // Must match PRESET_NAME_LEN
 
-#define WIRE_FORMAT_VERSION       6   // V6: per-channel preamp + master volume
+#define WIRE_FORMAT_VERSION       8   // V8: multichannel input routes and preamps
 #define WIRE_MAX_SPDIF_INSTANCES  4   // RP2350 max
 
 // Platform IDs
@@ -44,7 +45,7 @@ typedef struct __attribute__((packed)) {
     uint8_t  platform_id;            // WIRE_PLATFORM_RP2040 or _RP2350
     uint8_t  num_channels;           // Actual channel count (7 or 11)
     uint8_t  num_output_channels;    // Actual output count (5 or 9)
-    uint8_t  num_input_channels;     // Always 2
+    uint8_t  num_input_channels;     // Matrix inputs (2, or 8 on RP2350 V8+)
     uint8_t  max_bands;              // Bands per channel in this payload (12)
     uint16_t payload_length;         // Total packet size including header
     uint16_t fw_version_major;       // Firmware version
@@ -130,7 +131,8 @@ typedef struct __attribute__((packed)) {
 // ============================================================================
 typedef struct __attribute__((packed)) {
     uint8_t  type;                   // Filter type enum
-    uint8_t  reserved[3];
+    uint8_t  order;                  // Cascade types: order, bits 4-7 stage (V7+, 0 before)
+    uint8_t  reserved[2];
     float    freq;                   // Hz
     float    q;                      // Q factor
     float    gain_db;                // dB
@@ -184,6 +186,15 @@ typedef struct __attribute__((packed)) {
     uint8_t  reserved[12];       // Future expansion (pad to 16 bytes)
 } WireMasterVolume;              // 16 bytes
 
+// ============================================================================
+// Section 15: Multichannel Inputs (456 bytes) — V8+
+// ============================================================================
+// Matrix inputs past the master pair (input 2 + index).  Zero on RP2040.
+typedef struct __attribute__((packed)) {
+    float          preamp_db[WIRE_MAX_AUX_INPUTS];                              //  24
+    WireCrosspoint crosspoints[WIRE_MAX_AUX_INPUTS][WIRE_MAX_OUTPUT_CHANNELS];  // 432
+} WireAuxInputs;                     // 456 bytes
+
 // ============================================================================
 // Complete Packet
 // ============================================================================
@@ -202,7 +213,8 @@ typedef struct __attribute__((packed)) {
     WireLevellerConfig  leveller;                                          //   16
     WirePreampConfig    preamp;                                            //   16
     WireMasterVolume    master_volume;                                     //   16
-} WireBulkParams;                    // Total: 2896 bytes
+    WireAuxInputs       aux_inputs;                                        //  456
+} WireBulkParams;                    // Total: 3352 bytes
 
 #define WIRE_BULK_PARAMS_SIZE  sizeof(WireBulkParams)
 
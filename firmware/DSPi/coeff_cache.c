@@ -0,0 +1,397 @@
+/*
+ * coeff_cache.c — Per-sample-rate coefficient cache
+ *
+ * Build order per bank (one step per coeff_cache_service() call):
+ *   steps 0 .. NUM_CHANNELS-1          one EQ channel (up to MAX_BANDS bands)
+ *   next  LOUDNESS_CHUNKS steps        LOUDNESS_CHUNK_STEPS volume steps each
+ *   last  step                         crossfeed + leveller
+ *
+ * Each step is a handful of transcendental calls, well under the 4 ms of
+ * slack the USB ring provides, so building never starves the audio path.
+ *
+ * Boot records: once all banks are built and the active preset is the one
+ * the next boot will load, the boot-rate bank's EQ part (non-bypassed bands
+ * only) and loudness table are written to the preset journal, one part per
+ * pass and only if the stored hash differs.
+ */
+
+#include <string.h>
+#include "coeff_cache.h"
+#include "dsp_pipeline.h"
+#include "filter_cascade.h"
+#include "dyneq.h"
+#include "loudness.h"
+#include "crossfeed.h"
+#include "leveller.h"
+#include "usb_audio.h"
+#include "flash_storage.h"
+
+extern volatile LevellerConfig leveller_config;
+extern volatile bool leveller_bypassed;
+extern LevellerCoeffs leveller_coeffs;
+
+#define LOUDNESS_CHUNK_STEPS    8
+#define LOUDNESS_CHUNKS         ((LOUDNESS_VOL_STEPS + LOUDNESS_CHUNK_STEPS - 1) / LOUDNESS_CHUNK_STEPS)
+#define BUILD_STEP_LOUDNESS     NUM_CHANNELS
+#define BUILD_STEP_MISC         (BUILD_STEP_LOUDNESS + LOUDNESS_CHUNKS)
+#define BUILD_STEPS_PER_BANK    (BUILD_STEP_MISC + 1)
+
+static const uint32_t cache_rates[COEFF_CACHE_NUM_RATES] = { 44100, 48000 };
+
+typedef struct {
+    Biquad filters[NUM_CHANNELS][MAX_BANDS];   // Coefficient fields only; state unused
+    LoudnessCoeffs loudness[LOUDNESS_VOL_STEPS][LOUDNESS_BIQUAD_COUNT];
+    CrossfeedState crossfeed;                  // Coefficients with zeroed state
+    LevellerCoeffs leveller;
+    bool valid;
+} CoeffBank;
+
+// Parameter snapshot the banks were built from
+typedef struct {
+    EqParamPacket recipes[NUM_CHANNELS][MAX_BANDS];
+    float loudness_ref_spl;
+    float loudness_intensity_pct;
+    CrossfeedConfig crossfeed;
+    LevellerConfig leveller;
+#if ENABLE_DYNEQ
+    DynEqPacket dyneq[DYNEQ_MAX_BANDS];        // Which bands are designed dynamic
+#endif
+} CoeffSource;
+
+static CoeffBank banks[COEFF_CACHE_NUM_RATES];
+static CoeffSource source;
+static bool source_taken = false;
+
+static uint8_t build_bank = 0;
+static uint16_t build_step = 0;
+
+static uint32_t boot_rate;                  // Rate the boot records are built for
+static bool     boot_store_pending = false;
+static uint8_t  boot_store_part;
+static uint8_t  boot_buf[COEFF_BOOT_RECORD_MAX];
+
+static int rate_to_index(uint32_t sample_rate) {
+    for (int i = 0; i < COEFF_CACHE_NUM_RATES; i++) {
+        if (cache_rates[i] == sample_rate) return i;
+    }
+    return -1;
+}
+
+// ----------------------------------------------------------------------------
+// SOURCE TRACKING
+// ----------------------------------------------------------------------------
+
+static bool source_matches_live(void) {
+    if (!source_taken) return false;
+    if (memcmp(source.recipes, filter_recipes, sizeof(source.recipes)) != 0) return false;
+    if (source.loudness_ref_spl != loudness_ref_spl) return false;
+    if (source.loudness_intensity_pct != loudness_intensity_pct) return false;
+    if (memcmp(&source.crossfeed, (const void *)&crossfeed_config, sizeof(CrossfeedConfig)) != 0) return false;
+    if (memcmp(&source.leveller, (const void *)&leveller_config, sizeof(LevellerConfig)) != 0) return false;
+#if ENABLE_DYNEQ
+    DynEqPacket dyneq[DYNEQ_MAX_BANDS];
+    dyneq_snapshot(dyneq);
+    if (memcmp(source.dyneq, dyneq, sizeof(dyneq)) != 0) return false;
+#endif
+    return true;
+}
+
+static void take_source_snapshot(void) {
+    memcpy(source.recipes, filter_recipes, sizeof(source.recipes));
+    source.loudness_ref_spl = loudness_ref_spl;
+    source.loudness_intensity_pct = loudness_intensity_pct;
+    memcpy(&source.crossfeed, (const void *)&crossfeed_config, sizeof(CrossfeedConfig));
+    memcpy(&source.leveller, (const void *)&leveller_config, sizeof(LevellerConfig));
+#if ENABLE_DYNEQ
+    dyneq_snapshot(source.dyneq);
+#endif
+    source_taken = true;
+
+    for (int i = 0; i < COEFF_CACHE_NUM_RATES; i++) banks[i].valid = false;
+    build_bank = 0;
+    build_step = 0;
+}
+
+// ----------------------------------------------------------------------------
+// BACKGROUND BUILD
+// ----------------------------------------------------------------------------
+
+static void build_one_step(CoeffBank *bank, float rate, uint16_t step) {
+    if (step < BUILD_STEP_LOUDNESS) {
+        int ch = step;
+        for (int b = 0; b < MAX_BANDS; b++) {
+            // dsp_compute_coefficients clamps the recipe in place — work on a
+            // copy so the snapshot stays comparable against the live recipes.
+            EqParamPacket p = source.recipes[ch][b];
+            Biquad *bq = &bank->filters[ch][b];
+            memset(bq, 0, sizeof(*bq));
+            dsp_compute_coefficients(&p, bq, rate);
+        }
+    } else if (step < BUILD_STEP_MISC) {
+        int chunk = step - BUILD_STEP_LOUDNESS;
+        loudness_compute_table(bank->loudness, source.loudness_ref_spl,
+                               source.loudness_intensity_pct, rate,
+                               chunk * LOUDNESS_CHUNK_STEPS, LOUDNESS_CHUNK_STEPS);
+    } else {
+        crossfeed_init(&bank->crossfeed);
+        crossfeed_compute_coefficients(&bank->crossfeed, &source.crossfeed, rate);
+        leveller_compute_coefficients(&bank->leveller, &source.leveller, rate);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// BOOT RECORDS
+// ----------------------------------------------------------------------------
+
+// FNV-1a over the parameters a boot record part is built from.  The
+// firmware version is included so a new coefficient design never installs
+// stale coefficients.
+static uint32_t hash_bytes(uint32_t h, const void *data, size_t len) {
+    const uint8_t *p = (const uint8_t *)data;
+    while (len--) {
+        h ^= *p++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static uint32_t boot_hash(uint8_t part, uint32_t rate) {
+    uint16_t fw = FW_VERSION_BCD;
+    uint32_t h = 2166136261u;
+    h = hash_bytes(h, &fw, sizeof(fw));
+    h = hash_bytes(h, &part, sizeof(part));
+    h = hash_bytes(h, &rate, sizeof(rate));
+    if (part == COEFF_BOOT_EQ) {
+        h = hash_bytes(h, source.recipes, sizeof(source.recipes));
+#if ENABLE_DYNEQ
+        h = hash_bytes(h, source.dyneq, sizeof(source.dyneq));
+#endif
+    } else {
+        h = hash_bytes(h, &source.loudness_ref_spl, sizeof(float));
+        h = hash_bytes(h, &source.loudness_intensity_pct, sizeof(float));
+    }
+    return h;
+}
+
+// Stored record for `part` if it was built from the current source at
+// `rate`; NULL otherwise.  `count` receives the entry count.
+static const uint8_t *boot_record(uint8_t part, uint32_t rate, uint16_t entry_size, uint16_t *count) {
+    uint16_t len;
+    const uint8_t *rec = preset_boot_coeffs_get(part, &len);
+    CoeffBootHeader hdr;
+    if (!rec || len < sizeof(hdr)) return NULL;
+    memcpy(&hdr, rec, sizeof(hdr));
+    if (hdr.hash != boot_hash(part, rate) || hdr.rate != rate || hdr.entry_size != entry_size
+        || len != sizeof(hdr) + (uint32_t)hdr.count * entry_size) return NULL;
+    *count = hdr.count;
+    return rec + sizeof(hdr);
+}
+
+static bool boot_load_eq(CoeffBank *bank, uint32_t rate) {
+    uint16_t count;
+    const uint8_t *p = boot_record(COEFF_BOOT_EQ, rate, sizeof(CoeffBootBand), &count);
+    if (!p) return false;
+
+    // Every band starts flat, exactly as the design code leaves it
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        for (int b = 0; b < MAX_BANDS; b++) {
+            EqParamPacket flat = { .type = FILTER_FLAT };
+            memset(&bank->filters[ch][b], 0, sizeof(Biquad));
+            dsp_compute_coefficients(&flat, &bank->filters[ch][b], (float)rate);
+        }
+    }
+
+    for (uint16_t i = 0; i < count; i++, p += sizeof(CoeffBootBand)) {
+        CoeffBootBand e;
+        memcpy(&e, p, sizeof(e));
+        if (e.ch >= NUM_CHANNELS || e.band >= MAX_BANDS) return false;
+        Biquad *bq = &bank->filters[e.ch][e.band];
+        bq->bypass = false;
+#if PICO_RP2350
+        bq->use_svf = e.use_svf != 0;
+        bq->svf_type = e.svf_type;
+        bq->cascade = cascade_head_stages(&source.recipes[e.ch][e.band]);
+        if (bq->use_svf) {
+            bq->sva1 = e.c[0]; bq->sva2 = e.c[1]; bq->sva3 = e.c[2];
+            bq->svm0 = e.c[3]; bq->svm1 = e.c[4]; bq->svm2 = e.c[5];
+            continue;
+        }
+#endif
+        bq->b0 = e.c[0]; bq->b1 = e.c[1]; bq->b2 = e.c[2];
+        bq->a1 = e.c[3]; bq->a2 = e.c[4];
+    }
+    return true;
+}
+
+static bool boot_load_loudness(CoeffBank *bank, uint32_t rate) {
+    uint16_t count;
+    const uint8_t *p = boot_record(COEFF_BOOT_LOUDNESS, rate, sizeof(LoudnessCoeffs), &count);
+    if (!p || count != LOUDNESS_VOL_STEPS * LOUDNESS_BIQUAD_COUNT) return false;
+    memcpy(bank->loudness, p, sizeof(bank->loudness));
+    return true;
+}
+
+static uint16_t boot_encode(uint8_t part, const CoeffBank *bank, uint32_t rate, uint8_t *out) {
+    CoeffBootHeader hdr = { .hash = boot_hash(part, rate), .rate = rate };
+    uint8_t *p = out + sizeof(hdr);
+
+    if (part == COEFF_BOOT_LOUDNESS) {
+        hdr.count = LOUDNESS_VOL_STEPS * LOUDNESS_BIQUAD_COUNT;
+        hdr.entry_size = sizeof(LoudnessCoeffs);
+        memcpy(p, bank->loudness, sizeof(bank->loudness));
+        p += sizeof(bank->loudness);
+    } else {
+        hdr.entry_size = sizeof(CoeffBootBand);
+        for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+            for (int b = 0; b < MAX_BANDS; b++) {
+                const Biquad *bq = &bank->filters[ch][b];
+                if (bq->bypass) continue;
+                CoeffBootBand e;
+                memset(&e, 0, sizeof(e));
+                e.ch = (uint8_t)ch;
+                e.band = (uint8_t)b;
+#if PICO_RP2350
+                e.use_svf = bq->use_svf;
+                e.svf_type = (uint8_t)bq->svf_type;
+                if (bq->use_svf) {
+                    e.c[0] = bq->sva1; e.c[1] = bq->sva2; e.c[2] = bq->sva3;
+                    e.c[3] = bq->svm0; e.c[4] = bq->svm1; e.c[5] = bq->svm2;
+                } else
+#endif
+                {
+                    e.c[0] = bq->b0; e.c[1] = bq->b1; e.c[2] = bq->b2;
+                    e.c[3] = bq->a1; e.c[4] = bq->a2;
+                }
+                memcpy(p, &e, sizeof(e));
+                p += sizeof(e);
+                hdr.count++;
+            }
+        }
+    }
+
+    memcpy(out, &hdr, sizeof(hdr));
+    return (uint16_t)(p - out);
+}
+
+// Write one boot record part if it is out of date.  Called with all banks
+// built from the live parameters.
+static void boot_store_step(void) {
+    int idx = rate_to_index(boot_rate);
+    if (idx < 0 || preset_get_active() != preset_get_boot_slot()) {
+        boot_store_pending = false;
+        return;
+    }
+
+    uint8_t part = boot_store_part++;
+    if (boot_store_part >= COEFF_BOOT_PARTS) boot_store_pending = false;
+
+    uint16_t count;
+    uint16_t entry_size = (part == COEFF_BOOT_EQ) ? sizeof(CoeffBootBand) : sizeof(LoudnessCoeffs);
+    if (boot_record(part, boot_rate, entry_size, &count)) return;   // Already current
+
+    uint16_t len = boot_encode(part, &banks[idx], boot_rate, boot_buf);
+    preset_boot_coeffs_put(part, boot_buf, len);
+}
+
+void coeff_cache_boot_store_request(void) {
+    boot_store_pending = true;
+    boot_store_part = 0;
+}
+
+uint8_t coeff_cache_boot(uint32_t sample_rate) {
+    boot_rate = sample_rate;
+    take_source_snapshot();
+
+    int idx = rate_to_index(sample_rate);
+    if (idx < 0) return 0;
+    CoeffBank *bank = &banks[idx];
+    float rate = (float)sample_rate;
+
+    uint8_t hit = 0;
+    if (boot_load_eq(bank, sample_rate)) {
+        hit |= COEFF_BOOT_HIT_EQ;
+    } else {
+        for (uint16_t step = 0; step < BUILD_STEP_LOUDNESS; step++) build_one_step(bank, rate, step);
+    }
+    if (boot_load_loudness(bank, sample_rate)) {
+        hit |= COEFF_BOOT_HIT_LOUDNESS;
+    } else {
+        for (uint16_t step = BUILD_STEP_LOUDNESS; step < BUILD_STEP_MISC; step++) build_one_step(bank, rate, step);
+    }
+    build_one_step(bank, rate, BUILD_STEP_MISC);
+    bank->valid = true;
+
+    coeff_cache_apply(sample_rate);
+    if (hit != (COEFF_BOOT_HIT_EQ | COEFF_BOOT_HIT_LOUDNESS)) coeff_cache_boot_store_request();
+    return hit;
+}
+
+// ----------------------------------------------------------------------------
+// SERVICE
+// ----------------------------------------------------------------------------
+
+void coeff_cache_service(void) {
+    if (!source_matches_live()) {
+        take_source_snapshot();
+        return;   // Start building on the next pass
+    }
+
+    // Skip banks that are already current (the boot bank)
+    while (build_bank < COEFF_CACHE_NUM_RATES && banks[build_bank].valid) build_bank++;
+    if (build_bank >= COEFF_CACHE_NUM_RATES) {
+        // All banks current
+        if (boot_store_pending) boot_store_step();
+        return;
+    }
+
+    CoeffBank *bank = &banks[build_bank];
+    build_one_step(bank, (float)cache_rates[build_bank], build_step);
+
+    if (++build_step >= BUILD_STEPS_PER_BANK) {
+        bank->valid = true;
+        build_step = 0;
+        build_bank++;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// INSTALL
+// ----------------------------------------------------------------------------
+
+bool coeff_cache_apply(uint32_t sample_rate) {
+    int idx = rate_to_index(sample_rate);
+    if (idx < 0 || !banks[idx].valid || !source_matches_live()) return false;
+
+    const CoeffBank *bank = &banks[idx];
+
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        bool all_bypassed = true;
+        for (int b = 0; b < channel_band_counts[ch]; b++) {
+            dsp_load_coefficients(&filters[ch][b], &bank->filters[ch][b]);
+            if (!filters[ch][b].bypass) all_bypassed = false;
+        }
+        channel_bypassed[ch] = all_bypassed;
+    }
+
+    loudness_install_table(bank->loudness);
+    if (loudness_enabled) {
+        audio_set_volume(audio_state.volume);
+    }
+
+    crossfeed_state = bank->crossfeed;
+    crossfeed_bypassed = !crossfeed_config.enabled;
+
+    leveller_coeffs = bank->leveller;
+    leveller_bypassed = !leveller_config.enabled;
+
+    return true;
+}
+
+uint8_t coeff_cache_valid_mask(void) {
+    if (!source_matches_live()) return 0;
+    uint8_t mask = 0;
+    for (int i = 0; i < COEFF_CACHE_NUM_RATES; i++) {
+        if (banks[i].valid) mask |= (1u << i);
+    }
+    return mask;
+}
@@ -0,0 +1,92 @@
+/*
+ * coeff_cache.h — Per-sample-rate coefficient cache
+ *
+ * Keeps a complete set of rate-dependent coefficients (EQ filters, loudness
+ * table, crossfeed, leveller) for each supported host rate, so that a rate
+ * switch installs precomputed banks instead of recomputing everything inline.
+ *
+ * Banks are rebuilt in small steps from idle main-loop time whenever the
+ * parameter source (filter recipes, loudness/crossfeed/leveller config)
+ * changes.  A bank is only installed if it was built from exactly the live
+ * parameters; otherwise perform_rate_change() falls back to the full recalc.
+ *
+ * The 48 kHz bank's EQ coefficients and loudness table are also persisted
+ * as journal records (flash_storage.c), each tagged with a hash of the
+ * parameters and firmware version it was built from.  At boot,
+ * coeff_cache_boot() installs them directly when the hash matches the
+ * loaded preset instead of designing every filter before output starts.
+ *
+ * All functions are main-loop only (not ISR-safe).
+ */
+
+#ifndef COEFF_CACHE_H
+#define COEFF_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+#include "loudness.h"
+
+#define COEFF_CACHE_NUM_RATES   2   // 44.1, 48 kHz; the other streaming rates (~16 KB a bank) recalc inline
+
+// Persisted boot records (journal keys)
+#define COEFF_BOOT_EQ           0
+#define COEFF_BOOT_LOUDNESS     1
+#define COEFF_BOOT_PARTS        2
+
+// Record layout: CoeffBootHeader, then `count` entries
+typedef struct __attribute__((packed)) {
+    uint32_t hash;              // Source parameters + rate + firmware version
+    uint32_t rate;
+    uint16_t count;
+    uint16_t entry_size;
+} CoeffBootHeader;
+
+// EQ entry: one non-bypassed band
+typedef struct __attribute__((packed)) {
+    uint8_t ch;
+    uint8_t band;
+#if PICO_RP2350
+    uint8_t use_svf;
+    uint8_t svf_type;
+    float   c[6];               // b0 b1 b2 a1 a2 (biquad) or sva1-3 svm0-2 (SVF)
+#else
+    uint8_t reserved[2];
+    int32_t c[5];               // b0 b1 b2 a1 a2
+#endif
+} CoeffBootBand;
+
+#define COEFF_BOOT_EQ_MAX       (sizeof(CoeffBootHeader) + NUM_CHANNELS * MAX_BANDS * sizeof(CoeffBootBand))
+#define COEFF_BOOT_LOUDNESS_MAX (sizeof(CoeffBootHeader) + LOUDNESS_VOL_STEPS * LOUDNESS_BIQUAD_COUNT * sizeof(LoudnessCoeffs))
+#define COEFF_BOOT_RECORD_MAX   (COEFF_BOOT_EQ_MAX > COEFF_BOOT_LOUDNESS_MAX ? COEFF_BOOT_EQ_MAX : COEFF_BOOT_LOUDNESS_MAX)
+
+// coeff_cache_boot() result: parts installed from flash
+#define COEFF_BOOT_HIT_EQ       (1u << COEFF_BOOT_EQ)
+#define COEFF_BOOT_HIT_LOUDNESS (1u << COEFF_BOOT_LOUDNESS)
+
+// Advance the background build by one bounded step.  Detects parameter
+// changes and restarts the build when the source no longer matches.
+// Called once per main-loop iteration.
+void coeff_cache_service(void);
+
+// Install the cached bank for sample_rate into the live filter, loudness,
+// crossfeed and leveller state.  Returns false (and touches nothing) if the
+// bank is missing or stale — caller must do a full recalculation.
+bool coeff_cache_apply(uint32_t sample_rate);
+
+// Boot: build the bank for sample_rate from the live (just loaded)
+// parameters, taking the EQ and loudness parts from the persisted records
+// where their hash matches, and install it like coeff_cache_apply().
+// Returns COEFF_BOOT_HIT_* for the parts that came from flash.
+uint8_t coeff_cache_boot(uint32_t sample_rate);
+
+// Ask for the persisted records to be refreshed once the 48 kHz bank is
+// built, if the active preset is the one loaded at boot.  Called when the
+// active preset or the boot selection changes.
+void coeff_cache_boot_store_request(void);
+
+// Bitmask of banks that are complete and match the live parameters
+// (bit 0 = 44.1 kHz, bit 1 = 48 kHz, bit 2 = 96 kHz).
+uint8_t coeff_cache_valid_mask(void);
+
+#endif // COEFF_CACHE_H
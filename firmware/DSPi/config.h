@@ -77,22 +77,43 @@ extern volatile uint32_t nominal_feedback_10_14;
 // SPDIF Buffer Configuration
 #define AUDIO_BUFFER_COUNT    8   // Producer buffers per SPDIF instance
 #define SPDIF_CONSUMER_BUFFER_COUNT 16  // Consumer buffers per SPDIF instance (DMA side)
-#define AUDIO_BUFFER_SAMPLES  192
 
-// DELAY CONFIGURATION
-#if PICO_RP2350
-#define MAX_DELAY_SAMPLES 4096   // 85ms at 48kHz
-#else
-#define MAX_DELAY_SAMPLES 2048   // 42ms at 48kHz
+// Highest streaming rate (CMakeLists.txt).  One block is one USB packet:
+// AUDIO_FREQ_MAX / 1000 + 1 samples with feedback jitter, rounded up to
+// whole words of four samples.
+#ifndef AUDIO_FREQ_MAX
+#define AUDIO_FREQ_MAX        192000
 #endif
+#define AUDIO_BUFFER_SAMPLES  (((AUDIO_FREQ_MAX / 1000 + 1) + 3) & ~3)   // 196
+
+// Rates the descriptors advertise and perform_rate_change() accepts.  The
+// 24-bit alt stops at 96 kHz: 176.4 kHz would need a 1068-byte packet, over
+// the 1023-byte full-speed isochronous limit.
+static inline bool audio_rate_supported(uint32_t rate) {
+    switch (rate) {
+        case 44100: case 48000: case 88200: case 96000: case 176400: case 192000:
+            return rate <= AUDIO_FREQ_MAX;
+        default:
+            return false;
+    }
+}
+
+// Highest rate an S/PDIF slot carries.  176.4 kHz has an IEC 60958 channel
+// status code and a PIO divider that fits; 192 kHz is for I2S slots only.
+// Above it the S/PDIF PIO keeps clocking but is fed digital silence
+// (COST_GATE_SPDIF_RATE), so receivers see a valid, muted stream.
+#define SPDIF_RATE_MAX        176400
+
+// DELAY CONFIGURATION
+#define MAX_DELAY_SAMPLES 2048   // 42ms at 48kHz; 4096 does not fit the RP2350 RAM budget
 #define MAX_DELAY_MASK    (MAX_DELAY_SAMPLES - 1)
 
 // Latency alignment (in samples - automatically adapts to sample rate)
-// SPDIF path: watermark = AUDIO_BUFFER_COUNT/2 buffers
+// SPDIF path: consumer fill held by the feedback servo (latency profile),
+//   48 samples per consumer buffer — see latency_profile.c
 // PDM path: DMA buffer = PDM_DMA_BUFFER_SIZE/8 PCM samples
-#define SPDIF_BUFFER_SAMPLES  384  // Consumer path depth at 50% fill (16 buffers * 48 samples * 50%)
+// Sub alignment = SPDIF depth - PDM depth, recomputed per profile
 #define PDM_BUFFER_SAMPLES    (PDM_DMA_BUFFER_SIZE / 8)                           // 256
-#define SUB_ALIGN_SAMPLES     (SPDIF_BUFFER_SAMPLES - PDM_BUFFER_SAMPLES)         // 128
 
 // ----------------------------------------------------------------------------
 // VENDOR INTERFACE CONFIGURATION (WinUSB / WCID)
@@ -100,10 +121,12 @@ extern volatile uint32_t nominal_feedback_10_14;
 
 #define VENDOR_INTERFACE_NUMBER  2
 
-// RESTORED: Dummy Endpoint for macOS compatibility
+// Vendor bulk pipe — framed, sequence-tagged command protocol (vendor_frame.h).
+// Carries the same REQ_* commands as EP0 without contending with audio class
+// control traffic.  Replaces the former dummy IN endpoint kept for macOS.
+#define VENDOR_EP_OUT       0x03
 #define VENDOR_EP_IN        0x83
 #define VENDOR_EP_SIZE      64
-#define VENDOR_EP_INTERVAL  10
 
 // Microsoft WCID Vendor Code
 #define MS_VENDOR_CODE      0x01
@@ -169,6 +192,26 @@ extern volatile uint32_t nominal_feedback_10_14;
 // Clip Detection Commands
 #define REQ_CLEAR_CLIPS             0x83
 
+// Meter Stream Commands (frames are pushed on the vendor bulk IN pipe)
+#define REQ_SET_METER_STREAM        0x84  // payload = uint8_t frame rate in Hz (0 = off)
+#define REQ_GET_METER_STREAM        0x85  // returns uint8_t frame rate in Hz
+#define REQ_METER_FRAME             0x86  // request code of pushed meter event frames (not a command)
+#define METER_STREAM_MAX_HZ         100
+
+// Output Rate Lock Commands (RP2350; stalled on RP2040)
+#define REQ_SET_RATE_LOCK           0x87  // payload = uint32_t rate in Hz (0 = off), applied + persisted
+#define REQ_GET_RATE_LOCK           0x88  // returns RateLockStatusPacket (20 bytes)
+
+// Feature gate (config_cost.h): stages bypassed because they do not fit at the current rate
+#define REQ_GET_FEATURE_GATE        0x89  // returns FeatureGatePacket (12 bytes)
+
+// Multichannel input status (RP2350; stalled on RP2040)
+#define REQ_GET_INPUT_STATUS        0x8A  // returns InputStatusPacket (20 bytes)
+
+// Loopback capture (loopback.h)
+#define REQ_SET_LOOPBACK_SRC        0x8B  // payload = LoopbackSrcPacket (2 bytes)
+#define REQ_GET_LOOPBACK_STATUS     0x8C  // returns LoopbackStatusPacket (24 bytes)
+
 // Preset System Commands
 #define REQ_PRESET_SAVE             0x90
 #define REQ_PRESET_LOAD             0x91
@@ -221,7 +264,7 @@ extern volatile uint32_t nominal_feedback_10_14;
 #define REQ_GET_LEVELLER_GATE       0xBF
 
 // Per-Channel Preamp Commands
-#define REQ_SET_PREAMP_CH           0xD0  // wValue = channel index (0=L, 1=R), payload = float dB
+#define REQ_SET_PREAMP_CH           0xD0  // wValue = input index (0=L, 1=R, 2+ multichannel), payload = float dB
 #define REQ_GET_PREAMP_CH           0xD1  // wValue = channel index, returns float dB
 
 // Master Volume Commands
@@ -232,6 +275,59 @@ extern volatile uint32_t nominal_feedback_10_14;
 #define REQ_SAVE_MASTER_VOLUME      0xD6  // no payload, stores live master vol to directory
 #define REQ_GET_SAVED_MASTER_VOLUME 0xD7  // returns float dB from directory's independent field
 
+// Latency Profile Commands
+#define REQ_SET_LATENCY_PROFILE     0xD8  // payload = uint8_t profile (LATENCY_PROFILE_*), applied + persisted
+#define REQ_GET_LATENCY_PROFILE     0xD9  // returns uint8_t requested profile
+#define REQ_GET_LATENCY_REPORT      0xDA  // returns LatencyReportPacket (24 bytes)
+
+// Scene Morph Commands (live state = scene A, a cached preset slot = scene B)
+#define REQ_SET_SCENE_MORPH         0xDB  // payload = SceneMorphRequestPacket (4 bytes)
+#define REQ_SET_SCENE_POSITION      0xDC  // payload = uint16_t position (0 = scene A, 65535 = scene B)
+#define REQ_END_SCENE_MORPH         0xDD  // payload = uint8_t scene to settle on (0 = A, 1 = B)
+#define REQ_GET_SCENE_MORPH         0xDE  // returns SceneMorphStatusPacket (8 bytes)
+
+// Preset store (REQ_PRESET_GET_DIR only reports slots 0-15)
+#define REQ_PRESET_GET_STORE        0xDF  // returns PresetStoreInfoPacket (28 bytes)
+
+// Boot instrumentation
+#define REQ_GET_BOOT_TIMING         0xE0  // returns BootTimingPacket (20 bytes)
+
+// Stage profiler
+#define REQ_SET_PROFILER            0xE1  // payload = uint8_t flags (PROFILER_FLAG_*)
+#define REQ_GET_PROFILER_STAGE      0xE2  // wValue = stage (PROF_STAGE_*), returns ProfilerStagePacket (56 bytes)
+
+// Deadline monitor
+#define REQ_GET_DEADLINE_STATS      0xE3  // wValue = 1 clears after reading; returns DeadlineStatsPacket (36 bytes)
+
+// Event trace
+#define REQ_GET_TRACE               0xE4  // Drains up to (wLength - 12) / 12 events; returns TraceDrainHeader + TraceEvent[]
+
+// Configuration cost estimate
+#define REQ_GET_CONFIG_COST         0xE5  // returns ConfigCostPacket (36 bytes) for the latest check
+
+// FIR convolution (RP2350; stalled on RP2040)
+#define REQ_SET_FIR_BEGIN           0xE6  // payload = FirBeginPacket (4 bytes); poll REQ_GET_FIR_STATUS for LOADING
+#define REQ_SET_FIR_TAPS            0xE7  // wValue = output, payload = uint16_t offset, 2 reserved, up to 15 float taps
+#define REQ_SET_FIR_COMMIT          0xE8  // payload = uint8_t output
+#define REQ_SET_FIR_CLEAR           0xE9  // payload = uint8_t output (0xFF = all)
+#define REQ_GET_FIR_STATUS          0xEA  // wValue = output, returns FirStatusPacket (16 bytes)
+#define REQ_SET_FIR_XOVER           0xEB  // payload = FirXoverPacket (12 bytes); type OFF removes it
+#define REQ_GET_FIR_XOVER           0xEC  // wValue = output, returns FirXoverStatusPacket (24 bytes)
+
+// Dynamic EQ (RP2350)
+#define REQ_SET_DYN_EQ              0xED  // payload = DynEqPacket (28 bytes); enabled = 0 removes it
+#define REQ_GET_DYN_EQ              0xEE  // wValue = (channel << 8) | band, returns DynEqStatusPacket (40 bytes)
+
+// Multiband compressor (RP2350)
+#define REQ_SET_MB_CONFIG           0xCA  // payload = MultibandConfigPacket (20 bytes)
+#define REQ_GET_MB_STATUS           0xCB  // wValue = instance, returns MultibandStatusPacket (56 bytes)
+#define REQ_SET_MB_BAND             0xCC  // payload = MultibandBandPacket (24 bytes)
+#define REQ_GET_MB_BAND             0xCD  // wValue = (instance << 8) | band, returns MultibandBandPacket (24 bytes)
+
+// Output true-peak limiter (RP2350)
+#define REQ_SET_OUT_LIMITER         0xCE  // payload = OutLimiterPacket (8 bytes)
+#define REQ_GET_OUT_LIMITER         0xCF  // wValue = output, returns OutLimiterStatusPacket (16 bytes)
+
 // Master Volume Constants
 #define MASTER_VOL_MUTE_DB          (-128.0f)  // Sentinel value: true -inf (mute)
 #define MASTER_VOL_MIN_DB           (-127.0f)  // Minimum non-mute attenuation
@@ -247,11 +343,217 @@ extern volatile uint32_t nominal_feedback_10_14;
 #define MASTER_VOLUME_MODE_INDEPENDENT   0
 #define MASTER_VOLUME_MODE_WITH_PRESET   1
 
+// Latency Profiles (stored in the preset directory; device-wide, not per preset)
+// BALANCED is 0 so directories written before profiles existed load as the
+// original fixed configuration.
+#define LATENCY_PROFILE_BALANCED    0   // 8 consumer buffers — the original fixed set point
+#define LATENCY_PROFILE_ULTRA_LOW   1   // 4 buffers (6 while the PDM sub is active)
+#define LATENCY_PROFILE_SAFE        2   // 12 buffers — maximum jitter tolerance
+#define LATENCY_PROFILE_COUNT       3
+
+// Scene Morph
+#define SCENE_MORPH_MODE_CROSSFADE  0   // Run to scene B over time_ms, then B becomes live
+#define SCENE_MORPH_MODE_MANUAL     1   // Follow REQ_SET_SCENE_POSITION until REQ_END_SCENE_MORPH
+#define SCENE_MORPH_STATE_IDLE      0
+#define SCENE_MORPH_STATE_RUNNING   1
+#define SCENE_MORPH_STATE_ENDING    2   // Settling on the end scene
+#define SCENE_MORPH_OK              0
+#define SCENE_MORPH_ERR_NOT_CACHED  1   // Slot not switchable from the preset RAM cache
+#define SCENE_MORPH_ERR_CPU         2   // Estimated load with both banks over the limit
+#define SCENE_MORPH_ERR_BUSY        3   // A morph is already running
+#define SCENE_MORPH_ERR_CANCELLED   4   // Cut short by a preset load or rate change
+#define SCENE_MORPH_DEFAULT_MS      50
+#define SCENE_MORPH_MAX_MS          10000
+
+// Stage Profiler — per-pass cycle counts of each audio pipeline stage.
+// Core 0 stages time process_audio_packet(), Core 1 stages eq_worker_loop().
+#define PROFILER_FLAG_ENABLE        0x01  // Profile passes while set
+#define PROFILER_FLAG_RESET         0x02  // Clear all stage statistics
+#define PROF_STAGE_INPUT            0   // Buffer setup, input conversion + preamp
+#define PROF_STAGE_LOUDNESS         1
+#define PROF_STAGE_MASTER_EQ        2
+#define PROF_STAGE_LEVELLER         3
+#define PROF_STAGE_CROSSFEED        4   // Crossfeed + master peaks
+#define PROF_STAGE_MIX              5   // Matrix mixing
+#define PROF_STAGE_OUTPUT_EQ        6   // Output EQ + gain (Core 0 outputs)
+#define PROF_STAGE_DELAY            7
+#define PROF_STAGE_PACK             8   // Output peaks, S/PDIF / PDM conversion, buffer return
+#define PROF_STAGE_CORE1_WAIT       9   // Core 0 waiting for Core 1 (EQ worker mode only)
+#define PROF_STAGE_CORE0_TOTAL      10  // Whole process_audio_packet() pass
+#define PROF_STAGE_C1_OUTPUT_EQ     11  // Core 1: output EQ + gain
+#define PROF_STAGE_C1_DELAY         12
+#define PROF_STAGE_C1_PACK          13  // Core 1: output peaks + S/PDIF conversion
+#define PROF_STAGE_CORE1_TOTAL      14  // Whole eq_worker_loop() pass
+#define PROF_STAGE_COUNT            15
+#define PROF_STAGE_FIRST_CORE1      PROF_STAGE_C1_OUTPUT_EQ
+#define PROFILER_HIST_BINS          16
+#define PROFILER_HIST_FIRST_BITS    7   // Bin 0 = under 2^7 cycles, bin n = 2^(n+6) .. 2^(n+7)-1, last bin open
+
+// Deadline Monitor — block processing time against the real-time budget
+// (samples / sample rate).  Latched until REQ_GET_DEADLINE_STATS clears.
+#define DEADLINE_WARN_PERMILLE      900   // High-water at or above this (‰ of budget) raises the warning
+#define DEADLINE_WINDOW_BLOCKS      1000  // Blocks per "recent" worst-case window (~1 s)
+#define STATUS_FLAG_OVERLOAD_WARN   0x01  // High-water mark in the danger zone
+#define STATUS_FLAG_DEADLINE_MISS   0x02  // At least one block exceeded its budget
+
+// Event Trace — timestamped events appended by both cores and the ISRs,
+// drained oldest-first by REQ_GET_TRACE.  Fault events marked (burst) are
+// recorded at most once per TRACE_BURST_US per core; their arg is the
+// running counter, so the host can see how many were folded together.
+#if PICO_RP2350
+#define TRACE_RING_EVENTS           128   // Per core, power of two
+#else
+#define TRACE_RING_EVENTS           64
+#endif
+#define TRACE_BURST_US              10000
+#define TRACE_EVT_BOOT              0x01  // arg = FW_VERSION_BCD
+#define TRACE_EVT_RATE_CHANGE       0x02  // arg = new sample rate (Hz)
+#define TRACE_EVT_STREAM_ALT        0x03  // arg = new alt | (previous alt << 8)
+#define TRACE_EVT_STREAM_RESYNC     0x04  // Outputs re-locked after a USB stream restart
+#define TRACE_EVT_AUDIO_GAP         0x05  // Packet gap reset sync; arg = gap (µs)
+#define TRACE_EVT_PRESET_LOAD       0x06  // arg = slot | (result << 8), bit 16 set if switched from the RAM cache, bit 17 if crossfaded
+#define TRACE_EVT_PRESET_SAVE       0x07  // arg = slot | (result << 8)
+#define TRACE_EVT_TYPE_SWITCH       0x08  // arg = slot change mask
+#define TRACE_EVT_FLASH_ERASE       0x09  // arg = flash offset; logged when the erase completes
+#define TRACE_EVT_FLASH_PROGRAM     0x0A  // arg = flash offset; logged when the program completes
+#define TRACE_EVT_FLASH_TIMEOUT     0x0B  // arg = flash offset
+#define TRACE_EVT_CONFIG_COST       0x0C  // arg = COST_RESULT_* | source << 8 | critical permille << 16
+#define TRACE_EVT_SPDIF_UNDERRUN    0x10  // (burst) arg = spdif_underruns
+#define TRACE_EVT_SPDIF_OVERRUN     0x11  // (burst) arg = spdif_overruns
+#define TRACE_EVT_PDM_RING_UNDERRUN 0x12  // (burst) arg = pdm_ring_underruns
+#define TRACE_EVT_PDM_RING_OVERRUN  0x13  // (burst) arg = pdm_ring_overruns
+#define TRACE_EVT_PDM_DMA_UNDERRUN  0x14  // (burst) arg = pdm_dma_underruns
+#define TRACE_EVT_PDM_DMA_OVERRUN   0x15  // (burst) arg = pdm_dma_overruns
+#define TRACE_EVT_DEADLINE_MISS     0x16  // (burst) arg = block busy time (µs)
+#define TRACE_EVT_TYPE_COUNT        0x17
+
+// Configuration cost checks (config_cost.h).  REQ_SET_ALL_PARAMS payloads
+// are estimated before they are applied; preset loads and rate changes are
+// checked on the live state after the fact.  All are advisory: an
+// overrun is reported, never refused.
+#define COST_SOURCE_NONE            0
+#define COST_SOURCE_SET_ALL_PARAMS  1
+#define COST_SOURCE_PRESET_LOAD     2
+#define COST_SOURCE_RATE_CHANGE     3
+
+// FIR convolution (fir_bank.h).  A per-output stage after the output EQ,
+// loaded over the vendor interface and not stored in presets.  Filter
+// memory comes from a fixed pool of FIR_POOL_UNITS units; an output with
+// P partitions of FIR_PARTITION taps takes P + 1 units (2064 bytes each).
+// RP2350 only, and off by default: with the pool, scratch and code it
+// needs ~45 KB that the default build does not have (Memory Layout in
+// current_architecture.md).  Build with -DENABLE_FIR=1 after freeing RAM
+// elsewhere; ram_budget.ld fails the link if the heap would not fit.
+#ifndef ENABLE_FIR
+#define ENABLE_FIR                  0
+#endif
+#if ENABLE_FIR && !PICO_RP2350
+#error "FIR convolution needs the RP2350"
+#endif
+#define FIR_POOL_UNITS              12    // 24.8 KB; 1408 taps on one output, or two 511-tap crossovers
+#define FIR_TAPS_PER_PACKET         15    // REQ_SET_FIR_TAPS payload after the 4-byte header
+
+// FIR states (FirStatusPacket.state)
+#define FIR_STATE_EMPTY             0     // No filter; output passes through
+#define FIR_STATE_PENDING           1     // Begin / commit / clear waiting for the main loop
+#define FIR_STATE_LOADING           2     // Accepting REQ_SET_FIR_TAPS
+#define FIR_STATE_ACTIVE            3
+#define FIR_STATE_ERROR             4     // See FirStatusPacket.error; output passes through
+
+// FIR errors
+#define FIR_ERR_NONE                0
+#define FIR_ERR_OUTPUT              1     // Output index out of range
+#define FIR_ERR_LENGTH              2     // Zero taps or longer than the pool allows
+#define FIR_ERR_NO_MEMORY           3     // No contiguous run of free units; clear other outputs
+#define FIR_ERR_SEQUENCE            4     // Taps out of order, or request in the wrong state
+#define FIR_ERR_INCOMPLETE          5     // Commit before every tap arrived
+#define FIR_ERR_PARAM               6     // Crossover taps / order / frequency out of range
+
+// Linear-phase FIR crossover types (FirXoverPacket.type).  LOWPASS and
+// HIGHPASS at the same frequency, order and length are complementary.
+#define FIR_XOVER_OFF               0
+#define FIR_XOVER_LOWPASS           1
+#define FIR_XOVER_HIGHPASS          2
+
+// Dynamic EQ (dyneq.h).  Peaking and shelf bands whose gain follows a
+// band-passed sidechain, set over the vendor interface and not stored in
+// presets.  DYNEQ_MAX_BANDS across all channels.
+#if PICO_RP2350
+#define ENABLE_DYNEQ                1
+#define DYNEQ_MAX_BANDS             8
+#else
+#define ENABLE_DYNEQ                0
+#endif
+
+// Multiband compressor (multiband.h).  Instance 0 is the master pair, after
+// the leveller; the others can each take one output, after its EQ and FIR.
+// Set over the vendor interface and not stored in presets.
+#define MB_MAX_BANDS                4
+#define MB_DETECT_RMS               0
+#define MB_DETECT_PEAK              1
+#define MB_ERR_NONE                 0
+#define MB_ERR_PARAM                1     // Band count, crossover frequencies or output out of range
+#define MB_ERR_OUTPUT_TAKEN         2     // Another instance already runs on that output
+#if PICO_RP2350
+#define ENABLE_MULTIBAND            1
+#define MB_INSTANCES                3     // Master + 2 per-output
+#else
+#define ENABLE_MULTIBAND            0
+#endif
+
+// Output true-peak limiter (limiter.h).  Brickwall, per output, in the
+// delay stage; while any is enabled every output is delayed by its
+// lookahead.  Set over the vendor interface and not stored in presets.
+#if PICO_RP2350
+#define ENABLE_LIMITER              1
+#else
+#define ENABLE_LIMITER              0
+#endif
+
+// Output rate lock (rate_lock.h).  An ASRC after input conversion runs the
+// pipeline and outputs at a fixed rate whatever the USB rate.  Device-wide,
+// stored in the preset directory.
+#if PICO_RP2350
+#define ENABLE_ASRC                 1
+#else
+#define ENABLE_ASRC                 0
+#endif
+#define RATE_LOCK_STATE_OFF         0     // Outputs follow the USB rate
+#define RATE_LOCK_STATE_DIRECT      1     // USB rate is the locked rate; ASRC bypassed
+#define RATE_LOCK_STATE_TRACKING    2     // ASRC running, fill servo settling
+#define RATE_LOCK_STATE_LOCKED      3     // ASRC running, fill at its set point
+#define RATE_LOCK_STATE_UNSUPPORTED 4     // USB rate ≥ 4× the lock; outputs follow the USB rate
+
+// Multichannel USB input.  Streaming alt 3 carries MC_INPUT_CHANNELS 16-bit
+// channels (7.1 order: L R C LFE BL BR SL SR) at up to MC_INPUT_RATE_MAX.
+// L/R are the master pair; the others are matrix inputs 2-7, taken straight
+// from their preamp into the mixer.  Routes and preamps are stored in presets.
+#if PICO_RP2350
+#define ENABLE_MC_INPUT             1
+#define MC_INPUT_CHANNELS           8
+#define MC_INPUT_RATE_MAX           48000   // 8ch x 16-bit at 96 kHz exceeds the full-speed iso packet limit
+#else
+#define ENABLE_MC_INPUT             0
+#endif
+
+// Loopback capture (loopback.h).  A second streaming interface sends a
+// selectable pair of processed outputs (post-EQ, post-delay) back to the
+// host at the output rate, 16-bit (alt 1) or 24-bit (alt 2), up to
+// LOOPBACK_RATE_MAX (usb_descriptors.h).  Selection is RAM only.
+#define ENABLE_LOOPBACK             1
+#define LOOPBACK_RING_FRAMES        512     // Power of 2; 10.7 ms at LOOPBACK_RATE_MAX
+#define LOOPBACK_FILL_MS            3       // Ring depth the pacer holds
+#define LOOPBACK_STATE_IDLE         0     // Host has the interface at alt 0
+#define LOOPBACK_STATE_RUNNING      1     // Streaming the selected outputs
+#define LOOPBACK_STATE_PRIMING      2     // Streaming silence until the ring reaches its fill
+#define LOOPBACK_STATE_RATE_MISMATCH 3    // Host capture rate is not the output rate; streaming silence
+
 // System
 #define REQ_ENTER_BOOTLOADER        0xF0
 
 // Preset configuration
-#define PRESET_SLOTS                10
+#define PRESET_SLOTS                128  // Slot IDs 0-127; flash capacity depends on preset content
+#define PRESET_MASK_WORDS           ((PRESET_SLOTS + 31) / 32)
 #define PRESET_NAME_LEN             32
 
 // Preset startup modes
@@ -264,6 +566,7 @@ extern volatile uint32_t nominal_feedback_10_14;
 #define PRESET_ERR_SLOT_EMPTY       0x02
 #define PRESET_ERR_CRC              0x03
 #define PRESET_ERR_FLASH_WRITE      0x04
+#define PRESET_ERR_STORE_FULL       0x05  // Not enough preset storage left for the save
 
 // Platform IDs
 #define PLATFORM_RP2040             0
@@ -338,7 +641,22 @@ extern volatile uint32_t nominal_feedback_10_14;
 #endif
 
 // Matrix Mixer Configuration
-#define NUM_INPUT_CHANNELS   2   // USB L/R (expandable to 4 for S/PDIF input)
+#define NUM_MASTER_INPUTS    2   // USB L/R: the inputs the master chain processes
+#if ENABLE_MC_INPUT
+#define NUM_INPUT_CHANNELS   MC_INPUT_CHANNELS
+#else
+#define NUM_INPUT_CHANNELS   2   // USB L/R
+#endif
+
+// Largest audio OUT packet of any streaming alt (+1 sample for feedback
+// jitter).  Sizes the endpoint's DPRAM buffers and the ingest ring slots.
+#define USB_PACKET_STEREO_16 ((AUDIO_FREQ_MAX / 1000 + 1) * 2 * 2)
+#if ENABLE_MC_INPUT
+#define USB_PACKET_MC_16     ((MC_INPUT_RATE_MAX / 1000 + 1) * MC_INPUT_CHANNELS * 2)
+#define USB_AUDIO_MAX_PACKET (USB_PACKET_MC_16 > USB_PACKET_STEREO_16 ? USB_PACKET_MC_16 : USB_PACKET_STEREO_16)
+#else
+#define USB_AUDIO_MAX_PACKET USB_PACKET_STEREO_16
+#endif
 
 // Core 1 Operating Mode
 typedef enum {
@@ -361,13 +679,16 @@ typedef struct {
     volatile bool     work_ready;
     volatile bool     work_done;
 #if PICO_RP2350
-    float           (*buf_out)[192];   // Pointer to buf_out array, set once at init
+    float           (*buf_out)[AUDIO_BUFFER_SAMPLES];   // Pointer to buf_out array, set once at init
     uint32_t          sample_count;
     float             vol_mul;
     uint32_t          delay_write_idx;  // Snapshot for Core 1 delay processing
     int32_t          *spdif_out[3];     // Pairs 1-3 output buffers (NULL = skip)
+    uint16_t          xover_mask;       // Outputs with a crossover FIR this block
+    uint16_t          xover_core1_mask; // ... of which Core 1 runs (any output)
+    volatile bool     xover_done[2];    // Per core: its share of the crossover FIRs is done
 #else
-    int32_t         (*buf_out)[192];   // Pointer to buf_out array (Q28), set once at init
+    int32_t         (*buf_out)[AUDIO_BUFFER_SAMPLES];   // Pointer to buf_out array (Q28), set once at init
     uint32_t          sample_count;
     int32_t           vol_mul;         // Q15 master volume
     uint32_t          delay_write_idx;
@@ -407,7 +728,7 @@ typedef struct {
 
 // Matrix Route Packet (for vendor commands)
 typedef struct __attribute__((packed)) {
-    uint8_t input;          // 0-1 (USB L/R)
+    uint8_t input;          // 0-1 (USB L/R), 2-7 multichannel inputs (RP2350)
     uint8_t output;         // 0-8
     uint8_t enabled;        // 0 or 1
     uint8_t phase_invert;   // 0 or 1
@@ -426,8 +747,14 @@ typedef struct {
     float svic1eq, svic2eq;                    // integrator state
     uint32_t svf_type;                         // FilterType enum for inner loop specialization
 
+    // Dynamic band (dyneq.h): design values, then sidechain and gain state
+    float dyn_k, dyn_gain_db;                  // 1/Q and static gain of the recipe
+    float dyn_sc1, dyn_sc2, dyn_env, dyn_gr_db;
+
     bool use_svf;                              // true = SVF path, false = biquad path
     bool bypass;
+    uint8_t cascade;                           // First stage of a cascade type: its stage count
+    uint8_t dyn;                               // Dynamic band: its slot + 1, 0 = static
 } Biquad;
 #else
 typedef struct {
@@ -439,14 +766,20 @@ typedef struct {
 
 enum FilterType {
     FILTER_FLAT = 0, FILTER_PEAKING = 1, FILTER_LOWSHELF = 2,
-    FILTER_HIGHSHELF = 3, FILTER_LOWPASS = 4, FILTER_HIGHPASS = 5
+    FILTER_HIGHSHELF = 3, FILTER_LOWPASS = 4, FILTER_HIGHPASS = 5,
+    // Cascade types (filter_cascade.h): one logical filter of `order`,
+    // expanded into ceil(order / 2) consecutive bands
+    FILTER_BUTTERWORTH_LP = 6, FILTER_BUTTERWORTH_HP = 7,
+    FILTER_LR_LP = 8, FILTER_LR_HP = 9,
+    FILTER_BESSEL_LP = 10, FILTER_BESSEL_HP = 11,
+    FILTER_LINKWITZ = 12, FILTER_ALLPASS = 13
 };
 
 typedef struct __attribute__((packed)) {
     uint8_t channel;
     uint8_t band;
     uint8_t type;
-    uint8_t reserved;
+    uint8_t order;      // Cascade types: bits 0-3 order, bits 4-7 stage (set by the firmware)
     float freq;
     float Q;
     float gain_db;
@@ -457,6 +790,7 @@ typedef struct {
     uint8_t cpu0_load;
     uint8_t cpu1_load;
     uint16_t clip_flags;         // Per-channel clip latch bitmask (sticky, cleared by REQ_CLEAR_CLIPS)
+    uint8_t status_flags;        // STATUS_FLAG_* (deadline monitor, latched)
 } SystemStatusPacket;
 
 // ----------------------------------------------------------------------------
@@ -518,6 +852,323 @@ typedef struct __attribute__((packed)) {
     PdmBufferStats pdm;
 } BufferStatsPacket;             // 4 + 32 + 8 = 44 bytes
 
+// Meter Stream Frame — payload of REQ_METER_FRAME events on the bulk IN pipe.
+// Counter fields are deltas since the previous frame, saturating at 0xFFFF.
+typedef struct __attribute__((packed)) {
+    uint8_t num_channels;        // NUM_CHANNELS (length of peaks[])
+    uint8_t flags;               // Bit 0: PDM active, Bit 1: audio streaming,
+                                 // Bit 2: overload warning, Bit 3: deadline missed
+    uint16_t blocks;             // Audio packets processed since previous frame
+    uint16_t clip_flags;         // Sticky clip latch (same as REQ_GET_STATUS)
+    uint8_t cpu0_load;
+    uint8_t cpu1_load;
+    uint8_t consumer_fill_pct[4]; // Per output slot (unused zeroed)
+    uint8_t pdm_dma_fill_pct;
+    uint8_t pdm_ring_fill_pct;
+    uint16_t spdif_underruns;
+    uint16_t spdif_overruns;
+    uint16_t pdm_underruns;      // Ring + DMA
+    uint16_t pdm_overruns;       // Ring + DMA
+    uint16_t usb_ring_overruns;
+    uint16_t usb_errors;
+    uint16_t peaks[NUM_CHANNELS]; // Peak hold since previous frame
+} MeterFramePacket;              // 26 + 2 * NUM_CHANNELS (48 RP2350, 40 RP2040)
+
+// Latency Report — REQ_GET_LATENCY_REPORT.  Latencies are estimates at the
+// servo set point for the current sample rate, excluding user output delays.
+typedef struct __attribute__((packed)) {
+    uint8_t profile;             // Active LATENCY_PROFILE_*
+    uint8_t fill_target;         // Consumer buffers held by the feedback servo
+    uint8_t consumer_capacity;   // SPDIF_CONSUMER_BUFFER_COUNT
+    uint8_t consumer_fill;       // Current slot-0 consumer fill (buffers)
+    int16_t sub_align_samples;   // Delay added to the PDM sub path
+    uint16_t buffer_samples;     // Samples per consumer buffer
+    uint32_t sample_rate;        // Output rate
+    uint32_t spdif_latency_us;   // USB packet → S/PDIF / I2S output
+    uint32_t pdm_latency_us;     // USB packet → PDM sub output (after alignment)
+} LatencyReportPacket;           // 24 bytes
+
+// Scene Morph start — REQ_SET_SCENE_MORPH
+typedef struct __attribute__((packed)) {
+    uint8_t slot;                // Preset slot holding scene B
+    uint8_t mode;                // SCENE_MORPH_MODE_*
+    uint16_t time_ms;            // Crossfade length / full-travel time (0 = default)
+} SceneMorphRequestPacket;       // 4 bytes
+
+// Scene Morph status — REQ_GET_SCENE_MORPH
+typedef struct __attribute__((packed)) {
+    uint8_t state;               // SCENE_MORPH_STATE_*
+    uint8_t slot;                // Scene B slot (last morph when idle)
+    uint8_t mode;                // SCENE_MORPH_MODE_*
+    uint8_t result;              // SCENE_MORPH_OK or SCENE_MORPH_ERR_* of the last start
+    uint16_t position;           // 0 = scene A, 65535 = scene B
+    uint8_t est_cpu0_load;       // Core 0 load estimate with both banks (%)
+    uint8_t est_cpu1_load;       // Core 1 load estimate (0 unless EQ worker)
+} SceneMorphStatusPacket;        // 8 bytes
+
+// Preset store summary — REQ_PRESET_GET_STORE
+typedef struct __attribute__((packed)) {
+    uint8_t slot_count;          // PRESET_SLOTS
+    uint8_t occupied_count;
+    uint16_t reserved;
+    uint32_t data_capacity;      // Flash bytes available for preset data
+    uint32_t data_used;          // Flash bytes held by saved presets
+    uint8_t occupied[PRESET_SLOTS / 8];  // Bit N = slot N occupied
+} PresetStoreInfoPacket;         // 12 + PRESET_SLOTS / 8 (28 bytes)
+
+// Boot timing — REQ_GET_BOOT_TIMING.  Times are microseconds since the
+// timer started (early runtime init, after the boot ROM and the copy to RAM).
+typedef struct __attribute__((packed)) {
+    uint32_t init_done_us;       // core0_init() finished, main loop starting
+    uint32_t first_audio_us;     // First USB audio packet processed (0 = none yet)
+    uint32_t preset_load_us;     // Duration of preset_boot_load()
+    uint32_t coeff_setup_us;     // Duration of boot coefficient setup
+    uint8_t coeff_flags;         // COEFF_BOOT_HIT_* — parts loaded from flash
+    uint8_t reserved[3];
+} BootTimingPacket;              // 20 bytes
+
+// Stage profiler statistics — REQ_GET_PROFILER_STAGE.  Cycle counts are at
+// clk_sys_hz; the histogram is log2-binned (PROFILER_HIST_FIRST_BITS) and
+// halved whenever a bin would overflow, so it keeps its shape.
+typedef struct __attribute__((packed)) {
+    uint8_t stage;               // PROF_STAGE_*
+    uint8_t core;                // Core the stage runs on
+    uint8_t flags;               // PROFILER_FLAG_ENABLE if profiling is on
+    uint8_t stage_count;         // PROF_STAGE_COUNT
+    uint32_t count;              // Passes recorded since the last reset
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint32_t mean_cycles;
+    uint32_t clk_sys_hz;
+    uint16_t hist[PROFILER_HIST_BINS];
+} ProfilerStagePacket;           // 56 bytes
+
+// Deadline statistics — REQ_GET_DEADLINE_STATS.  Times are wall-clock µs per
+// block, so they include IRQ and flash-writer time that lands in the block.
+// Permille values are relative to the budget of the block they were seen in.
+typedef struct __attribute__((packed)) {
+    uint32_t blocks;             // Core 0 blocks measured
+    uint32_t misses;             // Core 0 blocks over budget
+    uint32_t core1_blocks;       // Core 1 EQ worker passes measured
+    uint32_t core1_misses;
+    uint16_t budget_us;          // Budget of the latest block
+    uint16_t worst_us;           // Core 0 high-water
+    uint16_t worst_permille;
+    uint16_t recent_permille;    // Core 0 worst over the last full window
+    uint16_t core1_worst_us;
+    uint16_t core1_worst_permille;
+    uint16_t core1_recent_permille;
+    int16_t headroom_permille;   // 1000 - worst of both cores (negative = over budget)
+    uint8_t flags;               // STATUS_FLAG_*
+    uint8_t warn_permille_div10; // DEADLINE_WARN_PERMILLE / 10
+    uint16_t window_blocks;      // DEADLINE_WINDOW_BLOCKS
+} DeadlineStatsPacket;           // 36 bytes
+
+// Event trace — REQ_GET_TRACE.  The response is a TraceDrainHeader followed
+// by `count` TraceEvents from both cores, merged oldest first.
+typedef struct __attribute__((packed)) {
+    uint32_t time_us;            // time_us_32() when recorded
+    uint8_t type;                // TRACE_EVT_*
+    uint8_t core;                // Recording core
+    uint16_t seq;                // Per-core sequence number (gaps = overwritten events)
+    uint32_t arg;
+} TraceEvent;                    // 12 bytes
+
+typedef struct __attribute__((packed)) {
+    uint16_t count;              // Events that follow
+    uint16_t lost;               // Events overwritten before they could be drained
+    uint32_t now_us;             // time_us_32() at the drain
+    uint8_t event_size;          // sizeof(TraceEvent)
+    uint8_t remaining;           // Events still queued (saturated at 255)
+    uint16_t ring_events;        // TRACE_RING_EVENTS
+} TraceDrainHeader;              // 12 bytes
+
+// Configuration cost — REQ_GET_CONFIG_COST.  Cycle counts are per sample.
+typedef struct __attribute__((packed)) {
+    uint8_t source;              // COST_SOURCE_*
+    uint8_t result;              // COST_RESULT_*
+    uint8_t core1_mode;          // Core1Mode the configuration implies
+    uint8_t applied;             // 0 if bulk_params_apply() rejected the payload
+    uint32_t sample_rate;        // Output rate
+    uint32_t clk_sys_hz;
+    uint32_t core0_cycles;
+    uint32_t core1_cycles;
+    uint32_t critical_cycles;    // One block's wall time (Core 0 waits for Core 1)
+    uint32_t budget_cycles;      // clk_sys / sample rate
+    uint16_t core0_permille;
+    uint16_t core1_permille;
+    uint16_t critical_permille;
+    uint16_t sequence;           // Incremented by every check
+} ConfigCostPacket;              // 36 bytes
+
+// Feature gate — REQ_GET_FEATURE_GATE.  Re-evaluated by the main loop as
+// settings and the output rate change; the gated stages' settings are kept
+// and come back when they fit again.
+typedef struct __attribute__((packed)) {
+    uint8_t gated;               // COST_GATE_* stages bypassed
+    uint8_t result;              // COST_RESULT_* of what still runs
+    uint16_t ungated_permille;   // Critical path with every stage as configured
+    uint16_t gated_permille;     // Critical path of what still runs
+    uint16_t sequence;           // Incremented by every change of gated
+    uint32_t sample_rate;        // Output rate
+} FeatureGatePacket;             // 12 bytes
+
+// Input status — REQ_GET_INPUT_STATUS.  Peaks are what each input feeds the
+// mixer in the latest block, same scale as SystemStatusPacket.peaks: the
+// master pair after the master chain (its peaks[0..1]), inputs 2+ post-preamp.
+typedef struct __attribute__((packed)) {
+    uint8_t num_inputs;          // NUM_INPUT_CHANNELS (length of peaks[])
+    uint8_t stream_channels;     // Channels of the running streaming alt (0 = stopped)
+    uint8_t mix_inputs;          // Inputs reaching the mixer this block (aux silent while the ASRC resamples)
+    uint8_t reserved;
+    uint16_t peaks[8];           // Platform maximum; num_inputs are valid
+} InputStatusPacket;             // 20 bytes
+
+// Loopback capture — REQ_SET_LOOPBACK_SRC / REQ_GET_LOOPBACK_STATUS
+typedef struct __attribute__((packed)) {
+    uint8_t left;                // Output index captured as the left channel
+    uint8_t right;               // Output index captured as the right channel
+} LoopbackSrcPacket;             // 2 bytes
+
+typedef struct __attribute__((packed)) {
+    LoopbackSrcPacket src;
+    uint8_t state;               // LOOPBACK_STATE_*
+    uint8_t bit_depth;           // Of the running alt (0 = idle)
+    uint32_t rate;               // Capture rate the host selected
+    uint32_t output_rate;        // Rate the outputs run at
+    uint16_t fill;               // Ring frames queued
+    uint16_t fill_target;        // Frames the pacer holds (adds to the measured latency)
+    uint32_t overruns;           // Frames dropped, ring full
+    uint32_t underruns;          // Frames sent as silence, ring empty
+} LoopbackStatusPacket;          // 24 bytes
+
+// FIR convolution — REQ_SET_FIR_BEGIN / REQ_GET_FIR_STATUS
+typedef struct __attribute__((packed)) {
+    uint8_t output;              // 0 .. NUM_OUTPUT_CHANNELS-1
+    uint8_t reserved;
+    uint16_t taps;               // Filter length
+} FirBeginPacket;                // 4 bytes
+
+typedef struct __attribute__((packed)) {
+    uint8_t output;
+    uint8_t state;               // FIR_STATE_*
+    uint8_t error;               // FIR_ERR_* of the last failed request
+    uint8_t reserved;
+    uint16_t taps;               // Length being loaded or running
+    uint16_t received;           // Taps loaded so far
+    uint16_t partition_size;     // FIR_PARTITION; also the added latency in samples
+    uint16_t partitions;
+    uint16_t pool_units;         // FIR_POOL_UNITS
+    uint16_t pool_units_free;
+} FirStatusPacket;               // 16 bytes
+
+// Linear-phase FIR crossover — REQ_SET_FIR_XOVER / REQ_GET_FIR_XOVER
+typedef struct __attribute__((packed)) {
+    uint8_t output;
+    uint8_t type;                // FIR_XOVER_*
+    uint8_t order;               // Linkwitz-Riley magnitude order: 2, 4, 6, 8 (12-48 dB/oct)
+    uint8_t reserved;
+    uint16_t taps;               // Odd, 31-511; delay = (taps - 1) / 2 samples
+    uint16_t reserved2;
+    float freq_hz;
+} FirXoverPacket;                // 12 bytes
+
+typedef struct __attribute__((packed)) {
+    FirXoverPacket config;       // As requested
+    uint8_t state;               // FIR_STATE_* (PENDING while designing; output silent)
+    uint8_t error;               // FIR_ERR_* of the last failed request
+    uint8_t core;                // Core that runs it this block (0 / 1)
+    uint8_t reserved;
+    uint16_t delay_samples;      // This output's FIR stage latency
+    uint16_t comp_samples;       // Added to this output's delay line to align outputs
+    uint32_t design_rate;        // Sample rate the coefficients were designed for
+} FirXoverStatusPacket;          // 24 bytes
+
+// Dynamic EQ band — REQ_SET_DYN_EQ / REQ_GET_DYN_EQ
+typedef struct __attribute__((packed)) {
+    uint8_t channel;
+    uint8_t band;                // Peaking, low shelf or high shelf band
+    uint8_t enabled;             // 0 = static band (removes its dynamics)
+    uint8_t reserved;
+    float threshold_db;          // Sidechain RMS level where the gain starts to move (dBFS)
+    float ratio;                 // 1-20: cut (1 - 1/ratio) dB per dB above threshold
+    float range_db;              // Largest cut from the band's static gain, 0-24 dB
+    float sc_freq;               // Sidechain band-pass centre (Hz); 0 = the band's frequency
+    float sc_q;                  // Sidechain band-pass Q; 0 = the band's Q
+    uint16_t attack_ms;          // 0-90% step times of the gain change
+    uint16_t release_ms;
+} DynEqPacket;                   // 28 bytes
+
+typedef struct __attribute__((packed)) {
+    DynEqPacket config;          // enabled = 0 if the band has no dynamics
+    uint8_t active;              // Band is peaking / shelf and its dynamics run
+    uint8_t slots_free;          // Of DYNEQ_MAX_BANDS
+    uint16_t reserved;
+    float sidechain_db;          // Sidechain RMS level
+    float gain_change_db;        // Current change from the static gain (<= 0)
+} DynEqStatusPacket;             // 40 bytes
+
+// Multiband compressor — REQ_SET_MB_CONFIG / REQ_GET_MB_STATUS
+typedef struct __attribute__((packed)) {
+    uint8_t instance;            // 0 = master pair, 1..MB_INSTANCES-1 = per-output
+    uint8_t enabled;
+    uint8_t bands;               // 3 or 4
+    uint8_t detector;            // MB_DETECT_*
+    uint8_t output;              // Per-output instances: the output it runs on
+    uint8_t reserved[3];
+    float xover_hz[3];           // Band edges, ascending; 3 bands use the first two
+} MultibandConfigPacket;         // 20 bytes
+
+// One band's gain computer — REQ_SET_MB_BAND / REQ_GET_MB_BAND
+typedef struct __attribute__((packed)) {
+    uint8_t instance;
+    uint8_t band;                // 0 = lowest
+    uint16_t reserved;
+    float threshold_db;          // Detector level where the gain starts to move (dBFS)
+    float ratio;                 // 1-100; 100 limits (1 dB of cut per dB over)
+    float knee_db;               // Soft knee width, 0-24 dB
+    float makeup_db;             // 0-24 dB
+    uint16_t attack_ms;          // 0-90% step times of the gain change
+    uint16_t release_ms;
+} MultibandBandPacket;           // 24 bytes
+
+typedef struct __attribute__((packed)) {
+    MultibandConfigPacket config;
+    uint8_t active;              // Running in the audio path
+    uint8_t error;               // MB_ERR_* of the last refused request
+    uint16_t reserved;
+    float level_db[MB_MAX_BANDS];        // Detector level per band (louder channel)
+    float gain_db[MB_MAX_BANDS];         // Current band gain, makeup included
+} MultibandStatusPacket;         // 56 bytes
+
+// Output true-peak limiter — REQ_SET_OUT_LIMITER / REQ_GET_OUT_LIMITER
+typedef struct __attribute__((packed)) {
+    uint8_t output;
+    uint8_t enabled;
+    uint16_t release_ms;         // 0-90% recovery time, 1-1000 ms
+    float ceiling_db;            // True-peak ceiling, -24-0 dBTP
+} OutLimiterPacket;              // 8 bytes
+
+typedef struct __attribute__((packed)) {
+    OutLimiterPacket config;
+    uint8_t active;              // Running in the output's delay stage
+    uint8_t reserved;
+    uint16_t lookahead_samples;  // Added to every output's delay while any limiter is on
+    float gain_db;               // Current gain (<= 0)
+} OutLimiterStatusPacket;        // 16 bytes
+
+// Output rate lock — REQ_GET_RATE_LOCK
+typedef struct __attribute__((packed)) {
+    uint32_t locked_rate;        // Requested lock in Hz (0 = off)
+    uint32_t usb_rate;           // Host stream rate
+    uint32_t output_rate;        // Rate the pipeline and outputs run at
+    uint8_t state;               // RATE_LOCK_STATE_*
+    uint8_t consumer_fill;       // Current slot-0 consumer fill (buffers)
+    uint8_t fill_target;         // Set point of the ASRC fill servo
+    uint8_t reserved;
+    int32_t ratio_ppm;           // Resampling ratio against nominal (+: input consumed faster)
+} RateLockStatusPacket;          // 20 bytes
+
 extern uint8_t channel_band_counts[NUM_CHANNELS];
 extern volatile SystemStatusPacket global_status;
 
@@ -0,0 +1,408 @@
+/*
+ * config_cost.c — Pre-flight CPU cost estimate of a DSP configuration
+ *
+ * The model follows process_audio_packet() and eq_worker_loop():
+ *
+ *   Core 0 serial:    input, ASRC, loudness, master EQ, leveller, multiband, crossfeed, mix
+ *   Core 0 parallel:  EQ, FIR, gain, delay and packing of the outputs it keeps
+ *   Core 1:           EQ worker outputs (with their FIRs), or the PDM modulator
+ *   Either core:      FIR crossovers, EQ worker mode only (see assign_xovers())
+ *
+ * In EQ worker mode Core 0 waits for Core 1 at the end of the block, so a
+ * block takes serial + max(parallel, Core 1).  In PDM mode Core 1 paces
+ * itself against the PDM DMA and has its own per-sample deadline.
+ */
+
+#include <string.h>
+#include <math.h>
+#include "config_cost.h"
+
+// Values match FilterType (config.h)
+#define WIRE_FILTER_FLAT        0
+#define WIRE_FILTER_PEAKING     1
+#define WIRE_FILTER_LOWSHELF    2
+#define WIRE_FILTER_HIGHSHELF   3
+#define WIRE_FILTER_CASCADE_FIRST 6     // FILTER_BUTTERWORTH_LP
+#define WIRE_FILTER_LR_LP       8
+#define WIRE_FILTER_LR_HP       9
+#define WIRE_FILTER_LINKWITZ    12
+#define WIRE_FILTER_ALLPASS     13
+
+// Outputs handed to the Core 1 EQ worker (CORE1_EQ_FIRST/LAST_OUTPUT)
+#define COST_CORE1_FIRST_OUTPUT 2
+
+// Uncalibrated.  Each figure is an estimate from the inner loop's
+// instruction count at -O3 (memory and branch stalls guessed), made when
+// the stage was written; none has been measured on the target yet.  Until
+// they are checked against the stage profiler (REQ_GET_PROFILER_STAGE),
+// the firmware only reports an OVER result and never refuses on it.
+static const CostKernels kernels_rp2040 = {
+    // Cortex-M0+, Q28 fixed point (fast_mul_q28 / dsp_process_rp2040.S)
+    .base = 40,
+    .aux_input = 0,             // No multichannel input
+    .biquad = 60,
+    .svf = 60,                  // No SVF path; never selected
+    .eq_channel = 24,
+    .loudness = 280,
+    .crossfeed = 160,
+    .leveller = 320,
+    .leveller_lookahead = 20,
+    .crosspoint = 14,
+    .output = 30,
+    .delay = 14,
+    .pdm_push = 16,
+    .pdm_modulator = 3300,
+    .fir_output = 0,            // No FIR stage
+    .fir_partition = 0,
+    .xover_output = 0,
+    .xover_pair = 0,
+    .dyn_band = 0,              // No dynamic EQ
+    .mb_svf = 0,                // No multiband compressor
+    .mb_band = 0,
+    .limiter = 0,               // No limiter
+    .asrc = 0,                  // No rate lock
+};
+
+static const CostKernels kernels_rp2350 = {
+    // Cortex-M33 with single-precision FPU
+    .base = 20,
+    .aux_input = 6,
+    .biquad = 14,
+    .svf = 16,
+    .eq_channel = 8,
+    .loudness = 72,
+    .crossfeed = 40,
+    .leveller = 90,
+    .leveller_lookahead = 12,
+    .crosspoint = 3,
+    .output = 10,
+    .delay = 8,
+    .pdm_push = 12,
+    .pdm_modulator = 2600,
+    .fir_output = 90,
+    .fir_partition = 10,
+    .xover_output = 6,
+    .xover_pair = 3,
+    .dyn_band = 14,
+    .mb_svf = 10,
+    .mb_band = 9,
+    .limiter = 60,              // Every segment oversampled
+    .asrc = 300,                // 48 interpolated taps, two channels
+};
+
+const CostKernels *config_cost_kernels(uint8_t platform_id) {
+    if (platform_id == WIRE_PLATFORM_RP2040) return &kernels_rp2040;
+    if (platform_id == WIRE_PLATFORM_RP2350) return &kernels_rp2350;
+    return NULL;
+}
+
+static uint8_t core1_last_output(uint8_t platform_id) {
+    return platform_id == WIRE_PLATFORM_RP2350 ? 7 : 3;
+}
+
+// Same test as is_filter_flat() in dsp_pipeline.c
+static bool band_flat(const WireBandParams *b) {
+    if (b->type == WIRE_FILTER_FLAT) return true;
+    if (b->freq <= 0.0f) return true;
+    if (b->type == WIRE_FILTER_PEAKING || b->type == WIRE_FILTER_LOWSHELF ||
+        b->type == WIRE_FILTER_HIGHSHELF) {
+        if (fabsf(b->gain_db) < 0.01f) return true;
+    }
+    return false;
+}
+
+// Same crossover as dsp_compute_coefficients(), after its frequency clamp
+static bool band_svf(const WireBandParams *b, uint8_t platform_id, float rate) {
+    if (platform_id != WIRE_PLATFORM_RP2350) return false;
+    float f = b->freq;
+    if (f < 10.0f) f = 10.0f;
+    if (f > rate * 0.45f) f = rate * 0.45f;
+    return f < rate / 7.5f;
+}
+
+// Stages of a cascade type's first band, as cascade_stages() in
+// filter_cascade.c; 0 for a stage band, 1 for any other type.  V6 and
+// older payloads carry no order.
+static uint8_t band_stages(const WireBandParams *b, uint8_t format_version) {
+    if (b->type < WIRE_FILTER_CASCADE_FIRST || b->type > WIRE_FILTER_ALLPASS) return 1;
+    uint8_t order = format_version >= 7 ? b->order : 0;
+    if (order >> 4) return 0;
+    order &= 0x0F;
+    switch (b->type) {
+        case WIRE_FILTER_LR_LP:
+        case WIRE_FILTER_LR_HP:     order = order < 2 ? 2 : order > 8 ? 8 : (uint8_t)((order + 1) & ~1u); break;
+        case WIRE_FILTER_LINKWITZ:  order = 2; break;
+        case WIRE_FILTER_ALLPASS:   order = order == 1 ? 1 : 2; break;
+        default:                    order = order < 1 ? 1 : order > 8 ? 8 : order; break;
+    }
+    return (uint8_t)((order + 1) / 2);
+}
+
+bool config_cost_from_wire(const WireBulkParams *in, uint32_t sample_rate, CostConfig *out) {
+    const WireHeader *h = &in->header;
+    if (h->format_version < 2 || h->format_version > WIRE_FORMAT_VERSION) return false;
+    if (!config_cost_kernels(h->platform_id)) return false;
+    if (h->num_channels > WIRE_MAX_CHANNELS || h->num_output_channels > WIRE_MAX_OUTPUT_CHANNELS) return false;
+    if (h->num_channels != h->num_output_channels + 2) return false;
+
+    memset(out, 0, sizeof(*out));
+    out->platform_id = h->platform_id;
+    out->num_channels = h->num_channels;
+    out->num_outputs = h->num_output_channels;
+
+    float rate = (float)sample_rate;
+    for (int ch = 0; ch < h->num_channels; ch++) {
+        // RP2040 bypass also skips output EQ
+        bool bypassed = in->global.bypass &&
+                        (ch < 2 || h->platform_id == WIRE_PLATFORM_RP2040);
+        if (bypassed) continue;
+        // A cascade's stages take the bands after its first one; a stage
+        // band without its first band is applied as flat
+        for (int b = 0; b < COST_EQ_BANDS; ) {
+            const WireBandParams *bp = &in->eq[ch][b];
+            uint8_t n = band_stages(bp, h->format_version);
+            if (n == 0) { b++; continue; }
+            if (n > COST_EQ_BANDS - b) n = (uint8_t)(COST_EQ_BANDS - b);
+            b += n;
+            if (band_flat(bp)) continue;
+            if (band_svf(bp, h->platform_id, rate)) out->svf_bands[ch] += n;
+            else out->biquad_bands[ch] += n;
+        }
+    }
+
+    for (int o = 0; o < h->num_output_channels; o++) {
+        const WireOutputChannel *oc = &in->outputs[o];
+        if (!oc->enabled) continue;
+        out->output_enabled |= (uint16_t)(1u << o);
+        if (!oc->mute) out->output_eq |= (uint16_t)(1u << o);
+        if (oc->delay_ms * rate >= 500.0f) out->output_delayed |= (uint16_t)(1u << o);   // >= 0.5 sample
+        for (int i = 0; i < WIRE_MAX_INPUT_CHANNELS; i++) {
+            if (in->crosspoints[i][o].enabled) out->crosspoints++;
+        }
+    }
+
+    // Multichannel inputs (V8+): the sparse mix skips unrouted ones, but a
+    // routed one is converted whether or not the host streams it
+    if (h->format_version >= 8 && h->num_input_channels > WIRE_MAX_INPUT_CHANNELS) {
+        int aux = h->num_input_channels - WIRE_MAX_INPUT_CHANNELS;
+        if (aux > WIRE_MAX_AUX_INPUTS) aux = WIRE_MAX_AUX_INPUTS;
+        for (int a = 0; a < aux; a++) {
+            bool routed = false;
+            for (int o = 0; o < h->num_output_channels; o++) {
+                if (!in->outputs[o].enabled || !in->aux_inputs.crosspoints[a][o].enabled) continue;
+                out->crosspoints++;
+                routed = true;
+            }
+            if (routed) out->aux_inputs++;
+        }
+    }
+
+    out->loudness = in->global.loudness_enabled != 0;
+    out->crossfeed = in->crossfeed.enabled != 0;
+    if (h->format_version >= 4) {
+        out->leveller = in->leveller.enabled != 0;
+        out->leveller_lookahead = out->leveller && in->leveller.lookahead;
+    }
+    return true;
+}
+
+static uint32_t channel_cost(const CostKernels *k, const CostConfig *cfg, int ch) {
+    // A dynamic band is also counted as an SVF band when its static gain
+    // is not 0 dB; dyn_band covers the rest
+    uint32_t bands = cfg->biquad_bands[ch] + cfg->svf_bands[ch] + cfg->dyn_bands[ch];
+    if (!bands) return 0;
+    return k->eq_channel + cfg->biquad_bands[ch] * k->biquad + cfg->svf_bands[ch] * k->svf
+         + cfg->dyn_bands[ch] * k->dyn_band;
+}
+
+// One channel of a multiband compressor: LR4 splits of 3 SVFs each plus
+// the phase-matching all-passes (multiband.h), and each band's detector
+// and gain ramp
+static uint32_t multiband_cost(const CostKernels *k, uint8_t bands) {
+    if (!bands) return 0;
+    uint32_t svfs = bands == 4 ? 11 : 7;
+    return svfs * k->mb_svf + bands * k->mb_band;
+}
+
+static uint32_t output_cost(const CostKernels *k, const CostConfig *cfg, int o) {
+    uint16_t bit = (uint16_t)(1u << o);
+    if (!(cfg->output_enabled & bit)) return 0;
+    uint32_t c = k->output;
+    if (cfg->output_eq & bit) c += channel_cost(k, cfg, 2 + o) + multiband_cost(k, cfg->mb_output_bands[o]);
+    if (cfg->output_limited & bit) c += k->limiter;
+    else if (cfg->output_delayed & bit) c += k->delay;
+    if (cfg->fir_partitions[o]) c += k->fir_output + cfg->fir_partitions[o] * k->fir_partition;
+    return c;
+}
+
+static uint32_t xover_cost(const CostKernels *k, const CostConfig *cfg, int o) {
+    if (!cfg->xover_taps[o] || !(cfg->output_enabled & (1u << o))) return 0;
+    return k->xover_output + (uint32_t)(cfg->xover_taps[o] + 1) / 2 * k->xover_pair;
+}
+
+// Longest first, each crossover to the core with less work so far.  The
+// crossovers run before either core's per-output work, and a core waits
+// only for the crossovers of its own outputs, so balancing the totals is
+// close enough.
+static uint16_t assign_xovers(const CostKernels *k, const CostConfig *cfg,
+                              uint32_t *core0, uint32_t *core1) {
+    uint16_t pending = 0, core1_mask = 0;
+    for (int o = 0; o < cfg->num_outputs; o++) {
+        if (xover_cost(k, cfg, o)) pending |= (uint16_t)(1u << o);
+    }
+    while (pending) {
+        int best = -1;
+        uint32_t best_cost = 0;
+        for (int o = 0; o < cfg->num_outputs; o++) {
+            uint32_t c = xover_cost(k, cfg, o);
+            if ((pending & (1u << o)) && c > best_cost) { best = o; best_cost = c; }
+        }
+        pending &= (uint16_t)~(1u << best);
+        if (*core1 < *core0) {
+            *core1 += best_cost;
+            core1_mask |= (uint16_t)(1u << best);
+        } else {
+            *core0 += best_cost;
+        }
+    }
+    return core1_mask;
+}
+
+static uint16_t permille(uint32_t cycles, uint32_t budget) {
+    uint32_t p = budget ? (uint32_t)((uint64_t)cycles * 1000u / budget) : 0xFFFF;
+    return p > 0xFFFF ? 0xFFFF : (uint16_t)p;
+}
+
+void config_cost_estimate(const CostConfig *cfg, uint32_t sample_rate, uint32_t clk_hz,
+                          CostEstimate *out) {
+    memset(out, 0, sizeof(*out));
+    const CostKernels *k = config_cost_kernels(cfg->platform_id);
+    if (!k || !sample_rate || !cfg->num_outputs) {
+        out->result = COST_RESULT_INVALID;
+        return;
+    }
+
+    // Core 1 mode, as derive_core1_mode(): the PDM sub (last output) wins
+    uint8_t pdm_out = cfg->num_outputs - 1;
+    uint8_t c1_last = core1_last_output(cfg->platform_id);
+    if ((cfg->output_enabled & (1u << pdm_out)) && !cfg->pdm_gated) {
+        out->core1_mode = COST_CORE1_PDM;
+    } else {
+        for (int o = COST_CORE1_FIRST_OUTPUT; o <= c1_last; o++) {
+            if (cfg->output_enabled & (1u << o)) out->core1_mode = COST_CORE1_EQ_WORKER;
+        }
+    }
+
+    uint32_t serial = k->base + cfg->aux_inputs * k->aux_input
+                    + channel_cost(k, cfg, 0) + channel_cost(k, cfg, 1)
+                    + cfg->crosspoints * k->crosspoint;
+    if (cfg->loudness) serial += k->loudness;
+    if (cfg->leveller) serial += k->leveller + (cfg->leveller_lookahead ? k->leveller_lookahead : 0);
+    if (cfg->crossfeed) serial += k->crossfeed;
+    if (cfg->asrc) serial += k->asrc;
+    serial += 2 * multiband_cost(k, cfg->mb_master_bands);
+
+    uint32_t parallel = 0, core1 = 0;
+    for (int o = 0; o < cfg->num_outputs; o++) {
+        bool on_core1 = out->core1_mode == COST_CORE1_EQ_WORKER &&
+                        o >= COST_CORE1_FIRST_OUTPUT && o <= c1_last;
+        if (on_core1) core1 += output_cost(k, cfg, o);
+        else parallel += output_cost(k, cfg, o);
+    }
+    if (out->core1_mode == COST_CORE1_PDM) {
+        parallel += k->pdm_push;
+        core1 = k->pdm_modulator;
+    }
+    if (out->core1_mode == COST_CORE1_EQ_WORKER) {
+        out->xover_core1_mask = assign_xovers(k, cfg, &parallel, &core1);
+    } else {
+        for (int o = 0; o < cfg->num_outputs; o++) parallel += xover_cost(k, cfg, o);
+    }
+
+    out->core0_cycles = serial + parallel;
+    out->core1_cycles = core1;
+    if (out->core1_mode == COST_CORE1_EQ_WORKER) {
+        out->critical_cycles = serial + (parallel > core1 ? parallel : core1);
+    } else {
+        out->critical_cycles = out->core0_cycles > core1 ? out->core0_cycles : core1;
+    }
+
+    out->budget_cycles = clk_hz / sample_rate;
+    out->core0_permille = permille(out->core0_cycles, out->budget_cycles);
+    out->core1_permille = permille(out->core1_cycles, out->budget_cycles);
+    out->critical_permille = permille(out->critical_cycles, out->budget_cycles);
+
+    if (out->critical_permille > COST_LIMIT_PERMILLE) out->result = COST_RESULT_OVER;
+    else if (out->critical_permille >= COST_WARN_PERMILLE) out->result = COST_RESULT_WARN;
+    else out->result = COST_RESULT_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Feature gate
+// ---------------------------------------------------------------------------
+
+static const uint8_t gate_order[] = {
+    COST_GATE_CROSSFEED,
+    COST_GATE_LEVELLER,
+    COST_GATE_LOUDNESS,
+    COST_GATE_MASTER_EQ,
+    COST_GATE_PDM,
+};
+
+static uint16_t pdm_output_bit(const CostConfig *cfg) {
+    return cfg->num_outputs ? (uint16_t)(1u << (cfg->num_outputs - 1)) : 0;
+}
+
+// The stages of gate that cfg has on
+static uint8_t gate_present(const CostConfig *cfg, uint8_t gate) {
+    uint8_t on = 0;
+    if (cfg->crossfeed) on |= COST_GATE_CROSSFEED;
+    if (cfg->leveller) on |= COST_GATE_LEVELLER;
+    if (cfg->loudness) on |= COST_GATE_LOUDNESS;
+    for (int ch = 0; ch < 2; ch++) {
+        if (cfg->biquad_bands[ch] || cfg->svf_bands[ch] || cfg->dyn_bands[ch]) on |= COST_GATE_MASTER_EQ;
+    }
+    if ((cfg->output_enabled & pdm_output_bit(cfg)) && !cfg->pdm_gated) on |= COST_GATE_PDM;
+    return on & gate;
+}
+
+void config_cost_apply_gate(CostConfig *cfg, uint8_t gate) {
+    if (gate & COST_GATE_CROSSFEED) cfg->crossfeed = false;
+    if (gate & COST_GATE_LEVELLER) {
+        cfg->leveller = false;
+        cfg->leveller_lookahead = false;
+    }
+    if (gate & COST_GATE_LOUDNESS) cfg->loudness = false;
+    if (gate & COST_GATE_MASTER_EQ) {
+        for (int ch = 0; ch < 2; ch++) {
+            cfg->biquad_bands[ch] = 0;
+            cfg->svf_bands[ch] = 0;
+            cfg->dyn_bands[ch] = 0;
+        }
+    }
+    // The sub is still mixed and equalized on Core 0; only the modulator
+    // and the ring push stop
+    if ((gate & COST_GATE_PDM) && (cfg->output_enabled & pdm_output_bit(cfg))) cfg->pdm_gated = true;
+}
+
+uint8_t config_cost_gate(CostConfig *cfg, uint32_t sample_rate, uint32_t clk_hz,
+                         CostEstimate *out) {
+    uint8_t gated = 0;
+    config_cost_estimate(cfg, sample_rate, clk_hz, out);
+
+    // Nothing taken off Core 0 helps a modulator that overruns on its own
+    if (out->core1_mode == COST_CORE1_PDM && out->core1_permille > COST_LIMIT_PERMILLE) {
+        gated |= COST_GATE_PDM;
+        config_cost_apply_gate(cfg, COST_GATE_PDM);
+        config_cost_estimate(cfg, sample_rate, clk_hz, out);
+    }
+
+    for (unsigned i = 0; i < sizeof(gate_order) && out->result == COST_RESULT_OVER; i++) {
+        uint8_t g = gate_present(cfg, gate_order[i]);
+        if (!g) continue;
+        gated |= g;
+        config_cost_apply_gate(cfg, g);
+        config_cost_estimate(cfg, sample_rate, clk_hz, out);
+    }
+    return gated;
+}
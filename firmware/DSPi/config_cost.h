@@ -0,0 +1,153 @@
+/*
+ * config_cost.h — Pre-flight CPU cost estimate of a DSP configuration
+ *
+ * Predicts the cycles per sample each core would spend on a configuration
+ * before it is applied, from a per-platform table of kernel costs: active
+ * EQ bands (biquad or SVF), loudness, leveller, crossfeed, multichannel
+ * inputs, matrix crosspoints, enabled outputs, delays, FIR partitions and
+ * crossovers, dynamic EQ bands, multiband compressors, the rate lock ASRC
+ * and the PDM modulator.  The Core 1 mode is derived the same way
+ * derive_core1_mode() does, and work split between the cores follows the
+ * EQ worker assignment.  FIR crossovers can run on either core; the
+ * estimate also decides which core runs each one (xover_core1_mask).
+ *
+ * The firmware checks REQ_SET_ALL_PARAMS payloads and preset loads and
+ * reports the result without refusing (the kernels are uncalibrated); the
+ * host app links the same files to show headroom for a configuration it
+ * has not sent yet.
+ *
+ * Feature gate: what fits at 48 kHz may not at 176.4 or 192 kHz, where the
+ * budget per sample is a quarter.  config_cost_gate() sheds optional stages
+ * until the estimate fits, and the firmware bypasses those stages for as
+ * long as the rate and settings keep them over budget instead of letting
+ * every block underrun.
+ *
+ * Like vendor_frame.c, plain C with no SDK dependencies: the input is either
+ * a WireBulkParams image or a CostConfig summary, and the platform comes
+ * from the image's header.
+ */
+
+#ifndef CONFIG_COST_H
+#define CONFIG_COST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "bulk_params.h"
+
+#define COST_EQ_BANDS           10      // channel_band_counts[] on both platforms
+#define COST_WARN_PERMILLE      900     // Critical path at or above this: warn
+#define COST_LIMIT_PERMILLE     1000    // Above this: COST_RESULT_OVER
+
+// Results
+#define COST_RESULT_OK          0
+#define COST_RESULT_WARN        1       // Within budget, little headroom
+#define COST_RESULT_OVER        2       // Predicted to overrun every block
+#define COST_RESULT_INVALID     3       // Image not understood (version / platform)
+
+// Feature gate: stages config_cost_gate() may shed, in the order it sheds
+// them.  Output EQ, FIRs, delays and limiters are never shed: they shape
+// what each driver receives.
+#define COST_GATE_CROSSFEED     0x01
+#define COST_GATE_LEVELLER      0x02
+#define COST_GATE_LOUDNESS      0x04
+#define COST_GATE_MASTER_EQ     0x08    // Master EQ bands, dynamic ones included
+#define COST_GATE_PDM           0x10    // PDM sub: first when the modulator alone overruns Core 1
+#define COST_GATE_SPDIF_RATE    0x20    // S/PDIF slots carry silence: rate above SPDIF_RATE_MAX (not a cost)
+
+// Core 1 modes (values match Core1Mode)
+#define COST_CORE1_IDLE         0
+#define COST_CORE1_PDM          1
+#define COST_CORE1_EQ_WORKER    2
+
+// Kernel costs, cycles per sample.  Initial figures come from the inner-loop
+// instruction counts at -O3; recalibrate against the stage profiler
+// (REQ_GET_PROFILER_STAGE) when the pipeline changes.
+typedef struct {
+    uint16_t base;              // Input conversion, preamp, master peaks
+    uint16_t aux_input;         // One multichannel input past the master pair: conversion, preamp, peak
+    uint16_t biquad;            // One active biquad band
+    uint16_t svf;               // One active SVF band
+    uint16_t eq_channel;        // Per channel with any active band
+    uint16_t loudness;          // Stereo loudness shelves
+    uint16_t crossfeed;
+    uint16_t leveller;
+    uint16_t leveller_lookahead;
+    uint16_t crosspoint;        // One enabled matrix crosspoint
+    uint16_t output;            // Gain, peak and S/PDIF / I2S packing per enabled output
+    uint16_t delay;             // Per output with a delay
+    uint16_t pdm_push;          // Core 0: sub sample to the PDM ring
+    uint16_t pdm_modulator;     // Core 1: 256x sigma-delta per sample
+    uint16_t fir_output;        // Per output with a FIR: both FFTs, block copies
+    uint16_t fir_partition;     // One FIR partition (spectrum multiply-add)
+    uint16_t xover_output;      // Per output with a FIR crossover: history copies
+    uint16_t xover_pair;        // One symmetric crossover coefficient pair
+    uint16_t dyn_band;          // Dynamic EQ band on top of its SVF: sidechain, detector, ramp
+    uint16_t mb_svf;            // Multiband compressor: one split / all-pass SVF, per channel
+    uint16_t mb_band;           // Multiband compressor: one band's detector and gain, per channel
+    uint16_t limiter;           // Per limited output, in place of delay: detector, 4x oversampling
+    uint16_t asrc;              // Rate lock resampler, stereo, per output sample
+} CostKernels;
+
+// What the estimate depends on, extracted from a wire image or live state.
+typedef struct {
+    uint8_t  platform_id;       // WIRE_PLATFORM_*
+    uint8_t  num_channels;
+    uint8_t  num_outputs;
+    uint8_t  biquad_bands[WIRE_MAX_CHANNELS];   // Active biquad bands per channel
+    uint8_t  svf_bands[WIRE_MAX_CHANNELS];      // Active SVF bands per channel
+    uint16_t output_enabled;    // Bit per output
+    uint16_t output_eq;         // Bit per output whose EQ runs (enabled, not muted)
+    uint16_t output_delayed;    // Bit per output with a delay
+    uint8_t  crosspoints;       // Enabled crosspoints into enabled outputs
+    uint8_t  aux_inputs;        // Multichannel inputs routed to an enabled output
+    bool     loudness;
+    bool     crossfeed;
+    bool     leveller;
+    bool     leveller_lookahead;
+    uint8_t  fir_partitions[WIRE_MAX_OUTPUT_CHANNELS];  // Active FIR partitions per output
+    uint16_t xover_taps[WIRE_MAX_OUTPUT_CHANNELS];      // FIR crossover taps per output (0 = none)
+    uint8_t  dyn_bands[WIRE_MAX_CHANNELS];              // Dynamic EQ bands per channel
+    uint8_t  mb_master_bands;                           // Multiband compressor on the master pair (0 = off)
+    uint8_t  mb_output_bands[WIRE_MAX_OUTPUT_CHANNELS]; // Multiband compressor per output (0 = none)
+    uint16_t output_limited;    // Bit per output with a true-peak limiter
+    bool     asrc;              // Rate lock resampling the input
+    bool     pdm_gated;         // Sub still mixed, its modulator shed (COST_GATE_PDM)
+} CostConfig;
+
+typedef struct {
+    uint32_t core0_cycles;      // Per sample, Core 0's own work
+    uint32_t core1_cycles;      // Per sample, Core 1 (EQ worker or PDM)
+    uint32_t critical_cycles;   // Per sample, one block's wall time
+    uint32_t budget_cycles;     // clk_sys / sample rate
+    uint16_t core0_permille;
+    uint16_t core1_permille;
+    uint16_t critical_permille;
+    uint8_t  core1_mode;        // COST_CORE1_*
+    uint8_t  result;            // COST_RESULT_*
+    uint16_t xover_core1_mask;  // FIR crossovers assigned to Core 1 (EQ worker mode)
+} CostEstimate;
+
+// Kernel table for a platform, NULL if unknown.
+const CostKernels *config_cost_kernels(uint8_t platform_id);
+
+// Summarize a wire image as it would run at sample_rate.  False if the
+// header's version or platform is not understood.  FIR filters are not
+// part of the image, nor are dynamic EQ, multiband compressor, limiter or
+// rate lock settings; fir_partitions, xover_taps, dyn_bands, the mb_
+// fields, output_limited and asrc are left zero for the caller to fill.
+bool config_cost_from_wire(const WireBulkParams *in, uint32_t sample_rate, CostConfig *out);
+
+// Estimate a configuration at sample_rate on a clk_hz system clock.
+void config_cost_estimate(const CostConfig *cfg, uint32_t sample_rate, uint32_t clk_hz,
+                          CostEstimate *out);
+
+// Remove the COST_GATE_* stages in gate from cfg.
+void config_cost_apply_gate(CostConfig *cfg, uint8_t gate);
+
+// Shed stages from cfg until it is no longer COST_RESULT_OVER, or nothing
+// is left to shed.  Returns the COST_GATE_* stages shed (only ones cfg had
+// on); out is the estimate of what is left.
+uint8_t config_cost_gate(CostConfig *cfg, uint32_t sample_rate, uint32_t clk_hz,
+                         CostEstimate *out);
+
+#endif // CONFIG_COST_H
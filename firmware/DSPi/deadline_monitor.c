@@ -0,0 +1,105 @@
+/*
+ * deadline_monitor.c — Worst-case block time against the real-time budget
+ */
+
+#include <string.h>
+#include "deadline_monitor.h"
+#include "event_trace.h"
+#include "pico/stdlib.h"
+
+typedef struct {
+    uint32_t blocks;
+    uint32_t misses;
+    uint32_t budget_us;
+    uint32_t worst_us;
+    uint32_t worst_permille;
+    uint32_t window_permille;       // Worst of the window in progress
+    uint32_t window_count;
+    uint32_t recent_permille;       // Worst of the last full window
+} CoreDeadline;
+
+static CoreDeadline core_stats[2];
+static volatile uint32_t clear_seq = 0;         // Bumped by a clearing read
+static uint32_t core_clear_seq[2];              // Last clear each core applied
+
+static inline bool core_current(uint8_t core) {
+    return core_clear_seq[core] == clear_seq;
+}
+
+void __not_in_flash_func(deadline_record)(uint8_t core, uint32_t busy_us, uint32_t sample_count, uint32_t sample_rate) {
+    CoreDeadline *d = &core_stats[core];
+
+    uint32_t seq = clear_seq;
+    if (core_clear_seq[core] != seq) {
+        memset(d, 0, sizeof(*d));
+        core_clear_seq[core] = seq;
+    }
+
+    if (!sample_count || !sample_rate) return;
+    uint32_t budget_us = sample_count * 1000000u / sample_rate;   // <= 192e6, no overflow
+    if (!budget_us) return;
+    uint32_t permille = busy_us * 1000u / budget_us;
+
+    d->blocks++;
+    d->budget_us = budget_us;
+    if (busy_us > budget_us) {
+        d->misses++;
+        trace_burst(TRACE_EVT_DEADLINE_MISS, busy_us);
+    }
+    if (busy_us > d->worst_us) d->worst_us = busy_us;
+    if (permille > d->worst_permille) d->worst_permille = permille;
+
+    if (permille > d->window_permille) d->window_permille = permille;
+    if (++d->window_count >= DEADLINE_WINDOW_BLOCKS) {
+        d->recent_permille = d->window_permille;
+        d->window_permille = 0;
+        d->window_count = 0;
+    }
+
+    if (core == 0) global_status.status_flags = deadline_status_flags();
+}
+
+uint8_t deadline_status_flags(void) {
+    uint8_t flags = 0;
+    for (int c = 0; c < 2; c++) {
+        if (!core_current(c)) continue;
+        if (core_stats[c].worst_permille >= DEADLINE_WARN_PERMILLE) flags |= STATUS_FLAG_OVERLOAD_WARN;
+        if (core_stats[c].misses) flags |= STATUS_FLAG_DEADLINE_MISS;
+    }
+    return flags;
+}
+
+static inline uint16_t sat16(uint32_t v) {
+    return v > 0xFFFF ? 0xFFFF : (uint16_t)v;
+}
+
+void deadline_get_stats(DeadlineStatsPacket *out, bool clear) {
+    CoreDeadline c0, c1;
+    if (core_current(0)) c0 = core_stats[0]; else memset(&c0, 0, sizeof(c0));
+    if (core_current(1)) c1 = core_stats[1]; else memset(&c1, 0, sizeof(c1));
+
+    memset(out, 0, sizeof(*out));
+    out->blocks = c0.blocks;
+    out->misses = c0.misses;
+    out->core1_blocks = c1.blocks;
+    out->core1_misses = c1.misses;
+    out->budget_us = sat16(c0.budget_us);
+    out->worst_us = sat16(c0.worst_us);
+    out->worst_permille = sat16(c0.worst_permille);
+    out->recent_permille = sat16(c0.recent_permille);
+    out->core1_worst_us = sat16(c1.worst_us);
+    out->core1_worst_permille = sat16(c1.worst_permille);
+    out->core1_recent_permille = sat16(c1.recent_permille);
+
+    uint32_t worst = c0.worst_permille > c1.worst_permille ? c0.worst_permille : c1.worst_permille;
+    if (worst > 1000 - INT16_MIN) worst = 1000 - INT16_MIN;
+    out->headroom_permille = (int16_t)(1000 - (int32_t)worst);
+    out->flags = deadline_status_flags();
+    out->warn_permille_div10 = DEADLINE_WARN_PERMILLE / 10;
+    out->window_blocks = DEADLINE_WINDOW_BLOCKS;
+
+    if (clear) {
+        clear_seq++;
+        global_status.status_flags = 0;
+    }
+}
@@ -0,0 +1,39 @@
+/*
+ * deadline_monitor.h — Worst-case block time against the real-time budget
+ *
+ * cpu0_load / cpu1_load are EMAs: a configuration can average 70% and still
+ * overrun a block now and then when USB IRQs and flash work land in it.
+ * The monitor keeps the high-water mark of each core's block time as a
+ * fraction of that block's budget (sample_count / sample rate), counts
+ * blocks that overran, and keeps the worst of the last full window for a
+ * live view.
+ *
+ * Core 0 records every process_audio_packet() pass; Core 1 every EQ worker
+ * pass.  Each core writes only its own statistics.  A clear from the vendor
+ * IRQ is applied by each core on its next record; until then that core's
+ * statistics read as empty.
+ *
+ * global_status.status_flags is refreshed by Core 0 after every block:
+ * STATUS_FLAG_OVERLOAD_WARN once either high-water reaches
+ * DEADLINE_WARN_PERMILLE, STATUS_FLAG_DEADLINE_MISS once a block overran.
+ * Both latch until cleared.
+ */
+
+#ifndef DEADLINE_MONITOR_H
+#define DEADLINE_MONITOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+// Record one block.  `core` is the calling core; busy_us is the block's
+// wall-clock processing time.
+void deadline_record(uint8_t core, uint32_t busy_us, uint32_t sample_count, uint32_t sample_rate);
+
+// Current STATUS_FLAG_* bits.
+uint8_t deadline_status_flags(void);
+
+// Fill a statistics report, then optionally clear.  IRQ-safe.
+void deadline_get_stats(DeadlineStatsPacket *out, bool clear);
+
+#endif // DEADLINE_MONITOR_H
@@ -0,0 +1,17 @@
+/*
+ * dsp_math.h — Constants shared by the DSP modules
+ *
+ * Single-precision literals, so expressions stay in float on the M33 FPU.
+ * No SDK dependencies: the host tests build the modules that use it.
+ */
+
+#ifndef DSP_MATH_H
+#define DSP_MATH_H
+
+#define PI_F                3.1415926535f
+#define TWO_PI_F            6.28318530718f
+#define SQRT2_F             1.4142135624f
+#define LN10_OVER_20        0.11512925f     // ln(10) / 20: dB to linear
+#define LN10_OVER_40        0.05756463f     // ln(10) / 40: dB to shelf amplitude A
+
+#endif // DSP_MATH_H
@@ -2,6 +2,11 @@
 #include <string.h>
 #include "dsp_pipeline.h"
 #include "dcp_inline.h"
+#include "latency_profile.h"
+#include "fir_bank.h"
+#include "filter_cascade.h"
+#include "dyneq.h"
+#include "limiter.h"
 
 static inline bool is_filter_flat(const EqParamPacket *p) {
     if (p->type == FILTER_FLAT) return true;
@@ -58,17 +63,96 @@ DSP_TIME_CRITICAL int32_t fast_mul_q28(int32_t a, int32_t b) {
 }
 #endif
 
-void dsp_compute_coefficients(EqParamPacket *p, Biquad *bq, float sample_rate) {
-    if (is_filter_flat(p) || sample_rate == 0) {
-        bq->bypass = true;
+static void set_bypass(Biquad *bq) {
+    bq->bypass = true;
 #if PICO_RP2350
-        bq->b0 = 1.0f; bq->b1 = 0.0f; bq->b2 = 0.0f; bq->a1 = 0.0f; bq->a2 = 0.0f;
-        bq->sva1 = 0.0f; bq->sva2 = 0.0f; bq->sva3 = 0.0f;
-        bq->svm0 = 0.0f; bq->svm1 = 0.0f; bq->svm2 = 0.0f;
-        bq->use_svf = false;
+    bq->b0 = 1.0f; bq->b1 = 0.0f; bq->b2 = 0.0f; bq->a1 = 0.0f; bq->a2 = 0.0f;
+    bq->sva1 = 0.0f; bq->sva2 = 0.0f; bq->sva3 = 0.0f;
+    bq->svm0 = 0.0f; bq->svm1 = 0.0f; bq->svm2 = 0.0f;
+    bq->use_svf = false;
+    bq->cascade = 0;
+    bq->dyn = 0;
+#else
+    bq->b0 = 1 << FILTER_SHIFT; bq->b1 = 0; bq->b2 = 0; bq->a1 = 0; bq->a2 = 0;
+#endif
+}
+
+static void store_biquad(Biquad *bq, float b0_f, float b1_f, float b2_f,
+                         float a0_f, float a1_f, float a2_f) {
+#if PICO_RP2350
+    // Float storage
+    float inv_a0 = 1.0f / a0_f;
+    bq->b0 = b0_f * inv_a0;
+    bq->b1 = b1_f * inv_a0;
+    bq->b2 = b2_f * inv_a0;
+    bq->a1 = a1_f * inv_a0;
+    bq->a2 = a2_f * inv_a0;
 #else
-        bq->b0 = 1 << FILTER_SHIFT; bq->b1 = 0; bq->b2 = 0; bq->a1 = 0; bq->a2 = 0;
+    // Q28 Fixed Point Storage
+    float scale = (float)(1LL << FILTER_SHIFT);
+    bq->b0 = (int32_t)((b0_f / a0_f) * scale);
+    bq->b1 = (int32_t)((b1_f / a0_f) * scale);
+    bq->b2 = (int32_t)((b2_f / a0_f) * scale);
+    bq->a1 = (int32_t)((a1_f / a0_f) * scale);
+    bq->a2 = (int32_t)((a2_f / a0_f) * scale);
 #endif
+}
+
+// One stage of a cascade type (filter_cascade.h).  The section is bilinear
+// transformed with its pole frequency prewarped; on RP2350 the SVF path
+// realizes the same section through its output mix.
+static void cascade_coefficients(const EqParamPacket *p, Biquad *bq, float sample_rate) {
+    CascadeSection s;
+    if (!cascade_section(p, sample_rate, &s)) {
+        set_bypass(bq);
+        return;
+    }
+    float g = tanf(3.1415926535f * s.pole_hz / sample_rate);
+    float c2 = s.c2, c1 = s.c1, c0 = s.c0, k = s.k;
+
+#if PICO_RP2350
+    if (bq->use_svf) {
+        if (s.first_order) {
+            // (c1 s + c0) / (s + 1) as (c1 s + c0)(s + 1) / (s + 1)^2
+            c2 = s.c1; c1 = s.c1 + s.c0; k = 2.0f;
+        }
+        bq->sva1 = 1.0f / (1.0f + g * (g + k));
+        bq->sva2 = g * bq->sva1;
+        bq->sva3 = g * bq->sva2;
+        bq->svm0 = c2;
+        bq->svm1 = c1 - c2 * k;
+        bq->svm2 = c0 - c2;
+
+        // Reuse the specialized inner loops where the mix matches
+        if (bq->svm0 == 0.0f && bq->svm1 == 0.0f && bq->svm2 == 1.0f) bq->svf_type = FILTER_LOWPASS;
+        else if (bq->svm0 == 1.0f && bq->svm2 == -1.0f && bq->svm1 == -k) bq->svf_type = FILTER_HIGHPASS;
+        else if (bq->svm0 == 1.0f && bq->svm2 == 0.0f) bq->svf_type = FILTER_PEAKING;
+        else bq->svf_type = FILTER_LOWSHELF;     // General mix
+
+        bq->b0 = 1.0f; bq->b1 = 0.0f; bq->b2 = 0.0f; bq->a1 = 0.0f; bq->a2 = 0.0f;
+        return;
+    }
+    bq->sva1 = 0.0f; bq->sva2 = 0.0f; bq->sva3 = 0.0f;
+    bq->svm0 = 0.0f; bq->svm1 = 0.0f; bq->svm2 = 0.0f;
+#endif
+
+    float gg = g * g;
+    if (s.first_order) {
+        store_biquad(bq, c1 + c0 * g, c0 * g - c1, 0.0f, 1.0f + g, g - 1.0f, 0.0f);
+    } else {
+        store_biquad(bq, c2 + c1 * g + c0 * gg, 2.0f * (c0 * gg - c2), c2 - c1 * g + c0 * gg,
+                     1.0f + k * g + gg, 2.0f * (gg - 1.0f), 1.0f - k * g + gg);
+    }
+}
+
+void dsp_compute_coefficients(EqParamPacket *p, Biquad *bq, float sample_rate) {
+    // A dynamic band runs at 0 dB static gain too: the sidechain moves it
+    uint8_t dyn = 0;
+#if ENABLE_DYNEQ
+    dyn = dyneq_band_slot(p);
+#endif
+    if ((dyn ? p->freq <= 0.0f : is_filter_flat(p)) || sample_rate == 0) {
+        set_bypass(bq);
         return;
     }
 
@@ -85,12 +169,23 @@ void dsp_compute_coefficients(EqParamPacket *p, Biquad *bq, float sample_rate) {
 #if PICO_RP2350
     // SVF/biquad crossover decision + state reset on path change
     bool was_svf = bq->use_svf;
-    bq->use_svf = (p->freq < (sample_rate / 7.5f));
+    bq->use_svf = dyn || (p->freq < (sample_rate / 7.5f));
     if (was_svf != bq->use_svf) {
         bq->s1 = 0.0f; bq->s2 = 0.0f;
         bq->svic1eq = 0.0f; bq->svic2eq = 0.0f;
     }
 
+    bq->cascade = cascade_head_stages(p);
+    if (dyn) {
+        dyneq_compute_band(p, bq, sample_rate, dyn);
+        return;
+    }
+    bq->dyn = 0;
+    if (cascade_is_type(p->type)) {
+        cascade_coefficients(p, bq, sample_rate);
+        return;
+    }
+
     if (bq->use_svf) {
         // SVF coefficients (Simper, "SvfLinearTrapAllOutputs", Cytomic 2021)
         // Shelf k = 1/Q matches RBJ Audio-EQ-Cookbook response exactly.
@@ -140,6 +235,11 @@ void dsp_compute_coefficients(EqParamPacket *p, Biquad *bq, float sample_rate) {
     // Clear SVF coefficients for biquad path
     bq->sva1 = 0.0f; bq->sva2 = 0.0f; bq->sva3 = 0.0f;
     bq->svm0 = 0.0f; bq->svm1 = 0.0f; bq->svm2 = 0.0f;
+#else
+    if (cascade_is_type(p->type)) {
+        cascade_coefficients(p, bq, sample_rate);
+        return;
+    }
 #endif
 
     float omega = 2.0f * 3.1415926535f * p->freq / sample_rate;
@@ -154,24 +254,36 @@ void dsp_compute_coefficients(EqParamPacket *p, Biquad *bq, float sample_rate) {
         case FILTER_HIGHSHELF: b0_f = A*((A+1)+(A-1)*cs+2*sqrtf(A)*alpha); b1_f = -2*A*((A-1)+(A+1)*cs); b2_f = A*((A+1)+(A-1)*cs-2*sqrtf(A)*alpha); a0_f = (A+1)-(A-1)*cs+2*sqrtf(A)*alpha; a1_f = 2*((A-1)-(A+1)*cs); a2_f = (A+1)-(A-1)*cs-2*sqrtf(A)*alpha; break;
         default: break;
     }
+    store_biquad(bq, b0_f, b1_f, b2_f, a0_f, a1_f, a2_f);
+}
 
+// Copy precomputed coefficients into a live filter, preserving its state.
+// Mirrors the SVF/biquad path-change reset in dsp_compute_coefficients().
+void dsp_load_coefficients(Biquad *bq, const Biquad *src) {
 #if PICO_RP2350
-    // Float storage
-    float inv_a0 = 1.0f / a0_f;
-    bq->b0 = b0_f * inv_a0;
-    bq->b1 = b1_f * inv_a0;
-    bq->b2 = b2_f * inv_a0;
-    bq->a1 = a1_f * inv_a0;
-    bq->a2 = a2_f * inv_a0;
+    if (bq->use_svf != src->use_svf) {
+        bq->s1 = 0.0f; bq->s2 = 0.0f;
+        bq->svic1eq = 0.0f; bq->svic2eq = 0.0f;
+    }
+    bq->b0 = src->b0; bq->b1 = src->b1; bq->b2 = src->b2;
+    bq->a1 = src->a1; bq->a2 = src->a2;
+    bq->sva1 = src->sva1; bq->sva2 = src->sva2; bq->sva3 = src->sva3;
+    bq->svm0 = src->svm0; bq->svm1 = src->svm1; bq->svm2 = src->svm2;
+    bq->svf_type = src->svf_type;
+    bq->use_svf = src->use_svf;
+    bq->cascade = src->cascade;
+    if (bq->dyn != src->dyn) {
+        bq->dyn_sc1 = 0.0f; bq->dyn_sc2 = 0.0f;
+        bq->dyn_env = 0.0f; bq->dyn_gr_db = 0.0f;
+    }
+    bq->dyn_k = src->dyn_k;
+    bq->dyn_gain_db = src->dyn_gain_db;
+    bq->dyn = src->dyn;
 #else
-    // Q28 Fixed Point Storage
-    float scale = (float)(1LL << FILTER_SHIFT);
-    bq->b0 = (int32_t)((b0_f / a0_f) * scale);
-    bq->b1 = (int32_t)((b1_f / a0_f) * scale);
-    bq->b2 = (int32_t)((b2_f / a0_f) * scale);
-    bq->a1 = (int32_t)((a1_f / a0_f) * scale);
-    bq->a2 = (int32_t)((a2_f / a0_f) * scale);
+    bq->b0 = src->b0; bq->b1 = src->b1; bq->b2 = src->b2;
+    bq->a1 = src->a1; bq->a2 = src->a2;
 #endif
+    bq->bypass = src->bypass;
 }
 
 void dsp_init_default_filters() {
@@ -213,6 +325,31 @@ void dsp_init_default_filters() {
     filter_recipes[CH_OUT_SUB][0] = lp;
 }
 
+// Delay line length in samples for output `out` at `delay_ms`, including
+// the PDM sub alignment on the last delay channel.
+int32_t dsp_delay_samples_for(int out, float delay_ms, float sample_rate) {
+    // PDM sub needs alignment compensation (last delay channel).
+    // Negative only while the sub is off (see latency_profile.c).
+    if (out == NUM_DELAY_CHANNELS - 1) {
+        int32_t align = latency_profile_sub_align_samples();
+        if (align > 0) delay_ms += (float)align / sample_rate * 1000.0f;
+    }
+#if ENABLE_FIR
+    // Outputs with less FIR latency wait for the one with the most
+    int32_t fir_comp = fir_latency_comp_samples((uint8_t)out);
+    if (fir_comp > 0) delay_ms += (float)fir_comp / sample_rate * 1000.0f;
+#endif
+
+    int32_t samples = (int32_t)(delay_ms * sample_rate / 1000.0f);
+#if ENABLE_LIMITER
+    // Every output waits out the limiters' lookahead
+    samples += limiter_latency_samples();
+#endif
+    if (samples > MAX_DELAY_SAMPLES) samples = MAX_DELAY_SAMPLES;
+    if (samples < 0) samples = 0;
+    return samples;
+}
+
 void dsp_update_delay_samples(float sample_rate) {
     // Update delay samples for all 9 output channels
     // Delay values come from the matrix mixer OutputChannel.delay_ms
@@ -221,17 +358,7 @@ void dsp_update_delay_samples(float sample_rate) {
     any_delay_active = false;
     for (int out = 0; out < NUM_DELAY_CHANNELS; out++) {
         // Get delay_ms from the corresponding EQ channel (CH_OUT_1 + out)
-        float delay_ms = channel_delays_ms[CH_OUT_1 + out];
-
-        // PDM sub needs alignment compensation (last delay channel)
-        if (out == NUM_DELAY_CHANNELS - 1) {
-            float align_ms = (float)SUB_ALIGN_SAMPLES / sample_rate * 1000.0f;
-            delay_ms += align_ms;
-        }
-
-        int32_t samples = (int32_t)(delay_ms * sample_rate / 1000.0f);
-        if (samples > MAX_DELAY_SAMPLES) samples = MAX_DELAY_SAMPLES;
-        if (samples < 0) samples = 0;
+        int32_t samples = dsp_delay_samples_for(out, channel_delays_ms[CH_OUT_1 + out], sample_rate);
         channel_delay_samples[out] = samples;
 
         if (samples > 0) any_delay_active = true;
@@ -278,6 +405,87 @@ float dsp_process_channel(Biquad * __restrict biquads, float input, uint8_t chan
     return sample;
 }
 
+// Cascade kernel: the stages of one cascade type share a path (chosen from
+// the recipe frequency), so they run two per pass over the block with the
+// intermediate sample kept in a register.  SVF stages use the general mix.
+DSP_TIME_CRITICAL
+static void process_cascade_block(Biquad * __restrict st, uint8_t stages,
+                                  float * __restrict samples, uint32_t count) {
+    uint8_t s = 0;
+    if (st->use_svf) {
+        for (; s < stages; s += 2) {
+            Biquad *x = &st[s];
+            float xa1 = x->sva1, xa2 = x->sva2, xa3 = x->sva3;
+            float xm0 = x->svm0, xm1 = x->svm1, xm2 = x->svm2;
+            float x1 = x->svic1eq, x2 = x->svic2eq;
+            if (s + 1 == stages) {
+                for (uint32_t i = 0; i < count; i++) {
+                    float in = samples[i];
+                    float v3 = in - x2;
+                    float v1 = xa1 * x1 + xa2 * v3;
+                    float v2 = x2 + xa2 * x1 + xa3 * v3;
+                    x1 = 2.0f * v1 - x1;
+                    x2 = 2.0f * v2 - x2;
+                    samples[i] = xm0 * in + xm1 * v1 + xm2 * v2;
+                }
+            } else {
+                Biquad *y = &st[s + 1];
+                float ya1 = y->sva1, ya2 = y->sva2, ya3 = y->sva3;
+                float ym0 = y->svm0, ym1 = y->svm1, ym2 = y->svm2;
+                float y1 = y->svic1eq, y2 = y->svic2eq;
+                for (uint32_t i = 0; i < count; i++) {
+                    float in = samples[i];
+                    float v3 = in - x2;
+                    float v1 = xa1 * x1 + xa2 * v3;
+                    float v2 = x2 + xa2 * x1 + xa3 * v3;
+                    x1 = 2.0f * v1 - x1;
+                    x2 = 2.0f * v2 - x2;
+                    float mid = xm0 * in + xm1 * v1 + xm2 * v2;
+                    v3 = mid - y2;
+                    v1 = ya1 * y1 + ya2 * v3;
+                    v2 = y2 + ya2 * y1 + ya3 * v3;
+                    y1 = 2.0f * v1 - y1;
+                    y2 = 2.0f * v2 - y2;
+                    samples[i] = ym0 * mid + ym1 * v1 + ym2 * v2;
+                }
+                y->svic1eq = y1; y->svic2eq = y2;
+            }
+            x->svic1eq = x1; x->svic2eq = x2;
+        }
+    } else {
+        for (; s < stages; s += 2) {
+            Biquad *x = &st[s];
+            float xb0 = x->b0, xb1 = x->b1, xb2 = x->b2, xa1 = x->a1, xa2 = x->a2;
+            float xs1 = x->s1, xs2 = x->s2;
+            if (s + 1 == stages) {
+                for (uint32_t i = 0; i < count; i++) {
+                    float in = samples[i];
+                    float out = xb0 * in + xs1;
+                    xs1 = xb1 * in - xa1 * out + xs2;
+                    xs2 = xb2 * in - xa2 * out;
+                    samples[i] = out;
+                }
+            } else {
+                Biquad *y = &st[s + 1];
+                float yb0 = y->b0, yb1 = y->b1, yb2 = y->b2, ya1 = y->a1, ya2 = y->a2;
+                float ys1 = y->s1, ys2 = y->s2;
+                for (uint32_t i = 0; i < count; i++) {
+                    float in = samples[i];
+                    float mid = xb0 * in + xs1;
+                    xs1 = xb1 * in - xa1 * mid + xs2;
+                    xs2 = xb2 * in - xa2 * mid;
+                    float out = yb0 * mid + ys1;
+                    ys1 = yb1 * mid - ya1 * out + ys2;
+                    ys2 = yb2 * mid - ya2 * out;
+                    samples[i] = out;
+                }
+                y->s1 = ys1; y->s2 = ys2;
+            }
+            x->s1 = xs1; x->s2 = xs2;
+        }
+    }
+}
+
 DSP_TIME_CRITICAL
 void dsp_process_channel_block(Biquad * __restrict biquads, float * __restrict samples,
                                uint32_t count, uint8_t channel) {
@@ -287,6 +495,19 @@ void dsp_process_channel_block(Biquad * __restrict biquads, float * __restrict s
         Biquad *bq = &biquads[band];
         if (bq->bypass) continue;
 
+#if ENABLE_DYNEQ
+        if (bq->dyn) {
+            dyneq_process_band(bq, samples, count);
+            continue;
+        }
+#endif
+
+        if (bq->cascade > 1 && band + bq->cascade <= num_bands) {
+            process_cascade_block(bq, bq->cascade, samples, count);
+            band += bq->cascade - 1;
+            continue;
+        }
+
         if (bq->use_svf) {
             // Load SVF coefficients
             float a1 = bq->sva1, a2 = bq->sva2, a3 = bq->sva3;
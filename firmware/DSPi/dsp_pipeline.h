@@ -25,8 +25,10 @@ extern bool any_delay_active;  // True if any channel has non-zero delay
 // API
 void dsp_init_default_filters(void);
 void dsp_compute_coefficients(EqParamPacket *p, Biquad *bq, float sample_rate);
+void dsp_load_coefficients(Biquad *bq, const Biquad *src);
 void dsp_recalculate_all_filters(float sample_rate);
 void dsp_update_delay_samples(float sample_rate);
+int32_t dsp_delay_samples_for(int out, float delay_ms, float sample_rate);
 
 // Optimized processing function
 #if PICO_RP2350
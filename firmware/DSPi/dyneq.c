@@ -0,0 +1,325 @@
+/*
+ * dyneq.c — Dynamic EQ bands (RP2350)
+ *
+ * Per block, for each dynamic band:
+ *   1. Per-sample: band-pass the band's input (SVF, unity peak) and update
+ *      an RMS envelope of it
+ *   2. Per-block:  soft-knee downward gain computer, limited to range_db
+ *   3. Per-block:  attack / release smoothing of the gain change (dB)
+ *   4. Per-sample: the band's SVF with its output mix ramped from the last
+ *      block's values to this block's
+ *
+ * Threading: slots are written by the main loop only, with Core 1 idle
+ * (Core 0 audio runs from the main loop itself).  The audio path reads a
+ * slot through Biquad.dyn; per-band state lives in the Biquad.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "dyneq.h"
+#include "dsp_math.h"
+#include "dsp_pipeline.h"
+#include "leveller.h"
+#include "flash_storage.h"
+#include "pdm_generator.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#if ENABLE_DYNEQ
+
+_Static_assert(sizeof(DynEqPacket) == 28, "DynEqPacket is a wire format");
+_Static_assert(sizeof(DynEqStatusPacket) == 40, "DynEqStatusPacket is a wire format");
+
+#define DYNEQ_RMS_SEC       0.010f          // Detector RMS window
+#define DYNEQ_KNEE_DB       6.0f
+#define DYNEQ_REQ_QUEUE     8               // Power of two
+
+typedef struct {
+    DynEqPacket cfg;            // cfg.enabled: slot in use; values clamped
+    EqParamPacket recipe;       // Band recipe the sidechain was designed from
+    uint32_t rate;              // Rate the sidechain and time constants are for
+
+    // Sidechain band-pass (SVF) and detector, at the live rate
+    float sca1, sca2, sca3, sck;
+    float alpha_rms, alpha_attack, alpha_release;
+    float slope;                // 1 - 1/ratio
+} DynEqSlot;
+
+static DynEqSlot slots[DYNEQ_MAX_BANDS];
+
+// Requests (USB IRQ → main loop), in order
+static DynEqPacket req_queue[DYNEQ_REQ_QUEUE];
+static volatile uint8_t req_head, req_tail;
+
+void dyneq_init(void) {
+    memset(slots, 0, sizeof(slots));
+    req_head = req_tail = 0;
+}
+
+static bool dynamic_type(uint8_t type) {
+    return type == FILTER_PEAKING || type == FILTER_LOWSHELF || type == FILTER_HIGHSHELF;
+}
+
+uint8_t dyneq_band_slot(const EqParamPacket *p) {
+    if (!dynamic_type(p->type)) return 0;
+    for (uint8_t i = 0; i < DYNEQ_MAX_BANDS; i++) {
+        const DynEqSlot *s = &slots[i];
+        if (s->cfg.enabled && s->cfg.channel == p->channel && s->cfg.band == p->band) return i + 1;
+    }
+    return 0;
+}
+
+// Output mix of a dynamic band at gain_db (see dyneq.h)
+static inline void dyn_mix(const Biquad *bq, float gain_db, float *m0, float *m1, float *m2) {
+    float a = expf(gain_db * LN10_OVER_40);
+    float k = bq->dyn_k;
+    switch (bq->svf_type) {
+        case FILTER_LOWSHELF:
+            *m0 = 1.0f; *m1 = k * (a - 1.0f); *m2 = a * a - 1.0f;
+            break;
+        case FILTER_HIGHSHELF:
+            *m0 = a * a; *m1 = k * (1.0f - a) * a; *m2 = 1.0f - a * a;
+            break;
+        default:    // Peaking
+            *m0 = 1.0f; *m1 = k * (a * a - 1.0f); *m2 = 0.0f;
+            break;
+    }
+}
+
+void dyneq_compute_band(EqParamPacket *p, Biquad *bq, float sample_rate, uint8_t slot) {
+    if (bq->dyn != slot) {
+        bq->dyn_sc1 = 0.0f; bq->dyn_sc2 = 0.0f;
+        bq->dyn_env = 0.0f; bq->dyn_gr_db = 0.0f;
+    }
+    float g = tanf(PI_F * p->freq / sample_rate);
+    float k = 1.0f / p->Q;
+    bq->sva1 = 1.0f / (1.0f + g * (g + k));
+    bq->sva2 = g * bq->sva1;
+    bq->sva3 = g * bq->sva2;
+    bq->dyn_k = k;
+    bq->dyn_gain_db = p->gain_db;
+    bq->svf_type = p->type;
+    bq->dyn = slot;
+    dyn_mix(bq, p->gain_db + bq->dyn_gr_db, &bq->svm0, &bq->svm1, &bq->svm2);
+}
+
+DSP_TIME_CRITICAL
+void dyneq_process_band(Biquad *bq, float *samples, uint32_t count) {
+    if (count == 0) return;
+    const DynEqSlot *s = &slots[bq->dyn - 1];
+
+    // ---- Detector and gain computer ----
+    // A slot freed under a bank that still refers to it (a scene or preset
+    // cache bank built before) just lets the gain recover.
+    float target = 0.0f;
+    if (s->cfg.enabled) {
+        const float a1 = s->sca1, a2 = s->sca2, a3 = s->sca3, sk = s->sck;
+        const float a_rms = s->alpha_rms, one_minus_a_rms = 1.0f - a_rms;
+        float c1 = bq->dyn_sc1, c2 = bq->dyn_sc2, env = bq->dyn_env;
+        for (uint32_t i = 0; i < count; i++) {
+            float v3 = samples[i] - c2;
+            float v1 = a1 * c1 + a2 * v3;
+            float v2 = c2 + a2 * c1 + a3 * v3;
+            c1 = 2.0f * v1 - c1;
+            c2 = 2.0f * v2 - c2;
+            float bp = sk * v1;
+            env = a_rms * env + one_minus_a_rms * (bp * bp);
+        }
+        if (env < 1e-30f) env = 0.0f;
+        bq->dyn_sc1 = c1; bq->dyn_sc2 = c2; bq->dyn_env = env;
+
+        float level_db = 10.0f * log10f(env + 1e-30f);
+        float cut = leveller_gain_computer(level_db - s->cfg.threshold_db, s->slope, DYNEQ_KNEE_DB);
+        if (cut > s->cfg.range_db) cut = s->cfg.range_db;
+        target = -cut;
+    }
+
+    // Cut deepens at the attack rate, recovers at the release rate
+    float alpha_sample = (target < bq->dyn_gr_db) ? s->alpha_attack : s->alpha_release;
+    float alpha = leveller_block_alpha(alpha_sample, count);
+    float gr = alpha * bq->dyn_gr_db + (1.0f - alpha) * target;
+    bq->dyn_gr_db = gr;
+
+    // ---- Band filter, mix ramped to the new gain ----
+    float m0, m1, m2;
+    dyn_mix(bq, bq->dyn_gain_db + gr, &m0, &m1, &m2);
+    float inv = 1.0f / (float)count;
+    float x0 = bq->svm0, x1 = bq->svm1, x2 = bq->svm2;
+    float d0 = (m0 - x0) * inv, d1 = (m1 - x1) * inv, d2 = (m2 - x2) * inv;
+
+    const float a1 = bq->sva1, a2 = bq->sva2, a3 = bq->sva3;
+    float ic1 = bq->svic1eq, ic2 = bq->svic2eq;
+    for (uint32_t i = 0; i < count; i++) {
+        x0 += d0; x1 += d1; x2 += d2;
+        float in = samples[i];
+        float v3 = in - ic2;
+        float v1 = a1 * ic1 + a2 * v3;
+        float v2 = ic2 + a2 * ic1 + a3 * v3;
+        ic1 = 2.0f * v1 - ic1;
+        ic2 = 2.0f * v2 - ic2;
+        samples[i] = x0 * in + x1 * v1 + x2 * v2;
+    }
+    bq->svic1eq = ic1; bq->svic2eq = ic2;
+    bq->svm0 = m0; bq->svm1 = m1; bq->svm2 = m2;
+}
+
+// ----------------------------------------------------------------------------
+// VENDOR REQUESTS (USB IRQ)
+// ----------------------------------------------------------------------------
+
+void dyneq_request(const DynEqPacket *req) {
+    if (req->channel >= NUM_CHANNELS || req->band >= channel_band_counts[req->channel]) return;
+    uint8_t head = req_head;
+    uint8_t next = (head + 1) & (DYNEQ_REQ_QUEUE - 1);
+    if (next == req_tail) return;   // Host is far ahead of the main loop
+    req_queue[head] = *req;
+    __dmb();
+    req_head = next;
+}
+
+static int find_slot(uint8_t channel, uint8_t band) {
+    for (int i = 0; i < DYNEQ_MAX_BANDS; i++) {
+        if (slots[i].cfg.enabled && slots[i].cfg.channel == channel && slots[i].cfg.band == band) return i;
+    }
+    return -1;
+}
+
+bool dyneq_get_status(uint8_t channel, uint8_t band, DynEqStatusPacket *pkt) {
+    if (channel >= NUM_CHANNELS || band >= channel_band_counts[channel]) return false;
+    memset(pkt, 0, sizeof(*pkt));
+    pkt->config.channel = channel;
+    pkt->config.band = band;
+    for (int i = 0; i < DYNEQ_MAX_BANDS; i++) {
+        if (!slots[i].cfg.enabled) pkt->slots_free++;
+    }
+    int i = find_slot(channel, band);
+    if (i < 0) return true;
+
+    const Biquad *bq = &filters[channel][band];
+    pkt->config = slots[i].cfg;
+    pkt->active = (bq->dyn == i + 1) && !bq->bypass;
+    if (pkt->active) {
+        pkt->sidechain_db = 10.0f * log10f(bq->dyn_env + 1e-30f);
+        pkt->gain_change_db = bq->dyn_gr_db;
+    } else {
+        pkt->sidechain_db = -300.0f;
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// MAIN LOOP
+// ----------------------------------------------------------------------------
+
+static float clampf(float v, float lo, float hi) {
+    return v < lo ? lo : v > hi ? hi : v;
+}
+
+// Sidechain and time constants from the slot, its band's live recipe and
+// the live rate
+static void design_slot(DynEqSlot *s, uint32_t rate) {
+    const EqParamPacket *p = &filter_recipes[s->cfg.channel][s->cfg.band];
+    float fs = (float)rate;
+    float f = clampf(s->cfg.sc_freq > 0.0f ? s->cfg.sc_freq : p->freq, 10.0f, fs * 0.45f);
+    float q = clampf(s->cfg.sc_q > 0.0f ? s->cfg.sc_q : p->Q, 0.1f, 20.0f);
+    float g = tanf(PI_F * f / fs);
+    float k = 1.0f / q;
+    s->sca1 = 1.0f / (1.0f + g * (g + k));
+    s->sca2 = g * s->sca1;
+    s->sca3 = g * s->sca2;
+    s->sck = k;
+
+    s->alpha_rms = leveller_time_alpha(fs, DYNEQ_RMS_SEC);
+    s->alpha_attack = leveller_time_alpha(fs, s->cfg.attack_ms * 0.001f);
+    s->alpha_release = leveller_time_alpha(fs, s->cfg.release_ms * 0.001f);
+    s->slope = 1.0f - 1.0f / s->cfg.ratio;
+    s->recipe = *p;
+    s->rate = rate;
+}
+
+static void redesign_band(uint8_t ch, uint8_t band, uint32_t rate) {
+    EqParamPacket r = filter_recipes[ch][band];
+    uint32_t flags = save_and_disable_interrupts();
+    dsp_compute_coefficients(&r, &filters[ch][band], (float)rate);
+    bool all_bypassed = true;
+    for (int b = 0; b < channel_band_counts[ch]; b++) {
+        if (!filters[ch][b].bypass) {
+            all_bypassed = false;
+            break;
+        }
+    }
+    channel_bypassed[ch] = all_bypassed;
+    restore_interrupts(flags);
+}
+
+static void apply_request(const DynEqPacket *req, uint32_t rate) {
+    int i = find_slot(req->channel, req->band);
+    if (!req->enabled) {
+        if (i < 0) return;
+        core1_wait_block();
+        slots[i].cfg.enabled = 0;
+    } else {
+        if (i < 0) {
+            for (i = 0; i < DYNEQ_MAX_BANDS && slots[i].cfg.enabled; i++) {}
+            if (i == DYNEQ_MAX_BANDS) return;   // No free slot (status shows slots_free 0)
+        }
+        DynEqSlot *s = &slots[i];
+        core1_wait_block();
+        s->cfg = *req;
+        s->cfg.enabled = 1;
+        s->cfg.reserved = 0;
+        s->cfg.threshold_db = clampf(req->threshold_db, -96.0f, 0.0f);
+        s->cfg.ratio = clampf(req->ratio, 1.0f, 20.0f);
+        s->cfg.range_db = clampf(req->range_db, 0.0f, 24.0f);
+        if (!(s->cfg.sc_freq > 0.0f)) s->cfg.sc_freq = 0.0f;
+        if (!(s->cfg.sc_q > 0.0f)) s->cfg.sc_q = 0.0f;
+        if (s->cfg.attack_ms < 1) s->cfg.attack_ms = 1;
+        if (s->cfg.attack_ms > 500) s->cfg.attack_ms = 500;
+        if (s->cfg.release_ms < 1) s->cfg.release_ms = 1;
+        if (s->cfg.release_ms > 5000) s->cfg.release_ms = 5000;
+        design_slot(s, rate);
+    }
+    redesign_band(req->channel, req->band, rate);
+
+    // Banks designed before this change have the band's old form
+    preset_cache_rebuild_banks();
+}
+
+void dyneq_service(uint32_t sample_rate) {
+    while (req_tail != req_head) {
+        uint8_t tail = req_tail;
+        __dmb();
+        DynEqPacket req = req_queue[tail];
+        req_tail = (tail + 1) & (DYNEQ_REQ_QUEUE - 1);
+        apply_request(&req, sample_rate);
+    }
+
+    // Follow the band's recipe (sidechain at the band's frequency / Q) and
+    // the sample rate
+    for (int i = 0; i < DYNEQ_MAX_BANDS; i++) {
+        DynEqSlot *s = &slots[i];
+        if (!s->cfg.enabled) continue;
+        if (s->rate == sample_rate &&
+            memcmp(&s->recipe, &filter_recipes[s->cfg.channel][s->cfg.band], sizeof(EqParamPacket)) == 0)
+            continue;
+        core1_wait_block();
+        design_slot(s, sample_rate);
+    }
+}
+
+void dyneq_snapshot(DynEqPacket out[DYNEQ_MAX_BANDS]) {
+    for (int i = 0; i < DYNEQ_MAX_BANDS; i++) {
+        if (slots[i].cfg.enabled) out[i] = slots[i].cfg;
+        else memset(&out[i], 0, sizeof(out[i]));
+    }
+}
+
+uint8_t dyneq_channel_bands(uint8_t channel) {
+    uint8_t n = 0;
+    for (int i = 0; i < DYNEQ_MAX_BANDS; i++) {
+        if (slots[i].cfg.enabled && slots[i].cfg.channel == channel) n++;
+    }
+    return n;
+}
+
+#endif // ENABLE_DYNEQ
@@ -0,0 +1,73 @@
+/*
+ * dyneq.h — Dynamic EQ bands (RP2350)
+ *
+ * A peaking or shelf band can be made dynamic: its gain moves from the
+ * recipe's gain_db toward gain_db - range_db as the level of a band-passed
+ * sidechain rises above a threshold, with a soft-knee ratio and attack /
+ * release smoothing like the leveller.  The sidechain is the band's own
+ * input, band-passed at sc_freq / sc_q (the band's frequency and Q when 0),
+ * so a bass bell can duck only when a boomy note rings, or a high shelf
+ * can de-ess.
+ *
+ * Dynamic bands always run on the SVF path in the forms whose output mix
+ * is cheap to move with gain:
+ *
+ *   peaking     k = 1/Q,  m1 = k (A^2 - 1)               (linear in gain)
+ *   low shelf   m1 = k (A - 1),      m2 = A^2 - 1
+ *   high shelf  m0 = A^2, m1 = k (1 - A) A, m2 = 1 - A^2
+ *
+ * with g = tan(pi f / Fs) left unscaled, so the integrators never change
+ * with gain.  Each block the detector sets a new target mix and the kernel
+ * ramps m0-m2 across the block.  No tanf(); per band and block, a log10f()
+ * for the detector level, a powf() for the attack / release step over the
+ * block (leveller_block_alpha()) and an expf() for the new mix.  A
+ * static peaking band's k is 1/(Q A) instead (constant bandwidth in
+ * dB), so at the same settings a dynamic cut is slightly narrower.
+ *
+ * Configuration lives in DYNEQ_MAX_BANDS slots keyed by (channel, band),
+ * set with REQ_SET_DYN_EQ and held in RAM only.  A slot whose band is not
+ * peaking / shelf (or is flat with no frequency) is kept but inactive.
+ * The per-band design values and state live in the Biquad, so each bank
+ * (live, scene B, caches) runs its own envelope.
+ */
+
+#ifndef DYNEQ_H
+#define DYNEQ_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+#if ENABLE_DYNEQ
+
+void dyneq_init(void);
+
+// Slot + 1 for the band in p if it is dynamic and of a dynamic-capable
+// type, 0 otherwise.  Main loop (coefficient design).
+uint8_t dyneq_band_slot(const EqParamPacket *p);
+
+// dsp_compute_coefficients() for a dynamic band: SVF integrators and the
+// mix at the static gain plus the band's current gain change.
+void dyneq_compute_band(EqParamPacket *p, Biquad *bq, float sample_rate, uint8_t slot);
+
+// Audio path, either core: detector, gain computer and ramped SVF.
+void dyneq_process_band(Biquad *bq, float *samples, uint32_t count);
+
+// Vendor requests (USB IRQ).  The set is applied by dyneq_service().
+void dyneq_request(const DynEqPacket *req);
+bool dyneq_get_status(uint8_t channel, uint8_t band, DynEqStatusPacket *pkt);
+
+// Main loop: apply a pending request (redesigning the band) and keep the
+// slots' sidechain and time constants in step with the live recipes and
+// sample rate.
+void dyneq_service(uint32_t sample_rate);
+
+// Slot configurations, for the coefficient cache's source snapshot.
+void dyneq_snapshot(DynEqPacket out[DYNEQ_MAX_BANDS]);
+
+// For the cost estimate: configured dynamic bands on a channel.
+uint8_t dyneq_channel_bands(uint8_t channel);
+
+#endif // ENABLE_DYNEQ
+
+#endif // DYNEQ_H
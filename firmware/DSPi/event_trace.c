@@ -0,0 +1,125 @@
+/*
+ * event_trace.c — Timestamped event trace ring
+ *
+ * head counts every event ever appended on a core; slot = head % size.  The
+ * producer fills the slot, then publishes head + 1.  An entry at read index
+ * t is intact while head - t < TRACE_RING_EVENTS: the producer only starts
+ * overwriting it once head reaches t + TRACE_RING_EVENTS.  The reader checks
+ * this again after copying, which catches an overwrite that raced the copy.
+ */
+
+#include <string.h>
+#include "event_trace.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+_Static_assert((TRACE_RING_EVENTS & (TRACE_RING_EVENTS - 1)) == 0, "trace ring size must be a power of two");
+_Static_assert(sizeof(TraceEvent) == 12, "TraceEvent is a wire format");
+_Static_assert(sizeof(TraceDrainHeader) == 12, "TraceDrainHeader is a wire format");
+
+#define TRACE_RING_MASK (TRACE_RING_EVENTS - 1)
+
+typedef struct {
+    TraceEvent ev[TRACE_RING_EVENTS];
+    volatile uint32_t head;
+    uint32_t burst_us[TRACE_EVT_TYPE_COUNT];   // Last trace_burst() time per type
+} TraceRing;
+
+static TraceRing rings[2];
+
+// Reader state (vendor request handler only)
+static uint32_t read_index[2];
+static uint32_t lost_events;
+
+static inline void ring_append(TraceRing *r, uint8_t core, uint8_t type, uint32_t arg, uint32_t now) {
+    uint32_t h = r->head;
+    TraceEvent *e = &r->ev[h & TRACE_RING_MASK];
+    e->time_us = now;
+    e->type = type;
+    e->core = core;
+    e->seq = (uint16_t)h;
+    e->arg = arg;
+    __dmb();
+    r->head = h + 1;
+}
+
+void __not_in_flash_func(trace_event)(uint8_t type, uint32_t arg) {
+    uint core = get_core_num();
+    uint32_t save = save_and_disable_interrupts();
+    ring_append(&rings[core], (uint8_t)core, type, arg, time_us_32());
+    restore_interrupts(save);
+}
+
+void __not_in_flash_func(trace_burst)(uint8_t type, uint32_t arg) {
+    if (type >= TRACE_EVT_TYPE_COUNT) return;
+    uint core = get_core_num();
+    TraceRing *r = &rings[core];
+    uint32_t save = save_and_disable_interrupts();
+    uint32_t now = time_us_32();
+    uint32_t last = r->burst_us[type];
+    if (!last || now - last >= TRACE_BURST_US) {
+        r->burst_us[type] = now ? now : 1;
+        ring_append(r, (uint8_t)core, type, arg, now);
+    }
+    restore_interrupts(save);
+}
+
+// Copy the oldest intact event of a core's ring without consuming it.
+// Skips (and counts) entries that were or are being overwritten.
+static bool ring_peek(uint8_t core, TraceEvent *out) {
+    TraceRing *r = &rings[core];
+    for (;;) {
+        uint32_t head = r->head;
+        __dmb();
+        uint32_t t = read_index[core];
+        if (head == t) return false;
+        if (head - t >= TRACE_RING_EVENTS) {
+            uint32_t skip = head - t - (TRACE_RING_EVENTS - 1);
+            read_index[core] = t + skip;
+            lost_events += skip;
+            continue;
+        }
+        *out = r->ev[t & TRACE_RING_MASK];
+        __dmb();
+        if (r->head - t < TRACE_RING_EVENTS) return true;
+    }
+}
+
+uint16_t trace_drain(uint8_t *buf, uint16_t max_len) {
+    if (max_len < sizeof(TraceDrainHeader)) return 0;
+    uint16_t max_events = (max_len - sizeof(TraceDrainHeader)) / sizeof(TraceEvent);
+
+    TraceEvent next[2];
+    bool have[2] = { ring_peek(0, &next[0]), ring_peek(1, &next[1]) };
+
+    uint16_t count = 0;
+    uint8_t *dst = buf + sizeof(TraceDrainHeader);
+    while (count < max_events && (have[0] || have[1])) {
+        // Merge by timestamp; both cores read the same timer
+        uint8_t c = !have[0] ? 1 : !have[1] ? 0
+                  : ((int32_t)(next[1].time_us - next[0].time_us) < 0 ? 1 : 0);
+        memcpy(dst, &next[c], sizeof(TraceEvent));
+        dst += sizeof(TraceEvent);
+        count++;
+        read_index[c]++;
+        have[c] = ring_peek(c, &next[c]);
+    }
+
+    uint32_t remaining = 0;
+    for (int c = 0; c < 2; c++) {
+        uint32_t queued = rings[c].head - read_index[c];
+        remaining += queued < TRACE_RING_EVENTS ? queued : TRACE_RING_EVENTS - 1;
+    }
+
+    TraceDrainHeader hdr = {
+        .count = count,
+        .lost = lost_events > 0xFFFF ? 0xFFFF : (uint16_t)lost_events,
+        .now_us = time_us_32(),
+        .event_size = sizeof(TraceEvent),
+        .remaining = remaining > 0xFF ? 0xFF : (uint8_t)remaining,
+        .ring_events = TRACE_RING_EVENTS,
+    };
+    memcpy(buf, &hdr, sizeof(hdr));
+    lost_events = 0;
+    return sizeof(TraceDrainHeader) + count * sizeof(TraceEvent);
+}
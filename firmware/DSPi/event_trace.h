@@ -0,0 +1,39 @@
+/*
+ * event_trace.h — Timestamped event trace ring
+ *
+ * The fault counters (spdif_underruns, pdm_ring_overruns, ...) say how often
+ * something went wrong, not when or next to what.  The trace keeps the last
+ * TRACE_RING_EVENTS events per core — rate changes, stream restarts, preset
+ * loads, output type switches, flash writes, underruns / overruns and
+ * deadline misses — each stamped with time_us_32(), so a glitch can be lined
+ * up with what the device was doing at the time.
+ *
+ * One ring per core, each written only by its own core: the main loop and
+ * that core's ISRs append with interrupts masked for the few cycles of the
+ * write, so there is no cross-core lock.  The ring overwrites its oldest
+ * entry when full; the reader detects overwritten entries from the head
+ * index and counts them as lost instead of returning torn events.
+ *
+ * The single reader is the vendor request handler (USB IRQ, Core 0).
+ */
+
+#ifndef EVENT_TRACE_H
+#define EVENT_TRACE_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Append an event on the calling core.  Safe from any context.
+void trace_event(uint8_t type, uint32_t arg);
+
+// As trace_event(), but drops the event if the same type was recorded on
+// this core less than TRACE_BURST_US ago.  For fault counters that can fire
+// every sample; pass the running counter as arg.
+void trace_burst(uint8_t type, uint32_t arg);
+
+// Move up to (max_len - sizeof(TraceDrainHeader)) / sizeof(TraceEvent)
+// events, oldest first, into buf behind a TraceDrainHeader.  Returns the
+// number of bytes written.  Vendor request handler only.
+uint16_t trace_drain(uint8_t *buf, uint16_t max_len);
+
+#endif // EVENT_TRACE_H
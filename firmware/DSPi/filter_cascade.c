@@ -0,0 +1,234 @@
+/*
+ * filter_cascade.c — Higher-order filter types expanded into SOS stages
+ *
+ * Low-pass prototypes are tabulated as sections (pole frequency relative
+ * to the filter's frequency, Q); Q = 0 marks a first-order section.  The
+ * high-pass of each family is the s -> 1/s transform: same Q, reciprocal
+ * pole frequency.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "filter_cascade.h"
+#include "dsp_math.h"
+
+#define LT_TARGET_Q 0.7071f
+
+// Bessel, normalized to -3 dB at 1 rad/s: {pole frequency, Q} per section,
+// lowest Q first, first-order section last
+static const float bessel_sections[CASCADE_MAX_ORDER][CASCADE_MAX_STAGES][2] = {
+    {{1.000000f, 0.0f}},
+    {{1.272020f, 0.577350f}},
+    {{1.447617f, 0.691047f}, {1.322676f, 0.0f}},
+    {{1.430172f, 0.521935f}, {1.603358f, 0.805538f}},
+    {{1.556347f, 0.563536f}, {1.755378f, 0.916477f}, {1.502316f, 0.0f}},
+    {{1.603919f, 0.510318f}, {1.689168f, 0.611195f}, {1.904708f, 1.023314f}},
+    {{1.716356f, 0.532356f}, {1.822417f, 0.660821f}, {2.049491f, 1.126258f}, {1.684368f, 0.0f}},
+    {{1.778466f, 0.505991f}, {1.832093f, 0.559609f}, {1.953196f, 0.710852f}, {2.188726f, 1.225669f}},
+};
+
+static const EqParamPacket flat_band = {
+    .type = FILTER_FLAT, .order = 0, .freq = 1000.0f, .Q = 0.707f, .gain_db = 0.0f,
+};
+
+bool cascade_is_type(uint8_t type) {
+    return type >= FILTER_BUTTERWORTH_LP && type <= FILTER_ALLPASS;
+}
+
+uint8_t cascade_order(uint8_t type, uint8_t order) {
+    switch (type) {
+        case FILTER_LR_LP:
+        case FILTER_LR_HP:
+            if (order < 2) order = 2;
+            if (order > CASCADE_MAX_ORDER) order = CASCADE_MAX_ORDER;
+            return (uint8_t)((order + 1) & ~1u);
+        case FILTER_LINKWITZ:
+            return 2;
+        case FILTER_ALLPASS:
+            return order == 1 ? 1 : 2;
+        default:
+            if (order < 1) order = 1;
+            if (order > CASCADE_MAX_ORDER) order = CASCADE_MAX_ORDER;
+            return order;
+    }
+}
+
+uint8_t cascade_stages(uint8_t type, uint8_t order) {
+    if (!cascade_is_type(type)) return 1;
+    return (uint8_t)((cascade_order(type, order) + 1) / 2);
+}
+
+uint8_t cascade_head_stages(const EqParamPacket *p) {
+    if (!cascade_is_type(p->type) || CASCADE_STAGE(p) != 0) return 0;
+    return cascade_stages(p->type, CASCADE_ORDER(p));
+}
+
+static void butterworth_sections(uint8_t order, float *w, float *q, uint8_t *n) {
+    for (int k = order / 2; k >= 1; k--) {
+        w[*n] = 1.0f;
+        q[*n] = 1.0f / (2.0f * sinf((float)(2 * k - 1) * PI_F / (float)(2 * order)));
+        (*n)++;
+    }
+    if (order & 1) { w[*n] = 1.0f; q[*n] = 0.0f; (*n)++; }
+}
+
+// Low-pass prototype sections of a family, lowest Q first
+static uint8_t prototype(uint8_t type, uint8_t order, float *w, float *q) {
+    uint8_t n = 0;
+    switch (type) {
+        case FILTER_BUTTERWORTH_LP:
+        case FILTER_BUTTERWORTH_HP:
+            butterworth_sections(order, w, q, &n);
+            break;
+        case FILTER_LR_LP:
+        case FILTER_LR_HP: {
+            // LR(2M) = Butterworth(M) squared; a doubled real pole is one Q 0.5 section
+            uint8_t m = order / 2, bw = 0;
+            float bw_w[CASCADE_MAX_STAGES], bw_q[CASCADE_MAX_STAGES];
+            if (m & 1) { w[n] = 1.0f; q[n] = 0.5f; n++; }
+            butterworth_sections(m, bw_w, bw_q, &bw);
+            for (uint8_t i = 0; i < bw; i++) {
+                if (bw_q[i] == 0.0f) continue;
+                w[n] = w[n + 1] = bw_w[i];
+                q[n] = q[n + 1] = bw_q[i];
+                n += 2;
+            }
+            break;
+        }
+        default:    // Bessel
+            for (uint8_t i = 0; i < (order + 1) / 2; i++) {
+                w[n] = bessel_sections[order - 1][i][0];
+                q[n] = bessel_sections[order - 1][i][1];
+                n++;
+            }
+            break;
+    }
+    return n;
+}
+
+bool cascade_section(const EqParamPacket *p, float sample_rate, CascadeSection *out) {
+    uint8_t order = cascade_order(p->type, CASCADE_ORDER(p));
+    uint8_t stage = CASCADE_STAGE(p);
+    if (stage >= cascade_stages(p->type, order)) return false;
+
+    memset(out, 0, sizeof(*out));
+    float fc = p->freq;
+
+    if (p->type == FILTER_ALLPASS) {
+        out->pole_hz = fc;
+        out->first_order = (order == 1);
+        if (out->first_order) {
+            out->c1 = -1.0f; out->c0 = 1.0f;
+        } else {
+            out->k = 1.0f / p->Q;
+            out->c2 = 1.0f; out->c1 = -out->k; out->c0 = 1.0f;
+        }
+    } else if (p->type == FILTER_LINKWITZ) {
+        // Zeros cancel the box's poles (f0, Q0), new poles at (fp, Qp).
+        // Normalized to the new poles with prewarped frequencies, so both
+        // pairs land exactly after the bilinear transform.
+        float fp = fc * powf(10.0f, -p->gain_db / 40.0f);
+        if (fp < 10.0f) fp = 10.0f;
+        if (fp > sample_rate * 0.45f) fp = sample_rate * 0.45f;
+        float r = tanf(PI_F * fc / sample_rate) / tanf(PI_F * fp / sample_rate);
+        out->pole_hz = fp;
+        out->k = 1.0f / LT_TARGET_Q;
+        out->c2 = 1.0f; out->c1 = r / p->Q; out->c0 = r * r;
+    } else {
+        float w[CASCADE_MAX_STAGES], q[CASCADE_MAX_STAGES];
+        prototype(p->type, order, w, q);
+        bool hp = (p->type == FILTER_BUTTERWORTH_HP || p->type == FILTER_LR_HP ||
+                   p->type == FILTER_BESSEL_HP);
+        out->pole_hz = hp ? fc / w[stage] : fc * w[stage];
+        out->first_order = (q[stage] == 0.0f);
+        if (!out->first_order) out->k = 1.0f / q[stage];
+        if (hp) {
+            if (out->first_order) out->c1 = 1.0f;
+            else out->c2 = 1.0f;
+        } else {
+            out->c0 = 1.0f;
+        }
+    }
+
+    if (out->pole_hz > sample_rate * 0.45f) out->pole_hz = sample_rate * 0.45f;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// RECIPE ROWS
+// ----------------------------------------------------------------------------
+
+static void set_flat(EqParamPacket *row, uint8_t b) {
+    uint8_t ch = row[b].channel;
+    row[b] = flat_band;
+    row[b].channel = ch;
+    row[b].band = b;
+}
+
+static void normalize(EqParamPacket *row, uint8_t band_count) {
+    uint8_t b = 0;
+    while (b < band_count) {
+        EqParamPacket *h = &row[b];
+        if (!cascade_is_type(h->type)) { b++; continue; }
+        if (CASCADE_STAGE(h) != 0) {
+            // A stage whose head was overwritten
+            set_flat(row, b++);
+            continue;
+        }
+
+        uint8_t order = cascade_order(h->type, CASCADE_ORDER(h));
+        uint8_t n = cascade_stages(h->type, order);
+        if (n > band_count - b) {
+            n = band_count - b;
+            order = 2 * n;
+        }
+        h->order = order;
+        for (uint8_t i = 1; i < n; i++) {
+            row[b + i] = *h;
+            row[b + i].band = b + i;
+            row[b + i].order = (uint8_t)(order | (i << 4));
+        }
+        b += n;
+    }
+}
+
+static uint16_t diff_mask(const EqParamPacket *a, const EqParamPacket *b, uint8_t band_count) {
+    uint16_t mask = 0;
+    for (uint8_t i = 0; i < band_count; i++) {
+        if (memcmp(&a[i], &b[i], sizeof(EqParamPacket)) != 0) mask |= (uint16_t)(1u << i);
+    }
+    return mask;
+}
+
+uint16_t cascade_normalize_row(EqParamPacket *row, uint8_t band_count) {
+    EqParamPacket before[MAX_BANDS];
+    memcpy(before, row, band_count * sizeof(EqParamPacket));
+    normalize(row, band_count);
+    return diff_mask(before, row, band_count);
+}
+
+uint16_t cascade_set_band(EqParamPacket *row, uint8_t band_count, const EqParamPacket *p) {
+    EqParamPacket before[MAX_BANDS];
+    memcpy(before, row, band_count * sizeof(EqParamPacket));
+    normalize(row, band_count);
+
+    uint8_t band = p->band;
+    uint8_t span = cascade_is_type(p->type) ? cascade_stages(p->type, CASCADE_ORDER(p)) : 1;
+    if (span > band_count - band) span = band_count - band;
+
+    // Remove every cascade the new filter lands on, all of its stages
+    uint8_t b = 0;
+    while (b < band_count) {
+        uint8_t n = cascade_head_stages(&row[b]);
+        if (n == 0) n = 1;
+        if (n > 1 && b < band + span && band < b + n) {
+            for (uint8_t i = 0; i < n; i++) set_flat(row, b + i);
+        }
+        b += n;
+    }
+
+    row[band] = *p;
+    row[band].order = cascade_is_type(p->type) ? CASCADE_ORDER(p) : 0;
+    normalize(row, band_count);
+    return diff_mask(before, row, band_count) | (uint16_t)(1u << band);
+}
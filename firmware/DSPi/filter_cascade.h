@@ -0,0 +1,69 @@
+/*
+ * filter_cascade.h — Higher-order filter types expanded into SOS stages
+ *
+ * A cascade type (FILTER_BUTTERWORTH_LP .. FILTER_ALLPASS) is one logical
+ * filter set on one band.  It needs ceil(order / 2) second-order sections,
+ * which take the band it was set on and the bands after it: an LR8 on
+ * band 2 occupies bands 2-5.  Every occupied band holds a copy of the
+ * recipe with its stage index in EqParamPacket.order, so each band's
+ * coefficients can be computed on their own like any other band, and the
+ * rate cache, presets and scene morph need no special handling.  An order
+ * N filter therefore always costs ceil(N / 2) bands of the channel's
+ * budget and the CPU of that many bands.
+ *
+ *   Butterworth LP / HP    order 1-8
+ *   Linkwitz-Riley LP / HP order 2, 4, 6, 8 (odd orders round up)
+ *   Bessel LP / HP         order 1-8, -3 dB at freq
+ *   Linkwitz transform     one stage: moves a sealed box's f0 / Q0 (freq,
+ *                          Q) to fp = f0 * 10^(-gain_db / 40) with Qp 0.707
+ *                          (gain_db is the low-frequency boost)
+ *   All-pass               order 1 or 2 (2 uses Q)
+ *
+ * Stages are ordered lowest Q first.  On RP2350 the first stage's
+ * Biquad.cascade lets dsp_process_channel_block() run the whole cascade
+ * with a fused kernel.
+ */
+
+#ifndef FILTER_CASCADE_H
+#define FILTER_CASCADE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+#define CASCADE_MAX_ORDER       8
+#define CASCADE_MAX_STAGES      4
+
+#define CASCADE_ORDER(p)        ((uint8_t)((p)->order & 0x0F))
+#define CASCADE_STAGE(p)        ((uint8_t)((p)->order >> 4))
+
+// One analog section, normalized to its pole frequency:
+// H(s) = (c2 s^2 + c1 s + c0) / (s^2 + k s + 1), or for a first-order
+// section (c1 s + c0) / (s + 1).
+typedef struct {
+    float pole_hz;
+    float k;                    // 1 / Q
+    float c2, c1, c0;
+    bool  first_order;
+} CascadeSection;
+
+bool cascade_is_type(uint8_t type);
+
+// Order after clamping to the type's range, and the stages it needs.
+uint8_t cascade_order(uint8_t type, uint8_t order);
+uint8_t cascade_stages(uint8_t type, uint8_t order);
+
+// Section for the stage recorded in p->order, from a clamped recipe.
+// False if the stage index is beyond the filter's stages.
+bool cascade_section(const EqParamPacket *p, float sample_rate, CascadeSection *out);
+
+// Bands of a channel's recipe row.  Both keep the row consistent: every
+// cascade head followed by exactly its stages, no stage without its head,
+// orders reduced to fit the bands left.  Return a mask of bands changed.
+uint16_t cascade_normalize_row(EqParamPacket *row, uint8_t band_count);
+uint16_t cascade_set_band(EqParamPacket *row, uint8_t band_count, const EqParamPacket *p);
+
+// Stage count for the first stage's band, 0 for any other band.
+uint8_t cascade_head_stages(const EqParamPacket *p);
+
+#endif // FILTER_CASCADE_H
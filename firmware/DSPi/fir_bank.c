@@ -0,0 +1,490 @@
+/*
+ * fir_bank.c — Per-output FIR stages (RP2350): crossover and convolution
+ *
+ * Ownership: the audio path only touches an output's engine while its bit
+ * is set in fir_active_mask (convolution) or fir_xover_mask (crossover).
+ * The main loop clears the bit — or for a crossover, marks it designing so
+ * the output is silenced — and waits for Core 1 to finish its block before
+ * it frees, reallocates or rewrites that output's memory; Core 0 audio
+ * runs from the main loop itself.  While an output is LOADING, the USB IRQ
+ * writes its staging area; nothing else does until the commit request
+ * moves it on.
+ */
+
+#include <string.h>
+#include "fir_bank.h"
+#include "fir_convolver.h"
+#include "fir_crossover.h"
+#include "pdm_generator.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#if ENABLE_FIR
+
+_Static_assert(FIR_POOL_UNITS <= 64, "unit bitmap is 64 bits");
+_Static_assert(NUM_OUTPUT_CHANNELS <= 16, "fir_active_mask is 16 bits");
+_Static_assert(sizeof(FirStatusPacket) == 16, "FirStatusPacket is a wire format");
+_Static_assert(sizeof(FirXoverStatusPacket) == 24, "FirXoverStatusPacket is a wire format");
+_Static_assert(AUDIO_BUFFER_SAMPLES <= FIR_XOVER_MAX_BLOCK, "crossover history sized for one packet");
+
+#define FIR_MAX_TAPS            ((FIR_POOL_UNITS - 1) * FIR_PARTITION)
+#define FIR_PREPARE_PER_PASS    4       // Partitions transformed per main loop pass (~15k cycles each)
+#define XOVER_DESIGN_PER_PASS   16      // Crossover coefficients per pass (~2.5k cycles each at 511 taps)
+
+typedef struct {
+    FirConvolver conv;
+    uint16_t taps;
+    uint16_t received;
+    uint16_t prepared;          // Partitions transformed so far while committing
+    uint8_t  first_unit;
+    uint8_t  units;             // 0 = nothing allocated
+    volatile uint8_t state;     // FIR_STATE_*
+    uint8_t  error;             // FIR_ERR_*
+} FirSlot;
+
+typedef struct {
+    FirXover x;
+    FirXoverPacket cfg;         // Parameters being designed or running
+    uint32_t design_rate;
+    uint8_t  first_unit;
+    uint8_t  units;
+    volatile uint8_t state;     // FIR_STATE_*
+    uint8_t  error;
+} XoverSlot;
+
+static float fir_pool[FIR_POOL_UNITS * FIR_UNIT_FLOATS] __attribute__((aligned(8)));
+static float fir_scratch[2][FIR_SCRATCH_FLOATS];
+static FirSlot slots[NUM_OUTPUT_CHANNELS];
+static XoverSlot xovers[NUM_OUTPUT_CHANNELS];
+static uint64_t units_used;
+static uint16_t committing_mask;
+static volatile uint16_t xover_designing;   // Subset of fir_xover_mask: silenced, not filtered
+
+volatile uint16_t fir_active_mask;
+volatile uint16_t fir_xover_mask;
+volatile uint16_t fir_xover_core1_mask;
+
+// Requests (USB IRQ → main loop), bit per output
+static volatile uint16_t req_begin_mask;
+static volatile uint16_t req_commit_mask;
+static volatile uint16_t req_clear_mask;
+static volatile uint16_t req_begin_taps[NUM_OUTPUT_CHANNELS];
+static volatile uint16_t req_xover_mask;
+static FirXoverPacket req_xover[NUM_OUTPUT_CHANNELS];
+
+void fir_bank_init(void) {
+    fir_conv_init();
+    memset(slots, 0, sizeof(slots));
+    memset(xovers, 0, sizeof(xovers));
+    units_used = 0;
+    fir_active_mask = 0;
+    fir_xover_mask = 0;
+    fir_xover_core1_mask = 0;
+}
+
+void __not_in_flash_func(fir_bank_process)(uint8_t out, float *samples, uint32_t count) {
+    fir_conv_process(&slots[out].conv, samples, count, fir_scratch[get_core_num()]);
+}
+
+void __not_in_flash_func(fir_xover_run)(uint16_t mask, float (*bufs)[AUDIO_BUFFER_SAMPLES], uint32_t count) {
+    uint16_t designing = xover_designing;
+    for (uint8_t o = 0; mask; o++, mask >>= 1) {
+        if (!(mask & 1)) continue;
+        if (designing & (1u << o)) {
+            memset(bufs[o], 0, count * sizeof(float));
+        } else {
+            fir_xover_process(&xovers[o].x, bufs[o], count);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// VENDOR REQUESTS (USB IRQ)
+// ----------------------------------------------------------------------------
+
+void fir_request_begin(const FirBeginPacket *req) {
+    if (req->output >= NUM_OUTPUT_CHANNELS) return;
+    uint16_t bit = (uint16_t)(1u << req->output);
+    req_begin_taps[req->output] = req->taps;
+    req_clear_mask &= (uint16_t)~bit;
+    req_commit_mask &= (uint16_t)~bit;
+    slots[req->output].state = FIR_STATE_PENDING;
+    __dmb();
+    req_begin_mask |= bit;
+}
+
+void fir_request_taps(uint8_t out, const uint8_t *payload, uint16_t len) {
+    if (out >= NUM_OUTPUT_CHANNELS) return;
+    FirSlot *s = &slots[out];
+    if (s->state != FIR_STATE_LOADING) {
+        // As for a commit out of sequence: a running filter keeps running
+        s->error = FIR_ERR_SEQUENCE;
+        if (s->state != FIR_STATE_ACTIVE) s->state = FIR_STATE_ERROR;
+        return;
+    }
+
+    uint16_t offset = 0;
+    uint16_t n = 0;
+    if (len >= 8) {             // Header and at least one tap
+        memcpy(&offset, payload, 2);
+        n = (len - 4) / 4;
+        if (n > FIR_TAPS_PER_PACKET) n = FIR_TAPS_PER_PACKET;
+    }
+    if (n == 0 || offset != s->received || offset + n > s->taps) {
+        s->error = FIR_ERR_SEQUENCE;
+        s->state = FIR_STATE_ERROR;
+        return;
+    }
+
+    const uint8_t *src = payload + 4;
+    for (uint16_t i = 0; i < n; i++) {
+        uint32_t t = offset + i;
+        memcpy(&fir_conv_staging(&s->conv, t / FIR_PARTITION)[t % FIR_PARTITION], src, 4);
+        src += 4;
+    }
+    s->received = offset + n;
+}
+
+void fir_request_commit(uint8_t out) {
+    if (out >= NUM_OUTPUT_CHANNELS) return;
+    FirSlot *s = &slots[out];
+    if (s->state != FIR_STATE_LOADING) {
+        s->error = FIR_ERR_SEQUENCE;
+        if (s->state != FIR_STATE_ACTIVE) s->state = FIR_STATE_ERROR;
+        return;
+    }
+    if (s->received != s->taps) {
+        s->error = FIR_ERR_INCOMPLETE;
+        s->state = FIR_STATE_ERROR;
+        return;
+    }
+    s->state = FIR_STATE_PENDING;
+    __dmb();
+    req_commit_mask |= (uint16_t)(1u << out);
+}
+
+void fir_request_clear(uint8_t out) {
+    uint16_t bits = (out == 0xFF) ? (uint16_t)((1u << NUM_OUTPUT_CHANNELS) - 1)
+                  : (out < NUM_OUTPUT_CHANNELS) ? (uint16_t)(1u << out) : 0;
+    if (!bits) return;
+    req_begin_mask &= (uint16_t)~bits;
+    req_commit_mask &= (uint16_t)~bits;
+    for (int o = 0; o < NUM_OUTPUT_CHANNELS; o++) {
+        if (bits & (1u << o)) slots[o].state = FIR_STATE_PENDING;
+    }
+    __dmb();
+    req_clear_mask |= bits;
+}
+
+bool fir_get_status(uint8_t out, FirStatusPacket *pkt) {
+    if (out >= NUM_OUTPUT_CHANNELS) return false;
+    const FirSlot *s = &slots[out];
+    uint8_t free_units = 0;
+    for (int u = 0; u < FIR_POOL_UNITS; u++) {
+        if (!(units_used & (1ull << u))) free_units++;
+    }
+    memset(pkt, 0, sizeof(*pkt));
+    pkt->output = out;
+    pkt->state = s->state;
+    pkt->error = s->error;
+    pkt->taps = s->taps;
+    pkt->received = s->received;
+    pkt->partition_size = FIR_PARTITION;
+    pkt->partitions = s->units ? s->units - 1 : 0;
+    pkt->pool_units = FIR_POOL_UNITS;
+    pkt->pool_units_free = free_units;
+    return true;
+}
+
+void fir_request_xover(const FirXoverPacket *req) {
+    if (req->output >= NUM_OUTPUT_CHANNELS) return;
+    XoverSlot *s = &xovers[req->output];
+    bool ok = req->type == FIR_XOVER_OFF ||
+              ((req->type == FIR_XOVER_LOWPASS || req->type == FIR_XOVER_HIGHPASS) &&
+               (req->taps & 1) && req->taps >= FIR_XOVER_MIN_TAPS && req->taps <= FIR_XOVER_MAX_TAPS &&
+               (req->order == 2 || req->order == 4 || req->order == 6 || req->order == 8) &&
+               req->freq_hz > 0.0f);
+    if (!ok) {
+        // Refused without touching a running crossover
+        s->error = FIR_ERR_PARAM;
+        return;
+    }
+    req_xover[req->output] = *req;
+    s->state = FIR_STATE_PENDING;
+    __dmb();
+    req_xover_mask |= (uint16_t)(1u << req->output);
+}
+
+bool fir_get_xover_status(uint8_t out, FirXoverStatusPacket *pkt) {
+    if (out >= NUM_OUTPUT_CHANNELS) return false;
+    const XoverSlot *s = &xovers[out];
+    uint16_t bit = (uint16_t)(1u << out);
+    memset(pkt, 0, sizeof(*pkt));
+    pkt->config = s->cfg;
+    pkt->config.output = out;
+    pkt->state = s->state;
+    pkt->error = s->error;
+    pkt->core = (fir_xover_core1_mask & bit) ? 1 : 0;
+    pkt->delay_samples = (uint16_t)(fir_output_latency(out));
+    pkt->comp_samples = (uint16_t)fir_latency_comp_samples(out);
+    pkt->design_rate = s->design_rate;
+    return true;
+}
+
+uint16_t fir_xover_taps(uint8_t out) {
+    if (out >= NUM_OUTPUT_CHANNELS || !(fir_xover_mask & (1u << out))) return 0;
+    return xovers[out].x.taps;
+}
+
+uint32_t fir_output_latency(uint8_t out) {
+    if (out >= NUM_OUTPUT_CHANNELS) return 0;
+    uint16_t bit = (uint16_t)(1u << out);
+    uint32_t l = 0;
+    if (fir_xover_mask & bit) l += xovers[out].x.centre;
+    if (fir_active_mask & bit) l += FIR_PARTITION;
+    return l;
+}
+
+int32_t fir_latency_comp_samples(uint8_t out) {
+    uint32_t worst = 0;
+    for (uint8_t o = 0; o < NUM_OUTPUT_CHANNELS; o++) {
+        uint32_t l = fir_output_latency(o);
+        if (l > worst) worst = l;
+    }
+    return (int32_t)(worst - fir_output_latency(out));
+}
+
+void fir_xover_set_core1_mask(uint16_t mask) {
+    fir_xover_core1_mask = mask;
+}
+
+uint16_t fir_active_partitions(uint8_t out) {
+    if (out >= NUM_OUTPUT_CHANNELS || !(fir_active_mask & (1u << out))) return 0;
+    return slots[out].conv.partitions;
+}
+
+// ----------------------------------------------------------------------------
+// MAIN LOOP
+// ----------------------------------------------------------------------------
+
+// Take an output's convolution out of the audio path.
+static void deactivate(uint8_t out) {
+    uint16_t bit = (uint16_t)(1u << out);
+    if (!(fir_active_mask & bit)) return;
+    fir_active_mask &= (uint16_t)~bit;
+    core1_wait_block();
+}
+
+static void units_free(uint8_t first, uint8_t count) {
+    for (int u = 0; u < count; u++) units_used &= ~(1ull << (first + u));
+}
+
+static void release(FirSlot *s) {
+    units_free(s->first_unit, s->units);
+    s->units = 0;
+    s->taps = 0;
+    s->received = 0;
+}
+
+// First fit over the unit bitmap.  Returns the first unit (now marked
+// used) or -1.
+static int units_alloc(uint8_t count) {
+    int run = 0;
+    for (int u = 0; u < FIR_POOL_UNITS; u++) {
+        run = (units_used & (1ull << u)) ? 0 : run + 1;
+        if (run == count) {
+            int first = u - count + 1;
+            for (int i = 0; i < count; i++) units_used |= 1ull << (first + i);
+            return first;
+        }
+    }
+    return -1;
+}
+
+static void start_loading(FirSlot *s, uint16_t taps) {
+    if (taps == 0 || taps > FIR_MAX_TAPS) {
+        s->error = FIR_ERR_LENGTH;
+        s->state = FIR_STATE_ERROR;
+        return;
+    }
+    uint16_t partitions = (taps + FIR_PARTITION - 1) / FIR_PARTITION;
+    int first = units_alloc((uint8_t)(partitions + 1));
+    if (first < 0) {
+        s->error = FIR_ERR_NO_MEMORY;
+        s->state = FIR_STATE_ERROR;
+        return;
+    }
+    s->first_unit = (uint8_t)first;
+    s->units = (uint8_t)(partitions + 1);
+
+    fir_conv_bind(&s->conv, &fir_pool[(uint32_t)first * FIR_UNIT_FLOATS], partitions);
+    fir_conv_clear_staging(&s->conv);
+    s->taps = taps;
+    s->received = 0;
+    s->error = FIR_ERR_NONE;
+    __dmb();
+    s->state = FIR_STATE_LOADING;
+}
+
+static void xover_remove(uint8_t out) {
+    XoverSlot *s = &xovers[out];
+    uint16_t bit = (uint16_t)(1u << out);
+    if (fir_xover_mask & bit) {
+        fir_xover_mask &= (uint16_t)~bit;
+        core1_wait_block();
+    }
+    xover_designing &= (uint16_t)~bit;
+    units_free(s->first_unit, s->units);
+    s->units = 0;
+    memset(&s->cfg, 0, sizeof(s->cfg));
+    s->design_rate = 0;
+    s->error = FIR_ERR_NONE;
+    s->state = FIR_STATE_EMPTY;
+}
+
+// Silence the output and start designing `cfg` at `rate`.  The new units
+// are allocated before the old ones are freed, so a failed allocation
+// leaves a running crossover alone.
+static void xover_start(uint8_t out, const FirXoverPacket *cfg, uint32_t rate) {
+    XoverSlot *s = &xovers[out];
+    uint16_t bit = (uint16_t)(1u << out);
+    uint32_t floats = fir_xover_floats(cfg->taps);
+    uint8_t units = (uint8_t)((floats + FIR_UNIT_FLOATS - 1) / FIR_UNIT_FLOATS);
+
+    bool same_memory = s->units && s->units >= units;
+    int first = same_memory ? s->first_unit : units_alloc(units);
+    if (first < 0) {
+        s->error = FIR_ERR_NO_MEMORY;
+        s->state = (fir_xover_mask & bit) ? FIR_STATE_ACTIVE : FIR_STATE_ERROR;
+        return;
+    }
+
+    xover_designing |= bit;
+    fir_xover_mask |= bit;
+    core1_wait_block();
+    if (!same_memory) {
+        units_free(s->first_unit, s->units);
+        s->first_unit = (uint8_t)first;
+        s->units = units;
+    }
+
+    if (!fir_xover_begin(&s->x, &fir_pool[(uint32_t)s->first_unit * FIR_UNIT_FLOATS], cfg->taps,
+                         cfg->order, cfg->type == FIR_XOVER_HIGHPASS, cfg->freq_hz, (float)rate)) {
+        // Frequency at or above Nyquist at this rate: keep the output silent
+        s->cfg = *cfg;
+        s->design_rate = rate;
+        s->error = FIR_ERR_PARAM;
+        s->state = FIR_STATE_ERROR;
+        return;
+    }
+    s->cfg = *cfg;
+    s->design_rate = rate;
+    s->error = FIR_ERR_NONE;
+    s->state = FIR_STATE_PENDING;
+}
+
+// Crossover requests, redesign after a rate change, and design steps.
+// Returns true if an output's FIR latency changed.
+static bool xover_service(uint32_t rate) {
+    bool changed = false;
+
+    if (req_xover_mask) {
+        uint32_t flags = save_and_disable_interrupts();
+        uint16_t req = req_xover_mask;
+        FirXoverPacket cfg[NUM_OUTPUT_CHANNELS];
+        memcpy(cfg, req_xover, sizeof(cfg));
+        req_xover_mask = 0;
+        restore_interrupts(flags);
+
+        for (uint8_t o = 0; o < NUM_OUTPUT_CHANNELS; o++) {
+            if (!(req & (1u << o))) continue;
+            if (cfg[o].type == FIR_XOVER_OFF) xover_remove(o);
+            else xover_start(o, &cfg[o], rate);
+            changed = true;
+        }
+    }
+
+    for (uint8_t o = 0; o < NUM_OUTPUT_CHANNELS; o++) {
+        XoverSlot *s = &xovers[o];
+        if (s->units && s->design_rate != rate && s->state != FIR_STATE_EMPTY) {
+            FirXoverPacket cfg = s->cfg;
+            xover_start(o, &cfg, rate);
+            changed = true;
+        }
+    }
+
+    uint16_t budget = XOVER_DESIGN_PER_PASS;
+    for (uint8_t o = 0; o < NUM_OUTPUT_CHANNELS && budget; o++) {
+        uint16_t bit = (uint16_t)(1u << o);
+        XoverSlot *s = &xovers[o];
+        if (!(xover_designing & bit) || s->state != FIR_STATE_PENDING) continue;
+        uint16_t before = s->x.designed;
+        bool done = fir_xover_design_step(&s->x, budget);
+        budget -= s->x.designed - before;
+        if (done) {
+            s->state = FIR_STATE_ACTIVE;
+            __dmb();
+            xover_designing &= (uint16_t)~bit;
+        }
+    }
+    return changed;
+}
+
+bool fir_bank_service(uint32_t sample_rate) {
+    bool changed = xover_service(sample_rate);
+
+    if (req_begin_mask | req_commit_mask | req_clear_mask) {
+        uint32_t flags = save_and_disable_interrupts();
+        uint16_t clear = req_clear_mask;
+        uint16_t begin = req_begin_mask;
+        uint16_t commit = req_commit_mask;
+        uint16_t taps[NUM_OUTPUT_CHANNELS];
+        for (int o = 0; o < NUM_OUTPUT_CHANNELS; o++) taps[o] = req_begin_taps[o];
+        req_clear_mask = req_begin_mask = req_commit_mask = 0;
+        restore_interrupts(flags);
+
+        for (uint8_t o = 0; o < NUM_OUTPUT_CHANNELS; o++) {
+            uint16_t bit = (uint16_t)(1u << o);
+            FirSlot *s = &slots[o];
+            if ((clear | begin) & bit) {
+                if (fir_active_mask & bit) changed = true;
+                deactivate(o);
+                committing_mask &= (uint16_t)~bit;
+                release(s);
+            }
+            if (clear & bit) {
+                s->error = FIR_ERR_NONE;
+                s->state = FIR_STATE_EMPTY;
+            }
+            if (begin & bit) start_loading(s, taps[o]);
+            if (commit & bit) {
+                s->prepared = 0;
+                committing_mask |= bit;
+            }
+        }
+    }
+
+    // Transform a few partitions per pass so the ring keeps draining
+    uint16_t budget = FIR_PREPARE_PER_PASS;
+    for (uint8_t o = 0; o < NUM_OUTPUT_CHANNELS && committing_mask && budget; o++) {
+        uint16_t bit = (uint16_t)(1u << o);
+        if (!(committing_mask & bit)) continue;
+        FirSlot *s = &slots[o];
+        while (budget && s->prepared < s->conv.partitions) {
+            // Core 0 scratch: Core 0 audio only runs between main loop calls
+            fir_conv_prepare(&s->conv, s->prepared++, fir_scratch[0]);
+            budget--;
+        }
+        if (s->prepared == s->conv.partitions) {
+            fir_conv_reset(&s->conv);
+            committing_mask &= (uint16_t)~bit;
+            s->state = FIR_STATE_ACTIVE;
+            __dmb();
+            fir_active_mask |= bit;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+#endif // ENABLE_FIR
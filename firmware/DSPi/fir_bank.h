@@ -0,0 +1,90 @@
+/*
+ * fir_bank.h — Per-output FIR stages (RP2350)
+ *
+ * Each output can run two FIR stages, both taking memory from one fixed
+ * pool of FIR_POOL_UNITS units, so the total length across outputs is
+ * bounded by the RAM budget rather than per output:
+ *
+ *   crossover    linear-phase LP / HP (fir_crossover.h) on the matrix
+ *                output, before the IIR EQ.  Either core can run any
+ *                output's crossover: Core 0 splits them with Core 1
+ *                through Core1EqWork (fir_xover_run()).
+ *   convolution  a long loaded FIR (fir_convolver.h) after the IIR EQ, on
+ *                the core that processes the output.
+ *
+ * Both are linear and time-invariant, so their position relative to the
+ * EQ does not change the result.  Their latency, (taps - 1) / 2 and
+ * FIR_PARTITION samples, is compensated on the other outputs through the
+ * delay lines (fir_latency_comp_samples()).
+ *
+ * Loading, from the host:
+ *
+ *   REQ_SET_FIR_BEGIN (output, taps)   main loop allocates, state LOADING
+ *   REQ_SET_FIR_TAPS  x ceil(taps/15)  in order, offsets in taps
+ *   REQ_SET_FIR_COMMIT                 main loop transforms, state ACTIVE
+ *
+ * Taps out of order, shorter than one tap, or outside LOADING are
+ * rejected with FIR_ERR_SEQUENCE (a running filter keeps running).  The
+ * output passes through unfiltered from BEGIN until the commit takes
+ * effect.  A crossover (REQ_SET_FIR_XOVER) is designed on the device; its
+ * output is silent while it is designed, including after a rate change.
+ * Filters live in RAM only and are lost on reboot.
+ */
+
+#ifndef FIR_BANK_H
+#define FIR_BANK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+#if ENABLE_FIR
+
+// Outputs with an active convolution, bit per output.  Read by both cores.
+extern volatile uint16_t fir_active_mask;
+
+// Outputs with a crossover stage (running, or silenced while designing),
+// and the subset Core 1 should run (fir_xover_set_core1_mask()).
+extern volatile uint16_t fir_xover_mask;
+extern volatile uint16_t fir_xover_core1_mask;
+
+void fir_bank_init(void);
+
+// Either core, for an output in fir_active_mask: filter in place.
+void fir_bank_process(uint8_t out, float *samples, uint32_t count);
+
+// Either core: run the crossovers of the outputs in `mask` (a subset of
+// fir_xover_mask) in place on bufs[out].
+void fir_xover_run(uint16_t mask, float (*bufs)[AUDIO_BUFFER_SAMPLES], uint32_t count);
+
+// Vendor requests.  IRQ-safe; begin / commit / clear are applied by the
+// next fir_bank_service().
+void fir_request_begin(const FirBeginPacket *req);
+void fir_request_taps(uint8_t out, const uint8_t *payload, uint16_t len);
+void fir_request_commit(uint8_t out);
+void fir_request_clear(uint8_t out);
+bool fir_get_status(uint8_t out, FirStatusPacket *pkt);
+void fir_request_xover(const FirXoverPacket *req);
+bool fir_get_xover_status(uint8_t out, FirXoverStatusPacket *pkt);
+
+// Main loop: allocate, transform, design, activate and free filters, and
+// redesign crossovers when the sample rate changes.  Returns true if an
+// output's FIR latency changed (the caller refreshes the delay lines).
+bool fir_bank_service(uint32_t sample_rate);
+
+// FIR latency of one output, and the delay that aligns it with the
+// output with the most FIR latency.
+uint32_t fir_output_latency(uint8_t out);
+int32_t fir_latency_comp_samples(uint8_t out);
+
+// Main loop: which crossovers Core 1 runs, from the cost estimate.
+void fir_xover_set_core1_mask(uint16_t mask);
+
+// For the cost estimate: partitions of the active convolution and taps of
+// the crossover on an output (0 = none).
+uint16_t fir_active_partitions(uint8_t out);
+uint16_t fir_xover_taps(uint8_t out);
+
+#endif // ENABLE_FIR
+
+#endif // FIR_BANK_H
@@ -0,0 +1,210 @@
+/*
+ * fir_convolver.c — Uniformly partitioned overlap-save FIR convolution
+ *
+ * Real FFT of length 2N through a complex FFT of length N: the even and
+ * odd samples are packed as real and imaginary parts, transformed, and
+ * separated with one twiddle pass.  The complex FFT is iterative radix-2
+ * on interleaved re/im floats with a single table of 2N-point twiddles,
+ * all single precision for the M33 FPU.
+ *
+ * Scaling: the forward transform is the plain DFT, the inverse returns
+ * 2N times the signal.  fir_conv_prepare() folds 1 / 2N into the partition
+ * spectra so the block loop has no extra multiply.
+ */
+
+#include <string.h>
+#include <math.h>
+#include "fir_convolver.h"
+
+#define N           FIR_PARTITION
+
+_Static_assert((N & (N - 1)) == 0, "FIR_PARTITION must be a power of two");
+
+static float tw_re[N];          // cos(2 pi k / 2N)
+static float tw_im[N];          // -sin(2 pi k / 2N), forward direction
+static uint8_t bitrev[N];
+
+void fir_conv_init(void) {
+    for (int k = 0; k < N; k++) {
+        float a = 6.28318530718f * (float)k / (float)FIR_FFT_SIZE;
+        tw_re[k] = cosf(a);
+        tw_im[k] = -sinf(a);
+    }
+    int bits = 0;
+    while ((1 << bits) < N) bits++;
+    for (int i = 0; i < N; i++) {
+        int r = 0;
+        for (int b = 0; b < bits; b++) {
+            if (i & (1 << b)) r |= 1 << (bits - 1 - b);
+        }
+        bitrev[i] = (uint8_t)r;
+    }
+}
+
+// In-place N-point complex FFT on interleaved re/im.  inverse = conjugate
+// twiddles, no scaling.
+static void fft_complex(float *a, bool inverse) {
+    for (int i = 0; i < N; i++) {
+        int r = bitrev[i];
+        if (r > i) {
+            float tr = a[2*i], ti = a[2*i+1];
+            a[2*i] = a[2*r];    a[2*i+1] = a[2*r+1];
+            a[2*r] = tr;        a[2*r+1] = ti;
+        }
+    }
+
+    // First stage: twiddle is 1
+    for (int i = 0; i < 2 * N; i += 4) {
+        float ur = a[i], ui = a[i+1];
+        float vr = a[i+2], vi = a[i+3];
+        a[i] = ur + vr;     a[i+1] = ui + vi;
+        a[i+2] = ur - vr;   a[i+3] = ui - vi;
+    }
+
+    for (int len = 4; len <= N; len <<= 1) {
+        int half = len >> 1;
+        int step = FIR_FFT_SIZE / len;      // Index step into the 2N table
+        for (int j = 0; j < half; j++) {
+            float wr = tw_re[j * step];
+            float wi = inverse ? -tw_im[j * step] : tw_im[j * step];
+            for (int i = j; i < N; i += len) {
+                float *u = &a[2*i];
+                float *v = &a[2*(i + half)];
+                float vr = v[0] * wr - v[1] * wi;
+                float vi = v[0] * wi + v[1] * wr;
+                v[0] = u[0] - vr;   v[1] = u[1] - vi;
+                u[0] += vr;         u[1] += vi;
+            }
+        }
+    }
+}
+
+// Real FFT: 2N samples -> N + 1 bins.  work = 2N floats, may alias x.
+static void rfft(const float *x, float *X, float *work) {
+    if (work != x) memcpy(work, x, FIR_FFT_SIZE * sizeof(float));
+    fft_complex(work, false);
+
+    float z0r = work[0], z0i = work[1];
+    X[0] = z0r + z0i;       X[1] = 0.0f;
+    X[2*N] = z0r - z0i;     X[2*N+1] = 0.0f;
+
+    for (int k = 1; k < N; k++) {
+        float ar = work[2*k],       ai = work[2*k+1];
+        float br = work[2*(N-k)],   bi = -work[2*(N-k)+1];     // conj(Z[N-k])
+        float er = 0.5f * (ar + br), ei = 0.5f * (ai + bi);     // Even samples
+        float or_ = 0.5f * (ai - bi), oi = -0.5f * (ar - br);   // Odd samples
+        float wr = tw_re[k], wi = tw_im[k];
+        X[2*k]   = er + or_ * wr - oi * wi;
+        X[2*k+1] = ei + or_ * wi + oi * wr;
+    }
+}
+
+// Inverse real FFT: N + 1 bins -> 2N samples, times 2N.
+static void irfft(const float *X, float *x) {
+    for (int k = 0; k < N; k++) {
+        float ar = X[2*k],          ai = X[2*k+1];
+        float br = X[2*(N-k)],      bi = -X[2*(N-k)+1];         // conj(X[N-k])
+        float er = ar + br,         ei = ai + bi;
+        float dr = ar - br,         di = ai - bi;
+        float wr = tw_re[k],        wi = -tw_im[k];             // conj(W^k)
+        float or_ = dr * wr - di * wi;
+        float oi = dr * wi + di * wr;
+        x[2*k]   = er - oi;         // E + iO
+        x[2*k+1] = ei + or_;
+    }
+    fft_complex(x, true);
+}
+
+static inline float *unit_spectrum(FirConvolver *c, uint16_t p) {
+    return c->units + (uint32_t)p * FIR_UNIT_FLOATS;
+}
+
+static inline float *unit_history(FirConvolver *c, uint16_t slot) {
+    return c->units + (uint32_t)slot * FIR_UNIT_FLOATS + 2 * FIR_BINS;
+}
+
+void fir_conv_bind(FirConvolver *c, float *mem, uint16_t partitions) {
+    c->window = mem;
+    c->out = mem + FIR_FFT_SIZE;
+    c->units = mem + FIR_UNIT_FLOATS;
+    c->partitions = partitions;
+    c->fill = 0;
+    c->head = 0;
+}
+
+float *fir_conv_staging(FirConvolver *c, uint16_t p) {
+    return unit_history(c, p);
+}
+
+void fir_conv_clear_staging(FirConvolver *c) {
+    for (uint16_t p = 0; p < c->partitions; p++) {
+        memset(unit_history(c, p), 0, N * sizeof(float));
+    }
+}
+
+void fir_conv_prepare(FirConvolver *c, uint16_t p, float *scratch) {
+    const float scale = 1.0f / (float)FIR_FFT_SIZE;
+    memcpy(scratch, fir_conv_staging(c, p), N * sizeof(float));
+    memset(scratch + N, 0, N * sizeof(float));
+    float *H = unit_spectrum(c, p);
+    rfft(scratch, H, scratch);
+    for (int i = 0; i < 2 * FIR_BINS; i++) H[i] *= scale;
+}
+
+void fir_conv_reset(FirConvolver *c) {
+    memset(c->window, 0, (FIR_FFT_SIZE + N) * sizeof(float));
+    for (uint16_t s = 0; s < c->partitions; s++) {
+        memset(unit_history(c, s), 0, 2 * FIR_BINS * sizeof(float));
+    }
+    c->fill = 0;
+    c->head = 0;
+}
+
+// One block: transform the window into the newest delay-line slot,
+// accumulate every partition against its delayed input, transform back.
+static void run_block(FirConvolver *c, float *scratch) {
+    uint16_t P = c->partitions;
+    c->head = (c->head + 1 == P) ? 0 : c->head + 1;
+    rfft(c->window, unit_history(c, c->head), scratch);
+    memcpy(c->window, c->window + N, N * sizeof(float));
+
+    float *acc = scratch + FIR_FFT_SIZE;
+    memset(acc, 0, 2 * FIR_BINS * sizeof(float));
+    uint16_t slot = c->head;
+    for (uint16_t p = 0; p < P; p++) {
+        const float *h = unit_spectrum(c, p);
+        const float *x = unit_history(c, slot);
+        float *y = acc;
+        for (int k = 0; k < FIR_BINS; k++) {
+            float xr = x[0], xi = x[1], hr = h[0], hi = h[1];
+            y[0] += xr * hr - xi * hi;
+            y[1] += xr * hi + xi * hr;
+            x += 2; h += 2; y += 2;
+        }
+        slot = slot ? slot - 1 : P - 1;
+    }
+
+    irfft(acc, scratch);
+    memcpy(c->out, scratch + N, N * sizeof(float));
+}
+
+void fir_conv_process(FirConvolver *c, float *samples, uint32_t count, float *scratch) {
+    uint32_t i = 0;
+    while (i < count) {
+        uint32_t n = N - c->fill;
+        if (n > count - i) n = count - i;
+        float *in = c->window + N + c->fill;
+        const float *out = c->out + c->fill;
+        for (uint32_t j = 0; j < n; j++) {
+            float x = samples[i + j];
+            samples[i + j] = out[j];
+            in[j] = x;
+        }
+        c->fill += n;
+        i += n;
+        if (c->fill == N) {
+            run_block(c, scratch);
+            c->fill = 0;
+        }
+    }
+}
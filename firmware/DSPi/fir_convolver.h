@@ -0,0 +1,74 @@
+/*
+ * fir_convolver.h — Uniformly partitioned overlap-save FIR convolution
+ *
+ * Long FIRs (room correction, speaker linearization) are too expensive as
+ * direct-form convolution: 4k taps at 48 kHz is ~200 M MAC/s.  The filter
+ * is split into partitions of FIR_PARTITION taps, each transformed once
+ * with a 2 * FIR_PARTITION real FFT.  Every FIR_PARTITION input samples
+ * the engine transforms the newest input window, multiplies it against
+ * every partition's spectrum through a frequency-domain delay line, and
+ * transforms the sum back — roughly one complex multiply-add per partition
+ * per sample, plus two FFTs per block.
+ *
+ * Output is delayed by FIR_PARTITION samples (one block is collected
+ * before it can be transformed).
+ *
+ * Memory is supplied by the caller in units of FIR_UNIT_FLOATS:
+ *
+ *   unit 0          input window (2N) + output block (N)
+ *   unit 1 + p      partition p spectrum (N + 1 bins) + one delay-line slot
+ *
+ * While a filter is being loaded the delay-line slots are unused, so
+ * fir_conv_staging() hands them out to hold the time-domain taps until
+ * fir_conv_prepare() turns them into partition spectra.
+ *
+ * Plain C with no SDK dependencies (like config_cost.c), so the host tools
+ * can build it to check against direct-form convolution.
+ */
+
+#ifndef FIR_CONVOLVER_H
+#define FIR_CONVOLVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FIR_PARTITION           128                         // N: taps per partition, samples per block
+#define FIR_FFT_SIZE            (2 * FIR_PARTITION)         // Real FFT length
+#define FIR_BINS                (FIR_PARTITION + 1)         // Complex bins kept (DC..Nyquist)
+#define FIR_UNIT_FLOATS         (4 * FIR_BINS)              // Spectrum + delay-line slot, interleaved re/im
+#define FIR_SCRATCH_FLOATS      (FIR_FFT_SIZE + 2 * FIR_BINS)   // Per calling core
+
+typedef struct {
+    float *window;              // 2N: previous block, current block
+    float *out;                 // N: output of the last transformed block
+    float *units;               // Partition units (unit 1 of the allocation)
+    uint16_t partitions;
+    uint16_t fill;              // Samples of the current block collected
+    uint16_t head;              // Delay-line slot of the newest input spectrum
+} FirConvolver;
+
+// Build the twiddle and bit-reverse tables.  Once at boot.
+void fir_conv_init(void);
+
+// Lay an engine over caller memory of (1 + partitions) * FIR_UNIT_FLOATS.
+void fir_conv_bind(FirConvolver *c, float *mem, uint16_t partitions);
+
+// Time-domain staging for partition p: FIR_PARTITION taps, zeroed by
+// fir_conv_clear_staging().  Valid until fir_conv_reset().
+float *fir_conv_staging(FirConvolver *c, uint16_t p);
+void fir_conv_clear_staging(FirConvolver *c);
+
+// Transform partition p's staged taps into its spectrum, scaled for the
+// inverse transform.  One partition per call so a long filter can be
+// prepared across several main loop passes; call fir_conv_reset() after
+// the last one.  scratch = FIR_SCRATCH_FLOATS.
+void fir_conv_prepare(FirConvolver *c, uint16_t p, float *scratch);
+
+// Clear input window, output block and delay line.
+void fir_conv_reset(FirConvolver *c);
+
+// Filter `count` samples in place.  scratch = FIR_SCRATCH_FLOATS, private
+// to the calling core.
+void fir_conv_process(FirConvolver *c, float *samples, uint32_t count, float *scratch);
+
+#endif // FIR_CONVOLVER_H
@@ -0,0 +1,106 @@
+/*
+ * fir_crossover.c — Linear-phase FIR crossover: designer and symmetric kernel
+ *
+ * Frequency sampling at odd length L with centre c = (L - 1) / 2:
+ *
+ *   p[j] = (1/L) * (M(0) + 2 * sum_{k=1..c} M(k/L) * cos(2 pi k (c - j) / L))
+ *
+ * where M is the target magnitude.  The cosine series for one coefficient
+ * is generated by rotating a phasor, so a coefficient costs c complex
+ * multiplies and no trig calls.  M(k/L) is tabulated once in the history
+ * area, which is unused until the design is complete.
+ */
+
+#include <string.h>
+#include <math.h>
+#include "fir_crossover.h"
+#include "dsp_math.h"
+
+uint32_t fir_xover_floats(uint16_t taps) {
+    return (uint32_t)(taps - 1) + FIR_XOVER_MAX_BLOCK + (taps + 1) / 2;
+}
+
+bool fir_xover_begin(FirXover *x, float *mem, uint16_t taps, uint8_t order,
+                     bool highpass, float freq_hz, float sample_rate) {
+    if (!(taps & 1) || taps < FIR_XOVER_MIN_TAPS || taps > FIR_XOVER_MAX_TAPS) return false;
+    if (order != 2 && order != 4 && order != 6 && order != 8) return false;
+    if (!(freq_hz > 0.0f) || freq_hz >= 0.5f * sample_rate) return false;
+
+    x->taps = taps;
+    x->centre = (taps - 1) / 2;
+    x->history = mem;
+    x->half = mem + (taps - 1) + FIR_XOVER_MAX_BLOCK;
+    x->designed = 0;
+    x->highpass = highpass;
+    x->order = order;
+    x->fc_norm = freq_hz / sample_rate;
+
+    // Low-pass magnitude at the frequency samples k / L, k = 0 .. c
+    float *mag = x->history;
+    for (uint16_t k = 0; k <= x->centre; k++) {
+        float r = ((float)k / (float)taps) / x->fc_norm;
+        mag[k] = 1.0f / (1.0f + powf(r, (float)order));
+    }
+    return true;
+}
+
+bool fir_xover_design_step(FirXover *x, uint16_t max_coeffs) {
+    const uint16_t c = x->centre;
+    const float *mag = x->history;
+    const float inv_l = 1.0f / (float)x->taps;
+    const float wscale = TWO_PI_F / (float)(x->taps - 1);
+
+    while (x->designed <= c && max_coeffs--) {
+        uint16_t j = x->designed;
+        float theta = TWO_PI_F * (float)(c - j) * inv_l;
+        float sr = sinf(theta), cr = cosf(theta);
+        float pr = cr, pi = sr;             // Phasor at k = 1
+        float sum = 0.0f;
+        for (uint16_t k = 1; k <= c; k++) {
+            sum += mag[k] * pr;
+            float t = pr * cr - pi * sr;
+            pi = pr * sr + pi * cr;
+            pr = t;
+        }
+        float p = (mag[0] + 2.0f * sum) * inv_l;
+        float w = 0.42f - 0.5f * cosf(wscale * (float)j) + 0.08f * cosf(2.0f * wscale * (float)j);
+        x->half[j] = p * w;
+        x->designed++;
+    }
+    if (x->designed <= c) return false;
+
+    // Unity DC gain, then the complement for high-pass
+    float dc = x->half[c];
+    for (uint16_t j = 0; j < c; j++) dc += 2.0f * x->half[j];
+    float norm = dc != 0.0f ? 1.0f / dc : 1.0f;
+    for (uint16_t j = 0; j <= c; j++) x->half[j] *= norm;
+    if (x->highpass) {
+        for (uint16_t j = 0; j < c; j++) x->half[j] = -x->half[j];
+        x->half[c] = 1.0f - x->half[c];
+    }
+
+    memset(x->history, 0, (x->taps - 1 + FIR_XOVER_MAX_BLOCK) * sizeof(float));
+    return true;
+}
+
+void fir_xover_process(FirXover *x, float *samples, uint32_t count) {
+    const uint16_t c = x->centre;
+    const uint16_t span = x->taps - 1;
+    const float *h = x->half;
+    float *hist = x->history;
+
+    memcpy(hist + span, samples, count * sizeof(float));
+    for (uint32_t n = 0; n < count; n++) {
+        const float *a = hist + n;              // Oldest input of this output sample
+        const float *b = hist + n + span;       // Newest
+        float acc0 = 0.0f, acc1 = 0.0f;
+        uint16_t k = 0;
+        for (; k + 1 < c; k += 2) {
+            acc0 += h[k]     * (a[k]     + b[-(int)k]);
+            acc1 += h[k + 1] * (a[k + 1] + b[-(int)k - 1]);
+        }
+        if (k < c) acc0 += h[k] * (a[k] + b[-(int)k]);
+        samples[n] = acc0 + acc1 + h[c] * a[c];
+    }
+    memmove(hist, hist + count, span * sizeof(float));
+}
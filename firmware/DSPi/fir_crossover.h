@@ -0,0 +1,60 @@
+/*
+ * fir_crossover.h — Linear-phase FIR crossover: designer and symmetric kernel
+ *
+ * The low-pass prototype has the magnitude of a Linkwitz-Riley crossover of
+ * the chosen order, 1 / (1 + (f / fc)^order), with linear phase instead of
+ * LR's phase rotation.  It is designed by frequency sampling at the filter
+ * length, Blackman-windowed and normalized to unity DC gain.  The high-pass
+ * is the exact complement, a centre impulse minus the low-pass, so the two
+ * sum to a pure delay of (taps - 1) / 2 samples.
+ *
+ * The filter is symmetric, so the kernel adds the two input samples that
+ * share a coefficient before multiplying: (taps + 1) / 2 multiplies per
+ * output sample instead of taps.
+ *
+ * Memory is supplied by the caller (fir_xover_floats()): the input history
+ * followed by the half coefficient set.  Design runs in steps so the main
+ * loop can spread it over several passes.
+ *
+ * Plain C with no SDK dependencies, like fir_convolver.c.
+ */
+
+#ifndef FIR_CROSSOVER_H
+#define FIR_CROSSOVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FIR_XOVER_MIN_TAPS      31
+#define FIR_XOVER_MAX_TAPS      511     // Odd lengths only
+#define FIR_XOVER_MAX_BLOCK     196     // Largest block per call (AUDIO_BUFFER_SAMPLES)
+
+typedef struct {
+    float *history;             // taps - 1 past inputs + the current block
+    float *half;                // Coefficients 0 .. centre
+    uint16_t taps;
+    uint16_t centre;            // (taps - 1) / 2, also the delay in samples
+    uint16_t designed;          // Coefficients designed so far
+    bool highpass;
+    uint8_t order;              // 2, 4, 6 or 8 (12 .. 48 dB/oct)
+    float fc_norm;              // Crossover frequency / sample rate
+} FirXover;
+
+// Floats of memory an engine of `taps` needs.
+uint32_t fir_xover_floats(uint16_t taps);
+
+// Lay an engine over caller memory and start a design.  False if the
+// parameters are out of range (taps even or outside MIN..MAX, order not
+// 2/4/6/8, frequency not below Nyquist).
+bool fir_xover_begin(FirXover *x, float *mem, uint16_t taps, uint8_t order,
+                     bool highpass, float freq_hz, float sample_rate);
+
+// Design up to `max_coeffs` more coefficients.  True once the filter is
+// complete (normalized and, for high-pass, complemented) and the history
+// cleared.
+bool fir_xover_design_step(FirXover *x, uint16_t max_coeffs);
+
+// Filter `count` (<= FIR_XOVER_MAX_BLOCK) samples in place.
+void fir_xover_process(FirXover *x, float *samples, uint32_t count);
+
+#endif // FIR_CROSSOVER_H
@@ -3,6 +3,23 @@
 #include "hardware/flash.h"
 #include "hardware/sync.h"
 #include "pico/bootrom.h"
+#include "pico/multicore.h"
+
+// dspi_flash_do_cmd() runs while audio is live, so it brackets each command
+// itself: Core 1 parked in RAM (if it has registered as a lockout victim)
+// and interrupts off on Core 0, so nothing can touch XIP between exit_xip
+// and the restore.  Core 1 is released last, once XIP reads work again.
+static bool __no_inline_not_in_flash_func(flash_cmd_begin)(uint32_t *irq) {
+    bool park = get_core_num() == 0 && multicore_lockout_victim_is_initialized(1);
+    if (park) multicore_lockout_start_blocking();
+    *irq = save_and_disable_interrupts();
+    return park;
+}
+
+static void __no_inline_not_in_flash_func(flash_cmd_end)(uint32_t irq, bool parked) {
+    restore_interrupts(irq);
+    if (parked) multicore_lockout_end_blocking();
+}
 
 #if PICO_RP2350
 
@@ -86,6 +103,58 @@ void __no_inline_not_in_flash_func(dspi_flash_range_program)(uint32_t flash_offs
     __compiler_memory_barrier();
 }
 
+// Serial command with the same m[0] save/restore.  Unlike the ROM erase/
+// program calls this never waits for the flash to finish: flash_writer.c
+// issues erase/program opcodes here and polls the status register through
+// it, so XIP is only off for the duration of each short command.  The whole
+// window, from connect() to the m[0] restore, runs inside flash_cmd_begin().
+void __no_inline_not_in_flash_func(dspi_flash_do_cmd)(const uint8_t *txbuf, uint8_t *rxbuf, size_t count) {
+    rom_connect_internal_flash_fn connect     = (rom_connect_internal_flash_fn) rom_func_lookup_inline(ROM_FUNC_CONNECT_INTERNAL_FLASH);
+    rom_flash_exit_xip_fn         exit_xip    = (rom_flash_exit_xip_fn)         rom_func_lookup_inline(ROM_FUNC_FLASH_EXIT_XIP);
+    rom_flash_flush_cache_fn      flush_cache = (rom_flash_flush_cache_fn)      rom_func_lookup_inline(ROM_FUNC_FLASH_FLUSH_CACHE);
+
+    uint32_t irq;
+    bool parked = flash_cmd_begin(&irq);
+
+    uint32_t saved_timing = qmi_hw->m[0].timing;
+    uint32_t saved_rcmd   = qmi_hw->m[0].rcmd;
+    uint32_t saved_rfmt   = qmi_hw->m[0].rfmt;
+
+    __compiler_memory_barrier();
+    connect();
+    exit_xip();
+    dspi_set_clkdiv();
+
+    // Direct-mode transfer on CS0 (same sequence as the SDK's flash_do_cmd)
+    hw_set_bits(&qmi_hw->direct_csr, QMI_DIRECT_CSR_EN_BITS);
+    while (qmi_hw->direct_csr & QMI_DIRECT_CSR_BUSY_BITS) {}
+    hw_set_bits(&qmi_hw->direct_csr, QMI_DIRECT_CSR_ASSERT_CS0N_BITS);
+    size_t tx_remaining = count;
+    size_t rx_remaining = count;
+    while (tx_remaining || rx_remaining) {
+        uint32_t csr = qmi_hw->direct_csr;
+        if (tx_remaining && !(csr & QMI_DIRECT_CSR_TXFULL_BITS)) {
+            qmi_hw->direct_tx = *txbuf++;
+            --tx_remaining;
+        }
+        if (rx_remaining && !(csr & QMI_DIRECT_CSR_RXEMPTY_BITS)) {
+            *rxbuf++ = (uint8_t)qmi_hw->direct_rx;
+            --rx_remaining;
+        }
+    }
+    while (qmi_hw->direct_csr & QMI_DIRECT_CSR_BUSY_BITS) {}
+    hw_clear_bits(&qmi_hw->direct_csr, QMI_DIRECT_CSR_ASSERT_CS0N_BITS | QMI_DIRECT_CSR_EN_BITS);
+    flush_cache();
+
+    qmi_hw->m[0].rcmd   = saved_rcmd;
+    qmi_hw->m[0].rfmt   = saved_rfmt;
+    qmi_hw->m[0].timing = (saved_timing & ~QMI_M0_TIMING_CLKDIV_BITS)
+                        | (DSPI_FLASH_SPI_CLKDIV << QMI_M0_TIMING_CLKDIV_LSB);
+    __compiler_memory_barrier();
+
+    flash_cmd_end(irq, parked);
+}
+
 #else  // PICO_RP2040
 
 // On RP2040, boot2's PICO_FLASH_SPI_CLKDIV already governs both XIP reads and
@@ -102,4 +171,13 @@ void dspi_flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t c
     flash_range_program(flash_offs, data, count);
 }
 
+// flash_do_cmd() leaves XIP off for the command, so it gets the same
+// bracket as on RP2350
+void dspi_flash_do_cmd(const uint8_t *txbuf, uint8_t *rxbuf, size_t count) {
+    uint32_t irq;
+    bool parked = flash_cmd_begin(&irq);
+    flash_do_cmd(txbuf, rxbuf, count);
+    flash_cmd_end(irq, parked);
+}
+
 #endif
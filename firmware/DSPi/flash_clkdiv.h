@@ -20,6 +20,13 @@ void dspi_flash_apply_clkdiv(void);
 void dspi_flash_range_erase(uint32_t flash_offs, size_t count);
 void dspi_flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
 
+// Raw serial command (opcode + address + data in `txbuf`, `count` bytes
+// clocked each way).  Returns as soon as the bytes are sent — it does not
+// wait for the flash to go idle.  Safe to call with audio running from Core
+// 0: it parks Core 1 and disables interrupts for the XIP-off window itself.
+// Used by flash_writer.c.
+void dspi_flash_do_cmd(const uint8_t *txbuf, uint8_t *rxbuf, size_t count);
+
 #ifdef __cplusplus
 }
 #endif
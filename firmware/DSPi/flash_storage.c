@@ -1,44 +1,56 @@
 /*
  * flash_storage.c — Preset-based parameter persistence for DSPi
  *
- * Flash Layout (from end of flash, working backwards):
+ * Flash Layout: 24 sectors (96 KB) at the end of flash, used as an
+ * append-only journal of CRC'd records.
  *
- *   Sector 0  (-48 KB):  Preset Directory  (metadata, slot names, startup config)
- *   Sector 1  (-44 KB):  Preset Slot 0     (full DSP state snapshot)
- *   Sector 2  (-40 KB):  Preset Slot 1
- *   ...
- *   Sector 10 ( -8 KB):  Preset Slot 9
- *   Sector 11 ( -4 KB):  Legacy sector     (old single-preset format, kept for
- *                                            backward compat / migration)
+ *   Each journal sector starts with a 16-byte header (magic, claim sequence,
+ *   erase count).  Records follow back-to-back on 16-byte boundaries:
  *
- * Each sector is 4 KB (FLASH_SECTOR_SIZE).  A preset slot stores the complete
- * user-configurable DSP state: EQ bands, preamp, delays, loudness, crossfeed,
- * matrix mixer, channel gains/mutes, and optionally pin assignments.
+ *     DIR_FIELDS  startup config, last-active slot, master volume, latency
+ *     SLOT_NAME   one 32-byte slot name
+ *     SLOT_PACKED one preset in the compact sectioned encoding
+ *     SLOT_DATA   one full PresetSlot (written by older firmware; read only)
+ *     SLOT_ERASED tombstone for a deleted slot
  *
- * The directory sector holds a 10-bit occupancy bitmask, 10 x 32-byte slot
- * names, startup configuration (which slot to load on boot), and the index
- * of the last-active slot.
+ * The newest valid record for each key wins, and the RAM index holds its
+ * flash offset, so any slot is found in O(1).  Changing a setting or a name
+ * appends one small record — a single page program, no erase.  Saving a
+ * preset appends one SLOT_PACKED record.  Sectors are erased only when the
+ * journal claims a new head sector; garbage collection copies the live
+ * records out of the emptiest sector to keep two spares available.  Head
+ * sectors are claimed in order of lowest erase count, so wear is spread over
+ * the whole region.
  *
- * On boot, preset_boot_load() reads the directory and loads the appropriate
- * slot based on the startup policy.  If no directory exists (first boot after
- * firmware upgrade), it attempts to migrate the legacy single-sector data
- * into slot 0.
+ * A preset slot stores the complete user-configurable DSP state: EQ bands,
+ * preamp, delays, loudness, crossfeed, matrix mixer, channel gains/mutes,
+ * and optionally pin assignments.  In RAM it is always a PresetSlot; on
+ * flash only the bands, routes, outputs and names that differ from neutral
+ * defaults are stored, plus the sections that differ from their defaults.
+ * A typical preset packs to 300-700 bytes, so the region holds 100+ of
+ * them; the exact count depends on content (see JOURNAL_SLOT_BUDGET).
+ *
+ * On boot, preset_boot_load() replays the journal into the RAM directory
+ * cache and loads the appropriate slot based on the startup policy.  Older
+ * firmware kept a 12-sector journal in the top half of the region, and
+ * before that a fixed layout in the same 12 sectors (directory, slots 0-9,
+ * single-preset legacy format).  Journal sectors from the smaller region are
+ * picked up as they are; fixed-layout data is migrated into the journal.
  */
 
 #include "flash_storage.h"
 #include "config.h"
 #include "dsp_pipeline.h"
-#include "flash_clkdiv.h"
+#include "flash_writer.h"
 #include "usb_audio.h"
 #include "crossfeed.h"
 #include "pdm_generator.h"
-#include "usb_feedback_controller.h"
 #include "leveller.h"
+#include "coeff_cache.h"
 
 #include "hardware/flash.h"
 #include "hardware/sync.h"
 #include "pico/stdlib.h"
-#include "pico/multicore.h"
 
 #include <string.h>
 #include <math.h>    // powf(), isfinite() for master volume (db_to_linear() clamps at -60 dB)
@@ -47,14 +59,22 @@
 // FLASH GEOMETRY
 // ============================================================================
 
-// Total reservation: 12 sectors (48 KB) at the end of flash.
-// Sector 0 = directory, sectors 1-10 = preset slots, sector 11 = legacy.
-#define PRESET_TOTAL_SECTORS    12
+// Total reservation: 24 sectors (96 KB) at the end of flash.
+#define PRESET_TOTAL_SECTORS    24
 #define PRESET_BASE_OFFSET      (PICO_FLASH_SIZE_BYTES - (PRESET_TOTAL_SECTORS * FLASH_SECTOR_SIZE))
 
-// Individual sector offsets (byte offset from start of flash)
-#define DIR_SECTOR_OFFSET       (PRESET_BASE_OFFSET)
-#define SLOT_SECTOR_OFFSET(n)   (PRESET_BASE_OFFSET + ((1 + (n)) * FLASH_SECTOR_SIZE))
+// Pre-journal fixed layout in the last 12 sectors — read only for migration.
+// Sector 0 = directory, sectors 1-10 = preset slots, sector 11 = legacy.
+// Sector numbers below are journal sector indices.
+#define FIXED_SECTORS           12
+#define FIXED_SLOTS             10
+#define FIXED_FIRST_SECTOR      (PRESET_TOTAL_SECTORS - FIXED_SECTORS)
+#define FIXED_DIR_SECTOR        (FIXED_FIRST_SECTOR)
+#define FIXED_SLOT_SECTOR(n)    (FIXED_FIRST_SECTOR + 1 + (n))
+#define FIXED_LEGACY_SECTOR     (PRESET_TOTAL_SECTORS - 1)
+
+#define DIR_SECTOR_OFFSET       (PRESET_BASE_OFFSET + (FIXED_DIR_SECTOR * FLASH_SECTOR_SIZE))
+#define SLOT_SECTOR_OFFSET(n)   (PRESET_BASE_OFFSET + (FIXED_SLOT_SECTOR(n) * FLASH_SECTOR_SIZE))
 #define LEGACY_SECTOR_OFFSET    (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE)
 
 // XIP read pointers (memory-mapped flash)
@@ -62,10 +82,21 @@
 #define SLOT_ADDR(n)            ((const PresetSlot *)(XIP_BASE + SLOT_SECTOR_OFFSET(n)))
 #define LEGACY_ADDR             ((const LegacyFlashStorage *)(XIP_BASE + LEGACY_SECTOR_OFFSET))
 
+// Journal — spans the whole reservation
+#define JOURNAL_SECTORS         PRESET_TOTAL_SECTORS
+#define JOURNAL_SECTOR_OFFSET(s) (PRESET_BASE_OFFSET + ((s) * FLASH_SECTOR_SIZE))
+#define JOURNAL_ALIGN           16      // Record alignment within a sector
+#define JOURNAL_SPARE_SECTORS   2       // Free sectors GC keeps in reserve
+#define JOURNAL_SECTOR_PAYLOAD  (FLASH_SECTOR_SIZE - sizeof(JournalSectorHeader))
+#define JOURNAL_NO_HEAD         0xFF
+
 // Magic numbers — each distinct so we can tell sector types apart
 #define DIR_MAGIC               0x44535032  // "DSP2"
 #define SLOT_MAGIC              0x44535033  // "DSP3"
 #define LEGACY_MAGIC            0x44535031  // "DSP1" (original format)
+#define JOURNAL_MAGIC           0x4453504A  // "DSPJ"
+#define JOURNAL_VERSION         1
+#define PACKED_FORMAT           1           // SLOT_PACKED encoding version
 
 // Current data version for preset slot contents
 #define SLOT_DATA_VERSION       12   // V12: per-channel preamp + master volume
@@ -106,10 +137,10 @@ typedef struct __attribute__((packed)) {
     uint16_t slot_occupied;
     uint8_t  include_master_volume;
     uint8_t  padding[1];
-    char     slot_names[PRESET_SLOTS][PRESET_NAME_LEN];
+    char     slot_names[FIXED_SLOTS][PRESET_NAME_LEN];
 } PresetDirectory_v1;
 
-// --- Preset Directory v2 (current, sector 0) ---
+// --- Preset Directory v2 (fixed-layout sector 0; migration only) ---
 typedef struct __attribute__((packed)) {
     uint32_t magic;                          // DIR_MAGIC
     uint16_t version;                        // Directory format version (2)
@@ -125,14 +156,29 @@ typedef struct __attribute__((packed)) {
     // Slot metadata
     uint16_t slot_occupied;                  // Bitmask: bit N = slot N has valid data
     uint8_t  master_volume_mode;             // MASTER_VOLUME_MODE_INDEPENDENT or _WITH_PRESET
-    uint8_t  padding[1];
+    uint8_t  latency_profile;                // LATENCY_PROFILE_* (was padding; 0 = BALANCED)
     float    master_volume_db;               // Independent master volume (mode 0 at boot)
-    char     slot_names[PRESET_SLOTS][PRESET_NAME_LEN];  // 32-byte NUL-terminated names
+    char     slot_names[FIXED_SLOTS][PRESET_NAME_LEN];  // 32-byte NUL-terminated names
 } PresetDirectory;
 
 #define DIR_VERSION_CURRENT  2
 
-// --- Preset Slot (sectors 1-10) ---
+// --- RAM directory cache (rebuilt from the journal index at boot) ---
+typedef struct {
+    uint8_t  startup_mode;                   // PRESET_STARTUP_SPECIFIED or _LAST_ACTIVE
+    uint8_t  default_slot;                   // Slot to load in SPECIFIED mode
+    uint8_t  last_active_slot;               // Last loaded/saved slot
+    uint8_t  include_pins;                   // Whether preset load restores pin config
+    uint8_t  master_volume_mode;             // MASTER_VOLUME_MODE_INDEPENDENT or _WITH_PRESET
+    uint8_t  latency_profile;                // LATENCY_PROFILE_*
+    uint16_t rate_lock_hz100;                // Output rate lock / 100 Hz (0 = off)
+    float    master_volume_db;               // Independent master volume (mode 0 at boot)
+    uint32_t slot_occupied[PRESET_MASK_WORDS];  // Bit N = slot N has valid data
+    uint32_t slot_bytes;                     // journal_slot_bytes(), for the vendor IRQ
+    char     slot_names[PRESET_SLOTS][PRESET_NAME_LEN];  // Served to the vendor IRQ from RAM
+} PresetDirCache;
+
+// --- Preset Slot (RAM form; SLOT_DATA record payload; fixed-layout sectors 1-10) ---
 typedef struct __attribute__((packed)) {
     uint32_t magic;                          // SLOT_MAGIC
     uint16_t version;                        // Data format version (matches SLOT_DATA_VERSION)
@@ -162,7 +208,7 @@ typedef struct __attribute__((packed)) {
     float crossfeed_custom_fc;
     float crossfeed_custom_feed_db;
     // Matrix mixer (V5)
-    FlashMatrixCrosspoint matrix_crosspoints[NUM_INPUT_CHANNELS][NUM_OUTPUT_CHANNELS];
+    FlashMatrixCrosspoint matrix_crosspoints[NUM_MASTER_INPUTS][NUM_OUTPUT_CHANNELS];
     FlashOutputChannel matrix_outputs[NUM_OUTPUT_CHANNELS];
     // Pin configuration (V6) — always stored, conditionally loaded
     uint8_t output_pins[NUM_PIN_OUTPUTS];
@@ -184,10 +230,36 @@ typedef struct __attribute__((packed)) {
     float   leveller_max_gain_db;
     float   leveller_gate_threshold_db;
     // Per-channel preamp + Master volume (V12)
-    float   preamp_db_per_ch[NUM_INPUT_CHANNELS];  // Per-input-channel preamp (dB)
+    float   preamp_db_per_ch[NUM_MASTER_INPUTS];   // Per-input-channel preamp (dB)
     float   master_volume_db;                       // Device master volume (-128 mute, -127..0 dB)
+#if ENABLE_MC_INPUT
+    // Multichannel inputs 2+ — RAM only.  Never part of a SLOT_DATA record
+    // or a fixed slot; packed slots carry them in PSEC_ROUTES and
+    // PSEC_AUX_PREAMP.
+    float   aux_preamp_db[NUM_INPUT_CHANNELS - NUM_MASTER_INPUTS];
+    FlashMatrixCrosspoint aux_crosspoints[NUM_INPUT_CHANNELS - NUM_MASTER_INPUTS][NUM_OUTPUT_CHANNELS];
+#endif
 } PresetSlot;
 
+// On-flash size of a full PresetSlot record (SLOT_DATA, fixed sectors)
+#if ENABLE_MC_INPUT
+#define SLOT_RECORD_SIZE  offsetof(PresetSlot, aux_preamp_db)
+#define SLOT_XP(s, in, out) ((in) < NUM_MASTER_INPUTS ? &(s)->matrix_crosspoints[in][out] \
+                             : &(s)->aux_crosspoints[(in) - NUM_MASTER_INPUTS][out])
+#else
+#define SLOT_RECORD_SIZE  sizeof(PresetSlot)
+#define SLOT_XP(s, in, out) (&(s)->matrix_crosspoints[in][out])
+#endif
+
+// Preamp of input `in`: V12+ stores one per master channel, older slots a
+// single value; multichannel inputs 2+ have their own.
+static inline float slot_preamp_db(const PresetSlot *s, int in) {
+#if ENABLE_MC_INPUT
+    if (in >= NUM_MASTER_INPUTS) return s->aux_preamp_db[in - NUM_MASTER_INPUTS];
+#endif
+    return s->version >= 12 ? s->preamp_db_per_ch[in] : s->preamp_db;
+}
+
 // --- Legacy single-sector format (for migration) ---
 typedef struct __attribute__((packed)) {
     uint32_t magic;
@@ -212,12 +284,182 @@ typedef struct __attribute__((packed)) {
     uint8_t padding4;
     float crossfeed_custom_fc;
     float crossfeed_custom_feed_db;
-    FlashMatrixCrosspoint matrix_crosspoints[NUM_INPUT_CHANNELS][NUM_OUTPUT_CHANNELS];
+    FlashMatrixCrosspoint matrix_crosspoints[NUM_MASTER_INPUTS][NUM_OUTPUT_CHANNELS];
     FlashOutputChannel matrix_outputs[NUM_OUTPUT_CHANNELS];
     uint8_t output_pins[NUM_PIN_OUTPUTS];
     uint8_t pin_padding[8 - NUM_PIN_OUTPUTS];
 } LegacyFlashStorage;
 
+// --- Journal sector header (first 16 bytes of every journal sector) ---
+typedef struct __attribute__((packed)) {
+    uint32_t magic;                          // JOURNAL_MAGIC
+    uint32_t seq;                            // Claim order — replay runs oldest first
+    uint32_t erase_count;                    // Erases since the sector joined the journal
+    uint16_t version;                        // JOURNAL_VERSION
+    uint16_t check;                          // Low 16 bits of CRC over the first 14 bytes
+} JournalSectorHeader;
+
+// --- Journal record header (payload follows, padded to JOURNAL_ALIGN) ---
+typedef struct __attribute__((packed)) {
+    uint8_t  type;                           // JREC_*
+    uint8_t  key;                            // Slot index for per-slot records
+    uint16_t len;                            // Payload bytes
+    uint32_t data_crc;                       // CRC over the payload
+    uint32_t reserved;                       // 0xFFFFFFFF
+    uint32_t hdr_crc;                        // CRC over the first 12 bytes
+} JournalRecordHeader;
+
+#define JREC_DIR_FIELDS   0x01    // JournalDirFields
+#define JREC_SLOT_NAME    0x02    // PRESET_NAME_LEN bytes
+#define JREC_SLOT_DATA    0x03    // PresetSlot (older firmware; still read)
+#define JREC_SLOT_ERASED  0x04    // No payload
+#define JREC_SLOT_PACKED  0x05    // PackedSlotHeader + sections
+#define JREC_BOOT_COEFFS  0x06    // Key COEFF_BOOT_*; see coeff_cache.h
+
+// --- DIR_FIELDS payload: the non-name part of PresetDirectory ---
+typedef struct __attribute__((packed)) {
+    uint8_t  startup_mode;
+    uint8_t  default_slot;
+    uint8_t  last_active_slot;
+    uint8_t  include_pins;
+    uint8_t  master_volume_mode;
+    uint8_t  latency_profile;
+    uint16_t rate_lock_hz100;   // Was padding; 0 = no rate lock
+    float    master_volume_db;
+} JournalDirFields;
+
+#define JREC_SIZE(len)  ((sizeof(JournalRecordHeader) + (len) + JOURNAL_ALIGN - 1) \
+                         & ~(JOURNAL_ALIGN - 1))
+
+// --- SLOT_PACKED payload ---
+//
+// A header followed by sections, each a PackedSection header and `len`
+// bytes of body.  Decoding starts from slot_baseline() and applies the
+// sections present; unknown tags are skipped, so sections can be added
+// without a format bump.  Bodies are byte-aligned only — read with memcpy.
+typedef struct __attribute__((packed)) {
+    uint8_t  format;                         // PACKED_FORMAT
+    uint8_t  slot_version;                   // SLOT_DATA_VERSION the state was collected under
+    uint8_t  slot_index;                     // Which slot this is (sanity check)
+    uint8_t  reserved;
+} PackedSlotHeader;
+
+typedef struct __attribute__((packed)) {
+    uint8_t  tag;                            // PSEC_*
+    uint8_t  reserved;
+    uint16_t len;                            // Body bytes
+} PackedSection;
+
+#define PSEC_BANDS      0x01    // EqParamPacket per band that is not neutral_band
+#define PSEC_LEVELS     0x02    // PackedLevels
+#define PSEC_DELAYS     0x03    // float[NUM_CHANNELS]
+#define PSEC_LOUDNESS   0x04    // PackedLoudness
+#define PSEC_CROSSFEED  0x05    // PackedCrossfeed
+#define PSEC_LEVELLER   0x06    // PackedLeveller
+#define PSEC_HARDWARE   0x07    // PackedHardware
+#define PSEC_ROUTES     0x08    // PackedRoute per crosspoint that is not all-zero
+#define PSEC_OUTPUTS    0x09    // PackedOutput per output that is not all-zero
+#define PSEC_NAMES      0x0A    // {ch, len, chars} per channel name that is not the default
+#define PSEC_AUX_PREAMP 0x0B    // float per multichannel input 2+ (dB), when any is not 0
+
+typedef struct __attribute__((packed)) {
+    float   preamp_db;                       // Legacy single preamp
+    float   preamp_db_per_ch[NUM_MASTER_INPUTS];
+    float   master_volume_db;
+    float   channel_gain_db[3];
+    uint8_t channel_mute[3];
+    uint8_t bypass;
+} PackedLevels;
+
+typedef struct __attribute__((packed)) {
+    uint8_t enabled;
+    uint8_t padding[3];
+    float   ref_spl;
+    float   intensity_pct;
+} PackedLoudness;
+
+typedef struct __attribute__((packed)) {
+    uint8_t enabled;
+    uint8_t preset;
+    uint8_t itd_enabled;
+    uint8_t padding;
+    float   custom_fc;
+    float   custom_feed_db;
+} PackedCrossfeed;
+
+typedef struct __attribute__((packed)) {
+    uint8_t enabled;
+    uint8_t speed;
+    uint8_t lookahead;
+    uint8_t padding;
+    float   amount;
+    float   max_gain_db;
+    float   gate_threshold_db;
+} PackedLeveller;
+
+typedef struct __attribute__((packed)) {
+    uint8_t output_pins[8];
+    uint8_t output_types[4];
+    uint8_t i2s_bck_pin;
+    uint8_t i2s_mck_pin;
+    uint8_t i2s_mck_enabled;
+    uint8_t i2s_mck_multiplier;              // Raw PresetSlot value (version-dependent)
+} PackedHardware;
+
+typedef struct __attribute__((packed)) {
+    uint8_t in;
+    uint8_t out;
+    uint8_t enabled;
+    uint8_t phase_invert;
+    float   gain_db;
+} PackedRoute;
+
+typedef struct __attribute__((packed)) {
+    uint8_t out;
+    uint8_t enabled;
+    uint8_t mute;
+    uint8_t padding;
+    float   gain_db;
+    float   delay_ms;
+} PackedOutput;
+
+#define PSEC_SIZE(body)  (sizeof(PackedSection) + (body))
+#define PACKED_SLOT_MAX  (sizeof(PackedSlotHeader)                                           \
+                          + PSEC_SIZE(NUM_CHANNELS * MAX_BANDS * sizeof(EqParamPacket))     \
+                          + PSEC_SIZE(sizeof(PackedLevels))                                  \
+                          + PSEC_SIZE(NUM_CHANNELS * sizeof(float))                          \
+                          + PSEC_SIZE(sizeof(PackedLoudness))                                \
+                          + PSEC_SIZE(sizeof(PackedCrossfeed))                               \
+                          + PSEC_SIZE(sizeof(PackedLeveller))                                \
+                          + PSEC_SIZE(sizeof(PackedHardware))                                \
+                          + PSEC_SIZE(NUM_INPUT_CHANNELS * NUM_OUTPUT_CHANNELS * sizeof(PackedRoute)) \
+                          + PSEC_SIZE(NUM_OUTPUT_CHANNELS * sizeof(PackedOutput))            \
+                          + PSEC_SIZE(NUM_CHANNELS * (2 + PRESET_NAME_LEN - 1))           \
+                          + PSEC_SIZE((NUM_INPUT_CHANNELS - NUM_MASTER_INPUTS) * sizeof(float)))
+
+// Capacity.  GC reclaims the sealed sector with the least live data, so it
+// always makes progress while the average sealed sector is less than full:
+// live data is capped at 7/8 of the sectors that are neither spare nor
+// head, which also absorbs the page-tail padding of small records.  Every
+// slot's name and tombstone and the boot coefficient records are reserved
+// up front, so renames, deletes and boot record refreshes never fail for
+// lack of space; presets get the rest.
+#define JOURNAL_LIVE_LIMIT   ((JOURNAL_SECTORS - JOURNAL_SPARE_SECTORS - 1) \
+                              * (JOURNAL_SECTOR_PAYLOAD * 7 / 8))
+#define JOURNAL_META_MAX     (JREC_SIZE(sizeof(JournalDirFields)) \
+                              + PRESET_SLOTS * (JREC_SIZE(PRESET_NAME_LEN) + JREC_SIZE(0)) \
+                              + COEFF_BOOT_PARTS * JREC_SIZE(COEFF_BOOT_RECORD_MAX))
+#define JOURNAL_SLOT_BUDGET  (JOURNAL_LIVE_LIMIT - JOURNAL_META_MAX)
+
+_Static_assert(sizeof(JournalSectorHeader) == JOURNAL_ALIGN, "sector header size");
+_Static_assert(sizeof(JournalRecordHeader) == JOURNAL_ALIGN, "record header size");
+_Static_assert(JREC_SIZE(PACKED_SLOT_MAX) <= JOURNAL_SECTOR_PAYLOAD, "packed preset too large for a sector");
+_Static_assert(JREC_SIZE(SLOT_RECORD_SIZE) <= JOURNAL_SECTOR_PAYLOAD, "preset slot too large for a sector");
+_Static_assert(JREC_SIZE(COEFF_BOOT_RECORD_MAX) <= JOURNAL_SECTOR_PAYLOAD, "boot coefficients too large for a sector");
+_Static_assert(JOURNAL_SLOT_BUDGET >= 16 * JREC_SIZE(PACKED_SLOT_MAX), "preset store too small");
+_Static_assert(JOURNAL_SECTORS <= 32, "sector masks are 32-bit");
+_Static_assert(PRESET_SLOTS <= 255, "record keys are 8-bit");
+
 // ============================================================================
 // EXTERNAL VARIABLES (defined in usb_audio.c / dsp_pipeline.c)
 // ============================================================================
@@ -243,9 +485,6 @@ extern volatile bool leveller_reset_pending;
 extern MatrixMixer matrix_mixer;
 extern uint8_t output_pins[NUM_PIN_OUTPUTS];
 extern char channel_names[NUM_CHANNELS][PRESET_NAME_LEN];
-extern volatile uint32_t feedback_10_14;
-extern volatile uint32_t nominal_feedback_10_14;
-extern usb_feedback_ctrl_t fb_ctrl;
 
 // ============================================================================
 // MODULE STATE
@@ -259,20 +498,40 @@ volatile uint32_t preset_mute_counter = 0;
 static void apply_factory_defaults(void);
 
 // RAM-cached copy of the directory — updated on every directory write and
-// loaded once at boot.  Avoids repeated flash reads for queries.
-static PresetDirectory dir_cache;
+// loaded once at boot.  Avoids repeated flash reads for queries.  dir_flush()
+// diffs it against the newest journal records and appends what changed.
+static PresetDirCache dir_cache;
 static bool dir_cache_valid = false;
 
-// Flash mute hold time in samples (rate-aware).
-//
-// A fixed sample count shrinks in real time at higher rates (e.g. 96 kHz),
-// which can be too short to cover post-flash pipeline refill and envelope
-// transitions.  Keep the hold at roughly 10 ms across rates with a floor
-// that preserves existing behavior at 48 kHz.
-static inline uint32_t flash_mute_hold_samples(void) {
-    uint64_t samples = ((uint64_t)audio_state.freq * 10u + 999u) / 1000u;
-    if (samples < 512u) samples = 512u;
-    return (uint32_t)samples;
+// Journal state, rebuilt from flash by journal_mount().
+static bool     jrnl_mounted = false;
+static uint32_t jrnl_seq[JOURNAL_SECTORS];       // Claim sequence (0 = not a journal sector)
+static uint32_t jrnl_erases[JOURNAL_SECTORS];    // Erase count from the sector header
+static uint16_t jrnl_live[JOURNAL_SECTORS];      // Bytes of live records per sector
+static uint32_t jrnl_free_mask;                  // Sectors that may be claimed
+static uint32_t jrnl_reserved_mask;              // Fixed-layout sectors awaiting migration
+static uint8_t  jrnl_head = JOURNAL_NO_HEAD;     // Sector currently being appended to
+static uint32_t jrnl_head_off;                   // Next append offset within the head
+static uint32_t jrnl_next_seq;
+
+// Newest valid record per key, as a flash offset (0 = none)
+static uint32_t jidx_fields;
+static uint32_t jidx_name[PRESET_SLOTS];
+static uint32_t jidx_slot[PRESET_SLOTS];         // SLOT_PACKED, SLOT_DATA or SLOT_ERASED
+static uint32_t jidx_boot[COEFF_BOOT_PARTS];
+
+// Decoded-slot staging and packed-record staging (static to avoid large
+// stack allocs).  Main loop only.
+static PresetSlot slot_buf;
+static uint8_t    pack_buf[PACKED_SLOT_MAX];
+
+static inline bool slot_bit(const uint32_t *mask, uint8_t n) {
+    return (mask[n >> 5] >> (n & 31)) & 1u;
+}
+
+static inline void slot_bit_set(uint32_t *mask, uint8_t n, bool on) {
+    if (on) mask[n >> 5] |= (1u << (n & 31));
+    else    mask[n >> 5] &= ~(1u << (n & 31));
 }
 
 // ============================================================================
@@ -309,132 +568,489 @@ static float db_to_linear(float db) {
 // LOW-LEVEL FLASH HELPERS
 // ============================================================================
 
-// Erase one sector and write data into it.
-// `offset` is the byte offset from the start of flash (not XIP address).
-// `data` and `len` specify the payload; it is zero-padded up to page alignment.
-static int flash_write_sector(uint32_t offset, const void *data, size_t len) {
-    // Round up to page boundary
-    size_t write_size = (len + FLASH_PAGE_SIZE - 1) & ~(FLASH_PAGE_SIZE - 1);
-
-    // Use a page-aligned scratch buffer (static to avoid large stack allocs)
-    static uint8_t __attribute__((aligned(256))) write_buf[FLASH_SECTOR_SIZE];
-    memset(write_buf, 0xFF, sizeof(write_buf));
-    memcpy(write_buf, data, len);
-
-    // Park Core 1 in RAM before quiescing XIP for flash erase/program.
-    // Guarded: (a) victim_is_initialized handles first-boot (Core 1 not
-    // launched yet) and launch-to-init race; (b) __get_current_exception
-    // skips lockout in IRQ context (USB vendor handler) where SDK lock
-    // internals are unsafe — IRQ callers rely on copy_to_ram build for
-    // XIP safety (see CMakeLists.txt:38).
-    bool do_lockout = multicore_lockout_victim_is_initialized(1)
-                      && (__get_current_exception() == 0);
-    if (do_lockout) multicore_lockout_start_blocking();
-
-    uint32_t flags = save_and_disable_interrupts();
-    dspi_flash_range_erase(offset, FLASH_SECTOR_SIZE);
-    dspi_flash_range_program(offset, write_buf, write_size);
-    restore_interrupts(flags);
-
-    if (do_lockout) multicore_lockout_end_blocking();
-
-    // Re-seed USB feedback controller after ~45ms interrupt blackout
-    // (see preset_bugfix.md for details)
-    fb_ctrl_reset(&fb_ctrl, nominal_feedback_10_14 << 2);
-    feedback_10_14 = nominal_feedback_10_14;
-
-    // Re-arm mute to cover SPDIF consumer pool refill (~4-8ms)
-    preset_mute_counter = flash_mute_hold_samples();
-    preset_loading = true;
-
-    // Verify magic survived the write
-    const uint32_t *verify = (const uint32_t *)(XIP_BASE + offset);
-    const uint32_t *expected = (const uint32_t *)data;
-    if (*verify != *expected) {
-        return -1;  // Write verification failed
+#define FLASH_NO_ERASE  0xFFFFFFFFu
+
+// Run an optional sector erase followed by an optional program through the
+// background writer (flash_writer.h): audio keeps flowing, so no mute or
+// feedback re-seed is needed afterwards.  `erase_offset` is a byte offset
+// from the start of flash or FLASH_NO_ERASE; `len` is a multiple of
+// FLASH_PAGE_SIZE (0 = no program).  Callers verify by reading back, which
+// is safe because the writer has finished by the time this returns.
+static void flash_op(uint32_t erase_offset, uint32_t prog_offset,
+                     const uint8_t *data, size_t len) {
+    if (erase_offset != FLASH_NO_ERASE && flash_writer_erase_sector(erase_offset) != 0) return;
+    if (len) flash_writer_program(prog_offset, data, len);
+}
+
+// ============================================================================
+// JOURNAL
+// ============================================================================
+
+// Page-aligned staging buffer (static to avoid large stack allocs)
+static uint8_t __attribute__((aligned(256))) write_buf[FLASH_SECTOR_SIZE];
+
+static inline const JournalRecordHeader *jrec_at(uint32_t offset) {
+    return (const JournalRecordHeader *)(XIP_BASE + offset);
+}
+
+static inline uint8_t jsector_of(uint32_t offset) {
+    return (uint8_t)((offset - PRESET_BASE_OFFSET) / FLASH_SECTOR_SIZE);
+}
+
+static uint16_t jsector_check(const JournalSectorHeader *h) {
+    return (uint16_t)crc32((const uint8_t *)h, offsetof(JournalSectorHeader, check));
+}
+
+static bool jsector_valid(uint8_t s) {
+    const JournalSectorHeader *h = (const JournalSectorHeader *)(XIP_BASE + JOURNAL_SECTOR_OFFSET(s));
+    return h->magic == JOURNAL_MAGIC && h->version == JOURNAL_VERSION
+           && h->seq != 0 && h->check == jsector_check(h);
+}
+
+static bool jrec_erased(uint32_t offset) {
+    const uint32_t *w = (const uint32_t *)(XIP_BASE + offset);
+    return (w[0] & w[1] & w[2] & w[3]) == 0xFFFFFFFFu;
+}
+
+// Find the next record header at or after sector-relative `off`.  Returns
+// its offset, or 0 at the end of the log.  Sets *torn if the header is
+// unreadable (interrupted program) — nothing after it can be located.
+static uint32_t jscan_next(uint8_t s, uint32_t off, bool *torn) {
+    uint32_t base = JOURNAL_SECTOR_OFFSET(s);
+    while (off + sizeof(JournalRecordHeader) <= FLASH_SECTOR_SIZE) {
+        const JournalRecordHeader *h = jrec_at(base + off);
+        if (!jrec_erased(base + off)) {
+            if (h->hdr_crc == crc32((const uint8_t *)h, offsetof(JournalRecordHeader, hdr_crc))
+                && off + JREC_SIZE(h->len) <= FLASH_SECTOR_SIZE) {
+                return off;
+            }
+            *torn = true;
+            return 0;
+        }
+        // Erased header.  At a page start this is the end of the log;
+        // mid-page it is the tail a small record skipped (see journal_place).
+        if ((off & (FLASH_PAGE_SIZE - 1)) == 0) break;
+        off = (off + FLASH_PAGE_SIZE) & ~(FLASH_PAGE_SIZE - 1);
     }
     return 0;
 }
 
+// Index slot for a record, or NULL if the record is not one we keep
+// (unknown type, bad key or unexpected length).
+static uint32_t *jidx_entry(uint8_t type, uint8_t key, uint16_t len) {
+    switch (type) {
+        case JREC_DIR_FIELDS:
+            return (len == sizeof(JournalDirFields)) ? &jidx_fields : NULL;
+        case JREC_SLOT_NAME:
+            return (key < PRESET_SLOTS && len == PRESET_NAME_LEN) ? &jidx_name[key] : NULL;
+        case JREC_SLOT_DATA:
+            return (key < PRESET_SLOTS && len == SLOT_RECORD_SIZE) ? &jidx_slot[key] : NULL;
+        case JREC_SLOT_PACKED:
+            return (key < PRESET_SLOTS && len >= sizeof(PackedSlotHeader) && len <= PACKED_SLOT_MAX)
+                   ? &jidx_slot[key] : NULL;
+        case JREC_SLOT_ERASED:
+            return (key < PRESET_SLOTS && len == 0) ? &jidx_slot[key] : NULL;
+        case JREC_BOOT_COEFFS:
+            return (key < COEFF_BOOT_PARTS && len <= COEFF_BOOT_RECORD_MAX) ? &jidx_boot[key] : NULL;
+        default:
+            return NULL;
+    }
+}
+
+// Point an index slot at a new record, moving the live-byte accounting from
+// the superseded record's sector to the new one.
+static void jidx_point(uint32_t *entry, uint32_t offset) {
+    if (*entry) jrnl_live[jsector_of(*entry)] -= JREC_SIZE(jrec_at(*entry)->len);
+    *entry = offset;
+    jrnl_live[jsector_of(offset)] += JREC_SIZE(jrec_at(offset)->len);
+}
+
+// Rebuild the index and sector state from flash.  Sectors are replayed in
+// claim order, so the newest valid record for each key wins.
+static void journal_mount(void) {
+    if (jrnl_mounted) return;
+
+    memset(jrnl_seq, 0, sizeof(jrnl_seq));
+    memset(jrnl_erases, 0, sizeof(jrnl_erases));
+    memset(jrnl_live, 0, sizeof(jrnl_live));
+    jidx_fields = 0;
+    memset(jidx_name, 0, sizeof(jidx_name));
+    memset(jidx_slot, 0, sizeof(jidx_slot));
+    memset(jidx_boot, 0, sizeof(jidx_boot));
+    jrnl_free_mask = 0;
+    jrnl_head = JOURNAL_NO_HEAD;
+    jrnl_head_off = 0;
+    jrnl_next_seq = 1;
+
+    uint8_t order[JOURNAL_SECTORS];
+    int count = 0;
+    for (uint8_t s = 0; s < JOURNAL_SECTORS; s++) {
+        if (!jsector_valid(s)) {
+            jrnl_free_mask |= (1u << s);
+            continue;
+        }
+        const JournalSectorHeader *h = (const JournalSectorHeader *)(XIP_BASE + JOURNAL_SECTOR_OFFSET(s));
+        jrnl_seq[s] = h->seq;
+        jrnl_erases[s] = h->erase_count;
+        if (h->seq >= jrnl_next_seq) jrnl_next_seq = h->seq + 1;
+
+        int i = count++;
+        while (i > 0 && jrnl_seq[order[i - 1]] > h->seq) {
+            order[i] = order[i - 1];
+            i--;
+        }
+        order[i] = s;
+    }
+
+    for (int i = 0; i < count; i++) {
+        uint8_t s = order[i];
+        uint32_t base = JOURNAL_SECTOR_OFFSET(s);
+        uint32_t end = sizeof(JournalSectorHeader);
+        bool torn = false;
+        for (uint32_t off = jscan_next(s, end, &torn); off; off = jscan_next(s, end, &torn)) {
+            const JournalRecordHeader *h = jrec_at(base + off);
+            end = off + JREC_SIZE(h->len);
+            uint32_t *entry = jidx_entry(h->type, h->key, h->len);
+            if (entry && crc32((const uint8_t *)(h + 1), h->len) == h->data_crc) {
+                jidx_point(entry, base + off);
+            }
+        }
+        if (i == count - 1) {
+            jrnl_head = s;
+            jrnl_head_off = torn ? FLASH_SECTOR_SIZE : end;   // Never append past a torn header
+        }
+    }
+
+    // Journal sectors with nothing live left are reclaimable
+    for (uint8_t s = 0; s < JOURNAL_SECTORS; s++) {
+        if (jrnl_seq[s] && s != jrnl_head && jrnl_live[s] == 0) {
+            jrnl_free_mask |= (1u << s);
+        }
+    }
+
+    jrnl_mounted = true;
+}
+
+static int journal_free_sectors(void) {
+    return __builtin_popcount(jrnl_free_mask & ~jrnl_reserved_mask);
+}
+
+// Erase the least-worn free sector and make it the head.  A head holding
+// nothing live (e.g. only a torn record) may be re-claimed — during
+// migration it can be the only sector not reserved.
+static int journal_roll(void) {
+    uint32_t avail = jrnl_free_mask & ~jrnl_reserved_mask;
+    if (jrnl_head != JOURNAL_NO_HEAD && jrnl_live[jrnl_head] == 0) avail |= (1u << jrnl_head);
+    uint8_t pick = JOURNAL_NO_HEAD;
+    for (uint8_t s = 0; s < JOURNAL_SECTORS; s++) {
+        if (!(avail & (1u << s))) continue;
+        if (pick == JOURNAL_NO_HEAD || jrnl_erases[s] < jrnl_erases[pick]) pick = s;
+    }
+    if (pick == JOURNAL_NO_HEAD) return -1;
+
+    JournalSectorHeader h = {
+        .magic       = JOURNAL_MAGIC,
+        .seq         = jrnl_next_seq++,
+        .erase_count = jrnl_erases[pick] + 1,
+        .version     = JOURNAL_VERSION,
+    };
+    h.check = jsector_check(&h);
+
+    memset(write_buf, 0xFF, FLASH_PAGE_SIZE);
+    memcpy(write_buf, &h, sizeof(h));
+    uint32_t offset = JOURNAL_SECTOR_OFFSET(pick);
+    flash_op(offset, offset, write_buf, FLASH_PAGE_SIZE);
+
+    jrnl_free_mask &= ~(1u << pick);
+    jrnl_seq[pick] = h.seq;
+    jrnl_erases[pick] = h.erase_count;
+    jrnl_live[pick] = 0;
+    jrnl_head = pick;
+    jrnl_head_off = sizeof(h);
+
+    if (!jsector_valid(pick)) {
+        jrnl_head_off = FLASH_SECTOR_SIZE;  // Unusable; the next append rolls again
+        return -1;
+    }
+    return 0;
+}
+
+// Offset within the head for a record of `size` bytes, or 0 if it does not
+// fit.  Records up to a page never straddle a page boundary, so small
+// updates always cost exactly one page program.
+static uint32_t journal_place(uint32_t size) {
+    if (jrnl_head == JOURNAL_NO_HEAD) return 0;
+    uint32_t off = jrnl_head_off;
+    if (size <= FLASH_PAGE_SIZE && (off & (FLASH_PAGE_SIZE - 1)) + size > FLASH_PAGE_SIZE) {
+        off = (off + FLASH_PAGE_SIZE - 1) & ~(FLASH_PAGE_SIZE - 1);
+    }
+    return (off + size <= FLASH_SECTOR_SIZE) ? off : 0;
+}
+
+// Program one record at the head (rolling to a new head if needed) and
+// index it.  `payload` may point into flash — it is staged in RAM first.
+static int journal_write(uint8_t type, uint8_t key, const void *payload, uint16_t len) {
+    uint32_t size = JREC_SIZE(len);
+    uint32_t off = journal_place(size);
+    if (!off) {
+        if (journal_roll() != 0) return -1;
+        off = journal_place(size);
+        if (!off) return -1;
+    }
+
+    JournalRecordHeader h = {
+        .type     = type,
+        .key      = key,
+        .len      = len,
+        .data_crc = crc32((const uint8_t *)payload, len),
+        .reserved = 0xFFFFFFFFu,
+    };
+    h.hdr_crc = crc32((const uint8_t *)&h, offsetof(JournalRecordHeader, hdr_crc));
+
+    // Stage the touched pages.  Everything outside the record stays 0xFF,
+    // which programming leaves unchanged, so neighbouring records survive.
+    uint32_t offset = JOURNAL_SECTOR_OFFSET(jrnl_head) + off;
+    uint32_t first = offset & ~(FLASH_PAGE_SIZE - 1);
+    uint32_t last = (offset + size + FLASH_PAGE_SIZE - 1) & ~(FLASH_PAGE_SIZE - 1);
+    memset(write_buf, 0xFF, last - first);
+    memcpy(write_buf + (offset - first), &h, sizeof(h));
+    if (len) memcpy(write_buf + (offset - first) + sizeof(h), payload, len);
+    flash_op(FLASH_NO_ERASE, first, write_buf, last - first);
+    jrnl_head_off = off + size;
+
+    // Verify before indexing.  A bad header would stop replay of this
+    // sector, so nothing more may be appended after it.
+    const JournalRecordHeader *w = jrec_at(offset);
+    if (memcmp(w, &h, sizeof(h)) != 0) {
+        jrnl_head_off = FLASH_SECTOR_SIZE;
+        return -1;
+    }
+    if (crc32((const uint8_t *)(w + 1), len) != h.data_crc) return -1;
+
+    uint32_t *entry = jidx_entry(type, key, len);
+    if (entry) jidx_point(entry, offset);
+    return 0;
+}
+
+// Reclaim the sealed sector with the least live data: copy its live records
+// to the head and mark it free (it is erased when next claimed).
+//
+// If the records do not fit in the head, the copy rolls into a spare.  That
+// still gains space as long as the victim is less than a full sector, which
+// the cap on live data guarantees for the emptiest sealed sector (see
+// JOURNAL_LIVE_LIMIT).
+static int journal_gc(void) {
+    uint8_t victim = JOURNAL_NO_HEAD;
+    for (uint8_t s = 0; s < JOURNAL_SECTORS; s++) {
+        if (!jrnl_seq[s] || s == jrnl_head || (jrnl_free_mask & (1u << s))) continue;
+        if (victim == JOURNAL_NO_HEAD || jrnl_live[s] < jrnl_live[victim]) victim = s;
+    }
+    if (victim == JOURNAL_NO_HEAD) return -1;
+    if (jrnl_live[victim] > FLASH_SECTOR_SIZE - jrnl_head_off
+        && (journal_free_sectors() == 0 || jrnl_live[victim] >= JOURNAL_SECTOR_PAYLOAD)) {
+        return -1;
+    }
+
+    uint32_t base = JOURNAL_SECTOR_OFFSET(victim);
+    uint32_t end = sizeof(JournalSectorHeader);
+    bool torn = false;
+    for (uint32_t off = jscan_next(victim, end, &torn); off; off = jscan_next(victim, end, &torn)) {
+        const JournalRecordHeader *h = jrec_at(base + off);
+        end = off + JREC_SIZE(h->len);
+        uint32_t *entry = jidx_entry(h->type, h->key, h->len);
+        if (entry && *entry == base + off) {
+            if (journal_write(h->type, h->key, h + 1, h->len) != 0) return -1;
+        }
+    }
+
+    jrnl_free_mask |= (1u << victim);
+    return 0;
+}
+
+// Keep JOURNAL_SPARE_SECTORS free.  GC can run out of victims while
+// fixed-layout sectors are reserved for migration; it is retried on the
+// next append.  A pass that spilled into a spare frees no sector, so the
+// loop is bounded.
+static void journal_keep_spare(void) {
+    for (int i = 0; i < JOURNAL_SECTORS && journal_free_sectors() < JOURNAL_SPARE_SECTORS; i++) {
+        if (journal_gc() != 0) break;
+    }
+}
+
+// Append a record.  Returns 0 on success, -1 if the write failed.
+static int journal_append(uint8_t type, uint8_t key, const void *payload, uint16_t len) {
+    journal_mount();
+    journal_keep_spare();
+    if (journal_write(type, key, payload, len) != 0) return -1;
+    journal_keep_spare();
+    return 0;
+}
+
+static bool journal_slot_present(uint8_t slot) {
+    return jidx_slot[slot] && jrec_at(jidx_slot[slot])->type != JREC_SLOT_ERASED;
+}
+
+// Journal bytes held by preset data (tombstones count as metadata).
+static uint32_t journal_slot_bytes(void) {
+    uint32_t total = 0;
+    for (uint8_t n = 0; n < PRESET_SLOTS; n++) {
+        if (journal_slot_present(n)) total += JREC_SIZE(jrec_at(jidx_slot[n])->len);
+    }
+    return total;
+}
+
+// True if a `len`-byte preset record for `slot` fits the slot budget,
+// counting the record it replaces as freed.
+static bool journal_slot_fits(uint8_t slot, uint16_t len) {
+    uint32_t used = journal_slot_bytes();
+    if (journal_slot_present(slot)) used -= JREC_SIZE(jrec_at(jidx_slot[slot])->len);
+    return used + JREC_SIZE(len) <= JOURNAL_SLOT_BUDGET;
+}
+
 // ============================================================================
 // DIRECTORY MANAGEMENT
 // ============================================================================
 
-// Load the directory from flash into the RAM cache.
-// Returns true if a valid directory was found.  Transparently migrates a v1
-// directory to v2 on first boot of new firmware, preserving slot names,
-// startup config, and the old include_master_volume flag (which maps 1:1 to
-// master_volume_mode).  The independent master_volume_db defaults to
-// MASTER_VOL_MAX_DB so boot-time audible behavior is unchanged post-upgrade.
-static int dir_flush(void);  // forward decl — migration calls it
+static void dir_fields_pack(const PresetDirCache *d, JournalDirFields *f) {
+    memset(f, 0, sizeof(*f));
+    f->startup_mode       = d->startup_mode;
+    f->default_slot       = d->default_slot;
+    f->last_active_slot   = d->last_active_slot;
+    f->include_pins       = d->include_pins;
+    f->master_volume_mode = d->master_volume_mode;
+    f->latency_profile    = d->latency_profile;
+    f->rate_lock_hz100    = d->rate_lock_hz100;
+    f->master_volume_db   = d->master_volume_db;
+}
+
+// Newest journal name of a slot ("" if it never had one).
+static const char *journal_name(uint8_t slot) {
+    return jidx_name[slot] ? (const char *)(jrec_at(jidx_name[slot]) + 1) : "";
+}
+
+// Build a directory from the journal index.  Slot occupancy comes from the
+// newest slot record of each slot (data or tombstone).
+static void dir_from_journal(PresetDirCache *d) {
+    memset(d, 0, sizeof(*d));
+    if (jidx_fields) {
+        const JournalDirFields *f = (const JournalDirFields *)(jrec_at(jidx_fields) + 1);
+        d->startup_mode       = f->startup_mode;
+        d->default_slot       = f->default_slot;
+        d->last_active_slot   = f->last_active_slot;
+        d->include_pins       = f->include_pins;
+        d->master_volume_mode = f->master_volume_mode;
+        d->latency_profile    = f->latency_profile;
+        d->rate_lock_hz100    = f->rate_lock_hz100;
+        d->master_volume_db   = f->master_volume_db;
+    }
+    for (uint8_t n = 0; n < PRESET_SLOTS; n++) {
+        if (jidx_name[n]) {
+            memcpy(d->slot_names[n], journal_name(n), PRESET_NAME_LEN);
+            d->slot_names[n][PRESET_NAME_LEN - 1] = '\0';
+        }
+        slot_bit_set(d->slot_occupied, n, journal_slot_present(n));
+    }
+    d->slot_bytes = journal_slot_bytes();
+}
+
+// Load the directory from the journal into the RAM cache.
+// Returns true if the journal holds a directory (a DIR_FIELDS record).
 static bool dir_load_cache(void) {
-    const PresetDirectory *flash_dir = DIR_ADDR;
-    if (flash_dir->magic != DIR_MAGIC) {
+    journal_mount();
+    if (!jidx_fields) {
         dir_cache_valid = false;
         return false;
     }
+    dir_from_journal(&dir_cache);
+    dir_cache_valid = true;
+    return true;
+}
+
+// Write the RAM-cached directory back to flash.  Appends only what differs
+// from the newest journal records: a tombstone per deleted slot, a record
+// per renamed slot, and one DIR_FIELDS record if any setting changed.  Each
+// is a single page program.
+static int dir_flush(void) {
+    journal_mount();
+    int result = 0;
+
+    for (uint8_t n = 0; n < PRESET_SLOTS; n++) {
+        if (journal_slot_present(n) && !slot_bit(dir_cache.slot_occupied, n)) {
+            if (journal_append(JREC_SLOT_ERASED, n, NULL, 0) != 0) result = -1;
+        }
+        if (strncmp(dir_cache.slot_names[n], journal_name(n), PRESET_NAME_LEN) != 0) {
+            if (journal_append(JREC_SLOT_NAME, n, dir_cache.slot_names[n], PRESET_NAME_LEN) != 0) result = -1;
+        }
+    }
+
+    // Fields go last: a DIR_FIELDS record is what marks the journal
+    // directory complete, which migration relies on.
+    JournalDirFields cur;
+    dir_fields_pack(&dir_cache, &cur);
+    if (!jidx_fields || memcmp(&cur, jrec_at(jidx_fields) + 1, sizeof(cur)) != 0) {
+        if (journal_append(JREC_DIR_FIELDS, 0, &cur, sizeof(cur)) != 0) result = -1;
+    }
+
+    dir_cache.slot_bytes = journal_slot_bytes();
+    return result;
+}
+
+// Load a fixed-layout directory (sector 0) into the RAM cache for
+// migration.  A v1 directory is converted to v2 on the way, preserving slot
+// names, startup config, and the old include_master_volume flag (which maps
+// 1:1 to master_volume_mode).  The independent master_volume_db defaults to
+// MASTER_VOL_DEFAULT_DB.
+static void dir_load_fixed_slots(uint16_t occupied, const char (*names)[PRESET_NAME_LEN]) {
+    for (uint8_t n = 0; n < FIXED_SLOTS; n++) {
+        slot_bit_set(dir_cache.slot_occupied, n, (occupied >> n) & 1u);
+        memcpy(dir_cache.slot_names[n], names[n], PRESET_NAME_LEN);
+        dir_cache.slot_names[n][PRESET_NAME_LEN - 1] = '\0';
+    }
+}
+
+static bool dir_load_fixed(void) {
+    const PresetDirectory *flash_dir = DIR_ADDR;
+    if (flash_dir->magic != DIR_MAGIC) return false;
 
     if (flash_dir->version == DIR_VERSION_CURRENT) {
-        // Current format — CRC covers everything after the 12-byte header.
+        // CRC covers everything after the 12-byte header.
         const uint8_t *data_start = (const uint8_t *)&flash_dir->startup_mode;
         size_t data_len = sizeof(PresetDirectory) - offsetof(PresetDirectory, startup_mode);
-        if (crc32(data_start, data_len) != flash_dir->crc32) {
-            dir_cache_valid = false;
-            return false;
-        }
-        memcpy(&dir_cache, flash_dir, sizeof(dir_cache));
-        dir_cache_valid = true;
+        if (crc32(data_start, data_len) != flash_dir->crc32) return false;
+        memset(&dir_cache, 0, sizeof(dir_cache));
+        dir_cache.startup_mode       = flash_dir->startup_mode;
+        dir_cache.default_slot       = flash_dir->default_slot;
+        dir_cache.last_active_slot   = flash_dir->last_active_slot;
+        dir_cache.include_pins       = flash_dir->include_pins;
+        dir_cache.master_volume_mode = flash_dir->master_volume_mode;
+        dir_cache.latency_profile    = flash_dir->latency_profile;
+        dir_cache.master_volume_db   = flash_dir->master_volume_db;
+        dir_load_fixed_slots(flash_dir->slot_occupied, flash_dir->slot_names);
         return true;
     }
 
     if (flash_dir->version == 1) {
-        // Legacy v1 format — read with the old struct, validate old CRC,
-        // then migrate to v2 in memory and flush.
         const PresetDirectory_v1 *v1 = (const PresetDirectory_v1 *)flash_dir;
         const uint8_t *v1_data_start = (const uint8_t *)&v1->startup_mode;
         size_t v1_data_len = sizeof(PresetDirectory_v1) - offsetof(PresetDirectory_v1, startup_mode);
-        if (crc32(v1_data_start, v1_data_len) != v1->crc32) {
-            dir_cache_valid = false;
-            return false;
-        }
+        if (crc32(v1_data_start, v1_data_len) != v1->crc32) return false;
         memset(&dir_cache, 0, sizeof(dir_cache));
         dir_cache.startup_mode       = v1->startup_mode;
         dir_cache.default_slot       = v1->default_slot;
         dir_cache.last_active_slot   = v1->last_active_slot;
         dir_cache.include_pins       = v1->include_pins;
-        dir_cache.slot_occupied      = v1->slot_occupied;
         dir_cache.master_volume_mode = v1->include_master_volume
                                          ? MASTER_VOLUME_MODE_WITH_PRESET
                                          : MASTER_VOLUME_MODE_INDEPENDENT;
         dir_cache.master_volume_db   = MASTER_VOL_DEFAULT_DB;
-        memcpy(dir_cache.slot_names, v1->slot_names, sizeof(dir_cache.slot_names));
-        dir_cache_valid = true;
-        (void)dir_flush();  // persist as v2; if the flush fails, cache stays valid in RAM
+        dir_load_fixed_slots(v1->slot_occupied, v1->slot_names);
         return true;
     }
 
     // Unknown future version — treat as invalid.
-    dir_cache_valid = false;
     return false;
 }
 
-// Write the RAM-cached directory back to flash.
-// Recomputes the CRC before writing.
-static int dir_flush(void) {
-    dir_cache.magic = DIR_MAGIC;
-    dir_cache.version = DIR_VERSION_CURRENT;
-    dir_cache.reserved = 0;
-    // CRC covers everything after the 12-byte header (magic + version + reserved + crc32)
-    const uint8_t *data_start = (const uint8_t *)&dir_cache.startup_mode;
-    size_t data_len = sizeof(PresetDirectory) - offsetof(PresetDirectory, startup_mode);
-    dir_cache.crc32 = crc32(data_start, data_len);
-
-    if (flash_write_sector(DIR_SECTOR_OFFSET, &dir_cache, sizeof(dir_cache)) != 0) {
-        return -1;
-    }
-    return 0;
-}
-
 // Ensure the directory cache is populated.  If no directory exists on flash,
 // initialize a fresh one with factory-default settings.
 static void dir_ensure(void) {
@@ -449,8 +1065,8 @@ static void dir_ensure(void) {
     dir_cache.include_pins = 1;              // Include pins in preset load by default
     dir_cache.master_volume_mode = MASTER_VOLUME_MODE_INDEPENDENT;
     dir_cache.master_volume_db   = MASTER_VOL_DEFAULT_DB;
-    dir_cache.slot_occupied = 0;             // All slots empty
-    // Slot 0 gets a default name; others are empty (already zeroed by memset)
+    // All slots empty.  Slot 0 gets a default name; others are empty
+    // (already zeroed by memset)
     strncpy(dir_cache.slot_names[0], "Default", PRESET_NAME_LEN - 1);
     dir_cache_valid = true;
     // Don't flush yet — will be flushed on first preset save
@@ -500,9 +1116,10 @@ static void collect_live_state(PresetSlot *slot, uint8_t slot_index) {
     // Matrix mixer
     for (int in = 0; in < NUM_INPUT_CHANNELS; in++) {
         for (int out = 0; out < NUM_OUTPUT_CHANNELS; out++) {
-            slot->matrix_crosspoints[in][out].enabled = matrix_mixer.crosspoints[in][out].enabled;
-            slot->matrix_crosspoints[in][out].phase_invert = matrix_mixer.crosspoints[in][out].phase_invert;
-            slot->matrix_crosspoints[in][out].gain_db = matrix_mixer.crosspoints[in][out].gain_db;
+            FlashMatrixCrosspoint *xp = SLOT_XP(slot, in, out);
+            xp->enabled = matrix_mixer.crosspoints[in][out].enabled;
+            xp->phase_invert = matrix_mixer.crosspoints[in][out].phase_invert;
+            xp->gain_db = matrix_mixer.crosspoints[in][out].gain_db;
         }
     }
     for (int out = 0; out < NUM_OUTPUT_CHANNELS; out++) {
@@ -541,16 +1158,31 @@ static void collect_live_state(PresetSlot *slot, uint8_t slot_index) {
     slot->leveller_gate_threshold_db = leveller_config.gate_threshold_db;
 
     // Per-channel preamp + Master volume (V12)
-    for (int i = 0; i < NUM_INPUT_CHANNELS; i++)
+    for (int i = 0; i < NUM_MASTER_INPUTS; i++)
         slot->preamp_db_per_ch[i] = global_preamp_db[i];
     slot->master_volume_db = master_volume_db;
+#if ENABLE_MC_INPUT
+    for (int i = NUM_MASTER_INPUTS; i < NUM_INPUT_CHANNELS; i++)
+        slot->aux_preamp_db[i - NUM_MASTER_INPUTS] = global_preamp_db[i];
+#endif
 
     // Compute CRC over the data section (everything after the 12-byte header)
     const uint8_t *data_start = (const uint8_t *)&slot->filter_recipes;
-    size_t data_len = sizeof(PresetSlot) - offsetof(PresetSlot, filter_recipes);
+    size_t data_len = SLOT_RECORD_SIZE - offsetof(PresetSlot, filter_recipes);
     slot->crc32 = crc32(data_start, data_len);
 }
 
+#if PICO_RP2350
+static const uint8_t default_output_pins[NUM_PIN_OUTPUTS] = {
+    PICO_AUDIO_SPDIF_PIN, PICO_SPDIF_PIN_2,
+    PICO_SPDIF_PIN_3, PICO_SPDIF_PIN_4, PICO_PDM_PIN
+};
+#else
+static const uint8_t default_output_pins[NUM_PIN_OUTPUTS] = {
+    PICO_AUDIO_SPDIF_PIN, PICO_SPDIF_PIN_2, PICO_PDM_PIN
+};
+#endif
+
 // Apply a dB value to the live master volume globals, clamped and with
 // NaN/Inf defended.  Shared between mode-0 (directory) and mode-1 (preset)
 // apply paths.  Uses powf() because db_to_linear() clamps at -60 dB and the
@@ -577,15 +1209,26 @@ static void apply_master_volume_db(float db) {
 //     Falls back to the directory value for older slots so we never leave
 //     the live globals at a stale value from a previous load.
 // `slot_or_null` may be NULL (e.g. factory-defaults path with no slot).
-static void apply_master_volume_from_mode(const PresetSlot *slot_or_null) {
-    float db;
+static float master_volume_db_for(const PresetSlot *slot_or_null) {
     if (dir_cache.master_volume_mode == MASTER_VOLUME_MODE_WITH_PRESET
         && slot_or_null && slot_or_null->version >= 12) {
-        db = slot_or_null->master_volume_db;
-    } else {
-        db = dir_cache.master_volume_db;
+        return slot_or_null->master_volume_db;
+    }
+    return dir_cache.master_volume_db;
+}
+
+static void apply_master_volume_from_mode(const PresetSlot *slot_or_null) {
+    apply_master_volume_db(master_volume_db_for(slot_or_null));
+}
+
+// Decoded I2S MCK multiplier of a V9+ slot.
+static uint16_t slot_mck_multiplier(const PresetSlot *slot) {
+    if (slot->version >= 11) {
+        // V11+: 0=128x, 1=256x
+        return (slot->i2s_mck_multiplier == 1) ? 256 : 128;
     }
-    apply_master_volume_db(db);
+    // V9-V10: raw value stored (128 or 0 for 256)
+    return (slot->i2s_mck_multiplier == 0) ? 256 : slot->i2s_mck_multiplier;
 }
 
 // Apply a validated PresetSlot to the live DSP state.
@@ -599,21 +1242,12 @@ static void apply_slot_to_live(const PresetSlot *slot, bool include_pins) {
     memcpy((void *)filter_recipes, slot->filter_recipes, sizeof(filter_recipes));
 
     // Preamp — V12+ has per-channel values, older versions use single legacy field
-    if (slot->version >= 12) {
-        for (int i = 0; i < NUM_INPUT_CHANNELS; i++) {
-            global_preamp_db[i] = slot->preamp_db_per_ch[i];
-            float linear = db_to_linear(slot->preamp_db_per_ch[i]);
-            global_preamp_mul[i] = (int32_t)(linear * (float)(1 << 28));
-            global_preamp_linear[i] = linear;
-        }
-    } else {
-        // Legacy: apply single preamp_db to all channels
-        for (int i = 0; i < NUM_INPUT_CHANNELS; i++) {
-            global_preamp_db[i] = slot->preamp_db;
-            float linear = db_to_linear(slot->preamp_db);
-            global_preamp_mul[i] = (int32_t)(linear * (float)(1 << 28));
-            global_preamp_linear[i] = linear;
-        }
+    for (int i = 0; i < NUM_INPUT_CHANNELS; i++) {
+        float db = slot_preamp_db(slot, i);
+        float linear = db_to_linear(db);
+        global_preamp_db[i] = db;
+        global_preamp_mul[i] = (int32_t)(linear * (float)(1 << 28));
+        global_preamp_linear[i] = linear;
     }
 
     // Bypass
@@ -647,10 +1281,11 @@ static void apply_slot_to_live(const PresetSlot *slot, bool include_pins) {
     // Matrix mixer
     for (int in = 0; in < NUM_INPUT_CHANNELS; in++) {
         for (int out = 0; out < NUM_OUTPUT_CHANNELS; out++) {
-            matrix_mixer.crosspoints[in][out].enabled = slot->matrix_crosspoints[in][out].enabled;
-            matrix_mixer.crosspoints[in][out].phase_invert = slot->matrix_crosspoints[in][out].phase_invert;
-            matrix_mixer.crosspoints[in][out].gain_db = slot->matrix_crosspoints[in][out].gain_db;
-            matrix_mixer.crosspoints[in][out].gain_linear = db_to_linear(slot->matrix_crosspoints[in][out].gain_db);
+            const FlashMatrixCrosspoint *xp = SLOT_XP(slot, in, out);
+            matrix_mixer.crosspoints[in][out].enabled = xp->enabled;
+            matrix_mixer.crosspoints[in][out].phase_invert = xp->phase_invert;
+            matrix_mixer.crosspoints[in][out].gain_db = xp->gain_db;
+            matrix_mixer.crosspoints[in][out].gain_linear = db_to_linear(xp->gain_db);
         }
     }
     for (int out = 0; out < NUM_OUTPUT_CHANNELS; out++) {
@@ -664,23 +1299,13 @@ static void apply_slot_to_live(const PresetSlot *slot, bool include_pins) {
 
     // Pin configuration (conditional)
     if (include_pins) {
-#if PICO_RP2350
-        static const uint8_t default_pins[NUM_PIN_OUTPUTS] = {
-            PICO_AUDIO_SPDIF_PIN, PICO_SPDIF_PIN_2,
-            PICO_SPDIF_PIN_3, PICO_SPDIF_PIN_4, PICO_PDM_PIN
-        };
-#else
-        static const uint8_t default_pins[NUM_PIN_OUTPUTS] = {
-            PICO_AUDIO_SPDIF_PIN, PICO_SPDIF_PIN_2, PICO_PDM_PIN
-        };
-#endif
         for (int i = 0; i < NUM_PIN_OUTPUTS; i++) {
             uint8_t pin = slot->output_pins[i];
             bool valid = (pin <= 29) && (pin != 12) && !(pin >= 23 && pin <= 25);
 #if !PICO_RP2350
             if (pin > 28) valid = false;
 #endif
-            output_pins[i] = valid ? pin : default_pins[i];
+            output_pins[i] = valid ? pin : default_output_pins[i];
         }
     }
 
@@ -704,13 +1329,7 @@ static void apply_slot_to_live(const PresetSlot *slot, bool include_pins) {
             i2s_bck_pin = slot->i2s_bck_pin;
             i2s_mck_pin = slot->i2s_mck_pin;
             i2s_mck_enabled = (slot->i2s_mck_enabled != 0);
-            if (slot->version >= 11) {
-                // V11+: 0=128x, 1=256x
-                i2s_mck_multiplier = (slot->i2s_mck_multiplier == 1) ? 256 : 128;
-            } else {
-                // V9-V10: raw value stored (128 or 0 for 256)
-                i2s_mck_multiplier = (slot->i2s_mck_multiplier == 0) ? 256 : slot->i2s_mck_multiplier;
-            }
+            i2s_mck_multiplier = slot_mck_multiplier(slot);
         } else {
             // Default: all S/PDIF, no I2S/MCK
             memset(output_types, 0, NUM_SPDIF_INSTANCES);
@@ -741,21 +1360,771 @@ static void apply_slot_to_live(const PresetSlot *slot, bool include_pins) {
     leveller_reset_pending = true;
 }
 
+// ============================================================================
+// COMPACT SLOT ENCODING (SLOT_PACKED)
+// ============================================================================
+//
+// Bands, crosspoints, outputs and channel names are written only where they
+// differ from a neutral entry, delays only if any is non-zero, and the
+// loudness / crossfeed / leveller sections only if they differ from their
+// defaults.  Levels and hardware are small and always written.  Decoding
+// fills anything absent from the values below, so for PACKED_FORMAT 1 they
+// must not change — a new default needs a new format or section tag.
+
+static const EqParamPacket neutral_band = {
+    .type = FILTER_FLAT, .freq = 1000.0f, .Q = 0.707f, .gain_db = 0.0f,
+};
+
+static const PackedLoudness default_loudness = {
+    .enabled = 0, .ref_spl = 83.0f, .intensity_pct = 100.0f,
+};
+
+static const PackedCrossfeed default_crossfeed = {
+    .enabled = 0, .preset = CROSSFEED_PRESET_DEFAULT, .itd_enabled = 1,
+    .custom_fc = 700.0f, .custom_feed_db = 4.5f,
+};
+
+static const PackedLeveller default_leveller = {
+    .enabled = 0, .speed = LEVELLER_SPEED_SLOW, .lookahead = 1,
+    .amount = 50.0f, .max_gain_db = 15.0f, .gate_threshold_db = -96.0f,
+};
+
+static const float no_delays[NUM_CHANNELS];
+
+static bool band_is_neutral(const EqParamPacket *p) {
+    return p->type == neutral_band.type && p->freq == neutral_band.freq
+        && p->Q == neutral_band.Q && p->gain_db == neutral_band.gain_db;
+}
+
+// --- Section <-> PresetSlot field mapping ---
+
+static void levels_pack(const PresetSlot *s, PackedLevels *l) {
+    memset(l, 0, sizeof(*l));
+    l->preamp_db = s->preamp_db;
+    memcpy(l->preamp_db_per_ch, s->preamp_db_per_ch, sizeof(l->preamp_db_per_ch));
+    l->master_volume_db = s->master_volume_db;
+    memcpy(l->channel_gain_db, s->channel_gain_db, sizeof(l->channel_gain_db));
+    memcpy(l->channel_mute, s->channel_mute, sizeof(l->channel_mute));
+    l->bypass = s->bypass;
+}
+
+static void levels_unpack(PresetSlot *s, const PackedLevels *l) {
+    s->preamp_db = l->preamp_db;
+    memcpy(s->preamp_db_per_ch, l->preamp_db_per_ch, sizeof(s->preamp_db_per_ch));
+    s->master_volume_db = l->master_volume_db;
+    memcpy(s->channel_gain_db, l->channel_gain_db, sizeof(s->channel_gain_db));
+    memcpy(s->channel_mute, l->channel_mute, sizeof(s->channel_mute));
+    s->bypass = l->bypass;
+}
+
+static void loudness_pack(const PresetSlot *s, PackedLoudness *l) {
+    memset(l, 0, sizeof(*l));
+    l->enabled = s->loudness_enabled;
+    l->ref_spl = s->loudness_ref_spl;
+    l->intensity_pct = s->loudness_intensity_pct;
+}
+
+static void loudness_unpack(PresetSlot *s, const PackedLoudness *l) {
+    s->loudness_enabled = l->enabled;
+    s->loudness_ref_spl = l->ref_spl;
+    s->loudness_intensity_pct = l->intensity_pct;
+}
+
+static void crossfeed_pack(const PresetSlot *s, PackedCrossfeed *c) {
+    memset(c, 0, sizeof(*c));
+    c->enabled = s->crossfeed_enabled;
+    c->preset = s->crossfeed_preset;
+    c->itd_enabled = s->crossfeed_itd_enabled;
+    c->custom_fc = s->crossfeed_custom_fc;
+    c->custom_feed_db = s->crossfeed_custom_feed_db;
+}
+
+static void crossfeed_unpack(PresetSlot *s, const PackedCrossfeed *c) {
+    s->crossfeed_enabled = c->enabled;
+    s->crossfeed_preset = c->preset;
+    s->crossfeed_itd_enabled = c->itd_enabled;
+    s->crossfeed_custom_fc = c->custom_fc;
+    s->crossfeed_custom_feed_db = c->custom_feed_db;
+}
+
+static void leveller_pack(const PresetSlot *s, PackedLeveller *l) {
+    memset(l, 0, sizeof(*l));
+    l->enabled = s->leveller_enabled;
+    l->speed = s->leveller_speed;
+    l->lookahead = s->leveller_lookahead;
+    l->amount = s->leveller_amount;
+    l->max_gain_db = s->leveller_max_gain_db;
+    l->gate_threshold_db = s->leveller_gate_threshold_db;
+}
+
+static void leveller_unpack(PresetSlot *s, const PackedLeveller *l) {
+    s->leveller_enabled = l->enabled;
+    s->leveller_speed = l->speed;
+    s->leveller_lookahead = l->lookahead;
+    s->leveller_amount = l->amount;
+    s->leveller_max_gain_db = l->max_gain_db;
+    s->leveller_gate_threshold_db = l->gate_threshold_db;
+}
+
+static void hardware_pack(const PresetSlot *s, PackedHardware *h) {
+    memset(h, 0, sizeof(*h));
+    memcpy(h->output_pins, s->output_pins, NUM_PIN_OUTPUTS);
+    memcpy(h->output_types, s->output_types, sizeof(h->output_types));
+    h->i2s_bck_pin = s->i2s_bck_pin;
+    h->i2s_mck_pin = s->i2s_mck_pin;
+    h->i2s_mck_enabled = s->i2s_mck_enabled;
+    h->i2s_mck_multiplier = s->i2s_mck_multiplier;
+}
+
+static void hardware_unpack(PresetSlot *s, const PackedHardware *h) {
+    memcpy(s->output_pins, h->output_pins, NUM_PIN_OUTPUTS);
+    memcpy(s->output_types, h->output_types, sizeof(s->output_types));
+    s->i2s_bck_pin = h->i2s_bck_pin;
+    s->i2s_mck_pin = h->i2s_mck_pin;
+    s->i2s_mck_enabled = h->i2s_mck_enabled;
+    s->i2s_mck_multiplier = h->i2s_mck_multiplier;
+}
+
+// The state a SLOT_PACKED record is decoded on top of.
+static void slot_baseline(PresetSlot *s, uint8_t slot, uint8_t version) {
+    memset(s, 0, sizeof(*s));
+    s->magic = SLOT_MAGIC;
+    s->version = version;
+    s->slot_index = slot;
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        for (int b = 0; b < MAX_BANDS; b++) s->filter_recipes[ch][b] = neutral_band;
+        get_default_channel_name(ch, s->channel_names[ch]);
+    }
+    loudness_unpack(s, &default_loudness);
+    crossfeed_unpack(s, &default_crossfeed);
+    leveller_unpack(s, &default_leveller);
+    memcpy(s->output_pins, default_output_pins, NUM_PIN_OUTPUTS);
+    s->i2s_bck_pin = PICO_I2S_BCK_PIN;
+    s->i2s_mck_pin = PICO_I2S_MCK_PIN;
+}
+
+// --- Encoder ---
+
+typedef struct {
+    uint8_t *buf;
+    uint16_t len;
+    uint16_t sec;                            // Offset of the open section header
+} PackWriter;
+
+static void pw_open(PackWriter *w, uint8_t tag) {
+    PackedSection h = { .tag = tag };
+    w->sec = w->len;
+    memcpy(w->buf + w->len, &h, sizeof(h));
+    w->len += sizeof(h);
+}
+
+static void pw_put(PackWriter *w, const void *data, uint16_t len) {
+    memcpy(w->buf + w->len, data, len);
+    w->len += len;
+}
+
+// Close the open section.  An empty section is dropped.
+static void pw_close(PackWriter *w) {
+    uint16_t body = w->len - w->sec - sizeof(PackedSection);
+    if (body == 0) {
+        w->len = w->sec;
+        return;
+    }
+    memcpy(w->buf + w->sec + offsetof(PackedSection, len), &body, sizeof(body));
+}
+
+// Fixed-size section, skipped if it equals `def` (NULL = always written).
+static void pw_section(PackWriter *w, uint8_t tag, const void *body, const void *def, uint16_t len) {
+    if (def && memcmp(body, def, len) == 0) return;
+    pw_open(w, tag);
+    pw_put(w, body, len);
+    pw_close(w);
+}
+
+// Encode a slot into `out` (PACKED_SLOT_MAX bytes).  Returns the length.
+static uint16_t slot_pack(const PresetSlot *s, uint8_t slot, uint8_t *out) {
+    PackWriter w = { .buf = out };
+    PackedSlotHeader hdr = {
+        .format       = PACKED_FORMAT,
+        .slot_version = (uint8_t)s->version,
+        .slot_index   = slot,
+    };
+    pw_put(&w, &hdr, sizeof(hdr));
+
+    pw_open(&w, PSEC_BANDS);
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        for (int b = 0; b < MAX_BANDS; b++) {
+            EqParamPacket p = s->filter_recipes[ch][b];
+            if (band_is_neutral(&p)) continue;
+            p.channel = (uint8_t)ch;
+            p.band = (uint8_t)b;
+            pw_put(&w, &p, sizeof(p));
+        }
+    }
+    pw_close(&w);
+
+    PackedLevels lv;
+    levels_pack(s, &lv);
+    pw_section(&w, PSEC_LEVELS, &lv, NULL, sizeof(lv));
+    pw_section(&w, PSEC_DELAYS, s->delays_ms, no_delays, sizeof(no_delays));
+
+    PackedLoudness ld;
+    loudness_pack(s, &ld);
+    pw_section(&w, PSEC_LOUDNESS, &ld, &default_loudness, sizeof(ld));
+    PackedCrossfeed cf;
+    crossfeed_pack(s, &cf);
+    pw_section(&w, PSEC_CROSSFEED, &cf, &default_crossfeed, sizeof(cf));
+    PackedLeveller lev;
+    leveller_pack(s, &lev);
+    pw_section(&w, PSEC_LEVELLER, &lev, &default_leveller, sizeof(lev));
+    PackedHardware hw;
+    hardware_pack(s, &hw);
+    pw_section(&w, PSEC_HARDWARE, &hw, NULL, sizeof(hw));
+
+    pw_open(&w, PSEC_ROUTES);
+    for (int in = 0; in < NUM_INPUT_CHANNELS; in++) {
+        for (int out = 0; out < NUM_OUTPUT_CHANNELS; out++) {
+            const FlashMatrixCrosspoint *xp = SLOT_XP(s, in, out);
+            PackedRoute r = {
+                .in           = (uint8_t)in,
+                .out          = (uint8_t)out,
+                .enabled      = xp->enabled,
+                .phase_invert = xp->phase_invert,
+                .gain_db      = xp->gain_db,
+            };
+            if (!r.enabled && !r.phase_invert && r.gain_db == 0.0f) continue;
+            pw_put(&w, &r, sizeof(r));
+        }
+    }
+    pw_close(&w);
+#if ENABLE_MC_INPUT
+    static const float no_aux_preamp[NUM_INPUT_CHANNELS - NUM_MASTER_INPUTS];
+    pw_section(&w, PSEC_AUX_PREAMP, s->aux_preamp_db, no_aux_preamp, sizeof(no_aux_preamp));
+#endif
+
+    pw_open(&w, PSEC_OUTPUTS);
+    for (int out = 0; out < NUM_OUTPUT_CHANNELS; out++) {
+        PackedOutput o = {
+            .out      = (uint8_t)out,
+            .enabled  = s->matrix_outputs[out].enabled,
+            .mute     = s->matrix_outputs[out].mute,
+            .gain_db  = s->matrix_outputs[out].gain_db,
+            .delay_ms = s->matrix_outputs[out].delay_ms,
+        };
+        if (!o.enabled && !o.mute && o.gain_db == 0.0f && o.delay_ms == 0.0f) continue;
+        pw_put(&w, &o, sizeof(o));
+    }
+    pw_close(&w);
+
+    pw_open(&w, PSEC_NAMES);
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        char def[PRESET_NAME_LEN];
+        get_default_channel_name(ch, def);
+        if (strncmp(s->channel_names[ch], def, PRESET_NAME_LEN) == 0) continue;
+        uint8_t entry[2] = { (uint8_t)ch, (uint8_t)strnlen(s->channel_names[ch], PRESET_NAME_LEN - 1) };
+        pw_put(&w, entry, sizeof(entry));
+        pw_put(&w, s->channel_names[ch], entry[1]);
+    }
+    pw_close(&w);
+
+    return w.len;
+}
+
+// --- Decoder ---
+
+// Decode a SLOT_PACKED payload into `s`.  Returns false if the record is
+// not for `slot`, has an unknown format, or a section overruns the payload.
+static bool slot_unpack(const uint8_t *data, uint16_t len, uint8_t slot, PresetSlot *s) {
+    PackedSlotHeader hdr;
+    if (len < sizeof(hdr)) return false;
+    memcpy(&hdr, data, sizeof(hdr));
+    if (hdr.format != PACKED_FORMAT || hdr.slot_index != slot) return false;
+    slot_baseline(s, slot, hdr.slot_version);
+
+    uint16_t pos = sizeof(hdr);
+    while (pos < len) {
+        PackedSection sec;
+        if (len - pos < sizeof(sec)) return false;
+        memcpy(&sec, data + pos, sizeof(sec));
+        pos += sizeof(sec);
+        if (sec.len > len - pos) return false;
+        const uint8_t *body = data + pos;
+        pos += sec.len;
+
+        // Fixed-size sections may grow in later firmware: read the prefix
+        switch (sec.tag) {
+            case PSEC_BANDS:
+                for (uint16_t i = 0; i + sizeof(EqParamPacket) <= sec.len; i += sizeof(EqParamPacket)) {
+                    EqParamPacket p;
+                    memcpy(&p, body + i, sizeof(p));
+                    if (p.channel < NUM_CHANNELS && p.band < MAX_BANDS)
+                        s->filter_recipes[p.channel][p.band] = p;
+                }
+                break;
+            case PSEC_LEVELS:
+                if (sec.len >= sizeof(PackedLevels)) {
+                    PackedLevels lv;
+                    memcpy(&lv, body, sizeof(lv));
+                    levels_unpack(s, &lv);
+                }
+                break;
+            case PSEC_DELAYS:
+                if (sec.len >= sizeof(s->delays_ms)) memcpy(s->delays_ms, body, sizeof(s->delays_ms));
+                break;
+            case PSEC_LOUDNESS:
+                if (sec.len >= sizeof(PackedLoudness)) {
+                    PackedLoudness ld;
+                    memcpy(&ld, body, sizeof(ld));
+                    loudness_unpack(s, &ld);
+                }
+                break;
+            case PSEC_CROSSFEED:
+                if (sec.len >= sizeof(PackedCrossfeed)) {
+                    PackedCrossfeed cf;
+                    memcpy(&cf, body, sizeof(cf));
+                    crossfeed_unpack(s, &cf);
+                }
+                break;
+            case PSEC_LEVELLER:
+                if (sec.len >= sizeof(PackedLeveller)) {
+                    PackedLeveller lev;
+                    memcpy(&lev, body, sizeof(lev));
+                    leveller_unpack(s, &lev);
+                }
+                break;
+            case PSEC_HARDWARE:
+                if (sec.len >= sizeof(PackedHardware)) {
+                    PackedHardware hw;
+                    memcpy(&hw, body, sizeof(hw));
+                    hardware_unpack(s, &hw);
+                }
+                break;
+            case PSEC_ROUTES:
+                for (uint16_t i = 0; i + sizeof(PackedRoute) <= sec.len; i += sizeof(PackedRoute)) {
+                    PackedRoute r;
+                    memcpy(&r, body + i, sizeof(r));
+                    if (r.in >= NUM_INPUT_CHANNELS || r.out >= NUM_OUTPUT_CHANNELS) continue;
+                    FlashMatrixCrosspoint *xp = SLOT_XP(s, r.in, r.out);
+                    xp->enabled = r.enabled;
+                    xp->phase_invert = r.phase_invert;
+                    xp->gain_db = r.gain_db;
+                }
+                break;
+#if ENABLE_MC_INPUT
+            case PSEC_AUX_PREAMP:
+                memcpy(s->aux_preamp_db, body,
+                       sec.len < sizeof(s->aux_preamp_db) ? sec.len : sizeof(s->aux_preamp_db));
+                break;
+#endif
+            case PSEC_OUTPUTS:
+                for (uint16_t i = 0; i + sizeof(PackedOutput) <= sec.len; i += sizeof(PackedOutput)) {
+                    PackedOutput o;
+                    memcpy(&o, body + i, sizeof(o));
+                    if (o.out >= NUM_OUTPUT_CHANNELS) continue;
+                    s->matrix_outputs[o.out].enabled = o.enabled;
+                    s->matrix_outputs[o.out].mute = o.mute;
+                    s->matrix_outputs[o.out].gain_db = o.gain_db;
+                    s->matrix_outputs[o.out].delay_ms = o.delay_ms;
+                }
+                break;
+            case PSEC_NAMES:
+                for (uint16_t i = 0; i + 2 <= sec.len; ) {
+                    uint8_t ch = body[i], n = body[i + 1];
+                    i += 2;
+                    if (n > sec.len - i) return false;
+                    if (ch < NUM_CHANNELS && n < PRESET_NAME_LEN) {
+                        memset(s->channel_names[ch], 0, PRESET_NAME_LEN);
+                        memcpy(s->channel_names[ch], body + i, n);
+                    }
+                    i += n;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
 // ============================================================================
 // SLOT VALIDATION
 // ============================================================================
 
-// Read and validate a preset slot from flash.
-// Returns a pointer to the flash-mapped slot if valid, NULL otherwise.
-static const PresetSlot *validate_slot(uint8_t slot) {
-    const PresetSlot *s = SLOT_ADDR(slot);
-    if (s->magic != SLOT_MAGIC) return NULL;
-    if (s->slot_index != slot) return NULL;
+// Check a mapped PresetSlot's header and CRC.
+static bool slot_intact(const PresetSlot *s, uint8_t slot) {
+    if (s->magic != SLOT_MAGIC) return false;
+    if (s->slot_index != slot) return false;
     // CRC check
     const uint8_t *data_start = (const uint8_t *)&s->filter_recipes;
-    size_t data_len = sizeof(PresetSlot) - offsetof(PresetSlot, filter_recipes);
-    if (crc32(data_start, data_len) != s->crc32) return NULL;
-    return s;
+    size_t data_len = SLOT_RECORD_SIZE - offsetof(PresetSlot, filter_recipes);
+    return crc32(data_start, data_len) == s->crc32;
+}
+
+// A full-layout record is used in place, unless the slot has a RAM-only
+// tail: then it is copied into slot_buf with the multichannel inputs at
+// 0 dB and unrouted.
+static const PresetSlot *slot_from_record(const PresetSlot *rec) {
+#if ENABLE_MC_INPUT
+    memcpy(&slot_buf, rec, SLOT_RECORD_SIZE);
+    memset((uint8_t *)&slot_buf + SLOT_RECORD_SIZE, 0, sizeof(slot_buf) - SLOT_RECORD_SIZE);
+    return &slot_buf;
+#else
+    return rec;
+#endif
+}
+
+// Read and validate a preset slot from the journal.  A packed record is
+// CRC-checked and decoded into slot_buf; a full SLOT_DATA record from older
+// firmware goes through slot_from_record().  Returns the slot if valid,
+// NULL otherwise.
+static const PresetSlot *validate_slot(uint8_t slot) {
+    journal_mount();
+    if (!journal_slot_present(slot)) return NULL;
+    const JournalRecordHeader *h = jrec_at(jidx_slot[slot]);
+    if (h->type == JREC_SLOT_DATA) {
+        const PresetSlot *s = (const PresetSlot *)(h + 1);
+        return slot_intact(s, slot) ? slot_from_record(s) : NULL;
+    }
+    const uint8_t *data = (const uint8_t *)(h + 1);
+    if (crc32(data, h->len) != h->data_crc) return NULL;
+    return slot_unpack(data, h->len, slot, &slot_buf) ? &slot_buf : NULL;
+}
+
+// Rewrite a slot held as a full SLOT_DATA record in the packed encoding.
+static void journal_repack_slot(uint8_t slot, const PresetSlot *s) {
+    uint16_t len = slot_pack(s, slot, pack_buf);
+    journal_append(JREC_SLOT_PACKED, slot, pack_buf, len);
+}
+
+// Same, for a slot in the fixed pre-journal layout (migration only).
+static const PresetSlot *validate_fixed_slot(uint8_t slot) {
+    const PresetSlot *s = SLOT_ADDR(slot);
+    return slot_intact(s, slot) ? slot_from_record(s) : NULL;
+}
+
+// Zero all delay line buffers.  Without this, stale audio from the
+// previous preset's delay lines bleeds through — e.g. switching from
+// a 40ms delay to 0ms would replay ~40ms of old audio as the write
+// index wraps past the old data.
+static void clear_delay_lines(void) {
+    extern
+#if PICO_RP2350
+    float delay_lines[NUM_DELAY_CHANNELS][MAX_DELAY_SAMPLES];
+#else
+    int32_t delay_lines[NUM_DELAY_CHANNELS][MAX_DELAY_SAMPLES];
+#endif
+    memset(delay_lines, 0, sizeof(delay_lines));
+}
+
+// ============================================================================
+// PRESET RAM CACHE
+// ============================================================================
+//
+// Up to CACHE_ENTRIES slots are held decoded in RAM (filled in slot order
+// after boot, replaced on save and load), together with their EQ
+// coefficients for the current sample rate.  Once all entries are used, a
+// save or full load evicts the least recently used one.  Switching to a cached preset is then a RAM copy plus a
+// coefficient install — no flash read, no CRC, no filter design and no
+// output pipeline reset.
+//
+// Coefficients are stored compactly: only bands that are not bypassed,
+// packed in (channel, band) order into one shared pool.  The pool is rebuilt
+// in the background, one channel per preset_cache_service() call, whenever a
+// slot or the sample rate changes.  A slot that does not fit stays on the
+// full preset_load() path.
+
+#define CACHE_ENTRIES       4       // One PresetSlot each (3.3 KB on RP2350, 1.8 KB on RP2040)
+#define CACHE_POOL_BANDS    64      // 96 B each on RP2350, 36 B on RP2040
+
+_Static_assert(CACHE_ENTRIES <= 16, "cache masks are 16-bit");
+
+typedef struct {
+    uint8_t ch;
+    uint8_t band;
+    Biquad  bq;                     // Coefficient fields only; state zeroed
+} CachedBand;
+
+static PresetSlot cache_slots[CACHE_ENTRIES];
+static uint8_t    cache_entry_slot[CACHE_ENTRIES];   // Slot held by each entry
+static uint8_t    cache_slot_entry[PRESET_SLOTS];    // Entry + 1 holding each slot, 0 = none
+static uint32_t   cache_entry_used[CACHE_ENTRIES];   // LRU stamps
+static uint32_t   cache_clock;
+static uint16_t   cache_mask;               // Entries in use
+static uint8_t    cache_fill_next;          // Next slot to read after boot (PRESET_SLOTS = done)
+static bool       cache_dir_dirty;          // Active slot changed by a switch, not yet written
+
+static CachedBand cache_pool[CACHE_POOL_BANDS];
+static uint16_t   cache_pool_used;
+static uint16_t   cache_bank_first[CACHE_ENTRIES];
+static uint16_t   cache_bank_count[CACHE_ENTRIES];
+static uint16_t   cache_bank_mask;          // Entries whose bank is complete for cache_bank_rate
+static uint32_t   cache_bank_rate;
+static uint8_t    cache_build_entry;
+static uint8_t    cache_build_ch;
+
+static void cache_restart_build(void) {
+    cache_bank_mask = 0;
+    cache_pool_used = 0;
+    cache_build_entry = 0;
+    cache_build_ch = 0;
+    cache_bank_rate = output_rate;
+}
+
+void preset_cache_rebuild_banks(void) {
+    cache_restart_build();
+}
+
+// Entry holding `slot`, or -1.
+static int cache_entry_of(uint8_t slot) {
+    return (slot < PRESET_SLOTS) ? (int)cache_slot_entry[slot] - 1 : -1;
+}
+
+static void cache_touch(int e) {
+    cache_entry_used[e] = ++cache_clock;
+}
+
+// A free entry, else (if `evict`) the least recently used one, else -1.
+static int cache_pick_entry(bool evict) {
+    int lru = -1;
+    for (int e = 0; e < CACHE_ENTRIES; e++) {
+        if (!(cache_mask & (1u << e))) return e;
+        if (lru < 0 || cache_entry_used[e] < cache_entry_used[lru]) lru = e;
+    }
+    return evict ? lru : -1;
+}
+
+static void cache_put(uint8_t slot, const PresetSlot *s, bool evict) {
+    int e = cache_entry_of(slot);
+    if (e < 0) {
+        e = cache_pick_entry(evict);
+        if (e < 0) return;
+        if (cache_mask & (1u << e)) cache_slot_entry[cache_entry_slot[e]] = 0;
+        cache_entry_slot[e] = slot;
+        cache_slot_entry[slot] = (uint8_t)(e + 1);
+    }
+    memcpy(&cache_slots[e], s, sizeof(PresetSlot));
+    cache_mask |= (1u << e);
+    cache_touch(e);
+    cache_restart_build();
+}
+
+static void cache_drop(uint8_t slot) {
+    int e = cache_entry_of(slot);
+    if (e < 0) return;
+    cache_mask &= ~(1u << e);
+    cache_slot_entry[slot] = 0;
+    cache_restart_build();
+}
+
+// Design one channel of the entry being built.
+static void cache_build_step(void) {
+    uint8_t e = cache_build_entry;
+    if (!(cache_mask & (1u << e))) {
+        cache_build_entry++;
+        return;
+    }
+
+    int ch = cache_build_ch;
+    if (ch == 0) {
+        cache_bank_first[e] = cache_pool_used;
+        cache_bank_count[e] = 0;
+    }
+
+    const PresetSlot *s = &cache_slots[e];
+    for (int b = 0; b < channel_band_counts[ch]; b++) {
+        EqParamPacket p = s->filter_recipes[ch][b];
+        Biquad bq;
+        memset(&bq, 0, sizeof(bq));
+        dsp_compute_coefficients(&p, &bq, (float)cache_bank_rate);
+        if (bq.bypass) continue;
+
+        if (cache_pool_used >= CACHE_POOL_BANDS) {
+            // Pool full: give the space back, this entry stays unbuilt
+            cache_pool_used = cache_bank_first[e];
+            cache_build_ch = 0;
+            cache_build_entry++;
+            return;
+        }
+        CachedBand *cb = &cache_pool[cache_pool_used++];
+        cb->ch = (uint8_t)ch;
+        cb->band = (uint8_t)b;
+        cb->bq = bq;
+        cache_bank_count[e]++;
+    }
+
+    if (++cache_build_ch >= NUM_CHANNELS) {
+        cache_bank_mask |= (1u << e);
+        cache_build_ch = 0;
+        cache_build_entry++;
+    }
+}
+
+// Core 1 mode the slot's output enables would select (mirrors
+// derive_core1_mode(), which reads the live matrix).
+static Core1Mode slot_core1_mode(const PresetSlot *s) {
+    if (s->matrix_outputs[NUM_OUTPUT_CHANNELS - 1].enabled)
+        return CORE1_MODE_PDM;
+    for (int out = CORE1_EQ_FIRST_OUTPUT; out <= CORE1_EQ_LAST_OUTPUT; out++) {
+        if (s->matrix_outputs[out].enabled)
+            return CORE1_MODE_EQ_WORKER;
+    }
+    return CORE1_MODE_IDLE;
+}
+
+// True if applying the slot leaves output hardware untouched: same output
+// types, I2S clocking and (when presets carry pins) pin assignment.  Pre-V9
+// slots reset the I2S configuration to defaults and always take the full path.
+static bool slot_outputs_match(const PresetSlot *s) {
+    extern uint8_t output_types[];
+    extern uint8_t i2s_bck_pin;
+    extern uint8_t i2s_mck_pin;
+    extern bool    i2s_mck_enabled;
+    extern uint16_t i2s_mck_multiplier;
+
+    if (s->version < 9) return false;
+    if (dir_cache.include_pins &&
+        memcmp(s->output_pins, output_pins, NUM_PIN_OUTPUTS) != 0) return false;
+    if (memcmp(s->output_types, output_types, NUM_SPDIF_INSTANCES) != 0) return false;
+    return s->i2s_bck_pin == i2s_bck_pin
+        && s->i2s_mck_pin == i2s_mck_pin
+        && (s->i2s_mck_enabled != 0) == i2s_mck_enabled
+        && slot_mck_multiplier(s) == i2s_mck_multiplier;
+}
+
+bool preset_cache_can_switch(uint8_t slot) {
+    int e = cache_entry_of(slot);
+    if (e < 0) return false;
+    uint16_t bit = 1u << e;
+    if (!(cache_mask & bit) || !(cache_bank_mask & bit)) return false;
+    if (cache_bank_rate != output_rate) return false;
+
+    const PresetSlot *s = &cache_slots[e];
+    return slot_core1_mode(s) == core1_mode && slot_outputs_match(s);
+}
+
+bool preset_cache_switch(uint8_t slot) {
+    if (!preset_cache_can_switch(slot)) return false;
+
+    int e = cache_entry_of(slot);
+    const PresetSlot *s = &cache_slots[e];
+    cache_touch(e);
+    apply_slot_to_live(s, dir_cache.include_pins != 0);
+    apply_master_volume_from_mode(s);
+
+    // Install the bank.  Bands that were idle start from zeroed state;
+    // bands that stay active keep theirs, as on a live EQ edit.
+    const CachedBand *cb = &cache_pool[cache_bank_first[e]];
+    const CachedBand *end = cb + cache_bank_count[e];
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        bool all_bypassed = true;
+        for (int b = 0; b < channel_band_counts[ch]; b++) {
+            Biquad *bq = &filters[ch][b];
+            if (cb < end && cb->ch == ch && cb->band == b) {
+                if (bq->bypass) {
+                    *bq = cb->bq;
+                } else {
+                    dsp_load_coefficients(bq, &cb->bq);
+                }
+                all_bypassed = false;
+                cb++;
+            } else {
+                bq->bypass = true;
+            }
+        }
+        channel_bypassed[ch] = all_bypassed;
+    }
+    dsp_update_delay_samples((float)output_rate);
+    clear_delay_lines();
+
+    // The directory write is left to preset_cache_service() so it never
+    // lengthens the fade.
+    dir_cache.last_active_slot = slot;
+    cache_dir_dirty = true;
+    coeff_cache_boot_store_request();
+    return true;
+}
+
+bool preset_cache_scene(uint8_t slot, Biquad (*bank)[MAX_BANDS], SceneLevels *lv) {
+    if (!preset_cache_can_switch(slot)) return false;
+    int e = cache_entry_of(slot);
+    const PresetSlot *s = &cache_slots[e];
+    cache_touch(e);
+
+    // Coefficients: expand the sparse bank, everything else bypassed
+    memset(bank, 0, sizeof(Biquad) * NUM_CHANNELS * MAX_BANDS);
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        for (int b = 0; b < MAX_BANDS; b++) bank[ch][b].bypass = true;
+    }
+    const CachedBand *cb = &cache_pool[cache_bank_first[e]];
+    for (uint16_t i = 0; i < cache_bank_count[e]; i++, cb++) {
+        bank[cb->ch][cb->band] = cb->bq;
+    }
+
+    // Gain stages, as apply_slot_to_live() would set them
+    for (int i = 0; i < NUM_INPUT_CHANNELS; i++) {
+        lv->preamp[i] = db_to_linear(slot_preamp_db(s, i));
+    }
+    for (int in = 0; in < NUM_INPUT_CHANNELS; in++) {
+        for (int out = 0; out < NUM_OUTPUT_CHANNELS; out++) {
+            const FlashMatrixCrosspoint *xp = SLOT_XP(s, in, out);
+            float g = xp->enabled ? db_to_linear(xp->gain_db) : 0.0f;
+            lv->xp_gain[in][out] = xp->phase_invert ? -g : g;
+        }
+    }
+    for (int out = 0; out < NUM_OUTPUT_CHANNELS; out++) {
+        bool on = s->matrix_outputs[out].enabled != 0;
+        lv->out_enabled[out] = on;
+        lv->out_gain[out] = (on && !s->matrix_outputs[out].mute)
+                          ? db_to_linear(s->matrix_outputs[out].gain_db) : 0.0f;
+        lv->out_delay_ms[out] = s->matrix_outputs[out].delay_ms;
+    }
+    float db = master_volume_db_for(s);
+    lv->master = (isfinite(db) && db > MASTER_VOL_MUTE_DB)
+               ? powf(10.0f, fminf(db, MASTER_VOL_MAX_DB) / 20.0f) : 0.0f;
+    lv->eq_bypass = (s->bypass != 0);
+    return true;
+}
+
+bool preset_cache_commit_scene(uint8_t slot) {
+    int e = cache_entry_of(slot);
+    if (e < 0) return false;
+
+    const PresetSlot *s = &cache_slots[e];
+    apply_slot_to_live(s, dir_cache.include_pins != 0);
+    apply_master_volume_from_mode(s);
+    dir_cache.last_active_slot = slot;
+    cache_dir_dirty = true;
+    coeff_cache_boot_store_request();
+    return true;
+}
+
+void preset_cache_service(void) {
+    if (cache_dir_dirty) {
+        cache_dir_dirty = false;
+        dir_flush();
+        return;
+    }
+
+    // Fill free entries in slot order, and move slots still held as full
+    // SLOT_DATA records (older firmware) to the packed encoding.
+    if (cache_fill_next < PRESET_SLOTS) {
+        dir_ensure();
+        uint8_t slot = cache_fill_next++;
+        if (!slot_bit(dir_cache.slot_occupied, slot)) return;
+        bool repack = journal_slot_present(slot) && jrec_at(jidx_slot[slot])->type == JREC_SLOT_DATA;
+        if (!repack && (cache_entry_of(slot) >= 0 || cache_pick_entry(false) < 0)) return;
+        const PresetSlot *s = validate_slot(slot);
+        if (!s) return;
+        cache_put(slot, s, false);
+        if (repack) journal_repack_slot(slot, s);
+        return;
+    }
+
+    if (cache_bank_rate != output_rate) {
+        cache_restart_build();
+        return;
+    }
+    if (cache_build_entry < CACHE_ENTRIES) cache_build_step();
 }
 
 // ============================================================================
@@ -767,23 +2136,24 @@ uint8_t preset_save(uint8_t slot) {
 
     dir_ensure();
 
-    // Build the slot data from current live state
-    static PresetSlot slot_buf;
+    // Build the slot data from current live state and encode it
     collect_live_state(&slot_buf, slot);
+    uint16_t len = slot_pack(&slot_buf, slot, pack_buf);
 
-    // Engage mute before flash writes to prevent audio glitches
-    preset_mute_counter = flash_mute_hold_samples();
-    preset_loading = true;
-    __dmb();
-
-    // Write slot to flash
-    if (flash_write_sector(SLOT_SECTOR_OFFSET(slot), &slot_buf, sizeof(slot_buf)) != 0) {
+    // Append slot record to the journal, if the store has room for it
+    if (!journal_slot_fits(slot, len)) {
+        return PRESET_ERR_STORE_FULL;
+    }
+    if (journal_append(JREC_SLOT_PACKED, slot, pack_buf, len) != 0) {
         return PRESET_ERR_FLASH_WRITE;
     }
 
+    cache_put(slot, &slot_buf, true);
+
     // Update directory: mark occupied, set last active
-    dir_cache.slot_occupied |= (1u << slot);
+    slot_bit_set(dir_cache.slot_occupied, slot, true);
     dir_cache.last_active_slot = slot;
+    coeff_cache_boot_store_request();
     if (dir_flush() != 0) {
         return PRESET_ERR_FLASH_WRITE;
     }
@@ -799,13 +2169,14 @@ uint8_t preset_load(uint8_t slot) {
     // NOTE: muting is now handled by prepare_pipeline_reset() in the main
     // loop caller, which also waits for Core 1 idle before we modify state.
 
-    if (dir_cache.slot_occupied & (1u << slot)) {
+    if (slot_bit(dir_cache.slot_occupied, slot)) {
         // Slot has user data — validate and load it
         const PresetSlot *s = validate_slot(slot);
         if (!s) {
             preset_loading = false;
             return PRESET_ERR_CRC;
         }
+        cache_put(slot, s, true);
         apply_slot_to_live(s, dir_cache.include_pins != 0);
         apply_master_volume_from_mode(s);
     } else {
@@ -814,22 +2185,11 @@ uint8_t preset_load(uint8_t slot) {
     }
 
     // Recalculate filters and delays for the current sample rate
-    extern volatile AudioState audio_state;
-    float rate = (float)audio_state.freq;
+    float rate = (float)output_rate;
     dsp_recalculate_all_filters(rate);
     dsp_update_delay_samples(rate);
 
-    // Zero all delay line buffers.  Without this, stale audio from the
-    // previous preset's delay lines bleeds through — e.g. switching from
-    // a 40ms delay to 0ms would replay ~40ms of old audio as the write
-    // index wraps past the old data.
-    extern
-#if PICO_RP2350
-    float delay_lines[NUM_DELAY_CHANNELS][MAX_DELAY_SAMPLES];
-#else
-    int32_t delay_lines[NUM_DELAY_CHANNELS][MAX_DELAY_SAMPLES];
-#endif
-    memset(delay_lines, 0, sizeof(delay_lines));
+    clear_delay_lines();
 
     // Transition Core 1 mode to match the new output enable state
     Core1Mode new_mode = derive_core1_mode();
@@ -844,6 +2204,7 @@ uint8_t preset_load(uint8_t slot) {
     // Update directory: set last active
     dir_cache.last_active_slot = slot;
     dir_flush();  // Best-effort; preset is already loaded even if dir write fails
+    coeff_cache_boot_store_request();
 
     return PRESET_OK;
 }
@@ -853,31 +2214,18 @@ uint8_t preset_delete(uint8_t slot) {
 
     dir_ensure();
 
-    // NOTE: muting is now handled by prepare_pipeline_reset() in the main
-    // loop caller.  The mute counter and preset_loading flag are set there.
+    // NOTE: when the active slot is deleted, the main loop caller brackets
+    // this with prepare_pipeline_reset().  Deleting any other slot only
+    // appends a tombstone, which the background writer does without a mute.
     __dmb();
 
-    // Erase the slot's flash sector (same lockout guard as flash_write_sector)
-    bool do_lockout = multicore_lockout_victim_is_initialized(1)
-                      && (__get_current_exception() == 0);
-    if (do_lockout) multicore_lockout_start_blocking();
-
-    uint32_t flags = save_and_disable_interrupts();
-    dspi_flash_range_erase(SLOT_SECTOR_OFFSET(slot), FLASH_SECTOR_SIZE);
-    restore_interrupts(flags);
-
-    if (do_lockout) multicore_lockout_end_blocking();
-
-    // Re-seed feedback controller after interrupt blackout
-    fb_ctrl_reset(&fb_ctrl, nominal_feedback_10_14 << 2);
-    feedback_10_14 = nominal_feedback_10_14;
-    preset_mute_counter = flash_mute_hold_samples();
-    preset_loading = true;
-
-    // Update directory — clear occupied bit and name, keep slot selected if active
-    dir_cache.slot_occupied &= ~(1u << slot);
+    // Update directory — clear occupied bit and name, keep slot selected if
+    // active.  The flush appends a tombstone; the old slot record becomes
+    // garbage for the journal GC.
+    slot_bit_set(dir_cache.slot_occupied, slot, false);
     memset(dir_cache.slot_names[slot], 0, PRESET_NAME_LEN);
     dir_flush();
+    cache_drop(slot);
 
     // If deleting the active slot, apply factory defaults to live state
     if (slot == dir_cache.last_active_slot) {
@@ -887,8 +2235,7 @@ uint8_t preset_delete(uint8_t slot) {
 
         apply_factory_defaults();
 
-        extern volatile AudioState audio_state;
-        float rate = (float)audio_state.freq;
+        float rate = (float)output_rate;
         dsp_recalculate_all_filters(rate);
         dsp_update_delay_samples(rate);
 
@@ -931,7 +2278,7 @@ void preset_get_directory(uint16_t *slot_occupied, uint8_t *startup_mode,
                           uint8_t *default_slot, uint8_t *last_active,
                           uint8_t *include_pins, uint8_t *master_volume_mode) {
     dir_ensure();
-    *slot_occupied      = dir_cache.slot_occupied;
+    *slot_occupied      = (uint16_t)dir_cache.slot_occupied[0];  // Slots 0-15
     *startup_mode       = dir_cache.startup_mode;
     *default_slot       = dir_cache.default_slot;
     *last_active        = dir_cache.last_active_slot;
@@ -939,6 +2286,20 @@ void preset_get_directory(uint16_t *slot_occupied, uint8_t *startup_mode,
     *master_volume_mode = dir_cache.master_volume_mode;
 }
 
+void preset_get_store_info(PresetStoreInfoPacket *out) {
+    dir_ensure();
+    memset(out, 0, sizeof(*out));
+    out->slot_count    = PRESET_SLOTS;
+    out->data_capacity = JOURNAL_SLOT_BUDGET;
+    out->data_used     = dir_cache.slot_bytes;
+    for (int n = 0; n < PRESET_SLOTS; n++) {
+        if (slot_bit(dir_cache.slot_occupied, n)) {
+            out->occupied[n >> 3] |= (uint8_t)(1u << (n & 7));
+            out->occupied_count++;
+        }
+    }
+}
+
 uint8_t preset_set_startup(uint8_t mode, uint8_t default_slot) {
     if (mode > PRESET_STARTUP_LAST_ACTIVE) return PRESET_ERR_INVALID_SLOT;
     if (default_slot >= PRESET_SLOTS) return PRESET_ERR_INVALID_SLOT;
@@ -946,6 +2307,7 @@ uint8_t preset_set_startup(uint8_t mode, uint8_t default_slot) {
 
     dir_cache.startup_mode = mode;
     dir_cache.default_slot = default_slot;
+    coeff_cache_boot_store_request();
     if (dir_flush() != 0) {
         return PRESET_ERR_FLASH_WRITE;
     }
@@ -965,6 +2327,30 @@ void preset_set_master_volume_mode(uint8_t mode) {
     dir_flush();
 }
 
+void preset_set_latency_profile(uint8_t profile) {
+    if (profile >= LATENCY_PROFILE_COUNT) profile = LATENCY_PROFILE_BALANCED;
+    dir_ensure();
+    dir_cache.latency_profile = profile;
+    dir_flush();
+}
+
+uint8_t preset_get_latency_profile(void) {
+    dir_ensure();
+    return (dir_cache.latency_profile < LATENCY_PROFILE_COUNT)
+               ? dir_cache.latency_profile : LATENCY_PROFILE_BALANCED;
+}
+
+void preset_set_rate_lock(uint32_t rate) {
+    dir_ensure();
+    dir_cache.rate_lock_hz100 = (uint16_t)(rate / 100);
+    dir_flush();
+}
+
+uint32_t preset_get_rate_lock(void) {
+    dir_ensure();
+    return (uint32_t)dir_cache.rate_lock_hz100 * 100;
+}
+
 // Copy the live master volume into the directory's independent field and
 // persist.  Accepted in both modes — in mode 1 the value is dormant until
 // the user switches to mode 0.  Matches the deferred-flush machinery used
@@ -988,10 +2374,77 @@ uint8_t preset_get_active(void) {
     return dir_cache.last_active_slot;
 }
 
+uint8_t preset_get_boot_slot(void) {
+    dir_ensure();
+    uint8_t slot = (dir_cache.startup_mode == PRESET_STARTUP_LAST_ACTIVE)
+                 ? dir_cache.last_active_slot : dir_cache.default_slot;
+
+    // Clamp to valid range
+    if (slot >= PRESET_SLOTS) {
+        slot = dir_cache.default_slot;
+        if (slot >= PRESET_SLOTS) slot = 0;
+    }
+    return slot;
+}
+
+// ============================================================================
+// BOOT COEFFICIENT RECORDS
+// ============================================================================
+
+const uint8_t *preset_boot_coeffs_get(uint8_t part, uint16_t *len) {
+    if (part >= COEFF_BOOT_PARTS) return NULL;
+    journal_mount();
+    if (!jidx_boot[part]) return NULL;
+    const JournalRecordHeader *h = jrec_at(jidx_boot[part]);
+    *len = h->len;
+    return (const uint8_t *)(h + 1);
+}
+
+uint8_t preset_boot_coeffs_put(uint8_t part, const void *data, uint16_t len) {
+    if (part >= COEFF_BOOT_PARTS || len > COEFF_BOOT_RECORD_MAX) return PRESET_ERR_INVALID_SLOT;
+    if (journal_append(JREC_BOOT_COEFFS, part, data, len) != 0) return PRESET_ERR_FLASH_WRITE;
+    return PRESET_OK;
+}
+
 // ============================================================================
 // BOOT / MIGRATION
 // ============================================================================
 
+// Migrate the fixed pre-journal layout (directory in sector 0, slot N in
+// sector N+1) into the journal.  Called when the journal has no directory.
+//
+// Migration reuses the same sectors, so unmigrated data is reserved from
+// claiming: each slot sector is released once its record is in the journal
+// (at worst one sector consumed per sector released, starting from the dead
+// legacy sector), and sector 0 is released once DIR_FIELDS is committed.
+// An interrupted migration simply resumes on the next boot — slots already
+// in the journal are skipped and sector 0 is still intact.
+static bool migrate_fixed_layout(void) {
+    if (!dir_load_fixed()) return false;
+
+    jrnl_reserved_mask = (1u << FIXED_DIR_SECTOR);
+    for (uint8_t n = 0; n < FIXED_SLOTS; n++) {
+        if (slot_bit(dir_cache.slot_occupied, n) && !journal_slot_present(n)) {
+            jrnl_reserved_mask |= (1u << FIXED_SLOT_SECTOR(n));
+        }
+    }
+
+    for (uint8_t n = 0; n < FIXED_SLOTS; n++) {
+        if (!(jrnl_reserved_mask & (1u << FIXED_SLOT_SECTOR(n)))) continue;
+        const PresetSlot *s = validate_fixed_slot(n);
+        uint16_t len = s ? slot_pack(s, n, pack_buf) : 0;
+        if (!s || journal_append(JREC_SLOT_PACKED, n, pack_buf, len) != 0) {
+            slot_bit_set(dir_cache.slot_occupied, n, false);  // Corrupt or unwritable — drop it
+        }
+        jrnl_reserved_mask &= ~(1u << FIXED_SLOT_SECTOR(n));
+    }
+
+    dir_cache_valid = true;
+    (void)dir_flush();  // If the flush fails, the cache stays valid in RAM
+    if (jidx_fields) jrnl_reserved_mask = 0;
+    return true;
+}
+
 // Attempt to migrate legacy single-sector data (pre-preset firmware) into
 // preset slot 0.  Called when no preset directory exists on flash.
 static bool migrate_legacy(void) {
@@ -1003,26 +2456,31 @@ static bool migrate_legacy(void) {
     size_t data_len = sizeof(LegacyFlashStorage) - offsetof(LegacyFlashStorage, filter_recipes);
     if (crc32(data_start, data_len) != legacy->crc32) return false;
 
-    // Build a PresetSlot from the legacy data.
-    // The data section layout is identical, so we can memcpy the data portion.
-    static PresetSlot slot_buf;
-    memset(&slot_buf, 0, sizeof(slot_buf));
-    slot_buf.magic = SLOT_MAGIC;
-    slot_buf.version = legacy->version;
-    slot_buf.slot_index = 0;
-
-    // Copy data fields (identical layout from filter_recipes onward)
-    memcpy(&slot_buf.filter_recipes, &legacy->filter_recipes,
-           sizeof(LegacyFlashStorage) - offsetof(LegacyFlashStorage, filter_recipes));
-
-    // Recompute CRC for the slot format
-    const uint8_t *slot_data = (const uint8_t *)&slot_buf.filter_recipes;
-    size_t slot_data_len = sizeof(PresetSlot) - offsetof(PresetSlot, filter_recipes);
-    slot_buf.crc32 = crc32(slot_data, slot_data_len);
-
-    // Write slot 0
-    if (flash_write_sector(SLOT_SECTOR_OFFSET(0), &slot_buf, sizeof(slot_buf)) != 0) {
-        return false;
+    // Keep the legacy sector out of the journal until the directory is in
+    jrnl_reserved_mask = (1u << FIXED_LEGACY_SECTOR);
+
+    if (!journal_slot_present(0)) {
+        // Build a PresetSlot from the legacy data.
+        // The data section layout is identical, so we can memcpy the data portion.
+        memset(&slot_buf, 0, sizeof(slot_buf));
+        slot_buf.magic = SLOT_MAGIC;
+        slot_buf.version = legacy->version;
+        slot_buf.slot_index = 0;
+
+        // Copy data fields (identical layout from filter_recipes onward)
+        memcpy(&slot_buf.filter_recipes, &legacy->filter_recipes,
+               sizeof(LegacyFlashStorage) - offsetof(LegacyFlashStorage, filter_recipes));
+
+        // Recompute CRC for the slot format
+        const uint8_t *slot_data = (const uint8_t *)&slot_buf.filter_recipes;
+        size_t slot_data_len = SLOT_RECORD_SIZE - offsetof(PresetSlot, filter_recipes);
+        slot_buf.crc32 = crc32(slot_data, slot_data_len);
+
+        uint16_t len = slot_pack(&slot_buf, 0, pack_buf);
+        if (journal_append(JREC_SLOT_PACKED, 0, pack_buf, len) != 0) {
+            jrnl_reserved_mask = 0;
+            return false;
+        }
     }
 
     // Create a fresh directory with slot 0 occupied and set as default
@@ -1033,40 +2491,27 @@ static bool migrate_legacy(void) {
     dir_cache.include_pins = 1;
     dir_cache.master_volume_mode = MASTER_VOLUME_MODE_INDEPENDENT;
     dir_cache.master_volume_db   = MASTER_VOL_DEFAULT_DB;
-    dir_cache.slot_occupied = 0x0001;  // Slot 0 occupied
+    slot_bit_set(dir_cache.slot_occupied, 0, true);  // Slot 0 occupied
     strncpy(dir_cache.slot_names[0], "Migrated", PRESET_NAME_LEN - 1);
     dir_cache_valid = true;
 
-    if (dir_flush() != 0) {
-        return false;
-    }
-
-    return true;
+    int result = dir_flush();
+    jrnl_reserved_mask = 0;
+    return result == 0;
 }
 
 int preset_boot_load(void) {
-    // Try to load the preset directory from flash
-    if (dir_load_cache()) {
+    // Load the preset directory from the journal, or from the fixed layout
+    // written by older firmware
+    if (dir_load_cache() || migrate_fixed_layout()) {
         // Directory exists — determine which slot to load
-        uint8_t target_slot;
-
-        if (dir_cache.startup_mode == PRESET_STARTUP_LAST_ACTIVE) {
-            target_slot = dir_cache.last_active_slot;
-        } else {
-            // PRESET_STARTUP_SPECIFIED (default)
-            target_slot = dir_cache.default_slot;
-        }
-
-        // Clamp to valid range
-        if (target_slot >= PRESET_SLOTS) {
-            target_slot = dir_cache.default_slot;
-            if (target_slot >= PRESET_SLOTS) target_slot = 0;
-        }
+        uint8_t target_slot = preset_get_boot_slot();
 
         // Load the slot: user data if occupied, factory defaults if empty
-        if ((dir_cache.slot_occupied & (1u << target_slot))) {
+        if (slot_bit(dir_cache.slot_occupied, target_slot)) {
             const PresetSlot *s = validate_slot(target_slot);
             if (s) {
+                cache_put(target_slot, s, true);
                 apply_slot_to_live(s, dir_cache.include_pins != 0);
                 apply_master_volume_from_mode(s);
             } else {
@@ -1086,6 +2531,7 @@ int preset_boot_load(void) {
         // Migration succeeded; slot 0 is now populated.  Load it.
         const PresetSlot *s = validate_slot(0);
         if (s) {
+            cache_put(0, s, true);
             apply_slot_to_live(s, false);  // Legacy migration: don't override pins
             apply_master_volume_from_mode(s);
         } else {
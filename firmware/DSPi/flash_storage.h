@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "config.h"
+#include "scene_morph.h"
 
 // Legacy result codes (used by flash_save_params / flash_load_params)
 #define FLASH_OK            0
@@ -28,13 +29,19 @@ void flash_factory_reset(void);
 // ============================================================================
 // PRESET API
 // ============================================================================
+//
+// Anything that writes flash (save, delete, name/startup/settings setters,
+// and load, which records the active slot) must run in the main loop: the
+// background writer runs the audio path while the flash is busy and must not
+// be re-entered from the USB IRQ (flash_writer.h).
 
-// Save the current live DSP state into a preset slot (0-9).
+// Save the current live DSP state into a preset slot (0 to PRESET_SLOTS-1).
 // Updates last_active_slot in the directory.
-// Returns PRESET_OK or PRESET_ERR_*.
+// Returns PRESET_OK or PRESET_ERR_* (PRESET_ERR_STORE_FULL if the preset
+// data area has no room for the encoded slot).
 uint8_t preset_save(uint8_t slot);
 
-// Load a preset slot (0-9) into the live DSP state.
+// Load a preset slot into the live DSP state.
 // If the slot is occupied, loads user data.  If empty, applies factory defaults.
 // Triggers filter recalculation and delay update internally.
 // Updates last_active_slot in the directory.
@@ -42,8 +49,8 @@ uint8_t preset_save(uint8_t slot);
 // Returns PRESET_OK or PRESET_ERR_*.
 uint8_t preset_load(uint8_t slot);
 
-// Delete a preset slot (0-9).  Erases the flash sector and clears the
-// occupied bit.  The active slot selection is unchanged — if the deleted
+// Delete a preset slot.  Appends a tombstone to the preset journal and
+// clears the occupied bit.  The active slot selection is unchanged — if the deleted
 // slot was active, it remains selected (loading it will yield factory defaults).
 // Returns PRESET_OK or PRESET_ERR_INVALID_SLOT.
 uint8_t preset_delete(uint8_t slot);
@@ -58,19 +65,24 @@ uint8_t preset_get_name(uint8_t slot, char *name_out);
 uint8_t preset_set_name(uint8_t slot, const char *name);
 
 // Get a summary of the preset directory:
-//   - slot_occupied:       16-bit bitmask (bit N = slot N occupied)
+//   - slot_occupied:       bit N = slot N occupied, slots 0-15 only
+//                          (preset_get_store_info() covers every slot)
 //   - startup_mode:        PRESET_STARTUP_SPECIFIED or PRESET_STARTUP_LAST_ACTIVE
-//   - default_slot:        slot loaded in SPECIFIED mode (0-9)
-//   - last_active:         last slot that was loaded/saved (always 0-9)
+//   - default_slot:        slot loaded in SPECIFIED mode
+//   - last_active:         last slot that was loaded/saved
 //   - include_pins:        whether preset load restores pin config (0/1)
 //   - master_volume_mode:  MASTER_VOLUME_MODE_INDEPENDENT (0) or _WITH_PRESET (1)
 void preset_get_directory(uint16_t *slot_occupied, uint8_t *startup_mode,
                           uint8_t *default_slot, uint8_t *last_active,
                           uint8_t *include_pins, uint8_t *master_volume_mode);
 
+// Occupancy of every slot plus preset data usage against capacity.  Served
+// from RAM, so safe from the vendor IRQ.
+void preset_get_store_info(PresetStoreInfoPacket *out);
+
 // Set startup behavior.
 //   mode: PRESET_STARTUP_SPECIFIED or PRESET_STARTUP_LAST_ACTIVE
-//   default_slot: which slot to load in SPECIFIED mode (0-9)
+//   default_slot: which slot to load in SPECIFIED mode
 // Returns PRESET_OK or PRESET_ERR_INVALID_SLOT.
 uint8_t preset_set_startup(uint8_t mode, uint8_t default_slot);
 
@@ -81,6 +93,20 @@ void preset_set_include_pins(uint8_t include);
 // Values outside the valid range are clamped to INDEPENDENT.
 void preset_set_master_volume_mode(uint8_t mode);
 
+// Set the device-wide latency profile (LATENCY_PROFILE_*) and persist.
+// Out-of-range values store BALANCED.
+void preset_set_latency_profile(uint8_t profile);
+
+// Stored latency profile, applied at boot.
+uint8_t preset_get_latency_profile(void);
+
+// Set the device-wide output rate lock in Hz (0 = off) and persist.  The
+// caller validates the rate (rate_lock_request()).
+void preset_set_rate_lock(uint32_t rate);
+
+// Stored rate lock, applied at boot (0 = off).
+uint32_t preset_get_rate_lock(void);
+
 // Copy the live master volume into the directory's independent field and
 // persist.  Accepted regardless of current mode (dormant in mode 1).
 // Returns PRESET_OK or PRESET_ERR_FLASH_WRITE.
@@ -90,17 +116,64 @@ uint8_t preset_save_master_volume(void);
 // boot in mode 0).  Does not affect live state.
 float preset_get_saved_master_volume(void);
 
-// Get the currently active preset slot (always 0-9).
+// Get the currently active preset slot.
 uint8_t preset_get_active(void);
 
+// Slot the next boot will load, from the startup policy.
+uint8_t preset_get_boot_slot(void);
+
+// Persisted boot coefficient record for `part` (COEFF_BOOT_*), or NULL if
+// none.  Points into XIP flash; valid until the next journal write.
+const uint8_t *preset_boot_coeffs_get(uint8_t part, uint16_t *len);
+
+// Replace the boot coefficient record for `part`.
+uint8_t preset_boot_coeffs_put(uint8_t part, const void *data, uint16_t len);
+
+// ============================================================================
+// PRESET RAM CACHE
+// ============================================================================
+
+// Recently used slots are kept decoded in RAM, with their EQ coefficients
+// pre-designed for the current sample rate.  Main loop only.
+
+// Background fill/rebuild, one bounded step per call.  Also writes the
+// active-slot change left behind by preset_cache_switch().
+void preset_cache_service(void);
+
+// Redesign the cached slots' banks: a design input outside the presets
+// (dynamic EQ bands) changed.
+void preset_cache_rebuild_banks(void);
+
+// True if `slot` can be switched to from the cache: its bank is built for
+// the current rate and applying it changes no output hardware (types, I2S
+// clocking, pins) and no Core 1 mode.
+bool preset_cache_can_switch(uint8_t slot);
+
+// Apply a cached slot to the live state without touching flash.  The caller
+// must have Core 1 idle and the output muted.  Returns false (nothing
+// applied) if preset_cache_can_switch() is false.
+bool preset_cache_switch(uint8_t slot);
+
+#define PRESET_SWITCH_SILENCE_TIMEOUT_US  20000   // Fade-out wait (8 ms envelope)
+
+// Scene B for a morph (scene_morph.h): expand the slot's cached coefficients
+// into a full bank (state zeroed, unused bands bypassed) and fill in its
+// gain stages.  Same preconditions as preset_cache_switch().
+bool preset_cache_scene(uint8_t slot, Biquad (*bank)[MAX_BANDS], SceneLevels *lv);
+
+// End of a morph on scene B: apply the cached slot to the live state like
+// preset_cache_switch(), but leave filters[] to the caller.
+bool preset_cache_commit_scene(uint8_t slot);
+
 // ============================================================================
 // BOOT / MIGRATION
 // ============================================================================
 
 // Called once at boot.  Always selects a preset.  Loads the appropriate preset
 // based on startup config; if the target slot is empty, applies factory defaults.
-// If no preset directory exists, attempts legacy migration from the old
-// single-sector flash format (copies into slot 0, sets as default).
+// If the journal holds no directory, migrates the fixed-sector layout of
+// older firmware into it, or failing that the old single-sector format
+// (copied into slot 0, set as default).
 // Always returns FLASH_OK.
 int preset_boot_load(void);
 
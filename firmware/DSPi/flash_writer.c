@@ -0,0 +1,176 @@
+/*
+ * flash_writer.c — Audio-continuous flash erase/program
+ *
+ * Standard SPI NOR commands (W25Q-compatible, as used by the SDK and boot2).
+ * Commands go through dspi_flash_do_cmd(), which keeps the RP2350 QMI clock
+ * divider and XIP read setup intact (flash_clkdiv.h).
+ *
+ * One operation at a time, as a small state machine:
+ *
+ *   ISSUE  send write enable + the next command (erase, or the next non-blank
+ *          page), then WAIT.  A program with no pages left is done.
+ *   WAIT   poll the status register once.  Still busy: try again next slice.
+ *          Idle: an erase is done, a program moves to the next page and
+ *          issues it in the same slice.
+ */
+
+#include "flash_writer.h"
+#include "flash_clkdiv.h"
+#include "event_trace.h"
+#include "hardware/flash.h"
+#include "pico/time.h"
+#include <string.h>
+
+#if !PICO_COPY_TO_RAM
+#error "flash_writer.c requires a copy_to_ram build: code must not run from flash while it is busy"
+#endif
+
+#define FLASH_CMD_PAGE_PROGRAM   0x02
+#define FLASH_CMD_READ_STATUS    0x05
+#define FLASH_CMD_WRITE_ENABLE   0x06
+#define FLASH_CMD_SECTOR_ERASE   0x20
+#define FLASH_STATUS_BUSY        0x01
+
+// ~5x the datasheet maxima
+#define FLASH_PROGRAM_TIMEOUT_US    15000
+#define FLASH_ERASE_TIMEOUT_US      2000000
+
+enum {
+    WRITER_IDLE = 0,
+    WRITER_ISSUE,
+    WRITER_WAIT,
+};
+
+static struct {
+    uint8_t  state;
+    bool     erase;
+    uint32_t offset;
+    const uint8_t *data;
+    size_t   len;
+    size_t   done;              // Program: bytes of `data` handled so far
+    uint64_t issued_us;         // Current command sent
+} op;
+
+static void (*writer_slot)(void);
+
+// Opcode + 24-bit address + one page.  Static: keeps the page off the stack.
+static uint8_t cmd_tx[4 + FLASH_PAGE_SIZE];
+static uint8_t cmd_rx[4 + FLASH_PAGE_SIZE];
+
+void flash_writer_set_slot_hook(void (*slot)(void)) {
+    writer_slot = slot;
+}
+
+static void flash_write_enable(void) {
+    uint8_t tx = FLASH_CMD_WRITE_ENABLE;
+    uint8_t rx;
+    dspi_flash_do_cmd(&tx, &rx, 1);
+}
+
+static void flash_addr_cmd(uint8_t opcode, uint32_t offset, const uint8_t *data, size_t len) {
+    cmd_tx[0] = opcode;
+    cmd_tx[1] = (uint8_t)(offset >> 16);
+    cmd_tx[2] = (uint8_t)(offset >> 8);
+    cmd_tx[3] = (uint8_t)offset;
+    if (len) memcpy(cmd_tx + 4, data, len);
+    dspi_flash_do_cmd(cmd_tx, cmd_rx, 4 + len);
+}
+
+static bool flash_busy(void) {
+    uint8_t tx[2] = { FLASH_CMD_READ_STATUS, 0 };
+    uint8_t rx[2];
+    dspi_flash_do_cmd(tx, rx, 2);
+    return (rx[1] & FLASH_STATUS_BUSY) != 0;
+}
+
+static bool page_blank(const uint8_t *data) {
+    const uint32_t *w = (const uint32_t *)data;
+    for (size_t i = 0; i < FLASH_PAGE_SIZE / 4; i++) {
+        if (w[i] != 0xFFFFFFFFu) return false;
+    }
+    return true;
+}
+
+bool flash_writer_start_erase(uint32_t offset) {
+    if (op.state != WRITER_IDLE) return false;
+    op.erase = true;
+    op.offset = offset;
+    op.state = WRITER_ISSUE;
+    return true;
+}
+
+bool flash_writer_start_program(uint32_t offset, const uint8_t *data, size_t len) {
+    if (op.state != WRITER_IDLE) return false;
+    op.erase = false;
+    op.offset = offset;
+    op.data = data;
+    op.len = len;
+    op.done = 0;
+    op.state = WRITER_ISSUE;
+    return true;
+}
+
+bool flash_writer_busy(void) {
+    return op.state != WRITER_IDLE;
+}
+
+// Send the next command.  Returns false if a program has nothing left.
+static bool writer_issue(void) {
+    if (op.erase) {
+        flash_write_enable();
+        flash_addr_cmd(FLASH_CMD_SECTOR_ERASE, op.offset, NULL, 0);
+    } else {
+        while (op.done < op.len && page_blank(op.data + op.done)) op.done += FLASH_PAGE_SIZE;
+        if (op.done >= op.len) return false;
+        flash_write_enable();
+        flash_addr_cmd(FLASH_CMD_PAGE_PROGRAM, op.offset + op.done, op.data + op.done, FLASH_PAGE_SIZE);
+    }
+    op.issued_us = time_us_64();
+    op.state = WRITER_WAIT;
+    return true;
+}
+
+static int writer_done(void) {
+    trace_event(op.erase ? TRACE_EVT_FLASH_ERASE : TRACE_EVT_FLASH_PROGRAM, op.offset);
+    op.state = WRITER_IDLE;
+    return 0;
+}
+
+int flash_writer_step(void) {
+    if (op.state == WRITER_IDLE) return 0;
+
+    if (op.state == WRITER_WAIT) {
+        uint64_t polled = time_us_64();
+        if (flash_busy()) {
+            if (polled - op.issued_us > (op.erase ? FLASH_ERASE_TIMEOUT_US : FLASH_PROGRAM_TIMEOUT_US)) {
+                trace_event(TRACE_EVT_FLASH_TIMEOUT, op.offset + (op.erase ? 0 : (uint32_t)op.done));
+                op.state = WRITER_IDLE;
+                return -1;
+            }
+            return 1;
+        }
+        if (op.erase) return writer_done();
+        op.done += FLASH_PAGE_SIZE;
+    }
+
+    // WRITER_ISSUE, or a page just finished
+    return writer_issue() ? 1 : writer_done();
+}
+
+int flash_writer_finish(void) {
+    for (;;) {
+        int rc = flash_writer_step();
+        if (rc <= 0) return rc;
+        if (writer_slot) writer_slot();
+    }
+}
+
+int flash_writer_erase_sector(uint32_t offset) {
+    if (!flash_writer_start_erase(offset)) return -1;
+    return flash_writer_finish();
+}
+
+int flash_writer_program(uint32_t offset, const uint8_t *data, size_t len) {
+    if (!flash_writer_start_program(offset, data, len)) return -1;
+    return flash_writer_finish();
+}
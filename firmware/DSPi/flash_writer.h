@@ -0,0 +1,61 @@
+/*
+ * flash_writer.h — Audio-continuous flash erase/program
+ *
+ * The SDK/ROM erase and program calls hold XIP off, and the caller holds
+ * interrupts off, until the flash finishes: ~45 ms for a sector erase.  Audio
+ * had to be muted around every save for that long.
+ *
+ * The writer instead runs each operation as a sequence of slices.  A slice
+ * is at most one status poll plus one command (write enable + erase opcode,
+ * or one 256-byte page program), and each command is a single short XIP-off
+ * window with Core 1 parked and interrupts off (dspi_flash_do_cmd()).  The
+ * flash then works on its own while XIP is back on.
+ *
+ * Slices are scheduled one per audio slot: after each slice the writer runs
+ * the slot hook, which the main loop sets to usb_audio_run_slot() — wait
+ * for the next USB packet and process it.  A page program therefore costs
+ * one slot of slack, and a sector erase a status poll per slot until it
+ * completes.  Before the hook is set (boot: migration, first-boot
+ * directory) slices run back to back.
+ *
+ * The binary is copy_to_ram, so neither core executes from flash; the
+ * preset journal (the only code that reads flash through XIP) waits for
+ * each operation to finish before reading.  The flash array is unreadable
+ * while it is busy, which is why reads must never overlap a write.
+ *
+ * Main loop only.
+ */
+
+#ifndef FLASH_WRITER_H
+#define FLASH_WRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Run between slices.  NULL (the boot default) runs them back to back.
+void flash_writer_set_slot_hook(void (*slot)(void));
+
+// Start an operation.  Returns false if one is already in progress.
+// `offset` is sector-aligned for an erase; for a program it is page-aligned
+// and `len` a multiple of FLASH_PAGE_SIZE.  `data` must stay valid until the
+// operation has finished.  Pages that are all 0xFF are skipped.
+bool flash_writer_start_erase(uint32_t offset);
+bool flash_writer_start_program(uint32_t offset, const uint8_t *data, size_t len);
+
+// One slice of the current operation.  Returns 1 while it is still in
+// progress, 0 once it has finished (or when idle), -1 if the flash did not
+// go idle in time (the operation is dropped).
+int flash_writer_step(void);
+
+bool flash_writer_busy(void);
+
+// Run slices, one per slot hook call, until the current operation ends.
+// Returns 0 or -1 as flash_writer_step().
+int flash_writer_finish(void);
+
+// Start and finish in one call (flash_storage.c).
+int flash_writer_erase_sector(uint32_t offset);
+int flash_writer_program(uint32_t offset, const uint8_t *data, size_t len);
+
+#endif // FLASH_WRITER_H
@@ -0,0 +1,110 @@
+/*
+ * latency_profile.c — Selectable output latency profiles
+ *
+ * Fill targets are in consumer buffers of PICO_AUDIO_SPDIF_DMA_SAMPLE_COUNT
+ * (48) samples; I2S uses the same pool geometry.  At 48 kHz one buffer is
+ * 1 ms, at 96 kHz 0.5 ms, at 192 kHz 0.25 ms.
+ *
+ * The PDM path depth is fixed (PDM_BUFFER_SAMPLES).  A profile whose S/PDIF
+ * depth would fall below it is raised to the smallest target that keeps the
+ * sub alignment non-negative while the sub is running — the sub cannot be
+ * advanced, only delayed.
+ */
+
+#include "latency_profile.h"
+#include "dsp_pipeline.h"
+#include "pdm_generator.h"
+#include "usb_audio.h"
+#include "usb_feedback_controller.h"
+#include "rate_lock.h"
+#include "pico/audio_spdif.h"
+
+extern usb_feedback_ctrl_t fb_ctrl;
+extern volatile uint8_t spdif0_consumer_fill;
+
+#define BUFFER_SAMPLES      PICO_AUDIO_SPDIF_DMA_SAMPLE_COUNT
+#define PDM_MIN_TARGET      ((PDM_BUFFER_SAMPLES + BUFFER_SAMPLES - 1) / BUFFER_SAMPLES)
+#define USB_TRANSIT_US      1000    // One USB frame: packet arrival → ring → DSP
+
+#define ULTRA_LOW_TARGET    4
+#define SAFE_TARGET         12
+
+// Pools are not resized per profile: every set point must leave headroom
+// in the fixed consumer pool.
+_Static_assert(SAFE_TARGET < SPDIF_CONSUMER_BUFFER_COUNT && FB_FILL_TARGET < SAFE_TARGET,
+               "deepest profile must fit the consumer pool");
+
+static const uint8_t profile_fill_targets[LATENCY_PROFILE_COUNT] = {
+    [LATENCY_PROFILE_BALANCED]  = FB_FILL_TARGET,
+    [LATENCY_PROFILE_ULTRA_LOW] = ULTRA_LOW_TARGET,
+    [LATENCY_PROFILE_SAFE]      = SAFE_TARGET,
+};
+
+static volatile uint8_t requested_profile = LATENCY_PROFILE_BALANCED;
+
+// Active plan.  Defaults match BALANCED so the boot-time delay setup (before
+// the first service pass) produces the original alignment.
+static uint8_t active_profile = LATENCY_PROFILE_BALANCED;
+static uint8_t active_fill_target = FB_FILL_TARGET;
+static bool    active_pdm = false;
+static bool    planned = false;
+static int32_t sub_align_samples = FB_FILL_TARGET * BUFFER_SAMPLES - PDM_BUFFER_SAMPLES;
+
+void latency_profile_request(uint8_t profile) {
+    if (profile >= LATENCY_PROFILE_COUNT) profile = LATENCY_PROFILE_BALANCED;
+    requested_profile = profile;
+}
+
+uint8_t latency_profile_get(void) {
+    return requested_profile;
+}
+
+void latency_profile_service(void) {
+    uint8_t profile = requested_profile;
+    bool pdm = pdm_enabled;
+    if (planned && profile == active_profile && pdm == active_pdm) return;
+
+    uint8_t target = profile_fill_targets[profile];
+    if (pdm && target < PDM_MIN_TARGET) target = PDM_MIN_TARGET;
+
+    active_profile = profile;
+    active_pdm = pdm;
+    active_fill_target = target;
+    sub_align_samples = (int32_t)target * BUFFER_SAMPLES - PDM_BUFFER_SAMPLES;
+    planned = true;
+
+    fb_ctrl_set_fill_target(&fb_ctrl, target);
+#if ENABLE_ASRC
+    asrc_ctrl_set_fill_target(&asrc_ctrl, target);
+#endif
+    dsp_update_delay_samples((float)output_rate);
+}
+
+int32_t latency_profile_sub_align_samples(void) {
+    return sub_align_samples;
+}
+
+static uint32_t samples_to_us(uint32_t samples, uint32_t sample_rate) {
+    return (uint32_t)(((uint64_t)samples * 1000000u) / sample_rate);
+}
+
+void latency_profile_report(LatencyReportPacket *out, uint32_t sample_rate) {
+    if (sample_rate == 0) sample_rate = 48000;
+
+    uint32_t spdif_depth = (uint32_t)active_fill_target * BUFFER_SAMPLES;
+    uint32_t pdm_depth = (sub_align_samples > 0) ? spdif_depth : PDM_BUFFER_SAMPLES;
+
+    out->profile           = active_profile;
+    out->fill_target       = active_fill_target;
+    out->consumer_capacity = SPDIF_CONSUMER_BUFFER_COUNT;
+    out->consumer_fill     = spdif0_consumer_fill;
+    out->sub_align_samples = (int16_t)sub_align_samples;
+    out->buffer_samples    = BUFFER_SAMPLES;
+    out->sample_rate       = sample_rate;
+    uint32_t transit_us = USB_TRANSIT_US;
+#if ENABLE_ASRC
+    transit_us += rate_lock_latency_us();
+#endif
+    out->spdif_latency_us  = samples_to_us(spdif_depth, sample_rate) + transit_us;
+    out->pdm_latency_us    = samples_to_us(pdm_depth, sample_rate) + transit_us;
+}
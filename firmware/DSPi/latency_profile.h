@@ -0,0 +1,47 @@
+/*
+ * latency_profile.h — Selectable output latency profiles
+ *
+ * The only deep buffer between a USB packet and the outputs is the S/PDIF /
+ * I2S consumer pool, whose fill is held at a set point by the feedback servo.
+ * A latency profile moves that set point and re-derives the PDM sub
+ * alignment delay from it, so mains and sub stay aligned at every setting.
+ *
+ * Pool sizes are fixed across profiles; a profile re-plans no allocation.
+ * The consumer pools stay at SPDIF_CONSUMER_BUFFER_COUNT (16) buffers per
+ * instance, and the PDM ring and DMA buffer and the USB ring
+ * (usb_audio_ring.h) keep their compile-time sizes.  Resizing a consumer
+ * pool would mean tearing down running output instances.  A profile moves
+ * the set point inside the fixed pool, so what changes is the headroom
+ * above it for jitter: 12 buffers at ULTRA_LOW, 8 at BALANCED, 4 at SAFE.
+ * The USB ring is empty in steady state and adds no latency.
+ *
+ * Requests may come from the USB IRQ; the re-plan itself runs in the main
+ * loop via latency_profile_service().
+ */
+
+#ifndef LATENCY_PROFILE_H
+#define LATENCY_PROFILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+// Select a profile (LATENCY_PROFILE_*).  Out-of-range values select
+// BALANCED.  IRQ-safe; applied by the next latency_profile_service().
+void latency_profile_request(uint8_t profile);
+
+// Requested profile (what REQ_GET_LATENCY_PROFILE reports).
+uint8_t latency_profile_get(void);
+
+// Re-plan when the requested profile or the PDM sub state has changed:
+// moves the feedback fill target and updates delay lines for the new sub
+// alignment.  Main loop only.
+void latency_profile_service(void);
+
+// Delay added to the PDM sub path, in samples (SPDIF depth - PDM depth).
+int32_t latency_profile_sub_align_samples(void);
+
+// Fill in a latency report for the given sample rate.
+void latency_profile_report(LatencyReportPacket *out, uint32_t sample_rate);
+
+#endif // LATENCY_PROFILE_H
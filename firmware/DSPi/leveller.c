@@ -34,7 +34,7 @@ static const float speed_presets[LEVELLER_SPEED_COUNT][3] = {
 // Form A: env = alpha * env + (1-alpha) * x
 // alpha near 1.0 = slow, alpha near 0.0 = fast.
 // T is the 0%-to-90% step response time.
-static float compute_alpha(float sample_rate, float time_sec) {
+float leveller_time_alpha(float sample_rate, float time_sec) {
     if (time_sec <= 0.0f || sample_rate <= 0.0f) return 0.0f;
     return expf(-logf(10.0f) / (sample_rate * time_sec));
 }
@@ -54,9 +54,9 @@ void leveller_compute_coefficients(LevellerCoeffs *out,
     float rms_sec     = speed_presets[spd][2];
 
     // One-pole retention coefficients (Form A)
-    out->alpha_rms     = compute_alpha(sample_rate, rms_sec);
-    out->alpha_attack  = compute_alpha(sample_rate, attack_sec);
-    out->alpha_release = compute_alpha(sample_rate, release_sec);
+    out->alpha_rms     = leveller_time_alpha(sample_rate, rms_sec);
+    out->alpha_attack  = leveller_time_alpha(sample_rate, attack_sec);
+    out->alpha_release = leveller_time_alpha(sample_rate, release_sec);
 
     // Fixed compression curve parameters
     out->threshold_db      = LEVELLER_THRESHOLD_DB;
@@ -123,19 +123,7 @@ void leveller_reset_state(LevellerState *state) {
 
 static inline float gain_computer(float x_db, float threshold, float ratio,
                                   float knee_width) {
-    float half_knee = knee_width * 0.5f;
-
-    if (x_db > (threshold + half_knee)) {
-        // Above knee: no boost (leave loud content alone)
-        return 0.0f;
-    } else if (x_db >= (threshold - half_knee)) {
-        // Within soft knee: quadratic transition from boost to unity
-        float d = threshold + half_knee - x_db;
-        return (1.0f - 1.0f / ratio) * d * d / (2.0f * knee_width);
-    } else {
-        // Below knee: full upward compression
-        return (threshold - x_db) * (1.0f - 1.0f / ratio);
-    }
+    return leveller_gain_computer(threshold - x_db, 1.0f - 1.0f / ratio, knee_width);
 }
 
 // ---------------------------------------------------------------------------
@@ -192,12 +180,9 @@ void leveller_process_block(LevellerState *state,
     }
 
     // ---- Per-block: asymmetric gain smoothing ----
-    // alpha_attack/release are per-SAMPLE coefficients. Since we apply the
-    // smoother once per BLOCK, raise to the block size to get the correct
-    // per-block alpha. Without this, time constants are block_size× too slow.
     float alpha_sample = (gc_db < state->gain_smooth_db) ? coeffs->alpha_attack
                                                           : coeffs->alpha_release;
-    float alpha = powf(alpha_sample, (float)count);
+    float alpha = leveller_block_alpha(alpha_sample, count);
     state->gain_smooth_db = alpha * state->gain_smooth_db
                           + (1.0f - alpha) * gc_db;
 
@@ -321,10 +306,9 @@ void leveller_process_block(LevellerState *state,
     }
 
     // Asymmetric gain smoothing (float)
-    // Raise per-sample alpha to block size for correct per-block time constant
     float alpha_sample = (gc_db < state->gain_smooth_db) ? coeffs->alpha_attack
                                                           : coeffs->alpha_release;
-    float alpha = powf(alpha_sample, (float)count);
+    float alpha = leveller_block_alpha(alpha_sample, count);
     state->gain_smooth_db = alpha * state->gain_smooth_db
                           + (1.0f - alpha) * gc_db;
 
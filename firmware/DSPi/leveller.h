@@ -24,6 +24,7 @@
 #define LEVELLER_H
 
 #include "config.h"
+#include <math.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -145,6 +146,32 @@ void leveller_compute_coefficients(LevellerCoeffs *out,
                                    const LevellerConfig *cfg,
                                    float sample_rate);
 
+// One-pole retention coefficient (Form A) with a 0-90% step time of
+// time_sec.  Also used by the dynamic EQ detectors (dyneq.c).
+float leveller_time_alpha(float sample_rate, float time_sec);
+
+// Soft-knee gain computer, shared with the dynamic EQ and the multiband
+// compressor.  `over_db` is how far the level is past the threshold in the
+// direction the stage acts on (level - threshold for a downward compressor,
+// threshold - level for the leveller's upward one).  Returns the size of
+// the gain change in dB: 0 below the knee, slope * over_db above it, and a
+// quadratic blend across it.  slope = 1 - 1/ratio.  A zero knee is hard.
+static inline float leveller_gain_computer(float over_db, float slope, float knee_db) {
+    if (2.0f * over_db <= -knee_db) return 0.0f;
+    if (2.0f * over_db < knee_db) {
+        float d = over_db + 0.5f * knee_db;
+        return slope * d * d / (2.0f * knee_db);
+    }
+    return slope * over_db;
+}
+
+// Per-block smoothing coefficient.  alpha_attack/release are per-sample
+// coefficients; a smoother stepped once per block of `count` samples needs
+// alpha^count, or its time constants come out count times too slow.
+static inline float leveller_block_alpha(float alpha_sample, uint32_t count) {
+    return powf(alpha_sample, (float)count);
+}
+
 // Reset all runtime state to initial values (zero envelopes, unity gain,
 // clear lookahead buffer).  Called when leveller is enabled or lookahead toggled.
 void leveller_reset_state(LevellerState *state);
@@ -0,0 +1,274 @@
+/*
+ * limiter.c — Output true-peak limiter (RP2350)
+ *
+ * Timeline, with the detector tap LIMITER_LOOKAHEAD samples ahead of the
+ * output tap: when a segment boundary passes, the detector has seen enough
+ * to oversample the segment that the output tap reaches one segment later.
+ * The gain ramp over the coming segment ends at
+ *
+ *   min(required gain of the coming segment, of the one after, release)
+ *
+ * and started at a value that already respected the coming segment, so
+ * every sample's gain is within its own segment's requirement.
+ *
+ * Threading: settings are written by the main loop only, after taking the
+ * output out of limiter_active_mask or waiting for Core 1's block.  Core 0
+ * audio runs from the main loop itself.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "limiter.h"
+#include "dsp_math.h"
+#include "leveller.h"
+#include "pdm_generator.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#if ENABLE_LIMITER
+
+_Static_assert(sizeof(OutLimiterPacket) == 8, "OutLimiterPacket is a wire format");
+_Static_assert(sizeof(OutLimiterStatusPacket) == 16, "OutLimiterStatusPacket is a wire format");
+_Static_assert(NUM_OUTPUT_CHANNELS <= 16, "limiter_active_mask is 16 bits");
+_Static_assert((LIMITER_SEGMENT & (LIMITER_SEGMENT - 1)) == 0, "segment phase comes from the write index");
+_Static_assert(2 * LIMITER_HALF_TAPS + LIMITER_SEGMENT - 2 <= 2 * LIMITER_SEGMENT - 1,
+               "the last two segments' sample peaks cover the interpolator's reach");
+
+#define LIM_PHASES          3               // Inter-sample points at 1/4, 2/4, 3/4
+#define LIM_TAPS            (2 * LIMITER_HALF_TAPS)
+#define LIM_WINDOW          (2 * LIMITER_SEGMENT)   // Delay line read per oversampled segment
+
+typedef struct {
+    OutLimiterPacket cfg;           // cfg.enabled: limiter wanted; values clamped
+    float ceiling;                  // Linear
+    float release_seg;              // Release retention per segment
+    uint32_t rate;
+
+    // Runtime
+    float gain;                     // Applied to the next output sample
+    float step;                     // Per sample, to the end of this segment
+    float end;                      // Gain at the end of this segment
+    float required;                 // Required gain of the segment being output next
+    float peak, prev_peak;          // Detector tap sample peaks: this and the last segment
+} LimiterOut;
+
+static LimiterOut outs[NUM_OUTPUT_CHANNELS];
+static float interp[LIM_PHASES][LIM_TAPS];
+static float interp_bound;          // Largest sum of |taps| over the phases
+
+volatile uint16_t limiter_active_mask;
+
+// Requests (USB IRQ → main loop), bit per output
+static OutLimiterPacket req[NUM_OUTPUT_CHANNELS];
+static volatile uint16_t req_mask;
+
+static void reset_state(LimiterOut *l) {
+    l->gain = 1.0f;
+    l->step = 0.0f;
+    l->end = 1.0f;
+    l->required = 1.0f;
+    l->peak = l->prev_peak = 0.0f;
+}
+
+void limiter_init(void) {
+    // Lanczos-windowed sinc at 1/4, 2/4, 3/4 between samples, unity DC
+    // gain.  Window half-width H + 0.5: reads no low up to 0.375 Fs, and
+    // at most 0.55 dB low at 0.42 Fs.
+    const float a = (float)LIMITER_HALF_TAPS + 0.5f;
+    interp_bound = 0.0f;
+    for (int p = 0; p < LIM_PHASES; p++) {
+        float frac = (float)(p + 1) / (float)(LIM_PHASES + 1);
+        float sum = 0.0f, abs_sum = 0.0f;
+        for (int j = 0; j < LIM_TAPS; j++) {
+            float d = frac - (float)(j - (LIMITER_HALF_TAPS - 1));
+            float w = a * sinf(PI_F * d / a) / (PI_F * d);
+            interp[p][j] = w * sinf(PI_F * d) / (PI_F * d);
+            sum += interp[p][j];
+        }
+        for (int j = 0; j < LIM_TAPS; j++) {
+            interp[p][j] /= sum;
+            abs_sum += fabsf(interp[p][j]);
+        }
+        if (abs_sum > interp_bound) interp_bound = abs_sum;
+    }
+
+    memset(outs, 0, sizeof(outs));
+    for (int o = 0; o < NUM_OUTPUT_CHANNELS; o++) {
+        outs[o].cfg.output = (uint8_t)o;
+        outs[o].cfg.release_ms = 50;
+        outs[o].cfg.ceiling_db = -1.0f;
+        reset_state(&outs[o]);
+    }
+    limiter_active_mask = 0;
+    req_mask = 0;
+}
+
+// ----------------------------------------------------------------------------
+// AUDIO PATH
+// ----------------------------------------------------------------------------
+
+// Gain the segment ending at detector tap position `tap` requires: its
+// true peak against the ceiling.  The segment's samples and their
+// preceding inter-sample points end LIMITER_HALF_TAPS - 1 before the tap.
+DSP_TIME_CRITICAL
+static float segment_gain(const LimiterOut *l, const float *dline, uint32_t tap) {
+    float gate = l->peak > l->prev_peak ? l->peak : l->prev_peak;
+    if (gate * interp_bound <= l->ceiling) return 1.0f;
+
+    float x[LIM_WINDOW];
+    uint32_t first = tap - (LIM_WINDOW - 1);
+    for (int i = 0; i < LIM_WINDOW; i++) x[i] = dline[(first + i) & MAX_DELAY_MASK];
+
+    // Sample t, and the points between t - 1 and t from x[t - H .. t + H - 1]
+    const int last = LIM_WINDOW - LIMITER_HALF_TAPS;
+    float tp = 0.0f;
+    for (int t = last - LIMITER_SEGMENT + 1; t <= last; t++) {
+        float a = fabsf(x[t]);
+        if (a > tp) tp = a;
+        const float *s = &x[t - LIMITER_HALF_TAPS];
+        for (int p = 0; p < LIM_PHASES; p++) {
+            const float *h = interp[p];
+            float v = 0.0f;
+            for (int j = 0; j < LIM_TAPS; j++) v += h[j] * s[j];
+            a = fabsf(v);
+            if (a > tp) tp = a;
+        }
+    }
+    return tp > l->ceiling ? l->ceiling / tp : 1.0f;
+}
+
+DSP_TIME_CRITICAL
+void limiter_delay_block(uint8_t out, float *samples, float *dline, uint32_t widx,
+                         int32_t dly, uint32_t count) {
+    LimiterOut *l = &outs[out];
+    int32_t ahead = dly - LIMITER_LOOKAHEAD;
+    if (ahead < 0) ahead = 0;   // Delays not yet grown by the lookahead
+
+    float gain = l->gain, step = l->step, peak = l->peak;
+    for (uint32_t i = 0; i < count; i++) {
+        dline[widx] = samples[i];
+        float a = fabsf(dline[(widx - ahead) & MAX_DELAY_MASK]);
+        if (a > peak) peak = a;
+        samples[i] = dline[(widx - dly) & MAX_DELAY_MASK] * gain;
+        gain += step;
+
+        if (((widx + 1) & (LIMITER_SEGMENT - 1)) == 0) {
+            // Segment boundary: plan the ramp across the next segment
+            l->peak = peak;
+            float next = segment_gain(l, dline, (widx - ahead) & MAX_DELAY_MASK);
+            gain = l->end;
+            float end = gain + (1.0f - gain) * (1.0f - l->release_seg);
+            if (l->required < end) end = l->required;
+            if (next < end) end = next;
+            step = (end - gain) * (1.0f / LIMITER_SEGMENT);
+            l->end = end;
+            l->required = next;
+            l->prev_peak = peak;
+            peak = 0.0f;
+        }
+        widx = (widx + 1) & MAX_DELAY_MASK;
+    }
+    l->gain = gain;
+    l->step = step;
+    l->peak = peak;
+}
+
+int32_t limiter_latency_samples(void) {
+    for (int o = 0; o < NUM_OUTPUT_CHANNELS; o++) {
+        if (outs[o].cfg.enabled) return LIMITER_LOOKAHEAD;
+    }
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+// VENDOR REQUESTS (USB IRQ)
+// ----------------------------------------------------------------------------
+
+void limiter_request(const OutLimiterPacket *pkt) {
+    if (pkt->output >= NUM_OUTPUT_CHANNELS) return;
+    req[pkt->output] = *pkt;
+    __dmb();
+    req_mask |= (uint16_t)(1u << pkt->output);
+}
+
+bool limiter_get_status(uint8_t out, OutLimiterStatusPacket *pkt) {
+    if (out >= NUM_OUTPUT_CHANNELS) return false;
+    const LimiterOut *l = &outs[out];
+    memset(pkt, 0, sizeof(*pkt));
+    pkt->config = l->cfg;
+    pkt->config.output = out;
+    pkt->active = (limiter_active_mask & (1u << out)) ? 1 : 0;
+    pkt->lookahead_samples = (uint16_t)limiter_latency_samples();
+    pkt->gain_db = pkt->active ? 20.0f * log10f(l->gain + 1e-30f) : 0.0f;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// MAIN LOOP
+// ----------------------------------------------------------------------------
+
+static void design(LimiterOut *l, uint32_t rate) {
+    float alpha = leveller_time_alpha((float)rate, l->cfg.release_ms * 0.001f);
+    l->release_seg = powf(alpha, (float)LIMITER_SEGMENT);
+    l->ceiling = expf(l->cfg.ceiling_db * LN10_OVER_20);
+    l->rate = rate;
+}
+
+static void apply_request(const OutLimiterPacket *pkt, uint32_t rate) {
+    uint8_t o = pkt->output;
+    LimiterOut *l = &outs[o];
+    uint16_t bit = (uint16_t)(1u << o);
+
+    if (limiter_active_mask & bit) {
+        limiter_active_mask &= (uint16_t)~bit;
+        core1_wait_block();
+    }
+    l->cfg = *pkt;
+    l->cfg.enabled = pkt->enabled ? 1 : 0;
+    if (!(l->cfg.ceiling_db >= -24.0f)) l->cfg.ceiling_db = -24.0f;
+    if (l->cfg.ceiling_db > 0.0f) l->cfg.ceiling_db = 0.0f;
+    if (l->cfg.release_ms < 1) l->cfg.release_ms = 1;
+    if (l->cfg.release_ms > 1000) l->cfg.release_ms = 1000;
+    design(l, rate);
+    if (!l->cfg.enabled) return;
+
+    reset_state(l);
+    __dmb();
+    limiter_active_mask |= bit;
+}
+
+bool limiter_service(uint32_t sample_rate) {
+    int32_t latency = limiter_latency_samples();
+
+    if (req_mask) {
+        uint32_t flags = save_and_disable_interrupts();
+        uint16_t mask = req_mask;
+        OutLimiterPacket pkts[NUM_OUTPUT_CHANNELS];
+        memcpy(pkts, req, sizeof(pkts));
+        req_mask = 0;
+        restore_interrupts(flags);
+
+        for (uint8_t o = 0; o < NUM_OUTPUT_CHANNELS; o++) {
+            if (mask & (1u << o)) apply_request(&pkts[o], sample_rate);
+        }
+    }
+
+    for (uint8_t o = 0; o < NUM_OUTPUT_CHANNELS; o++) {
+        LimiterOut *l = &outs[o];
+        if (!l->cfg.enabled || l->rate == sample_rate) continue;
+        core1_wait_block();
+        design(l, sample_rate);
+    }
+
+    return limiter_latency_samples() != latency;
+}
+
+uint16_t limiter_enabled_mask(void) {
+    uint16_t mask = 0;
+    for (int o = 0; o < NUM_OUTPUT_CHANNELS; o++) {
+        if (outs[o].cfg.enabled) mask |= (uint16_t)(1u << o);
+    }
+    return mask;
+}
+
+#endif // ENABLE_LIMITER
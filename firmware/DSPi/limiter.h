@@ -0,0 +1,69 @@
+/*
+ * limiter.h — Output true-peak limiter (RP2350)
+ *
+ * A brickwall limiter per output that keeps inter-sample peaks under a
+ * ceiling, so a DAC's reconstruction filter or a driver never sees an
+ * over that the sample values hide.  It runs in the output's delay stage
+ * and uses the delay line as its lookahead buffer: the output tap is the
+ * usual delay, and a detector tap LIMITER_LOOKAHEAD samples newer feeds
+ * the detector.  While any limiter is on, every output's delay grows by
+ * LIMITER_LOOKAHEAD (dsp_delay_samples_for()) so the outputs stay aligned.
+ *
+ * Detector, decimated to segments of LIMITER_SEGMENT samples:
+ *   - per sample only the detector tap's magnitude is tracked
+ *   - per segment, if the sample peak around it times the interpolator's
+ *     worst-case gain is under the ceiling no over is possible; otherwise
+ *     the segment is 4x oversampled (12-tap polyphase windowed sinc, three
+ *     phases between each pair of samples) from the delay line
+ *   - the segment's required gain sets the end point of a linear gain ramp
+ *     across the next segment of output, so each output sample's gain is
+ *     at most the gain its own segment requires; recovery is exponential
+ *     at release_ms
+ *
+ * Lookahead is 37 samples (0.77 ms at 48 kHz): two segments plus the
+ * interpolator's half length.  The hard clamp at packing stays as the last
+ * resort.  During a scene morph the delay crossfade runs instead and the
+ * limiter holds its gain.
+ */
+
+#ifndef LIMITER_H
+#define LIMITER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+#if ENABLE_LIMITER
+
+#define LIMITER_SEGMENT     16      // Power of two
+#define LIMITER_HALF_TAPS   6       // Interpolator taps each side of an inter-sample point
+#define LIMITER_LOOKAHEAD   (2 * LIMITER_SEGMENT + LIMITER_HALF_TAPS - 1)
+
+// Audio path: outputs whose delay stage runs the limiter.
+extern volatile uint16_t limiter_active_mask;
+
+void limiter_init(void);
+
+// Either core: the delay stage of a limited output.  Writes the block into
+// the delay line at widx, reads it back dly samples late with the
+// limiter's gain applied.
+void limiter_delay_block(uint8_t out, float *samples, float *dline, uint32_t widx,
+                         int32_t dly, uint32_t count);
+
+// Samples added to every output's delay (0 while no limiter is enabled).
+int32_t limiter_latency_samples(void);
+
+// Vendor requests (USB IRQ).  Sets are applied by limiter_service().
+void limiter_request(const OutLimiterPacket *req);
+bool limiter_get_status(uint8_t out, OutLimiterStatusPacket *pkt);
+
+// Main loop: apply pending requests and follow the sample rate.  Returns
+// true if the lookahead was added to or removed from the output delays.
+bool limiter_service(uint32_t sample_rate);
+
+// For the cost estimate: bit per output with an enabled limiter.
+uint16_t limiter_enabled_mask(void);
+
+#endif // ENABLE_LIMITER
+
+#endif // LIMITER_H
@@ -0,0 +1,212 @@
+/*
+ * loopback.c — Device-to-host loopback capture
+ *
+ * The ring holds 24-bit frames of the selected pair; ring_w is advanced by
+ * loopback_push() only, ring_r by the IN packet handler only, both
+ * free-running.  Rate or alt changes from the host flush the ring from the
+ * reader side (ring_r = ring_w) and re-prime.
+ *
+ * The fill target is LOOPBACK_FILL_MS at the capture rate, capped at half
+ * the ring so a whole audio packet always fits above it.  Pushes arrive one
+ * audio packet (~1 ms) at a time, so the measured fill is a sawtooth; the
+ * pacer's IIR filters it before the servo sees it.
+ */
+
+#include <string.h>
+#include <math.h>
+#include "loopback.h"
+#include "usb_audio.h"
+#include "usb_descriptors.h"
+#include "usb_feedback_controller.h"
+#include "rate_lock.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#if ENABLE_LOOPBACK
+
+_Static_assert(sizeof(LoopbackStatusPacket) == 24, "LoopbackStatusPacket is a wire format");
+_Static_assert((LOOPBACK_RING_FRAMES & (LOOPBACK_RING_FRAMES - 1)) == 0, "LOOPBACK_RING_FRAMES must be a power of 2");
+_Static_assert(LOOPBACK_RING_FRAMES / 2 >= AUDIO_BUFFER_SAMPLES, "A whole audio packet must fit above the fill target");
+
+#define RING_MASK   (LOOPBACK_RING_FRAMES - 1)
+
+extern usb_feedback_ctrl_t fb_ctrl;
+
+static int32_t ring[LOOPBACK_RING_FRAMES][2];
+static volatile uint32_t ring_w, ring_r;
+
+static volatile uint8_t lb_alt = 0;
+static volatile uint32_t lb_rate = 48000;
+static volatile LoopbackSrcPacket lb_src = { .left = 0, .right = 1 };
+
+// USB IRQ only
+static usb_capture_pacer_t pacer;
+static bool primed = false;
+static uint8_t lb_state = LOOPBACK_STATE_IDLE;
+static uint32_t lb_underruns;
+
+static uint32_t lb_overruns;        // Main loop
+
+static uint32_t fill_target_for(uint32_t rate) {
+    uint32_t t = rate * LOOPBACK_FILL_MS / 1000;
+    return t < LOOPBACK_RING_FRAMES / 2 ? t : LOOPBACK_RING_FRAMES / 2;
+}
+
+// Flush and re-prime.  USB IRQ (reader side).
+static void restart(void) {
+    ring_r = ring_w;
+    primed = false;
+    fb_pace_reset(&pacer, fill_target_for(lb_rate));
+}
+
+void loopback_init(void) {
+    ring_w = ring_r = 0;
+    restart();
+}
+
+bool loopback_set_alt(uint8_t alt) {
+    if (alt > 2) return false;
+    if (alt != lb_alt) {
+        lb_alt = alt;
+        restart();
+    }
+    return true;
+}
+
+void loopback_set_rate(uint32_t rate) {
+    if (rate == lb_rate || rate > LOOPBACK_RATE_MAX || !audio_rate_supported(rate)) return;
+    lb_rate = rate;
+    restart();
+}
+
+uint32_t loopback_get_rate(void) {
+    return lb_rate;
+}
+
+bool loopback_set_src(const LoopbackSrcPacket *src) {
+    if (src->left >= NUM_OUTPUT_CHANNELS || src->right >= NUM_OUTPUT_CHANNELS) return false;
+    lb_src.left = src->left;
+    lb_src.right = src->right;
+    return true;
+}
+
+#if PICO_RP2350
+void __not_in_flash_func(loopback_push)(const float buf_out[][AUDIO_BUFFER_SAMPLES], uint32_t count) {
+#else
+void __not_in_flash_func(loopback_push)(const int32_t buf_out[][AUDIO_BUFFER_SAMPLES], uint32_t count) {
+#endif
+    if (!lb_alt || lb_rate != output_rate) return;
+
+    uint32_t w = ring_w;
+    uint32_t space = LOOPBACK_RING_FRAMES - (w - ring_r);
+    if (count > space) {
+        lb_overruns += count - space;
+        count = space;
+    }
+
+#if PICO_RP2350
+    const float *l = buf_out[lb_src.left];
+    const float *r = buf_out[lb_src.right];
+    for (uint32_t i = 0; i < count; i++) {
+        int32_t *f = ring[(w + i) & RING_MASK];
+        f[0] = (int32_t)(fmaxf(-1.0f, fminf(1.0f, l[i])) * 8388607.0f);
+        f[1] = (int32_t)(fmaxf(-1.0f, fminf(1.0f, r[i])) * 8388607.0f);
+    }
+#else
+    const int32_t *l = buf_out[lb_src.left];
+    const int32_t *r = buf_out[lb_src.right];
+    for (uint32_t i = 0; i < count; i++) {
+        int32_t *f = ring[(w + i) & RING_MASK];
+        f[0] = clip_s24((l[i] + (1 << 5)) >> 6);
+        f[1] = clip_s24((r[i] + (1 << 5)) >> 6);
+    }
+#endif
+
+    __dmb();
+    ring_w = w + count;
+}
+
+// Loop A: output samples per host frame
+static uint32_t output_rate_q16(void) {
+#if ENABLE_ASRC
+    if (asrc_active) return asrc_ctrl.out_rate_q16;
+#endif
+    if (fb_ctrl.rate_valid) return fb_ctrl.rate_estimate_q16;
+    return (uint32_t)(((uint64_t)lb_rate << 16) / 1000);
+}
+
+uint32_t __not_in_flash_func(loopback_fill_packet)(uint8_t *dst, uint32_t max_bytes) {
+    uint8_t alt = lb_alt;
+    if (!alt) {
+        lb_state = LOOPBACK_STATE_IDLE;
+        return 0;
+    }
+    uint32_t frame_bytes = (alt == 2) ? 6 : 4;
+
+    uint32_t w = ring_w;
+    __dmb();
+    uint32_t r = ring_r;
+    uint32_t fill = w - r;
+
+    uint32_t n;
+    uint32_t take = 0;
+    if (lb_rate != output_rate) {
+        // Keep the host fed at its nominal rate; nothing is queued
+        lb_state = LOOPBACK_STATE_RATE_MISMATCH;
+        r = w;
+        primed = false;
+        n = fb_pace_packet(&pacer, (uint32_t)(((uint64_t)lb_rate << 16) / 1000), pacer.fill_target);
+    } else if (!primed) {
+        lb_state = LOOPBACK_STATE_PRIMING;
+        n = fb_pace_packet(&pacer, output_rate_q16(), pacer.fill_target);
+        if (fill >= pacer.fill_target) primed = true;
+    } else {
+        lb_state = LOOPBACK_STATE_RUNNING;
+        n = fb_pace_packet(&pacer, output_rate_q16(), fill);
+        take = n;
+        if (take > fill) {
+            lb_underruns += take - fill;
+            take = fill;
+            primed = false;
+        }
+    }
+    if (n > max_bytes / frame_bytes) n = max_bytes / frame_bytes;
+    if (take > n) take = n;
+
+    for (uint32_t i = 0; i < take; i++) {
+        const int32_t *f = ring[(r + i) & RING_MASK];
+        if (alt == 2) {
+            for (int c = 0; c < 2; c++) {
+                *dst++ = (uint8_t)f[c];
+                *dst++ = (uint8_t)(f[c] >> 8);
+                *dst++ = (uint8_t)(f[c] >> 16);
+            }
+        } else {
+            for (int c = 0; c < 2; c++) {
+                *dst++ = (uint8_t)(f[c] >> 8);
+                *dst++ = (uint8_t)(f[c] >> 16);
+            }
+        }
+    }
+    memset(dst, 0, (n - take) * frame_bytes);
+
+    __dmb();
+    ring_r = r + take;
+    return n * frame_bytes;
+}
+
+void loopback_get_status(LoopbackStatusPacket *pkt) {
+    memset(pkt, 0, sizeof(*pkt));
+    pkt->src.left    = lb_src.left;
+    pkt->src.right   = lb_src.right;
+    pkt->state       = lb_alt ? lb_state : LOOPBACK_STATE_IDLE;
+    pkt->bit_depth   = lb_alt == 2 ? 24 : lb_alt == 1 ? 16 : 0;
+    pkt->rate        = lb_rate;
+    pkt->output_rate = output_rate;
+    pkt->fill        = (uint16_t)(ring_w - ring_r);
+    pkt->fill_target = (uint16_t)pacer.fill_target;
+    pkt->overruns    = lb_overruns;
+    pkt->underruns   = lb_underruns;
+}
+
+#endif // ENABLE_LOOPBACK
@@ -0,0 +1,63 @@
+/*
+ * loopback.h — Device-to-host loopback capture
+ *
+ * A second streaming interface (ITF_NUM_LOOPBACK, iso IN on
+ * LOOPBACK_ENDPOINT) returns a selectable pair of processed outputs to the
+ * host, tapped from buf_out after EQ, delay and limiting, just before the
+ * outputs are packed.  The tap is a copy of two blocks already in memory;
+ * the pipeline itself does no extra work, and none at all while the host
+ * has the interface at alt 0.
+ *
+ * The outputs run on the device clock, so the stream is paced like the
+ * feedback endpoint: the Loop A estimate of output samples per host frame
+ * (fb_ctrl, or asrc_ctrl while the rate lock resamples) sets the samples per
+ * packet, and a fill servo on the capture ring trims it (fb_pace_packet()).
+ * The stream is silence while the ring primes and while the host's capture
+ * rate differs from the output rate.
+ *
+ * Threading: loopback_push() runs in the main loop after the output stages;
+ * everything else runs in the USB IRQ on the same core.  The ring is
+ * single-producer, single-consumer.
+ */
+
+#ifndef LOOPBACK_H
+#define LOOPBACK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+#if ENABLE_LOOPBACK
+
+void loopback_init(void);
+
+// USB IRQ: host selected alt (0 idle, 1 16-bit, 2 24-bit).  Returns false
+// for alts the interface does not have.
+bool loopback_set_alt(uint8_t alt);
+
+// USB IRQ: sampling frequency control on LOOPBACK_ENDPOINT.  Rates above
+// LOOPBACK_RATE_MAX (usb_descriptors.h) are ignored.
+void loopback_set_rate(uint32_t rate);
+uint32_t loopback_get_rate(void);
+
+// Select the outputs captured as left / right.  Returns false for indices
+// past NUM_OUTPUT_CHANNELS.  IRQ-safe.
+bool loopback_set_src(const LoopbackSrcPacket *src);
+
+// Main loop, once per audio packet after the output stages: queue count
+// frames of the selected outputs.
+#if PICO_RP2350
+void loopback_push(const float buf_out[][AUDIO_BUFFER_SAMPLES], uint32_t count);
+#else
+void loopback_push(const int32_t buf_out[][AUDIO_BUFFER_SAMPLES], uint32_t count);
+#endif
+
+// USB IRQ, once per IN packet: write the next packet to dst (at most
+// max_bytes) and return its length in bytes.
+uint32_t loopback_fill_packet(uint8_t *dst, uint32_t max_bytes);
+
+void loopback_get_status(LoopbackStatusPacket *pkt);
+
+#endif // ENABLE_LOOPBACK
+
+#endif // LOOPBACK_H
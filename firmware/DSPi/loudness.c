@@ -166,22 +166,25 @@ static void compute_shelf_coeffs(float freq, float Q, float gain_db,
 // Table Recomputation (called from main loop, not time-critical)
 // ----------------------------------------------------------------------------
 
-void loudness_recompute_table(float ref_spl, float intensity_pct, float sample_rate) {
+void loudness_compute_table(LoudnessCoeffs (*table)[LOUDNESS_BIQUAD_COUNT],
+                            float ref_spl, float intensity_pct, float sample_rate,
+                            int first_step, int step_count) {
     if (sample_rate < 1.0f) sample_rate = 48000.0f;
 
     // Clamp ref_spl to valid range
     if (ref_spl < 40.0f) ref_spl = 40.0f;
     if (ref_spl > 100.0f) ref_spl = 100.0f;
 
-    // Write into the INACTIVE buffer
-    uint8_t write_buf = 1 - active_buf;
+    int end_step = first_step + step_count;
+    if (first_step < 0) first_step = 0;
+    if (end_step > LOUDNESS_VOL_STEPS) end_step = LOUDNESS_VOL_STEPS;
 
     // Low shelf: fc=200 Hz, Q=0.707
     // High shelf: fc=6000 Hz, Q=0.707
     static const float shelf_freq[2] = { 200.0f, 6000.0f };
     static const float shelf_Q = 0.707f;
 
-    for (int vol_idx = 0; vol_idx < LOUDNESS_VOL_STEPS; vol_idx++) {
+    for (int vol_idx = first_step; vol_idx < end_step; vol_idx++) {
         // Volume in dB: index 0 = -60 dB (silent), index 60 = 0 dB
         float vol_db = (float)(vol_idx - 60);
 
@@ -203,15 +206,33 @@ void loudness_recompute_table(float ref_spl, float intensity_pct, float sample_r
         // Compute low shelf biquad coefficients
         compute_shelf_coeffs(shelf_freq[0], shelf_Q, low_gain_db,
                            0, sample_rate,
-                           &loudness_tables[write_buf][vol_idx][0]);
+                           &table[vol_idx][0]);
 
         // Compute high shelf biquad coefficients
         compute_shelf_coeffs(shelf_freq[1], shelf_Q, high_gain_db,
                            1, sample_rate,
-                           &loudness_tables[write_buf][vol_idx][1]);
+                           &table[vol_idx][1]);
     }
+}
+
+void loudness_recompute_table(float ref_spl, float intensity_pct, float sample_rate) {
+    // Write into the INACTIVE buffer
+    uint8_t write_buf = 1 - active_buf;
+
+    loudness_compute_table(loudness_tables[write_buf], ref_spl, intensity_pct,
+                           sample_rate, 0, LOUDNESS_VOL_STEPS);
 
     // Atomic swap: update active table pointer
     active_buf = write_buf;
     loudness_active_table = loudness_tables[active_buf];
 }
+
+void loudness_install_table(const LoudnessCoeffs (*table)[LOUDNESS_BIQUAD_COUNT]) {
+    // Same double-buffer discipline as a recompute: the copy lands in the
+    // inactive buffer, so the audio path never sees a half-written table.
+    uint8_t write_buf = 1 - active_buf;
+    memcpy(loudness_tables[write_buf], table, sizeof(loudness_tables[0]));
+
+    active_buf = write_buf;
+    loudness_active_table = loudness_tables[active_buf];
+}
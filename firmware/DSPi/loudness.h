@@ -30,4 +30,14 @@ extern LoudnessCoeffs (*loudness_active_table)[LOUDNESS_BIQUAD_COUNT];
 // Called from main loop on: boot, ref SPL change, intensity change, sample rate change
 void loudness_recompute_table(float ref_spl, float intensity_pct, float sample_rate);
 
+// Compute volume steps [first_step, first_step + step_count) into a caller-owned
+// table.  Does not touch the active table; used by the per-rate coefficient cache
+// to build tables incrementally from idle main-loop time.
+void loudness_compute_table(LoudnessCoeffs (*table)[LOUDNESS_BIQUAD_COUNT],
+                            float ref_spl, float intensity_pct, float sample_rate,
+                            int first_step, int step_count);
+
+// Copy a precomputed table into the inactive buffer and swap it in
+void loudness_install_table(const LoudnessCoeffs (*table)[LOUDNESS_BIQUAD_COUNT]);
+
 #endif // LOUDNESS_H
@@ -20,6 +20,7 @@
 #include "dsp_pipeline.h"
 #include "flash_clkdiv.h"
 #include "flash_storage.h"
+#include "flash_writer.h"
 #include "pico/audio_i2s_multi.h"
 #include "pdm_generator.h"
 #include "usb_audio.h"
@@ -27,6 +28,17 @@
 #include "crossfeed.h"
 #include "leveller.h"
 #include "bulk_params.h"
+#include "coeff_cache.h"
+#include "latency_profile.h"
+#include "scene_morph.h"
+#include "event_trace.h"
+#include "config_cost.h"
+#include "fir_bank.h"
+#include "filter_cascade.h"
+#include "dyneq.h"
+#include "multiband.h"
+#include "limiter.h"
+#include "rate_lock.h"
 #include "pico/audio_spdif.h"
 #include "usb_feedback_controller.h"
 
@@ -81,6 +93,15 @@ void __not_in_flash_func(usb_sof_irq)(void) {
     uint32_t remaining = dma_channel_hw_addr(dma_ch)->transfer_count;
     uint32_t current_total = *p_words_consumed + (xfer_words - remaining);
 
+#if ENABLE_ASRC
+    // Rate lock: the ASRC ratio follows the host clock and the feedback
+    // endpoint stays at the nominal USB rate
+    if (asrc_active) {
+        asrc_ctrl_sof_update(&asrc_ctrl, current_total, rate_shift, spdif0_consumer_fill);
+        return;
+    }
+#endif
+
     fb_ctrl_sof_update(&fb_ctrl, current_total, rate_shift, spdif0_consumer_fill);
 
     // Publish to endpoint-facing variables
@@ -118,43 +139,235 @@ extern LevellerState leveller_state;
 
 static void reset_usb_feedback_loop(void);
 
-// 96 kHz + 256x (24.576 MHz MCK) is unstable on current hardware/clocking, so
-// force 128x whenever that combination is encountered from persisted state.
+// 88.2 / 96 kHz + 256x (22.5792 / 24.576 MHz MCK) is unstable on current
+// hardware/clocking, so force 128x whenever that combination is encountered
+// from persisted state.
 static void sanitize_mck_multiplier_for_rate(uint32_t sample_rate_hz) {
     extern uint16_t i2s_mck_multiplier;
-    if (sample_rate_hz >= 96000u && i2s_mck_multiplier == 256u) {
+    if (sample_rate_hz >= 88200u && i2s_mck_multiplier == 256u) {
         i2s_mck_multiplier = 128u;
         printf("MCK 256x not supported at %lu Hz; forcing 128x\n",
                (unsigned long)sample_rate_hz);
     }
 }
 
-static void perform_rate_change(uint32_t new_freq) {
-    switch (new_freq) { case 44100: case 48000: case 96000: break; default: new_freq = 44100; }
+// ---------------------------------------------------------------------------
+// Configuration cost checks (config_cost.h)
+//
+// REQ_SET_ALL_PARAMS payloads are estimated before they are applied, and
+// preset loads and rate changes from the live state afterwards.  Either
+// way a predicted overrun is only reported: the kernel costs are not yet
+// calibrated on the target, and the feature gate and deadline monitor
+// handle what really overruns.
+// ---------------------------------------------------------------------------
+
+// FIR filters are loaded separately and survive REQ_SET_ALL_PARAMS and
+// preset loads, so every estimate takes them from the live bank.
+static void cost_config_add_fir(CostConfig *cfg) {
+#if ENABLE_FIR
+    for (int o = 0; o < NUM_OUTPUT_CHANNELS; o++) {
+        cfg->fir_partitions[o] = (uint8_t)fir_active_partitions(o);
+        cfg->xover_taps[o] = fir_xover_taps(o);
+    }
+#else
+    (void)cfg;
+#endif
+}
+
+// Dynamic EQ settings are not part of a wire image either
+static void cost_config_add_dyneq(CostConfig *cfg) {
+#if ENABLE_DYNEQ
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) cfg->dyn_bands[ch] = dyneq_channel_bands(ch);
+#else
+    (void)cfg;
+#endif
+}
+
+static void cost_config_add_multiband(CostConfig *cfg) {
+#if ENABLE_MULTIBAND
+    cfg->mb_master_bands = multiband_master_bands();
+    for (int o = 0; o < NUM_OUTPUT_CHANNELS; o++) cfg->mb_output_bands[o] = multiband_output_bands(o);
+#else
+    (void)cfg;
+#endif
+}
+
+// A limited output runs the limiter in place of its delay, and every
+// enabled output then carries the lookahead as delay
+static void cost_config_add_limiter(CostConfig *cfg) {
+#if ENABLE_LIMITER
+    cfg->output_limited = limiter_enabled_mask() & cfg->output_enabled;
+    if (limiter_latency_samples() > 0) cfg->output_delayed |= cfg->output_enabled;
+#else
+    (void)cfg;
+#endif
+}
+
+// The ASRC runs per output sample ahead of the master EQ
+static void cost_config_add_asrc(CostConfig *cfg) {
+#if ENABLE_ASRC
+    cfg->asrc = asrc_active;
+#else
+    (void)cfg;
+#endif
+}
+
+static void cost_config_from_live(CostConfig *out) {
+    memset(out, 0, sizeof(*out));
+#if PICO_RP2350
+    out->platform_id = WIRE_PLATFORM_RP2350;
+#else
+    out->platform_id = WIRE_PLATFORM_RP2040;
+#endif
+    out->num_channels = NUM_CHANNELS;
+    out->num_outputs = NUM_OUTPUT_CHANNELS;
+
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+#if PICO_RP2350
+        if (bypass_master_eq && ch < CH_OUT_1) continue;
+#else
+        if (bypass_master_eq) continue;   // RP2040 bypass also skips output EQ
+#endif
+        if (channel_bypassed[ch]) continue;
+        for (int b = 0; b < channel_band_counts[ch]; b++) {
+            const Biquad *bq = &filters[ch][b];
+            if (bq->bypass) continue;
+#if PICO_RP2350
+            if (bq->use_svf) { out->svf_bands[ch]++; continue; }
+#endif
+            out->biquad_bands[ch]++;
+        }
+    }
+
+    for (int o = 0; o < NUM_OUTPUT_CHANNELS; o++) {
+        if (!matrix_mixer.outputs[o].enabled) continue;
+        out->output_enabled |= (uint16_t)(1u << o);
+        if (!matrix_mixer.outputs[o].mute) out->output_eq |= (uint16_t)(1u << o);
+        if (o < NUM_DELAY_CHANNELS && channel_delay_samples[o] > 0) out->output_delayed |= (uint16_t)(1u << o);
+        for (int i = 0; i < NUM_INPUT_CHANNELS; i++) {
+            if (matrix_mixer.crosspoints[i][o].enabled) out->crosspoints++;
+        }
+    }
+    for (int i = NUM_MASTER_INPUTS; i < NUM_INPUT_CHANNELS; i++) {
+        for (int o = 0; o < NUM_OUTPUT_CHANNELS; o++) {
+            if (matrix_mixer.outputs[o].enabled && matrix_mixer.crosspoints[i][o].enabled) {
+                out->aux_inputs++;
+                break;
+            }
+        }
+    }
+
+    out->loudness = loudness_enabled;
+    out->crossfeed = crossfeed_config.enabled;
+    out->leveller = leveller_config.enabled;
+    out->leveller_lookahead = leveller_config.enabled && leveller_config.lookahead;
+    cost_config_add_fir(out);
+    cost_config_add_dyneq(out);
+    cost_config_add_multiband(out);
+    cost_config_add_limiter(out);
+    cost_config_add_asrc(out);
+}
+
+static void config_cost_publish(uint8_t source, const CostEstimate *est, uint32_t rate, bool applied) {
+    volatile ConfigCostPacket *r = &config_cost_report;
+    r->source = source;
+    r->result = est->result;
+    r->core1_mode = est->core1_mode;
+    r->applied = applied;
+    r->sample_rate = rate;
+    r->clk_sys_hz = clock_get_hz(clk_sys);
+    r->core0_cycles = est->core0_cycles;
+    r->core1_cycles = est->core1_cycles;
+    r->critical_cycles = est->critical_cycles;
+    r->budget_cycles = est->budget_cycles;
+    r->core0_permille = est->core0_permille;
+    r->core1_permille = est->core1_permille;
+    r->critical_permille = est->critical_permille;
+    r->sequence++;
+
+    trace_event(TRACE_EVT_CONFIG_COST, est->result | ((uint32_t)source << 8) |
+                                       ((uint32_t)est->critical_permille << 16));
+    if (est->result != COST_RESULT_OK) {
+        printf("Config cost: source=%u result=%u critical=%u/1000%s\n",
+               (unsigned)source, (unsigned)est->result, (unsigned)est->critical_permille,
+               applied ? "" : " (not applied)");
+    }
+}
+
+// Shed what the live configuration cannot run at the output rate
+// (config_cost_gate()).  The audio path bypasses the gated stages while
+// their settings stay as they are, so they come back once they fit again.
+// A gated PDM sub also takes Core 1 out of PDM mode.  est is the estimate
+// of what still runs.
+static void feature_gate_update(CostEstimate *est) {
+    CostConfig cfg;
+    CostEstimate ungated;
+    uint32_t clk = clock_get_hz(clk_sys);
+    cost_config_from_live(&cfg);
+    config_cost_estimate(&cfg, output_rate, clk, &ungated);
+    uint8_t gate = config_cost_gate(&cfg, output_rate, clk, est);
+    if (output_rate > SPDIF_RATE_MAX) gate |= COST_GATE_SPDIF_RATE;
+
+    volatile FeatureGatePacket *r = &feature_gate_report;
+    r->result = est->result;
+    r->ungated_permille = ungated.critical_permille;
+    r->gated_permille = est->critical_permille;
+    r->sample_rate = output_rate;
+    if (gate == feature_gate) return;
+
+    bool pdm_changed = ((gate ^ feature_gate) & COST_GATE_PDM) != 0;
+    feature_gate = gate;
+    r->gated = gate;
+    r->sequence++;
+    printf("Feature gate: 0x%02x at %lu Hz (critical %u/1000 as configured, %u/1000 gated)\n",
+           (unsigned)gate, (unsigned long)output_rate,
+           (unsigned)ungated.critical_permille, (unsigned)est->critical_permille);
+
+    if (pdm_changed) {
+        Core1Mode new_mode = derive_core1_mode();
+        if (new_mode != core1_mode) {
+            core1_mode = new_mode;
+#if ENABLE_SUB
+            pdm_set_enabled(new_mode == CORE1_MODE_PDM);
+#endif
+            __sev();
+        }
+    }
+}
+
+// Estimate the live configuration, gate it and publish the result.
+static void config_cost_check_live(uint8_t source) {
+    CostEstimate est;
+    feature_gate_update(&est);
+    config_cost_publish(source, &est, output_rate, true);
+}
+
+// Move the DSP pipeline and every output to a new rate.
+static void retune_outputs(uint32_t new_freq) {
+    // A running scene morph holds a bank designed for the old rate
+    scene_morph_cancel();
 
     // Update the audio format so pico_audio_spdif can update the PIO divider
     audio_format_48k.sample_freq = new_freq;
+    output_rate = new_freq;
 
 #if PICO_RP2350
     // RP2350: 307.2MHz fixed (VCO 1536 / 5 / 1) — no clock switching
 #else
     // RP2040: 307.2MHz fixed (VCO 1536 / 5 / 1) — no clock switching
 #endif
-    // Reset sync
-    extern volatile bool sync_started;
-    extern volatile uint64_t total_samples_produced;
-    sync_started = false;
-    total_samples_produced = 0;
-
-    // Pre-compute nominal feedback and reset controller
-    nominal_feedback_10_14 = ((uint64_t)new_freq << 14) / 1000;
-    feedback_10_14 = nominal_feedback_10_14;
-    reset_usb_feedback_loop();
 
-    dsp_recalculate_all_filters((float)new_freq);
-    loudness_recompute_pending = true;
-    crossfeed_update_pending = true;  // Recalculate crossfeed coefficients for new sample rate
-    leveller_update_pending = true;   // Recalculate leveller coefficients for new sample rate
+    // Fast path: install the background-built coefficient bank for this rate.
+    // Falls back to the full inline recalculation if parameters changed since
+    // the bank was built (or it has not finished building yet).
+    if (coeff_cache_apply(new_freq)) {
+        dsp_update_delay_samples((float)new_freq);
+    } else {
+        dsp_recalculate_all_filters((float)new_freq);
+        loudness_recompute_pending = true;
+        crossfeed_update_pending = true;  // Recalculate crossfeed coefficients for new sample rate
+        leveller_update_pending = true;   // Recalculate leveller coefficients for new sample rate
+    }
     pdm_update_clock(new_freq);
 
     // Atomically update all I2S instances and restart in sync (avoids brief
@@ -170,6 +383,35 @@ static void perform_rate_change(uint32_t new_freq) {
     }
 }
 
+// New USB rate, or a new rate lock at the current one.  With the outputs
+// locked they keep running; only the ASRC is redesigned for the new input.
+static void perform_rate_change(uint32_t new_freq) {
+    if (!audio_rate_supported(new_freq)) new_freq = 44100;
+    trace_event(TRACE_EVT_RATE_CHANGE, new_freq);
+
+    // Reset sync
+    extern volatile bool sync_started;
+    extern volatile uint64_t total_samples_produced;
+    sync_started = false;
+    total_samples_produced = 0;
+
+    uint32_t out_freq = new_freq;
+#if ENABLE_ASRC
+    uint32_t locked = rate_lock_configure(new_freq);
+    if (locked) out_freq = locked;
+#endif
+
+    // Pre-compute nominal feedback and reset controller
+    nominal_feedback_10_14 = ((uint64_t)new_freq << 14) / 1000;
+    feedback_10_14 = nominal_feedback_10_14;
+    reset_usb_feedback_loop();
+
+#if ENABLE_ASRC
+    if (locked && out_freq == output_rate) return;
+#endif
+    retune_outputs(out_freq);
+}
+
 // Reset an SPDIF instance's software queue state so it can restart in phase with
 // other SPDIF instances after output-type switching.
 static void spdif_reset_consumer_pipeline(audio_spdif_instance_t *inst) {
@@ -229,6 +471,7 @@ static void complete_pipeline_reset(void);
 // ---------------------------------------------------------------------------
 static void process_type_switches(uint8_t change_mask, const uint8_t new_types[]) {
     if (change_mask == 0) return;
+    trace_event(TRACE_EVT_TYPE_SWITCH, change_mask);
 
     extern uint8_t output_types[];
     extern audio_spdif_instance_t *spdif_instance_ptrs[];
@@ -403,9 +646,9 @@ static void process_type_switches(uint8_t change_mask, const uint8_t new_types[]
         if (output_types[i] == OUTPUT_TYPE_I2S) { any_i2s = true; break; }
     }
     if (any_i2s && i2s_mck_enabled) {
-        sanitize_mck_multiplier_for_rate(audio_state.freq);
+        sanitize_mck_multiplier_for_rate(output_rate);
         audio_i2s_mck_set_enabled(true);
-        audio_i2s_mck_update_frequency(audio_state.freq, i2s_mck_multiplier);
+        audio_i2s_mck_update_frequency(output_rate, i2s_mck_multiplier);
     } else if (!any_i2s) {
         audio_i2s_mck_set_enabled(false);
     }
@@ -427,6 +670,9 @@ static void process_type_switches(uint8_t change_mask, const uint8_t new_types[]
 static void reset_usb_feedback_loop(void) {
     fb_ctrl_reset(&fb_ctrl, nominal_feedback_10_14 << 2);
     feedback_10_14 = nominal_feedback_10_14;
+#if ENABLE_ASRC
+    rate_lock_reset_loop();
+#endif
 }
 
 // ---------------------------------------------------------------------------
@@ -447,11 +693,7 @@ static void reset_usb_feedback_loop(void) {
 // Phase 1: prepare for disruptive pipeline work.
 // Waits for Core 1 EQ worker to finish, then engages the audio mute.
 static void prepare_pipeline_reset(uint32_t mute_samples) {
-    if (core1_mode == CORE1_MODE_EQ_WORKER) {
-        while (core1_eq_work.work_ready && !core1_eq_work.work_done)
-            tight_loop_contents();
-        __dmb();
-    }
+    core1_wait_block();
     preset_mute_counter = mute_samples;
     preset_loading = true;
     __dmb();
@@ -527,64 +769,6 @@ static void complete_pipeline_reset(void) {
     restore_interrupts(flags);
 }
 
-// Flash writes disable interrupts for tens of milliseconds. Even when DSP
-// parameters are unchanged (e.g. preset save or directory writes), that
-// blackout can leave output consumer pools underfilled and inter-slot phase
-// skewed.  Bracket every deferred flash write with these helpers so audio
-// always resumes from a deterministic, synchronized state.
-//
-// Additional anti-pop handling:
-//  1) Use a rate-aware mute window (ms-based, not fixed sample count).
-//  2) Allow a short pre-flash settle period so muted packets are actually
-//     rendered to the outputs before interrupts are blacked out by flash ops.
-// Settle must exceed envelope ramp (~8ms) + consumer pipeline drain (~16ms @ 48kHz).
-// Premute must exceed settle + flash write (~45ms) + margin so the mute counter
-// never expires before the pipeline is reset.
-#define FLASH_WRITE_PREMUTE_MS       120u
-#define FLASH_WRITE_FADE_SETTLE_US   30000u
-
-static uint32_t samples_for_duration_ms(uint32_t sample_rate_hz, uint32_t duration_ms) {
-    uint64_t samples = ((uint64_t)sample_rate_hz * (uint64_t)duration_ms + 999u) / 1000u;
-    if (samples < PRESET_MUTE_SAMPLES) samples = PRESET_MUTE_SAMPLES;
-    if (samples > UINT32_MAX) samples = UINT32_MAX;
-    return (uint32_t)samples;
-}
-
-static void prepare_flash_write_operation(void) {
-    usb_audio_drain_ring();
-    prepare_pipeline_reset(samples_for_duration_ms(audio_state.freq,
-                                                   FLASH_WRITE_PREMUTE_MS));
-
-    // If stream is active, give the mute envelope time to ramp down before
-    // flash write lockout halts packet processing.
-    extern volatile bool sync_started;
-    if (sync_started) {
-        uint64_t start_us = time_us_64();
-        while ((time_us_64() - start_us) < FLASH_WRITE_FADE_SETTLE_US) {
-            usb_audio_drain_ring();
-            tight_loop_contents();
-        }
-    }
-
-    // Consume any packets that arrived during settle so flash starts from
-    // the quietest possible output state.
-    usb_audio_drain_ring();
-}
-
-// Full completion path: drain/restart all output consumer pipelines and reset
-// feedback state. Use this for operations that materially affect runtime audio
-// continuity (preset save/delete and legacy save command compatibility path).
-static void complete_flash_write_operation_full(void) {
-    complete_pipeline_reset();
-}
-
-// Light completion path: keep the mute envelope active, but skip a full output
-// pipeline rebuild. Suitable for metadata-only flash writes (names/startup flags)
-// where DSP/output topology is unchanged.
-static inline void complete_flash_write_operation_light(void) {
-    // Intentionally empty.
-}
-
 void core0_init() {
     // LED setup
     gpio_init(25); gpio_set_dir(25, GPIO_OUT);
@@ -609,7 +793,7 @@ void core0_init() {
 
     // Drop flash clock from ROM default (~102 MHz) to sys_clk/6 ≈ 51.2 MHz
     // for parity with RP2040.  Subsequent flash ops go through the wrappers
-    // in flash_clkdiv.c which restore this after each erase/program.
+    // in flash_clkdiv.c which restore this after each erase/program/command.
     dspi_flash_apply_clkdiv();
 #else
     vreg_set_voltage(VREG_VOLTAGE_1_15);
@@ -642,12 +826,30 @@ void core0_init() {
 
     // Load preset from flash.  Always selects a preset (factory defaults if
     // the target slot is empty).  Migrates legacy data on first boot.
+    uint32_t t0 = time_us_32();
     preset_boot_load();
+    boot_timing.preset_load_us = time_us_32() - t0;
+    latency_profile_request(preset_get_latency_profile());
+#if ENABLE_ASRC
+    rate_lock_request(preset_get_rate_lock());   // Applied by the first main loop pass
+#endif
     {
+        // Install the 48 kHz coefficients (EQ, loudness, crossfeed,
+        // leveller), taking EQ and loudness from the persisted boot records
+        // when they match the loaded preset.
+        t0 = time_us_32();
         uint32_t flags = save_and_disable_interrupts();
-        dsp_recalculate_all_filters(48000.0f);
+        boot_timing.coeff_flags = coeff_cache_boot(48000);
         dsp_update_delay_samples(48000.0f);
         restore_interrupts(flags);
+        boot_timing.coeff_setup_us = time_us_32() - t0;
+
+        // The boot bank already covers what the preset load queued
+        loudness_recompute_pending = false;
+        crossfeed_update_pending = false;
+        leveller_update_pending = false;
+        leveller_reset_pending = false;
+        leveller_reset_state(&leveller_state);
 
         // Apply output type + pin configuration from preset (before Core 1 starts).
         // usb_sound_card_init() created all slots as SPDIF; convert any that the
@@ -684,17 +886,6 @@ void core0_init() {
         }
     }
 
-    // Initial loudness table computation (uses loaded or default params)
-    loudness_recompute_table(loudness_ref_spl, loudness_intensity_pct, 48000.0f);
-    if (loudness_enabled && loudness_active_table) {
-        audio_set_volume(audio_state.volume);  // Re-select loudness coefficients
-    }
-
-    // Initial volume leveller setup (uses loaded or default params)
-    leveller_compute_coefficients(&leveller_coeffs, (const LevellerConfig *)&leveller_config, 48000.0f);
-    leveller_reset_state(&leveller_state);
-    leveller_bypassed = !leveller_config.enabled;
-
 #if ENABLE_SUB
     {
         extern uint8_t output_pins[];
@@ -717,6 +908,9 @@ void core0_init() {
 
     multicore_launch_core1(pdm_core1_entry);
 #endif
+
+    boot_timing.init_done_us = time_us_32();
+    trace_event(TRACE_EVT_BOOT, FW_VERSION_BCD);
 }
 
 int main(void) {
@@ -730,6 +924,11 @@ int main(void) {
 
     core0_init();
 
+    // From here on, flash writes take one slice per audio slot.  Boot-time
+    // writes (migration, first-boot directory) ran before any audio, slices
+    // back to back.
+    flash_writer_set_slot_hook(usb_audio_run_slot);
+
     // Enable watchdog
     watchdog_enable(8000, 1);
 
@@ -757,9 +956,7 @@ int main(void) {
                 memcpy(name, flash_set_name_buf, PRESET_NAME_LEN);
                 flash_set_name_pending = false;
                 restore_interrupts(f);
-                prepare_flash_write_operation();
                 uint8_t status = preset_set_name(slot, name);
-                complete_flash_write_operation_light();
                 if (status != PRESET_OK) {
                     printf("preset_set_name failed: slot=%u err=%u\n",
                            (unsigned)slot, (unsigned)status);
@@ -776,9 +973,7 @@ int main(void) {
                 slot = flash_set_startup_slot;
                 flash_set_startup_pending = false;
                 restore_interrupts(f);
-                prepare_flash_write_operation();
                 uint8_t status = preset_set_startup(mode, slot);
-                complete_flash_write_operation_light();
                 if (status != PRESET_OK) {
                     printf("preset_set_startup failed: mode=%u slot=%u err=%u\n",
                            (unsigned)mode, (unsigned)slot, (unsigned)status);
@@ -793,9 +988,7 @@ int main(void) {
                 val = flash_set_include_pins_val;
                 flash_set_include_pins_pending = false;
                 restore_interrupts(f);
-                prepare_flash_write_operation();
                 preset_set_include_pins(val);
-                complete_flash_write_operation_light();
             }
 
             extern volatile bool flash_set_master_volume_mode_pending;
@@ -806,19 +999,39 @@ int main(void) {
                 val = flash_set_master_volume_mode_val;
                 flash_set_master_volume_mode_pending = false;
                 restore_interrupts(f);
-                prepare_flash_write_operation();
                 preset_set_master_volume_mode(val);
-                complete_flash_write_operation_light();
             }
 
+            extern volatile bool flash_set_latency_profile_pending;
+            if (flash_set_latency_profile_pending) {
+                uint8_t val;
+                uint32_t f = save_and_disable_interrupts();
+                extern uint8_t flash_set_latency_profile_val;
+                val = flash_set_latency_profile_val;
+                flash_set_latency_profile_pending = false;
+                restore_interrupts(f);
+                preset_set_latency_profile(val);
+            }
+
+#if ENABLE_ASRC
+            extern volatile bool flash_set_rate_lock_pending;
+            if (flash_set_rate_lock_pending) {
+                uint32_t val;
+                uint32_t f = save_and_disable_interrupts();
+                extern uint32_t flash_set_rate_lock_val;
+                val = flash_set_rate_lock_val;
+                flash_set_rate_lock_pending = false;
+                restore_interrupts(f);
+                preset_set_rate_lock(val);
+            }
+#endif
+
             extern volatile bool flash_save_master_volume_pending;
             if (flash_save_master_volume_pending) {
                 uint32_t f = save_and_disable_interrupts();
                 flash_save_master_volume_pending = false;
                 restore_interrupts(f);
-                prepare_flash_write_operation();
                 preset_save_master_volume();
-                complete_flash_write_operation_light();
             }
         }
 
@@ -826,7 +1039,10 @@ int main(void) {
         if (eq_update_pending) {
             EqParamPacket p = pending_packet;
             eq_update_pending = false;
-            filter_recipes[p.channel][p.band] = p;
+            // A cascade type also rewrites the bands its stages occupy
+            // and any cascade it lands on (filter_cascade.h)
+            uint16_t changed = cascade_set_band(filter_recipes[p.channel],
+                                                channel_band_counts[p.channel], &p);
 
             // If updating a Core 1 EQ channel, wait for Core 1 to finish
             // current work before modifying coefficients
@@ -841,7 +1057,12 @@ int main(void) {
             }
 
             uint32_t flags = save_and_disable_interrupts();
-            dsp_compute_coefficients(&p, &filters[p.channel][p.band], (float)audio_state.freq);
+            for (int b = 0; b < channel_band_counts[p.channel]; b++) {
+                if (changed & (1u << b)) {
+                    EqParamPacket r = filter_recipes[p.channel][b];
+                    dsp_compute_coefficients(&r, &filters[p.channel][b], (float)output_rate);
+                }
+            }
 
             // Recalculate channel bypass flag
             bool all_bypassed = true;
@@ -862,12 +1083,25 @@ int main(void) {
             rate_change_pending = false;
             usb_audio_drain_ring();  // Process old-rate packets before clock switch
             perform_rate_change(r);
+            config_cost_check_live(COST_SOURCE_RATE_CHANGE);
         }
 
+#if ENABLE_ASRC
+        // Rate lock switched on, off or to another rate: the outputs move
+        // between the USB rate and the locked one
+        if (rate_lock_change_pending()) {
+            usb_audio_drain_ring();
+            prepare_pipeline_reset(PRESET_MUTE_SAMPLES);
+            perform_rate_change(audio_state.freq);
+            complete_pipeline_reset();
+            config_cost_check_live(COST_SOURCE_RATE_CHANGE);
+        }
+#endif
+
         // Handle loudness table recomputation
         if (loudness_recompute_pending) {
             loudness_recompute_pending = false;
-            loudness_recompute_table(loudness_ref_spl, loudness_intensity_pct, (float)audio_state.freq);
+            loudness_recompute_table(loudness_ref_spl, loudness_intensity_pct, (float)output_rate);
             // Update coefficient pointer for current volume
             if (loudness_enabled && loudness_active_table) {
                 audio_set_volume(audio_state.volume);
@@ -877,7 +1111,7 @@ int main(void) {
         // Handle crossfeed coefficient updates
         if (crossfeed_update_pending) {
             crossfeed_update_pending = false;
-            crossfeed_compute_coefficients(&crossfeed_state, (const CrossfeedConfig *)&crossfeed_config, (float)audio_state.freq);
+            crossfeed_compute_coefficients(&crossfeed_state, (const CrossfeedConfig *)&crossfeed_config, (float)output_rate);
             // Update bypass flag atomically
             crossfeed_bypassed = !crossfeed_config.enabled;
         }
@@ -885,7 +1119,7 @@ int main(void) {
         // Handle volume leveller coefficient updates
         if (leveller_update_pending) {
             leveller_update_pending = false;
-            leveller_compute_coefficients(&leveller_coeffs, (const LevellerConfig *)&leveller_config, (float)audio_state.freq);
+            leveller_compute_coefficients(&leveller_coeffs, (const LevellerConfig *)&leveller_config, (float)output_rate);
             if (leveller_reset_pending) {
                 leveller_reset_pending = false;
                 leveller_reset_state(&leveller_state);
@@ -906,13 +1140,15 @@ int main(void) {
 
                 prepare_pipeline_reset(PRESET_MUTE_SAMPLES);
                 complete_pipeline_reset();
+                trace_event(TRACE_EVT_STREAM_RESYNC, 0);
                 printf("USB stream restart: outputs resynced\n");
             }
         }
 
         // Handle deferred preset operations.
         // These were moved out of the USB IRQ to avoid:
-        //  - 45ms interrupt blackout from flash writes inside an ISR
+        //  - Flash writes inside an ISR (the background writer must not be
+        //    re-entered while the main loop is mid-write)
         //  - Missing pipeline reset after preset_load (stale consumer buffers
         //    with old DSP parameters would play out for ~24ms)
         //  - Delay line bleed-through when delay length changes between presets
@@ -924,6 +1160,34 @@ int main(void) {
             extern volatile uint8_t pending_preset_save_slot;
 
             if (preset_load_pending) {
+                // A load replaces the live scene outright
+                scene_morph_cancel();
+            }
+
+            if (preset_load_pending && preset_cache_can_switch(pending_preset_load_slot)) {
+                preset_load_pending = false;
+                __dmb();
+
+                // Cached preset on unchanged output hardware: crossfade to it
+                // as a scene morph, so the audio never drops out.  No flash
+                // access and no pipeline reset; scene_morph_service() commits
+                // the slot when the crossfade ends.  If both banks would not
+                // fit the CPU budget, fade out, swap the coefficient bank and
+                // fade back in instead: the mute is held open-ended until the
+                // swap is done, then released into the normal fade-in.
+                if (scene_morph_start_preset(pending_preset_load_slot) == SCENE_MORPH_OK) {
+                    trace_event(TRACE_EVT_PRESET_LOAD, pending_preset_load_slot | 0x30000u);
+                } else {
+                    usb_audio_drain_ring();
+                    prepare_pipeline_reset(UINT32_MAX);
+                    usb_audio_wait_preset_silence(PRESET_SWITCH_SILENCE_TIMEOUT_US);
+                    preset_cache_switch(pending_preset_load_slot);
+                    trace_event(TRACE_EVT_PRESET_LOAD, pending_preset_load_slot | 0x10000u);
+                    preset_mute_counter = 0;
+                    __dmb();
+                    config_cost_check_live(COST_SOURCE_PRESET_LOAD);
+                }
+            } else if (preset_load_pending) {
                 preset_load_pending = false;
                 __dmb();
 
@@ -940,17 +1204,18 @@ int main(void) {
                 // Apply the new preset: overwrites all DSP state (EQ, delays,
                 // matrix, gains, output_types[]), recalculates filter coefficients,
                 // transitions Core 1 mode, and writes the directory to flash.
-                preset_load(pending_preset_load_slot);
+                uint8_t load_status = preset_load(pending_preset_load_slot);
+                trace_event(TRACE_EVT_PRESET_LOAD, pending_preset_load_slot | ((uint32_t)load_status << 8));
 
                 // Presets can carry persisted raw MCK=0 (256x). Clamp invalid
-                // 96 kHz combinations and apply the effective MCK divider now
+                // 88.2 kHz+ combinations and apply the effective MCK divider now
                 // so no-type-change loads still update clock state.
                 {
                     extern bool i2s_mck_enabled;
                     extern uint16_t i2s_mck_multiplier;
                     if (i2s_mck_enabled) {
-                        sanitize_mck_multiplier_for_rate(audio_state.freq);
-                        audio_i2s_mck_update_frequency(audio_state.freq, i2s_mck_multiplier);
+                        sanitize_mck_multiplier_for_rate(output_rate);
+                        audio_i2s_mck_update_frequency(output_rate, i2s_mck_multiplier);
                     }
                 }
 
@@ -973,17 +1238,16 @@ int main(void) {
                     // No type changes — just resync pipelines
                     complete_pipeline_reset();
                 }
+                config_cost_check_live(COST_SOURCE_PRESET_LOAD);
             }
 
             if (save_params_pending) {
                 save_params_pending = false;
                 __dmb();
 
-                // Legacy REQ_SAVE_PARAMS compatibility path.  Keep this on the
-                // same robust flash-write flow as preset save.
-                prepare_flash_write_operation();
+                // Legacy REQ_SAVE_PARAMS compatibility path — same flow as
+                // preset save.
                 int status = flash_save_params();
-                complete_flash_write_operation_full();
                 if (status != FLASH_OK) {
                     printf("flash_save_params failed: err=%d\n", status);
                 }
@@ -993,28 +1257,31 @@ int main(void) {
                 preset_save_pending = false;
                 __dmb();
 
-                // Even though save does not modify DSP parameters, it performs
-                // two flash writes (slot + directory), each with long interrupt
-                // blackout.  Always do a full post-write resync so outputs
-                // cannot remain in a skewed/underfilled state.
-                prepare_flash_write_operation();
+                // Save does not modify DSP parameters, and the background
+                // flash writer keeps processing audio while the journal is
+                // written, so no mute or pipeline resync is needed.
                 uint8_t status = preset_save(pending_preset_save_slot);
-                complete_flash_write_operation_full();
+                trace_event(TRACE_EVT_PRESET_SAVE, pending_preset_save_slot | ((uint32_t)status << 8));
                 if (status != PRESET_OK) {
                     printf("preset_save failed: slot=%u err=%u\n",
                            (unsigned)pending_preset_save_slot, (unsigned)status);
                 }
             }
 
-            extern volatile uint16_t preset_delete_mask;
-            if (preset_delete_mask) {
-                // Atomically snapshot and clear the mask so new deletes
-                // arriving during processing are captured in the next pass.
-                uint32_t flags = save_and_disable_interrupts();
-                uint16_t mask = preset_delete_mask;
-                preset_delete_mask = 0;
-                restore_interrupts(flags);
+            extern volatile uint32_t preset_delete_mask[PRESET_MASK_WORDS];
+            uint32_t mask[PRESET_MASK_WORDS];
+            bool any_delete = false;
+            // Atomically snapshot and clear the mask so new deletes
+            // arriving during processing are captured in the next pass.
+            uint32_t flags = save_and_disable_interrupts();
+            for (int w = 0; w < PRESET_MASK_WORDS; w++) {
+                mask[w] = preset_delete_mask[w];
+                preset_delete_mask[w] = 0;
+                any_delete |= (mask[w] != 0);
+            }
+            restore_interrupts(flags);
 
+            if (any_delete) {
                 extern uint8_t output_types[];
 
                 // Snapshot output types before deletes — if the active
@@ -1023,11 +1290,17 @@ int main(void) {
                 uint8_t old_types[NUM_SPDIF_INSTANCES];
                 memcpy(old_types, output_types, NUM_SPDIF_INSTANCES);
 
-                // Single prepare/complete bracket around all deletes —
-                // each preset_delete() does its own flash erase internally.
-                prepare_flash_write_operation();
+                // Deleting the active slot applies factory defaults, which
+                // needs the pipeline reset bracket.  Other deletes only append
+                // tombstones and leave audio untouched.
+                uint8_t active = preset_get_active();
+                bool active_deleted = (mask[active >> 5] & (1u << (active & 31))) != 0;
+                if (active_deleted) {
+                    usb_audio_drain_ring();
+                    prepare_pipeline_reset(PRESET_MUTE_SAMPLES);
+                }
                 for (int slot = 0; slot < PRESET_SLOTS; slot++) {
-                    if (mask & (1u << slot)) {
+                    if (mask[slot >> 5] & (1u << (slot & 31))) {
                         preset_delete(slot);
                     }
                 }
@@ -1046,8 +1319,8 @@ int main(void) {
                     memcpy(new_types, output_types, NUM_SPDIF_INSTANCES);
                     memcpy(output_types, old_types, NUM_SPDIF_INSTANCES);
                     process_type_switches(change_mask, new_types);
-                } else {
-                    complete_flash_write_operation_full();
+                } else if (active_deleted) {
+                    complete_pipeline_reset();
                 }
             }
 
@@ -1066,9 +1339,10 @@ int main(void) {
                 usb_audio_drain_ring();
                 prepare_pipeline_reset(PRESET_MUTE_SAMPLES);
 
+                scene_morph_cancel();
                 flash_factory_reset();
-                dsp_recalculate_all_filters((float)audio_state.freq);
-                dsp_update_delay_samples((float)audio_state.freq);
+                dsp_recalculate_all_filters((float)output_rate);
+                dsp_update_delay_samples((float)output_rate);
                 loudness_recompute_pending = true;
                 crossfeed_update_pending = true;
 
@@ -1126,15 +1400,30 @@ int main(void) {
         if (bulk_params_pending) {
             bulk_params_pending = false;
 
+            // Pre-flight estimate with the feature gate's stages shed.
+            // Advisory only: the cost kernels are not calibrated on the
+            // target (config_cost.c), so a predicted overrun is published
+            // and traced, and the payload is applied anyway.
+            const WireBulkParams *wp = (const WireBulkParams *)bulk_param_buf;
+            CostConfig cost_cfg;
+            CostEstimate cost = { .result = COST_RESULT_INVALID };
+            if (config_cost_from_wire(wp, output_rate, &cost_cfg)) {
+                cost_config_add_fir(&cost_cfg);
+                cost_config_add_dyneq(&cost_cfg);
+                cost_config_add_multiband(&cost_cfg);
+                cost_config_add_limiter(&cost_cfg);
+                cost_config_add_asrc(&cost_cfg);
+                config_cost_gate(&cost_cfg, output_rate, clock_get_hz(clk_sys), &cost);
+            }
             usb_audio_drain_ring();  // Process before full state swap
             prepare_pipeline_reset(PRESET_MUTE_SAMPLES);
 
             // Apply the received parameters (pin config gated by include_pins setting)
             uint16_t _occ; uint8_t _m, _d, _la, inc_pins, _inc_mv;
             preset_get_directory(&_occ, &_m, &_d, &_la, &inc_pins, &_inc_mv);
-            int err = bulk_params_apply((const WireBulkParams *)bulk_param_buf, inc_pins != 0);
+            int err = bulk_params_apply(wp, inc_pins != 0);
             if (err == 0) {
-                float rate = (float)audio_state.freq;
+                float rate = (float)output_rate;
                 dsp_recalculate_all_filters(rate);
                 dsp_update_delay_samples(rate);
 
@@ -1144,11 +1433,15 @@ int main(void) {
                     extern bool i2s_mck_enabled;
                     extern uint16_t i2s_mck_multiplier;
                     if (i2s_mck_enabled) {
-                        sanitize_mck_multiplier_for_rate(audio_state.freq);
-                        audio_i2s_mck_update_frequency(audio_state.freq, i2s_mck_multiplier);
+                        sanitize_mck_multiplier_for_rate(output_rate);
+                        audio_i2s_mck_update_frequency(output_rate, i2s_mck_multiplier);
                     }
                 }
 
+                // Gate the new state before the first block runs it
+                CostEstimate live;
+                feature_gate_update(&live);
+
                 // Transition Core 1 mode to match new output enable state
                 Core1Mode new_mode = derive_core1_mode();
                 if (new_mode != core1_mode) {
@@ -1159,7 +1452,67 @@ int main(void) {
                     __sev();
                 }
             }
+            if (cost.result != COST_RESULT_INVALID) {
+                config_cost_publish(COST_SOURCE_SET_ALL_PARAMS, &cost, output_rate, err == 0);
+            }
+            bulk_params_release();
+        }
+
+        // Background build of per-rate coefficient banks (one bounded step)
+        coeff_cache_service();
+
+        // Preset RAM cache fill / bank rebuild (one bounded step)
+        preset_cache_service();
+
+        // Subscribed meter stream frame, if due
+        usb_audio_meter_service();
+
+        // Re-plan buffer depths after a profile change or PDM sub toggle
+        latency_profile_service();
+
+        // A/B scene morph: start/end requests and gain-stage interpolation.
+        // After latency_profile_service(), which may rewrite delay state.
+        // Scene B going live is a preset load as far as the cost gate goes.
+        if (scene_morph_service()) {
+            config_cost_check_live(COST_SOURCE_PRESET_LOAD);
+        }
+
+#if ENABLE_FIR
+        // FIR filter uploads and crossover designs.  A change in an output's
+        // FIR latency moves the compensating delays on the other outputs.
+        if (fir_bank_service(output_rate)) {
+            dsp_update_delay_samples((float)output_rate);
         }
+#endif
+
+        // Re-evaluate the feature gate, and re-split the FIR crossovers
+        // between the cores, as single settings change
+        static uint32_t gate_plan_us;
+        if (time_us_32() - gate_plan_us >= 100000) {
+            gate_plan_us = time_us_32();
+            CostEstimate est;
+            feature_gate_update(&est);
+#if ENABLE_FIR
+            if (fir_xover_mask) fir_xover_set_core1_mask(est.xover_core1_mask);
+#endif
+        }
+
+#if ENABLE_DYNEQ
+        // Dynamic EQ band settings; sidechains follow band edits and rate
+        // changes
+        dyneq_service(output_rate);
+#endif
+
+#if ENABLE_MULTIBAND
+        // Multiband compressor settings and rate changes
+        multiband_service(output_rate);
+#endif
+
+#if ENABLE_LIMITER
+        // Output limiter settings; the lookahead joins or leaves every
+        // output's delay with the first or last limiter
+        if (limiter_service(output_rate)) dsp_update_delay_samples((float)output_rate);
+#endif
 
         // LED heartbeat - toggle every ~1000 iterations
         static uint32_t loop_counter = 0;
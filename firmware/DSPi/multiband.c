@@ -0,0 +1,462 @@
+/*
+ * multiband.c — Multiband compressor / limiter (RP2350)
+ *
+ * Per block, for each channel of an instance:
+ *   1. Per-sample: LR4 band split (see multiband.h), each band's detector
+ *      updated, bands summed with gains ramped from the last block's to
+ *      the target the last block's detector set
+ * then once per block:
+ *   2. Per band: level from the louder channel, soft-knee gain computer,
+ *      makeup, attack / release smoothing -> next block's target gain
+ *
+ * Threading: instances are written by the main loop only.  The master
+ * instance only runs on Core 0 (from the main loop itself); a per-output
+ * instance is taken out of mb_output_mask, or Core 1's block is waited
+ * for, before its settings or state change.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "multiband.h"
+#include "dsp_math.h"
+#include "leveller.h"
+#include "pdm_generator.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#if ENABLE_MULTIBAND
+
+_Static_assert(sizeof(MultibandConfigPacket) == 20, "MultibandConfigPacket is a wire format");
+_Static_assert(sizeof(MultibandBandPacket) == 24, "MultibandBandPacket is a wire format");
+_Static_assert(sizeof(MultibandStatusPacket) == 56, "MultibandStatusPacket is a wire format");
+_Static_assert(NUM_OUTPUT_CHANNELS <= 16, "mb_output_mask is 16 bits");
+_Static_assert(MB_INSTANCES * MB_MAX_BANDS <= 16, "req_band_mask is 16 bits");
+
+#define MB_SVF_STAGES       11
+#define MB_RMS_SEC          0.010f          // RMS detector averaging
+#define MB_PEAK_DECAY_SEC   0.050f          // Peak detector fall
+#define MB_RATIO_LIMIT      100.0f          // At or above: limiter
+#define MB_XOVER_MIN_HZ     20.0f
+#define MB_XOVER_MAX_HZ     20000.0f
+
+typedef struct {
+    float a1, a2, a3;
+} MbSvf;
+
+typedef struct {
+    float s[MB_SVF_STAGES][2];      // SVF integrators, in kernel order
+    float env[MB_MAX_BANDS];        // Squared level: mean square or held peak
+} MbChannel;
+
+typedef struct {
+    MultibandConfigPacket cfg;      // cfg.enabled: instance in use; values clamped
+    MultibandBandPacket band[MB_MAX_BANDS];
+    uint8_t error;                  // MB_ERR_* of the last refused request
+    uint32_t rate;                  // Rate the derived values are for
+
+    // Derived at the live rate
+    MbSvf xo[3];
+    float alpha_det;
+    float alpha_attack[MB_MAX_BANDS];
+    float alpha_release[MB_MAX_BANDS];
+    float slope[MB_MAX_BANDS];      // 1 - 1/ratio
+
+    // Runtime
+    MbChannel ch[2];
+    float gain_db[MB_MAX_BANDS];    // Smoothed band gain
+    float gain_lin[MB_MAX_BANDS];   // Reached at the end of the last block
+    float gain_target[MB_MAX_BANDS];// Reached at the end of the next block
+    float level_db[MB_MAX_BANDS];   // For status
+} MbInstance;
+
+static MbInstance instances[MB_INSTANCES];
+static uint8_t output_instance[NUM_OUTPUT_CHANNELS];
+
+volatile bool mb_master_active;
+volatile uint16_t mb_output_mask;
+
+// Requests (USB IRQ → main loop)
+static MultibandConfigPacket req_cfg[MB_INSTANCES];
+static MultibandBandPacket req_band[MB_INSTANCES][MB_MAX_BANDS];
+static volatile uint8_t req_cfg_mask;       // Bit per instance
+static volatile uint16_t req_band_mask;     // Bit per instance * MB_MAX_BANDS + band
+
+static void reset_state(MbInstance *m) {
+    memset(m->ch, 0, sizeof(m->ch));
+    for (int b = 0; b < MB_MAX_BANDS; b++) {
+        m->gain_db[b] = m->band[b].makeup_db;
+        m->gain_lin[b] = m->gain_target[b] = expf(m->gain_db[b] * LN10_OVER_20);
+        m->level_db[b] = -300.0f;
+    }
+}
+
+void multiband_init(void) {
+    static const uint16_t attack_ms[MB_MAX_BANDS]  = { 30, 20, 10, 5 };
+    static const uint16_t release_ms[MB_MAX_BANDS] = { 400, 300, 200, 150 };
+
+    memset(instances, 0, sizeof(instances));
+    memset(output_instance, 0, sizeof(output_instance));
+    for (uint8_t i = 0; i < MB_INSTANCES; i++) {
+        MbInstance *m = &instances[i];
+        m->cfg.instance = i;
+        m->cfg.bands = MB_MAX_BANDS;
+        m->cfg.detector = MB_DETECT_RMS;
+        m->cfg.xover_hz[0] = 150.0f;
+        m->cfg.xover_hz[1] = 1000.0f;
+        m->cfg.xover_hz[2] = 5000.0f;
+        for (uint8_t b = 0; b < MB_MAX_BANDS; b++) {
+            MultibandBandPacket *p = &m->band[b];
+            p->instance = i;
+            p->band = b;
+            p->threshold_db = -24.0f;
+            p->ratio = 3.0f;
+            p->knee_db = 6.0f;
+            p->makeup_db = 0.0f;
+            p->attack_ms = attack_ms[b];
+            p->release_ms = release_ms[b];
+        }
+        reset_state(m);
+    }
+    mb_master_active = false;
+    mb_output_mask = 0;
+    req_cfg_mask = 0;
+    req_band_mask = 0;
+}
+
+// ----------------------------------------------------------------------------
+// AUDIO PATH
+// ----------------------------------------------------------------------------
+
+static inline void svf_tick(const MbSvf *c, float *s, float x, float *v1, float *v2) {
+    float v3 = x - s[1];
+    *v1 = c->a1 * s[0] + c->a2 * v3;
+    *v2 = s[1] + c->a2 * s[0] + c->a3 * v3;
+    s[0] = 2.0f * *v1 - s[0];
+    s[1] = 2.0f * *v2 - s[1];
+}
+
+// LR4 split: one SVF shared for LP2 / HP2, one more on each branch.
+// Butterworth stages: k = 1/Q = SQRT2_F.
+static inline void lr4_split(const MbSvf *c, float (*s)[2], float x, float *lo, float *hi) {
+    float v1, v2;
+    svf_tick(c, s[0], x, &v1, &v2);
+    float lp = v2;
+    float hp = x - SQRT2_F * v1 - v2;
+    svf_tick(c, s[1], lp, &v1, &v2);
+    *lo = v2;
+    svf_tick(c, s[2], hp, &v1, &v2);
+    *hi = hp - SQRT2_F * v1 - v2;
+}
+
+// 2nd-order all-pass matching an LR4 split's summed phase
+static inline float allpass(const MbSvf *c, float *s, float x) {
+    float v1, v2;
+    svf_tick(c, s, x, &v1, &v2);
+    return x - 2.0f * SQRT2_F * v1;
+}
+
+static inline float detect(float env, float y, float alpha, bool peak) {
+    float y2 = y * y;
+    if (peak) return y2 > env ? y2 : alpha * env;
+    return alpha * env + (1.0f - alpha) * y2;
+}
+
+static inline void run_channel(const MbInstance *m, MbChannel *c, float *samples, uint32_t count,
+                               const float *g0, const float *dg) {
+    const bool four = m->cfg.bands == 4;
+    const bool peak = m->cfg.detector == MB_DETECT_PEAK;
+    const float a = m->alpha_det;
+    float s[MB_SVF_STAGES][2];
+    memcpy(s, c->s, sizeof(s));
+    float e0 = c->env[0], e1 = c->env[1], e2 = c->env[2], e3 = c->env[3];
+    float g_0 = g0[0], g_1 = g0[1], g_2 = g0[2], g_3 = g0[3];
+
+    for (uint32_t i = 0; i < count; i++) {
+        float lo, hi, b0, b1, b2, b3 = 0.0f;
+        lr4_split(&m->xo[1], &s[0], samples[i], &lo, &hi);
+        if (four) {
+            lo = allpass(&m->xo[2], s[3], lo);
+            lr4_split(&m->xo[0], &s[4], lo, &b0, &b1);
+            hi = allpass(&m->xo[0], s[7], hi);
+            lr4_split(&m->xo[2], &s[8], hi, &b2, &b3);
+            e3 = detect(e3, b3, a, peak);
+            g_3 += dg[3];
+        } else {
+            lr4_split(&m->xo[0], &s[3], lo, &b0, &b1);
+            b2 = allpass(&m->xo[0], s[6], hi);
+        }
+        e0 = detect(e0, b0, a, peak);
+        e1 = detect(e1, b1, a, peak);
+        e2 = detect(e2, b2, a, peak);
+        g_0 += dg[0]; g_1 += dg[1]; g_2 += dg[2];
+        samples[i] = g_0 * b0 + g_1 * b1 + g_2 * b2 + g_3 * b3;
+    }
+
+    memcpy(c->s, s, sizeof(s));
+    c->env[0] = e0 < 1e-30f ? 0.0f : e0;
+    c->env[1] = e1 < 1e-30f ? 0.0f : e1;
+    c->env[2] = e2 < 1e-30f ? 0.0f : e2;
+    c->env[3] = e3 < 1e-30f ? 0.0f : e3;
+}
+
+DSP_TIME_CRITICAL
+static void process(MbInstance *m, float *const *bufs, int channels, uint32_t count) {
+    if (count == 0) return;
+    int bands = m->cfg.bands;
+
+    float g0[MB_MAX_BANDS], dg[MB_MAX_BANDS];
+    float inv = 1.0f / (float)count;
+    for (int b = 0; b < MB_MAX_BANDS; b++) {
+        g0[b] = m->gain_lin[b];
+        dg[b] = (m->gain_target[b] - g0[b]) * inv;
+    }
+    for (int c = 0; c < channels; c++) run_channel(m, &m->ch[c], bufs[c], count, g0, dg);
+
+    // Next block's target gains (linked: the louder channel per band)
+    for (int b = 0; b < bands; b++) {
+        float env = m->ch[0].env[b];
+        if (channels == 2 && m->ch[1].env[b] > env) env = m->ch[1].env[b];
+        float level_db = 10.0f * log10f(env + 1e-30f);
+        m->level_db[b] = level_db;
+
+        const MultibandBandPacket *p = &m->band[b];
+        float target = p->makeup_db
+                     - leveller_gain_computer(level_db - p->threshold_db, m->slope[b], p->knee_db);
+
+        // Linked channels share one gain per band, smoothed once per block
+        float alpha_sample = (target < m->gain_db[b]) ? m->alpha_attack[b] : m->alpha_release[b];
+        float alpha = leveller_block_alpha(alpha_sample, count);
+        m->gain_db[b] = alpha * m->gain_db[b] + (1.0f - alpha) * target;
+        m->gain_lin[b] = m->gain_target[b];
+        m->gain_target[b] = expf(m->gain_db[b] * LN10_OVER_20);
+    }
+}
+
+DSP_TIME_CRITICAL
+void multiband_process_master(float *buf_l, float *buf_r, uint32_t count) {
+    float *bufs[2] = { buf_l, buf_r };
+    process(&instances[0], bufs, 2, count);
+}
+
+DSP_TIME_CRITICAL
+void multiband_process_output(uint8_t out, float *samples, uint32_t count) {
+    process(&instances[output_instance[out]], &samples, 1, count);
+}
+
+// ----------------------------------------------------------------------------
+// VENDOR REQUESTS (USB IRQ)
+// ----------------------------------------------------------------------------
+
+void multiband_request_config(const MultibandConfigPacket *req) {
+    if (req->instance >= MB_INSTANCES) return;
+    req_cfg[req->instance] = *req;
+    __dmb();
+    req_cfg_mask |= (uint8_t)(1u << req->instance);
+}
+
+void multiband_request_band(const MultibandBandPacket *req) {
+    if (req->instance >= MB_INSTANCES || req->band >= MB_MAX_BANDS) return;
+    req_band[req->instance][req->band] = *req;
+    __dmb();
+    req_band_mask |= (uint16_t)(1u << (req->instance * MB_MAX_BANDS + req->band));
+}
+
+static bool instance_active(uint8_t i) {
+    const MbInstance *m = &instances[i];
+    if (i == 0) return mb_master_active;
+    return m->cfg.enabled && (mb_output_mask & (1u << m->cfg.output)) &&
+           output_instance[m->cfg.output] == i;
+}
+
+bool multiband_get_status(uint8_t instance, MultibandStatusPacket *pkt) {
+    if (instance >= MB_INSTANCES) return false;
+    const MbInstance *m = &instances[instance];
+    memset(pkt, 0, sizeof(*pkt));
+    pkt->config = m->cfg;
+    pkt->config.instance = instance;
+    pkt->active = instance_active(instance);
+    pkt->error = m->error;
+    for (int b = 0; b < MB_MAX_BANDS; b++) {
+        bool running = pkt->active && b < m->cfg.bands;
+        pkt->level_db[b] = running ? m->level_db[b] : -300.0f;
+        pkt->gain_db[b] = running ? m->gain_db[b] : 0.0f;
+    }
+    return true;
+}
+
+bool multiband_get_band(uint8_t instance, uint8_t band, MultibandBandPacket *pkt) {
+    if (instance >= MB_INSTANCES || band >= MB_MAX_BANDS) return false;
+    *pkt = instances[instance].band[band];
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// MAIN LOOP
+// ----------------------------------------------------------------------------
+
+static float clampf(float v, float lo, float hi) {
+    return v < lo ? lo : v > hi ? hi : v;
+}
+
+static void design_band(MbInstance *m, uint8_t b, float fs) {
+    const MultibandBandPacket *p = &m->band[b];
+    m->alpha_attack[b] = leveller_time_alpha(fs, p->attack_ms * 0.001f);
+    m->alpha_release[b] = leveller_time_alpha(fs, p->release_ms * 0.001f);
+    m->slope[b] = p->ratio >= MB_RATIO_LIMIT ? 1.0f : 1.0f - 1.0f / p->ratio;
+}
+
+static void design(MbInstance *m, uint32_t rate) {
+    float fs = (float)rate;
+    for (int e = 0; e < 3; e++) {
+        float f = clampf(m->cfg.xover_hz[e], MB_XOVER_MIN_HZ, fs * 0.45f);
+        float g = tanf(PI_F * f / fs);
+        MbSvf *c = &m->xo[e];
+        c->a1 = 1.0f / (1.0f + g * (g + SQRT2_F));
+        c->a2 = g * c->a1;
+        c->a3 = g * c->a2;
+    }
+    m->alpha_det = leveller_time_alpha(fs, m->cfg.detector == MB_DETECT_PEAK ? MB_PEAK_DECAY_SEC
+                                                                             : MB_RMS_SEC);
+    for (uint8_t b = 0; b < MB_MAX_BANDS; b++) design_band(m, b, fs);
+    m->rate = rate;
+}
+
+// Take an instance out of the audio path
+static void deactivate(uint8_t i) {
+    if (i == 0) {
+        mb_master_active = false;   // Core 0 only: not running while the main loop is
+        return;
+    }
+    const MbInstance *m = &instances[i];
+    uint16_t bit = (uint16_t)(1u << m->cfg.output);
+    if (!m->cfg.enabled || !(mb_output_mask & bit) || output_instance[m->cfg.output] != i) return;
+    mb_output_mask &= (uint16_t)~bit;
+    core1_wait_block();
+}
+
+static void activate(uint8_t i) {
+    __dmb();
+    if (i == 0) {
+        mb_master_active = true;
+        return;
+    }
+    uint8_t out = instances[i].cfg.output;
+    output_instance[out] = i;
+    __dmb();
+    mb_output_mask |= (uint16_t)(1u << out);
+}
+
+static bool config_valid(uint8_t i, const MultibandConfigPacket *req) {
+    if (req->bands != 3 && req->bands != 4) return false;
+    if (req->detector != MB_DETECT_RMS && req->detector != MB_DETECT_PEAK) return false;
+    if (i != 0 && req->output >= NUM_OUTPUT_CHANNELS) return false;
+    for (int e = 0; e < req->bands - 1; e++) {
+        float f = req->xover_hz[e];
+        if (!(f >= MB_XOVER_MIN_HZ && f <= MB_XOVER_MAX_HZ)) return false;
+        if (e > 0 && !(f > req->xover_hz[e - 1])) return false;
+    }
+    return true;
+}
+
+static void apply_config(uint8_t i, const MultibandConfigPacket *req, uint32_t rate) {
+    MbInstance *m = &instances[i];
+    if (!req->enabled) {
+        deactivate(i);
+        m->cfg.enabled = 0;
+        m->error = MB_ERR_NONE;
+        return;
+    }
+    if (!config_valid(i, req)) {
+        // Refused without touching a running instance
+        m->error = MB_ERR_PARAM;
+        return;
+    }
+    if (i != 0) {
+        for (uint8_t j = 1; j < MB_INSTANCES; j++) {
+            if (j != i && instances[j].cfg.enabled && instances[j].cfg.output == req->output) {
+                m->error = MB_ERR_OUTPUT_TAKEN;
+                return;
+            }
+        }
+    }
+
+    bool restart = !m->cfg.enabled || m->cfg.bands != req->bands ||
+                   (i != 0 && m->cfg.output != req->output);
+    if (restart) deactivate(i);
+    else core1_wait_block();
+
+    m->cfg = *req;
+    m->cfg.instance = i;
+    m->cfg.enabled = 1;
+    if (i == 0) m->cfg.output = 0;
+    memset(m->cfg.reserved, 0, sizeof(m->cfg.reserved));
+    for (int e = req->bands - 1; e < 3; e++) m->cfg.xover_hz[e] = 0.0f;
+    design(m, rate);
+    m->error = MB_ERR_NONE;
+    if (restart) {
+        reset_state(m);
+        activate(i);
+    }
+}
+
+static void apply_band(const MultibandBandPacket *req) {
+    MbInstance *m = &instances[req->instance];
+    MultibandBandPacket *p = &m->band[req->band];
+    core1_wait_block();
+    *p = *req;
+    p->reserved = 0;
+    p->threshold_db = clampf(req->threshold_db, -96.0f, 0.0f);
+    p->ratio = clampf(req->ratio, 1.0f, MB_RATIO_LIMIT);
+    p->knee_db = clampf(req->knee_db, 0.0f, 24.0f);
+    p->makeup_db = clampf(req->makeup_db, 0.0f, 24.0f);
+    if (p->attack_ms < 1) p->attack_ms = 1;
+    if (p->attack_ms > 500) p->attack_ms = 500;
+    if (p->release_ms < 1) p->release_ms = 1;
+    if (p->release_ms > 5000) p->release_ms = 5000;
+    if (m->rate) design_band(m, req->band, (float)m->rate);
+}
+
+void multiband_service(uint32_t sample_rate) {
+    if (req_cfg_mask | req_band_mask) {
+        uint32_t flags = save_and_disable_interrupts();
+        uint8_t cfg_mask = req_cfg_mask;
+        uint16_t band_mask = req_band_mask;
+        MultibandConfigPacket cfg[MB_INSTANCES];
+        MultibandBandPacket band[MB_INSTANCES][MB_MAX_BANDS];
+        memcpy(cfg, req_cfg, sizeof(cfg));
+        memcpy(band, req_band, sizeof(band));
+        req_cfg_mask = 0;
+        req_band_mask = 0;
+        restore_interrupts(flags);
+
+        for (uint8_t i = 0; i < MB_INSTANCES; i++) {
+            for (uint8_t b = 0; b < MB_MAX_BANDS; b++) {
+                if (band_mask & (1u << (i * MB_MAX_BANDS + b))) apply_band(&band[i][b]);
+            }
+        }
+        for (uint8_t i = 0; i < MB_INSTANCES; i++) {
+            if (cfg_mask & (1u << i)) apply_config(i, &cfg[i], sample_rate);
+        }
+    }
+
+    for (uint8_t i = 0; i < MB_INSTANCES; i++) {
+        MbInstance *m = &instances[i];
+        if (!m->cfg.enabled || m->rate == sample_rate) continue;
+        core1_wait_block();
+        design(m, sample_rate);
+    }
+}
+
+uint8_t multiband_master_bands(void) {
+    return instances[0].cfg.enabled ? instances[0].cfg.bands : 0;
+}
+
+uint8_t multiband_output_bands(uint8_t out) {
+    for (uint8_t i = 1; i < MB_INSTANCES; i++) {
+        const MbInstance *m = &instances[i];
+        if (m->cfg.enabled && m->cfg.output == out) return m->cfg.bands;
+    }
+    return 0;
+}
+
+#endif // ENABLE_MULTIBAND
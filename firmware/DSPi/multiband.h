@@ -0,0 +1,75 @@
+/*
+ * multiband.h — Multiband compressor / limiter (RP2350)
+ *
+ * A 3- or 4-band downward compressor with makeup, for broadcast-style
+ * level control.  Instance 0 runs on the master pair after the leveller
+ * (before crossfeed), stereo-linked per band; the other MB_INSTANCES - 1
+ * can each be put on one output, after its EQ and FIR, on whichever core
+ * processes that output.
+ *
+ * Band split: complementary Linkwitz-Riley 4th order crossovers built from
+ * Q 0.707 SVF stages.  One SVF on the input gives both the LP2 and HP2 of
+ * a split; one more SVF on each branch squares them to LR4 (3 SVFs per
+ * split).  LR4 low + high sums to a 2nd-order all-pass at the split
+ * frequency, so the branch that skips a split gets the same all-pass
+ * (one SVF, x - 2k v1) and the bands sum back flat:
+ *
+ *   3 bands   split f1 -> L, H;   L: split f0;   H: AP f0             7 SVFs
+ *   4 bands   split f1 -> L, H;   L: AP f2, split f0;
+ *                                 H: AP f0, split f2                 11 SVFs
+ *
+ * Each band has an RMS (10 ms) or peak (fast attack, 50 ms decay)
+ * detector, a soft-knee gain computer with makeup, and attack / release
+ * smoothing once per block as in the leveller.  A ratio of 100 is treated
+ * as infinite (limiting).  The gain from one block's detector is ramped
+ * in per sample across the next block, so the split runs once per sample
+ * with no band buffers; control lags the audio by one block (~1 ms).
+ *
+ * Cost on RP2350, per channel per sample: the SVFs above plus a detector
+ * and gain ramp per band (config_cost.c).  The master 4-band instance is
+ * well under a tenth of the budget at 48 kHz, leaving room for 10-band
+ * EQ on every output.
+ *
+ * Settings are held in RAM only; requests are applied by
+ * multiband_service() in the main loop.
+ */
+
+#ifndef MULTIBAND_H
+#define MULTIBAND_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+#if ENABLE_MULTIBAND
+
+// Audio path: instance 0 runs when mb_master_active; an output runs its
+// instance when its bit is set in mb_output_mask.
+extern volatile bool mb_master_active;
+extern volatile uint16_t mb_output_mask;
+
+void multiband_init(void);
+
+// Core 0: the master pair, in place.
+void multiband_process_master(float *buf_l, float *buf_r, uint32_t count);
+
+// Either core: one output's instance, in place.
+void multiband_process_output(uint8_t out, float *samples, uint32_t count);
+
+// Vendor requests (USB IRQ).  Sets are applied by multiband_service().
+void multiband_request_config(const MultibandConfigPacket *req);
+void multiband_request_band(const MultibandBandPacket *req);
+bool multiband_get_status(uint8_t instance, MultibandStatusPacket *pkt);
+bool multiband_get_band(uint8_t instance, uint8_t band, MultibandBandPacket *pkt);
+
+// Main loop: apply pending requests and follow sample rate changes.
+void multiband_service(uint32_t sample_rate);
+
+// For the cost estimate: bands of the master instance (0 when off) and of
+// the instance on each output.
+uint8_t multiband_master_bands(void);
+uint8_t multiband_output_bands(uint8_t out);
+
+#endif // ENABLE_MULTIBAND
+
+#endif // MULTIBAND_H
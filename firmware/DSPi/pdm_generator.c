@@ -4,6 +4,13 @@
 #include "pdm_generator.h"
 #include "dsp_pipeline.h"
 #include "usb_audio.h"
+#include "scene_morph.h"
+#include "stage_profiler.h"
+#include "deadline_monitor.h"
+#include "event_trace.h"
+#include "fir_bank.h"
+#include "multiband.h"
+#include "limiter.h"
 #include "pico/stdlib.h"
 #include "hardware/pio.h"
 #include "hardware/dma.h"
@@ -194,6 +201,7 @@ void pdm_push_sample(int32_t sample, bool reset) {
         __sev();
     } else {
         pdm_ring_overruns++;
+        trace_burst(TRACE_EVT_PDM_RING_OVERRUN, pdm_ring_overruns);
     }
 }
 
@@ -279,6 +287,7 @@ static void pdm_processing_loop() {
         // Underrun recovery - write pointer fell behind read pointer
         if (delta > (PDM_DMA_BUFFER_SIZE / 2)) {
             pdm_dma_underruns++;
+            trace_burst(TRACE_EVT_PDM_DMA_UNDERRUN, pdm_dma_underruns);
             local_pdm_err = 0;
             local_pdm_err2 = 0;
             local_pdm_write = (current_read_idx + TARGET_LEAD) & (PDM_DMA_BUFFER_SIZE - 1);
@@ -293,6 +302,7 @@ static void pdm_processing_loop() {
             sample_value = msg.sample;
         } else if (delta < TARGET_LEAD) {
             pdm_ring_underruns++;
+            trace_burst(TRACE_EVT_PDM_RING_UNDERRUN, pdm_ring_underruns);
             sample_value = 0;
         } else {
             while (pdm_head == pdm_tail) {
@@ -389,6 +399,7 @@ static void pdm_processing_loop() {
             int32_t new_delta = (local_pdm_write - new_read_idx) & (PDM_DMA_BUFFER_SIZE - 1);
             if (new_delta < 32) {
                 pdm_dma_overruns++;
+                trace_burst(TRACE_EVT_PDM_DMA_OVERRUN, pdm_dma_overruns);
             }
         }
 
@@ -438,11 +449,35 @@ static void __not_in_flash_func(eq_worker_loop)() {
         __dmb();
 
         uint32_t work_start = time_us_32();
+        ProfilerPass prof;
+        profiler_begin(&prof, 1);
 
         // Read work descriptor
-        float (*buf_out)[192] = core1_eq_work.buf_out;
+        float (*buf_out)[AUDIO_BUFFER_SAMPLES] = core1_eq_work.buf_out;
         uint32_t sample_count = core1_eq_work.sample_count;
         float vol_mul = core1_eq_work.vol_mul;
+        bool morphing = scene_morph_block.active;
+
+#if ENABLE_FIR
+        // Our share of the crossovers, then wait for Core 0's share of
+        // outputs 2-7 before their EQ
+        uint16_t xover_mask = core1_eq_work.xover_mask;
+        if (xover_mask) {
+            uint16_t xover_core1 = core1_eq_work.xover_core1_mask;
+            fir_xover_run(xover_core1, buf_out, sample_count);
+            __dmb();
+            core1_eq_work.xover_done[1] = true;
+            __sev();
+            uint16_t own = (uint16_t)(((1u << (CORE1_EQ_LAST_OUTPUT + 1)) - 1) &
+                                      ~((1u << CORE1_EQ_FIRST_OUTPUT) - 1));
+            if (xover_mask & (uint16_t)~xover_core1 & own) {
+                while (!core1_eq_work.xover_done[0]) {
+                    __wfe();
+                }
+                __dmb();
+            }
+        }
+#endif
 
         // Process EQ + gain for outputs assigned to Core 1
         extern MatrixMixer matrix_mixer;
@@ -452,10 +487,19 @@ static void __not_in_flash_func(eq_worker_loop)() {
             // Output EQ
             if (!matrix_mixer.outputs[out].mute) {
                 uint8_t eq_ch = CH_OUT_1 + out;
-                if (!channel_bypassed[eq_ch]) {
+                if (morphing) {
+                    scene_morph_eq_block(eq_ch, buf_out[out], sample_count);
+                } else if (!channel_bypassed[eq_ch]) {
                     dsp_process_channel_block(filters[eq_ch], buf_out[out], sample_count, eq_ch);
                 }
             }
+#if ENABLE_FIR
+            if (fir_active_mask & (1u << out)) fir_bank_process(out, buf_out[out], sample_count);
+#endif
+#if ENABLE_MULTIBAND
+            if ((mb_output_mask & (1u << out)) && !matrix_mixer.outputs[out].mute)
+                multiband_process_output(out, buf_out[out], sample_count);
+#endif
 
             // Combined gain + volume
             float gain = matrix_mixer.outputs[out].mute ? 0.0f
@@ -469,10 +513,22 @@ static void __not_in_flash_func(eq_worker_loop)() {
             }
         }
 
+        profiler_mark(&prof, PROF_STAGE_C1_OUTPUT_EQ);
+
         // Delay for Core 1 outputs
         if (any_delay_active) {
             for (int out = CORE1_EQ_FIRST_OUTPUT; out <= CORE1_EQ_LAST_OUTPUT; out++) {
+                if (morphing) {
+                    scene_morph_delay_block(out, buf_out[out], core1_eq_work.delay_write_idx, sample_count);
+                    continue;
+                }
                 int32_t dly = channel_delay_samples[out];
+#if ENABLE_LIMITER
+                if (limiter_active_mask & (1u << out)) {
+                    limiter_delay_block(out, buf_out[out], delay_lines[out], core1_eq_work.delay_write_idx, dly, sample_count);
+                    continue;
+                }
+#endif
                 if (dly <= 0) continue;
                 float *dst = buf_out[out];
                 float *dline = delay_lines[out];
@@ -485,6 +541,8 @@ static void __not_in_flash_func(eq_worker_loop)() {
             }
         }
 
+        profiler_mark(&prof, PROF_STAGE_C1_DELAY);
+
         // Peak metering for Core 1 outputs
         for (int out = CORE1_EQ_FIRST_OUTPUT; out <= CORE1_EQ_LAST_OUTPUT; out++) {
             float peak = 0;
@@ -502,8 +560,9 @@ static void __not_in_flash_func(eq_worker_loop)() {
             if (!out_ptr) continue;
             int left_out = CORE1_EQ_FIRST_OUTPUT + p * 2;
             int right_out = left_out + 1;
-            if (!matrix_mixer.outputs[left_out].enabled &&
-                !matrix_mixer.outputs[right_out].enabled) {
+            if ((!matrix_mixer.outputs[left_out].enabled &&
+                 !matrix_mixer.outputs[right_out].enabled) ||
+                spdif_slot_rate_muted(feature_gate, p + 1)) {
                 memset(out_ptr, 0, sample_count * 8);
                 continue;
             }
@@ -515,6 +574,9 @@ static void __not_in_flash_func(eq_worker_loop)() {
             }
         }
 
+        profiler_mark(&prof, PROF_STAGE_C1_PACK);
+        profiler_end(&prof, PROF_STAGE_CORE1_TOTAL);
+
         uint32_t work_end = time_us_32();
 
         if (c1eq_load_primed) {
@@ -533,6 +595,8 @@ static void __not_in_flash_func(eq_worker_loop)() {
         }
         c1eq_last_work_end = work_end;
 
+        deadline_record(1, work_end - work_start, sample_count, output_rate);
+
         // Signal completion to Core 0
         core1_eq_work.work_ready = false;
         __dmb();
@@ -561,12 +625,15 @@ static void __not_in_flash_func(eq_worker_loop)() {
         __dmb();
 
         uint32_t work_start = time_us_32();
+        ProfilerPass prof;
+        profiler_begin(&prof, 1);
 
         // Read work descriptor
-        int32_t (*buf_out)[192] = core1_eq_work.buf_out;
+        int32_t (*buf_out)[AUDIO_BUFFER_SAMPLES] = core1_eq_work.buf_out;
         uint32_t sample_count = core1_eq_work.sample_count;
         int32_t vol_mul = core1_eq_work.vol_mul;
         bool is_bypassed = bypass_master_eq;
+        bool morphing = scene_morph_block.active;
 
         // Process EQ + gain for outputs assigned to Core 1
         extern MatrixMixer matrix_mixer;
@@ -576,7 +643,9 @@ static void __not_in_flash_func(eq_worker_loop)() {
             // Output EQ (block-based)
             if (!matrix_mixer.outputs[out].mute) {
                 uint8_t eq_ch = CH_OUT_1 + out;
-                if (!is_bypassed && !channel_bypassed[eq_ch]) {
+                if (morphing) {
+                    scene_morph_eq_block(eq_ch, buf_out[out], sample_count);
+                } else if (!is_bypassed && !channel_bypassed[eq_ch]) {
                     dsp_process_channel_block(filters[eq_ch], buf_out[out], sample_count, eq_ch);
                 }
             }
@@ -593,9 +662,15 @@ static void __not_in_flash_func(eq_worker_loop)() {
             }
         }
 
+        profiler_mark(&prof, PROF_STAGE_C1_OUTPUT_EQ);
+
         // Delay for Core 1 outputs
         if (any_delay_active) {
             for (int out = CORE1_EQ_FIRST_OUTPUT; out <= CORE1_EQ_LAST_OUTPUT; out++) {
+                if (morphing) {
+                    scene_morph_delay_block(out, buf_out[out], core1_eq_work.delay_write_idx, sample_count);
+                    continue;
+                }
                 int32_t dly = channel_delay_samples[out];
                 if (dly <= 0) continue;
                 int32_t *dst = buf_out[out];
@@ -609,6 +684,8 @@ static void __not_in_flash_func(eq_worker_loop)() {
             }
         }
 
+        profiler_mark(&prof, PROF_STAGE_C1_DELAY);
+
         // Peak metering for Core 1 outputs
         for (int out = CORE1_EQ_FIRST_OUTPUT; out <= CORE1_EQ_LAST_OUTPUT; out++) {
             int32_t peak = 0;
@@ -626,8 +703,9 @@ static void __not_in_flash_func(eq_worker_loop)() {
             if (out_ptr) {
                 int left_out = CORE1_EQ_FIRST_OUTPUT;
                 int right_out = CORE1_EQ_FIRST_OUTPUT + 1;
-                if (!matrix_mixer.outputs[left_out].enabled &&
-                    !matrix_mixer.outputs[right_out].enabled) {
+                if ((!matrix_mixer.outputs[left_out].enabled &&
+                     !matrix_mixer.outputs[right_out].enabled) ||
+                    spdif_slot_rate_muted(feature_gate, 1)) {
                     memset(out_ptr, 0, sample_count * 8);
                 } else {
                     for (uint32_t i = 0; i < sample_count; i++) {
@@ -638,6 +716,9 @@ static void __not_in_flash_func(eq_worker_loop)() {
             }
         }
 
+        profiler_mark(&prof, PROF_STAGE_C1_PACK);
+        profiler_end(&prof, PROF_STAGE_CORE1_TOTAL);
+
         uint32_t work_end = time_us_32();
 
         if (c1eq_load_primed) {
@@ -656,6 +737,8 @@ static void __not_in_flash_func(eq_worker_loop)() {
         }
         c1eq_last_work_end = work_end;
 
+        deadline_record(1, work_end - work_start, sample_count, output_rate);
+
         // Signal completion to Core 0
         core1_eq_work.work_ready = false;
         __dmb();
@@ -667,6 +750,19 @@ static void __not_in_flash_func(eq_worker_loop)() {
 }
 #endif
 
+// ----------------------------------------------------------------------------
+// EQ WORKER HANDSHAKE (called from Core 0)
+// ----------------------------------------------------------------------------
+
+void core1_wait_block(void) {
+    __dmb();
+    if (core1_mode == CORE1_MODE_EQ_WORKER) {
+        while (core1_eq_work.work_ready && !core1_eq_work.work_done)
+            tight_loop_contents();
+        __dmb();
+    }
+}
+
 // ----------------------------------------------------------------------------
 // BUFFER FILL LEVEL ACCESSORS (called from Core 0)
 // ----------------------------------------------------------------------------
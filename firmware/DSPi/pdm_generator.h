@@ -24,4 +24,9 @@ extern volatile Core1Mode core1_mode;
 extern Core1EqWork core1_eq_work;
 extern volatile bool pdm_enabled;
 
+// Core 0 main loop: wait until the EQ worker block in flight, if any, has
+// finished.  After it returns Core 1 is not reading any state the main loop
+// changed before the call (an audio-path mask, a filter, a delay line).
+void core1_wait_block(void);
+
 #endif // PDM_GENERATOR_H
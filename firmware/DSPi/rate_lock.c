@@ -0,0 +1,113 @@
+/*
+ * rate_lock.c — Output rate lock (RP2350)
+ *
+ * Threading: the kernel and history are touched by the audio path only,
+ * and rate_lock_configure() runs in the main loop between packets, so they
+ * need no locking.  The control loop is written by the SOF IRQ; the main
+ * loop drops asrc_active before resetting it.  The ratio is read once per
+ * block, so a change never lands mid-block.
+ */
+
+#include <string.h>
+#include "rate_lock.h"
+#include "usb_audio.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#if ENABLE_ASRC
+
+_Static_assert(sizeof(RateLockStatusPacket) == 20, "RateLockStatusPacket is a wire format");
+_Static_assert(ASRC_MAX_BLOCK == AUDIO_BUFFER_SAMPLES, "ASRC blocks are one packet in and fit the audio buffers out");
+
+extern volatile uint8_t spdif0_consumer_fill;
+
+volatile bool asrc_active = false;
+asrc_ctrl_t asrc_ctrl;
+
+static AsrcKernel kernel;           // 12.2 KB
+static AsrcState state;
+
+static volatile uint32_t requested_rate = 0;
+static uint32_t applied_rate = 0;   // Lock in effect (0 = off)
+static uint32_t usb_rate = 0;       // Input side of the running ASRC
+static bool ratio_refused = false;  // Lock set, but usb_rate is too far above it
+
+void rate_lock_init(void) {
+    asrc_ctrl_init(&asrc_ctrl);
+    asrc_reset(&state);
+}
+
+void rate_lock_request(uint32_t rate) {
+    requested_rate = audio_rate_supported(rate) ? rate : 0;
+}
+
+uint32_t rate_lock_get(void) {
+    return requested_rate;
+}
+
+bool rate_lock_change_pending(void) {
+    return requested_rate != applied_rate;
+}
+
+uint32_t rate_lock_configure(uint32_t rate) {
+    asrc_active = false;
+    __dmb();
+    asrc_ctrl_stop(&asrc_ctrl);
+
+    applied_rate = requested_rate;
+    usb_rate = rate;
+    ratio_refused = false;
+    if (!applied_rate || applied_rate == rate) return applied_rate;
+    if (!asrc_ratio_supported(rate, applied_rate)) {
+        // Outputs follow the USB rate until it comes back in range
+        ratio_refused = true;
+        return 0;
+    }
+
+    asrc_kernel_design(&kernel, rate, applied_rate);
+    asrc_reset(&state);
+    asrc_ctrl_reset(&asrc_ctrl, rate, applied_rate);
+    __dmb();
+    asrc_active = true;
+    return applied_rate;
+}
+
+void rate_lock_reset_loop(void) {
+    if (!asrc_active) return;
+    uint32_t flags = save_and_disable_interrupts();
+    asrc_ctrl_reset(&asrc_ctrl, usb_rate, applied_rate);
+    restore_interrupts(flags);
+}
+
+uint32_t __not_in_flash_func(rate_lock_begin_block)(uint32_t n_in) {
+    return asrc_begin_block(&state, n_in, asrc_ctrl.ratio_q30);
+}
+
+void __not_in_flash_func(rate_lock_process)(float *l, float *r, uint32_t n_in, uint32_t n_out) {
+    asrc_process(&kernel, &state, l, r, n_in, l, r, n_out);
+}
+
+uint32_t rate_lock_latency_us(void) {
+    if (!asrc_active || !usb_rate) return 0;
+    return (uint32_t)((ASRC_TAPS / 2) * 1000000u / usb_rate);
+}
+
+void rate_lock_get_status(RateLockStatusPacket *pkt) {
+    memset(pkt, 0, sizeof(*pkt));
+    pkt->locked_rate   = requested_rate;
+    pkt->usb_rate      = audio_state.freq;
+    pkt->output_rate   = output_rate;
+    pkt->consumer_fill = spdif0_consumer_fill;
+    pkt->fill_target   = asrc_ctrl.fill_target;
+    if (asrc_active) {
+        pkt->state     = asrc_ctrl_locked(&asrc_ctrl) ? RATE_LOCK_STATE_LOCKED
+                                                      : RATE_LOCK_STATE_TRACKING;
+        pkt->ratio_ppm = asrc_ctrl_ratio_ppm(&asrc_ctrl);
+    } else {
+        pkt->state     = !applied_rate ? RATE_LOCK_STATE_OFF
+                       : ratio_refused ? RATE_LOCK_STATE_UNSUPPORTED
+                                       : RATE_LOCK_STATE_DIRECT;
+    }
+}
+
+#endif // ENABLE_ASRC
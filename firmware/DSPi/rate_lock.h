@@ -0,0 +1,75 @@
+/*
+ * rate_lock.h — Output rate lock (RP2350)
+ *
+ * Runs the DSP pipeline and every output at a fixed, user-selected rate
+ * whatever rate the host streams at.  An ASRC (asrc.h) right after input
+ * conversion resamples the USB stream to the locked rate, so a host rate
+ * change no longer retunes the output clocks, rebuilds the coefficients or
+ * makes a downstream DAC re-lock — only the ASRC's own table is redesigned.
+ *
+ * While the ASRC runs, the feedback endpoint holds the nominal USB rate and
+ * the ASRC control loop takes over the consumer fill servo (usb_sof_irq):
+ * the host clock is followed by the resampling ratio instead of by the
+ * host.  When the USB rate is the locked rate the ASRC is bypassed and the
+ * feedback loop runs as it does without a lock.
+ *
+ * Requests may come from the USB IRQ.  Applying one needs a pipeline
+ * reset, so the main loop polls rate_lock_change_pending() and goes through
+ * perform_rate_change(), which calls rate_lock_configure().
+ */
+
+#ifndef RATE_LOCK_H
+#define RATE_LOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+#if ENABLE_ASRC
+
+#include "asrc.h"
+
+// Audio path and SOF IRQ: the ASRC is between input conversion and the
+// master EQ.
+extern volatile bool asrc_active;
+
+// SOF IRQ: control loop, fed in place of fb_ctrl while asrc_active.
+extern asrc_ctrl_t asrc_ctrl;
+
+void rate_lock_init(void);
+
+// Lock the outputs to rate (Hz), or 0 for off.  Rates the outputs cannot
+// run at select off.  IRQ-safe; applied by the main loop.
+void rate_lock_request(uint32_t rate);
+
+// Requested lock (what REQ_SET_RATE_LOCK last set), 0 = off.
+uint32_t rate_lock_get(void);
+
+// Requested lock differs from the applied one.
+bool rate_lock_change_pending(void);
+
+// Main loop, from perform_rate_change() with the audio path idle: apply the
+// requested lock for a USB stream at usb_rate.  Returns the locked output
+// rate, or 0 if the outputs follow the USB rate — including when usb_rate
+// is ASRC_MAX_RATIO or more times the lock (state UNSUPPORTED).
+uint32_t rate_lock_configure(uint32_t usb_rate);
+
+// Re-baseline the control loop after the consumer pools were drained.
+void rate_lock_reset_loop(void);
+
+// Audio path, while asrc_active: output samples the next rate_lock_process()
+// of n_in inputs produces (at most ASRC_MAX_BLOCK).
+uint32_t rate_lock_begin_block(uint32_t n_in);
+
+// Audio path: resample n_in samples of l / r in place to the n_out that
+// rate_lock_begin_block() returned.
+void rate_lock_process(float *l, float *r, uint32_t n_in, uint32_t n_out);
+
+// ASRC group delay in microseconds (0 while bypassed).
+uint32_t rate_lock_latency_us(void);
+
+void rate_lock_get_status(RateLockStatusPacket *pkt);
+
+#endif // ENABLE_ASRC
+
+#endif // RATE_LOCK_H
@@ -0,0 +1,483 @@
+/*
+ * scene_morph.c — Crossfaded A/B scene morphing
+ *
+ * Threading: requests arrive from the vendor handler (USB IRQ) and are
+ * picked up by scene_morph_service() in the main loop.  The position is
+ * advanced by scene_morph_begin_block(), which runs on Core 0 inside
+ * process_audio_packet() — also main-loop context, so the run state below
+ * needs no locking.  Core 1 only reads scene_morph_block and the B bank,
+ * and only while a packet it was handed is in flight; the main loop never
+ * runs during that window.
+ */
+
+#include "scene_morph.h"
+#include "dsp_pipeline.h"
+#include "flash_storage.h"
+#include "pdm_generator.h"
+#include "usb_audio.h"
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/sync.h"
+#include <string.h>
+
+extern MatrixMixer matrix_mixer;
+
+// Start-gate cost model: cycles per active biquad per sample, and per
+// morphing channel per sample for the B-side copy, the mix and the second
+// delay tap.  Estimates, deliberately on the high side.
+#if PICO_RP2350
+#define MORPH_BIQUAD_CYCLES     14
+#define MORPH_CHANNEL_CYCLES    8
+#else
+#define MORPH_BIQUAD_CYCLES     60
+#define MORPH_CHANNEL_CYCLES    24
+#endif
+#define MORPH_LOAD_LIMIT_PCT    90
+
+volatile SceneMorphBlock scene_morph_block;
+
+// Scene B EQ bank (coefficients + state) and its per-channel summary
+static Biquad  morph_filters[NUM_CHANNELS][MAX_BANDS];
+static bool    morph_b_on[NUM_CHANNELS];        // B bank has an active band
+static bool    morph_a_off[NUM_CHANNELS];       // A bank silenced by scene A's EQ bypass
+static int32_t morph_delay_b[NUM_DELAY_CHANNELS];
+
+static SceneLevels levels_a, levels_b;
+
+// Scene A values overwritten while morphing, restored when ending on A
+static MatrixMixer saved_matrix;
+static float       saved_preamp_linear[NUM_INPUT_CHANNELS];
+static int32_t     saved_preamp_mul[NUM_INPUT_CHANNELS];
+static float       saved_master_linear;
+static int32_t     saved_master_q15;
+static bool        saved_eq_bypass;
+
+// Requests (USB IRQ → main loop)
+static volatile bool     req_start;
+static volatile bool     req_position;
+static volatile bool     req_end;
+static volatile SceneMorphRequestPacket req_start_pkt;
+static volatile uint16_t req_position_val;
+static volatile uint8_t  req_end_scene;
+
+// Run state
+static uint8_t  morph_state = SCENE_MORPH_STATE_IDLE;
+static uint8_t  morph_slot;
+static uint8_t  morph_mode;
+static uint8_t  morph_result = SCENE_MORPH_OK;
+static uint8_t  morph_est_load[2];
+static uint32_t morph_rate;
+static float    morph_step;                 // Position change per sample
+static float    morph_position;             // 0 = A, 1 = B
+static float    morph_target;
+
+// Per-core scratch for the B side of scene_morph_eq_block()
+#if PICO_RP2350
+static float   morph_scratch[2][AUDIO_BUFFER_SAMPLES];
+#else
+static int32_t morph_scratch[2][AUDIO_BUFFER_SAMPLES];
+#endif
+
+// ----------------------------------------------------------------------------
+// REQUESTS / STATUS
+// ----------------------------------------------------------------------------
+
+void scene_morph_request_start(const SceneMorphRequestPacket *req) {
+    req_start_pkt.slot = req->slot;
+    req_start_pkt.mode = req->mode;
+    req_start_pkt.time_ms = req->time_ms;
+    __dmb();
+    req_start = true;
+}
+
+void scene_morph_request_position(uint16_t position) {
+    req_position_val = position;
+    __dmb();
+    req_position = true;
+}
+
+void scene_morph_request_end(uint8_t scene) {
+    req_end_scene = scene ? 1 : 0;
+    __dmb();
+    req_end = true;
+}
+
+void scene_morph_status(SceneMorphStatusPacket *out) {
+    out->state = morph_state;
+    out->slot = morph_slot;
+    out->mode = morph_mode;
+    out->result = morph_result;
+    out->position = (uint16_t)(morph_position * 65535.0f + 0.5f);
+    out->est_cpu0_load = morph_est_load[0];
+    out->est_cpu1_load = morph_est_load[1];
+}
+
+// ----------------------------------------------------------------------------
+// GAIN STAGES
+// ----------------------------------------------------------------------------
+
+static void levels_from_live(SceneLevels *lv) {
+    for (int in = 0; in < NUM_INPUT_CHANNELS; in++) {
+        for (int out = 0; out < NUM_OUTPUT_CHANNELS; out++) {
+            const MatrixCrosspoint *xp = &matrix_mixer.crosspoints[in][out];
+            float g = xp->enabled ? xp->gain_linear : 0.0f;
+            lv->xp_gain[in][out] = xp->phase_invert ? -g : g;
+        }
+    }
+    for (int out = 0; out < NUM_OUTPUT_CHANNELS; out++) {
+        const OutputChannel *oc = &matrix_mixer.outputs[out];
+        lv->out_enabled[out] = oc->enabled != 0;
+        lv->out_gain[out] = (oc->enabled && !oc->mute) ? oc->gain_linear : 0.0f;
+        lv->out_delay_ms[out] = oc->delay_ms;
+    }
+    for (int i = 0; i < NUM_INPUT_CHANNELS; i++) lv->preamp[i] = global_preamp_linear[i];
+    lv->master = master_volume_linear;
+    lv->eq_bypass = bypass_master_eq;
+}
+
+static inline float lerp(float a, float b, float w) {
+    return a + (b - a) * w;
+}
+
+// Write the interpolated gain stages into the live state.  Polarity is
+// folded into the crosspoint gain so a route can pass through zero.
+static void levels_apply(float w) {
+    for (int in = 0; in < NUM_INPUT_CHANNELS; in++) {
+        for (int out = 0; out < NUM_OUTPUT_CHANNELS; out++) {
+            MatrixCrosspoint *xp = &matrix_mixer.crosspoints[in][out];
+            xp->gain_linear = lerp(levels_a.xp_gain[in][out], levels_b.xp_gain[in][out], w);
+        }
+    }
+    for (int out = 0; out < NUM_OUTPUT_CHANNELS; out++) {
+        matrix_mixer.outputs[out].gain_linear = lerp(levels_a.out_gain[out], levels_b.out_gain[out], w);
+    }
+    for (int i = 0; i < NUM_INPUT_CHANNELS; i++) {
+        float g = lerp(levels_a.preamp[i], levels_b.preamp[i], w);
+        global_preamp_linear[i] = g;
+        global_preamp_mul[i] = (int32_t)(g * (float)(1 << 28));
+    }
+    float m = lerp(levels_a.master, levels_b.master, w);
+    master_volume_linear = m;
+    master_volume_q15 = (int32_t)(m * 32768.0f);
+}
+
+// Put the live flags in morph form: every route and output either scene
+// uses is open, polarity and mute live in the interpolated gains.
+static void levels_open(void) {
+    for (int in = 0; in < NUM_INPUT_CHANNELS; in++) {
+        for (int out = 0; out < NUM_OUTPUT_CHANNELS; out++) {
+            MatrixCrosspoint *xp = &matrix_mixer.crosspoints[in][out];
+            xp->enabled = (levels_a.xp_gain[in][out] != 0.0f || levels_b.xp_gain[in][out] != 0.0f);
+            xp->phase_invert = 0;
+        }
+    }
+    for (int out = 0; out < NUM_OUTPUT_CHANNELS; out++) {
+        matrix_mixer.outputs[out].enabled = levels_a.out_enabled[out] || levels_b.out_enabled[out];
+        matrix_mixer.outputs[out].mute = 0;
+    }
+    bypass_master_eq = false;
+}
+
+// ----------------------------------------------------------------------------
+// START / END
+// ----------------------------------------------------------------------------
+
+// Channels whose EQ a scene-wide bypass silences
+static bool eq_bypass_covers(int ch) {
+#if PICO_RP2350
+    return ch == CH_MASTER_LEFT || ch == CH_MASTER_RIGHT;
+#else
+    (void)ch;
+    return true;   // RP2040 bypass also skips output EQ
+#endif
+}
+
+static uint32_t active_bands(const Biquad *bank, int ch) {
+    uint32_t n = 0;
+    for (int b = 0; b < channel_band_counts[ch]; b++) {
+        if (!bank[b].bypass) n++;
+    }
+    return n;
+}
+
+// Estimated load (%) of one core with the B bank added
+static uint8_t estimate_load(uint8_t current, uint32_t biquads, uint32_t channels) {
+    uint64_t cycles = (uint64_t)(biquads * MORPH_BIQUAD_CYCLES + channels * MORPH_CHANNEL_CYCLES)
+                    * morph_rate;
+    uint32_t extra = (uint32_t)(cycles * 100u / clock_get_hz(clk_sys));
+    uint32_t total = current + extra;
+    return (uint8_t)(total > 255 ? 255 : total);
+}
+
+// Each core runs the B bank for the channels it already processes.
+static bool morph_load_ok(void) {
+    uint32_t biquads[2] = {0, 0}, channels[2] = {0, 0};
+    bool worker = (core1_mode == CORE1_MODE_EQ_WORKER);
+
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        if (!morph_b_on[ch]) continue;
+        int out = ch - CH_OUT_1;
+        if (out >= 0 && !matrix_mixer.outputs[out].enabled && !levels_b.out_enabled[out]) continue;
+        int core = (worker && out >= CORE1_EQ_FIRST_OUTPUT && out <= CORE1_EQ_LAST_OUTPUT) ? 1 : 0;
+        biquads[core] += active_bands(morph_filters[ch], ch);
+        channels[core]++;
+    }
+
+    morph_est_load[0] = estimate_load(global_status.cpu0_load, biquads[0], channels[0]);
+    morph_est_load[1] = worker ? estimate_load(global_status.cpu1_load, biquads[1], channels[1]) : 0;
+    return morph_est_load[0] <= MORPH_LOAD_LIMIT_PCT && morph_est_load[1] <= MORPH_LOAD_LIMIT_PCT;
+}
+
+static uint8_t morph_start(uint8_t slot, uint8_t mode, uint32_t time_ms) {
+    if (morph_state != SCENE_MORPH_STATE_IDLE) {
+        morph_result = SCENE_MORPH_ERR_BUSY;
+        return morph_result;
+    }
+    if (mode > SCENE_MORPH_MODE_MANUAL) mode = SCENE_MORPH_MODE_CROSSFADE;
+    if (time_ms == 0) time_ms = SCENE_MORPH_DEFAULT_MS;
+    if (time_ms > SCENE_MORPH_MAX_MS) time_ms = SCENE_MORPH_MAX_MS;
+
+    morph_slot = slot;
+    morph_mode = mode;
+    morph_rate = output_rate;
+
+    if (!preset_cache_scene(slot, morph_filters, &levels_b)) {
+        morph_result = SCENE_MORPH_ERR_NOT_CACHED;
+        return morph_result;
+    }
+    levels_from_live(&levels_a);
+
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        morph_a_off[ch] = levels_a.eq_bypass && eq_bypass_covers(ch);
+        morph_b_on[ch] = !(levels_b.eq_bypass && eq_bypass_covers(ch))
+                      && active_bands(morph_filters[ch], ch) > 0;
+    }
+
+    if (!morph_load_ok()) {
+        morph_result = SCENE_MORPH_ERR_CPU;
+        return morph_result;
+    }
+
+    // Delay lines are only written for outputs with a delay.  Any line the
+    // B tap will read that scene A has not been feeding holds stale audio.
+    for (int out = 0; out < NUM_DELAY_CHANNELS; out++) {
+        morph_delay_b[out] = dsp_delay_samples_for(out, levels_b.out_delay_ms[out], (float)morph_rate);
+        if (morph_delay_b[out] > 0 && (!any_delay_active || channel_delay_samples[out] <= 0)) {
+            memset(delay_lines[out], 0, sizeof(delay_lines[out]));
+        }
+    }
+
+    memcpy(&saved_matrix, &matrix_mixer, sizeof(saved_matrix));
+    for (int i = 0; i < NUM_INPUT_CHANNELS; i++) {
+        saved_preamp_linear[i] = global_preamp_linear[i];
+        saved_preamp_mul[i] = global_preamp_mul[i];
+    }
+    saved_master_linear = master_volume_linear;
+    saved_master_q15 = master_volume_q15;
+    saved_eq_bypass = bypass_master_eq;
+
+    morph_position = 0.0f;
+    morph_step = 1000.0f / ((float)time_ms * (float)morph_rate);
+    if (mode == SCENE_MORPH_MODE_CROSSFADE) {
+        morph_target = 1.0f;
+        morph_state = SCENE_MORPH_STATE_ENDING;
+    } else {
+        morph_target = 0.0f;
+        morph_state = SCENE_MORPH_STATE_RUNNING;
+    }
+
+    levels_open();
+    levels_apply(0.0f);
+    any_delay_active = true;   // Both taps advance the shared write index
+    morph_result = SCENE_MORPH_OK;
+    return morph_result;
+}
+
+static void morph_stop(void) {
+    morph_state = SCENE_MORPH_STATE_IDLE;
+    scene_morph_block.active = false;
+    __dmb();
+}
+
+// Back to scene A as captured at start
+static void morph_end_on_a(void) {
+    memcpy(&matrix_mixer, &saved_matrix, sizeof(matrix_mixer));
+    for (int i = 0; i < NUM_INPUT_CHANNELS; i++) {
+        global_preamp_linear[i] = saved_preamp_linear[i];
+        global_preamp_mul[i] = saved_preamp_mul[i];
+    }
+    master_volume_linear = saved_master_linear;
+    master_volume_q15 = saved_master_q15;
+    bypass_master_eq = saved_eq_bypass;
+    dsp_update_delay_samples((float)output_rate);
+    morph_stop();
+}
+
+// Make scene B live.  The B bank is copied with its running state, so the
+// single-bank path continues exactly where the B side of the mix left off.
+static bool morph_end_on_b(void) {
+    if (!preset_cache_commit_scene(morph_slot)) {
+        morph_end_on_a();
+        return false;
+    }
+    memcpy(filters, morph_filters, sizeof(filters));
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        channel_bypassed[ch] = (active_bands(filters[ch], ch) == 0);
+    }
+    dsp_update_delay_samples((float)output_rate);
+    morph_stop();
+    return true;
+}
+
+uint8_t scene_morph_start_preset(uint8_t slot) {
+    return morph_start(slot, SCENE_MORPH_MODE_CROSSFADE, SCENE_MORPH_DEFAULT_MS);
+}
+
+void scene_morph_cancel(void) {
+    if (morph_state == SCENE_MORPH_STATE_IDLE) return;
+    morph_end_on_a();
+    morph_result = SCENE_MORPH_ERR_CANCELLED;
+}
+
+bool scene_morph_service(void) {
+    if (req_start) {
+        req_start = false;
+        __dmb();
+        morph_start(req_start_pkt.slot, req_start_pkt.mode, req_start_pkt.time_ms);
+    }
+    if (morph_state == SCENE_MORPH_STATE_IDLE) {
+        req_position = false;
+        req_end = false;
+        return false;
+    }
+
+    // The B bank was designed for the rate at start
+    if (output_rate != morph_rate) {
+        scene_morph_cancel();
+        return false;
+    }
+
+    if (req_position) {
+        req_position = false;
+        if (morph_state == SCENE_MORPH_STATE_RUNNING)
+            morph_target = (float)req_position_val / 65535.0f;
+    }
+    if (req_end) {
+        req_end = false;
+        morph_target = req_end_scene ? 1.0f : 0.0f;
+        morph_state = SCENE_MORPH_STATE_ENDING;
+    }
+
+    levels_apply(morph_position);
+    any_delay_active = true;
+
+    if (morph_state == SCENE_MORPH_STATE_ENDING && morph_position == morph_target) {
+        if (morph_target >= 1.0f) return morph_end_on_b();
+        morph_end_on_a();
+    }
+    return false;
+}
+
+// ----------------------------------------------------------------------------
+// AUDIO PATH
+// ----------------------------------------------------------------------------
+
+void __not_in_flash_func(scene_morph_begin_block)(uint32_t sample_count) {
+    if (morph_state == SCENE_MORPH_STATE_IDLE) {
+        scene_morph_block.active = false;
+        return;
+    }
+
+    float w0 = morph_position;
+    float delta = morph_step * (float)sample_count;
+    if (morph_position < morph_target) {
+        morph_position += delta;
+        if (morph_position > morph_target) morph_position = morph_target;
+    } else if (morph_position > morph_target) {
+        morph_position -= delta;
+        if (morph_position < morph_target) morph_position = morph_target;
+    }
+
+#if PICO_RP2350
+    scene_morph_block.w0 = w0;
+    scene_morph_block.w1 = morph_position;
+#else
+    scene_morph_block.w0 = (int32_t)(w0 * (float)(1 << 28));
+    scene_morph_block.w1 = (int32_t)(morph_position * (float)(1 << 28));
+#endif
+    scene_morph_block.active = true;
+}
+
+#if PICO_RP2350
+void __not_in_flash_func(scene_morph_eq_block)(uint8_t ch, float *samples, uint32_t count) {
+    bool a_on = !channel_bypassed[ch] && !morph_a_off[ch];
+    bool b_on = morph_b_on[ch];
+    if ((!a_on && !b_on) || count == 0) return;
+
+    float *b = morph_scratch[get_core_num()];
+    memcpy(b, samples, count * sizeof(float));
+    if (a_on) dsp_process_channel_block(filters[ch], samples, count, ch);
+    if (b_on) dsp_process_channel_block(morph_filters[ch], b, count, ch);
+
+    float w = scene_morph_block.w0;
+    float dw = (scene_morph_block.w1 - w) / (float)count;
+    for (uint32_t i = 0; i < count; i++) {
+        samples[i] += w * (b[i] - samples[i]);
+        w += dw;
+    }
+}
+
+void __not_in_flash_func(scene_morph_delay_block)(int out, float *samples, uint32_t write_idx, uint32_t count) {
+    int32_t da = channel_delay_samples[out];
+    int32_t db = morph_delay_b[out];
+    if ((da <= 0 && db <= 0) || count == 0) return;
+
+    float *dline = delay_lines[out];
+    float w = scene_morph_block.w0;
+    float dw = (scene_morph_block.w1 - w) / (float)count;
+    for (uint32_t i = 0; i < count; i++) {
+        dline[write_idx] = samples[i];
+        float a = dline[(write_idx - da) & MAX_DELAY_MASK];
+        float b = dline[(write_idx - db) & MAX_DELAY_MASK];
+        samples[i] = a + w * (b - a);
+        write_idx = (write_idx + 1) & MAX_DELAY_MASK;
+        w += dw;
+    }
+}
+#else
+void __not_in_flash_func(scene_morph_eq_block)(uint8_t ch, int32_t *samples, uint32_t count) {
+    bool a_on = !channel_bypassed[ch] && !morph_a_off[ch];
+    bool b_on = morph_b_on[ch];
+    if ((!a_on && !b_on) || count == 0) return;
+
+    int32_t *b = morph_scratch[get_core_num()];
+    memcpy(b, samples, count * sizeof(int32_t));
+    if (a_on) dsp_process_channel_block(filters[ch], samples, count, ch);
+    if (b_on) dsp_process_channel_block(morph_filters[ch], b, count, ch);
+
+    int32_t w = scene_morph_block.w0;
+    int32_t dw = (scene_morph_block.w1 - w) / (int32_t)count;
+    for (uint32_t i = 0; i < count; i++) {
+        samples[i] += fast_mul_q28(b[i] - samples[i], w);
+        w += dw;
+    }
+}
+
+void __not_in_flash_func(scene_morph_delay_block)(int out, int32_t *samples, uint32_t write_idx, uint32_t count) {
+    int32_t da = channel_delay_samples[out];
+    int32_t db = morph_delay_b[out];
+    if ((da <= 0 && db <= 0) || count == 0) return;
+
+    int32_t *dline = delay_lines[out];
+    int32_t w = scene_morph_block.w0;
+    int32_t dw = (scene_morph_block.w1 - w) / (int32_t)count;
+    for (uint32_t i = 0; i < count; i++) {
+        dline[write_idx] = samples[i];
+        int32_t a = dline[(write_idx - da) & MAX_DELAY_MASK];
+        int32_t b = dline[(write_idx - db) & MAX_DELAY_MASK];
+        samples[i] = a + fast_mul_q28(b - a, w);
+        write_idx = (write_idx + 1) & MAX_DELAY_MASK;
+        w += dw;
+    }
+}
+#endif
@@ -0,0 +1,92 @@
+/*
+ * scene_morph.h — Crossfaded A/B scene morphing
+ *
+ * Scene A is the live state; scene B is a preset slot taken from the preset
+ * RAM cache (flash_storage.h).  While a morph runs both EQ banks process
+ * every enabled channel and their outputs are mixed per sample by the morph
+ * position.  The linear gain stages (matrix crosspoints, output gains,
+ * preamp, master volume) are interpolated instead of run twice, and each
+ * delayed output reads two taps from its delay line.  Both ends are exact:
+ * at position 0 the output is scene A, at position 1 it is scene B.
+ *
+ * Each core runs the B bank for the channels it already owns (Core 0:
+ * master EQ + outputs 0-1, Core 1: the EQ worker outputs), so the extra
+ * EQ load is split the same way as the normal load.  A start is refused if
+ * the estimated per-core load with both banks exceeds a limit.
+ *
+ * Loudness, crossfeed, leveller, channel names and the legacy channel gains
+ * are not morphed; they change when scene B is committed.  Scene B must be
+ * switchable from the RAM cache (same output types, clocks, pins and Core 1
+ * mode as the live state).
+ *
+ * The morph owns the matrix, output gain, preamp and master volume values
+ * while it runs.  Ending on scene A restores the values captured at start.
+ */
+
+#ifndef SCENE_MORPH_H
+#define SCENE_MORPH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+// Gain-stage values of one scene, as the pipeline uses them
+typedef struct {
+    float xp_gain[NUM_INPUT_CHANNELS][NUM_OUTPUT_CHANNELS];  // Signed linear; 0 = route off
+    float out_gain[NUM_OUTPUT_CHANNELS];                     // Linear; 0 = output off or muted
+    bool  out_enabled[NUM_OUTPUT_CHANNELS];
+    float out_delay_ms[NUM_OUTPUT_CHANNELS];
+    float preamp[NUM_INPUT_CHANNELS];                        // Linear
+    float master;                                            // Linear master volume
+    bool  eq_bypass;                                         // bypass_master_eq
+} SceneLevels;
+
+// Per-block morph weights, written by Core 0 at the start of each audio
+// packet and read by both cores while it is processed.
+typedef struct {
+    bool active;
+#if PICO_RP2350
+    float w0, w1;                // Position at block start / end (0 = A, 1 = B)
+#else
+    int32_t w0, w1;              // Same, Q28
+#endif
+} SceneMorphBlock;
+
+extern volatile SceneMorphBlock scene_morph_block;
+
+// Vendor requests.  IRQ-safe; applied by the next scene_morph_service().
+void scene_morph_request_start(const SceneMorphRequestPacket *req);
+void scene_morph_request_position(uint16_t position);
+void scene_morph_request_end(uint8_t scene);
+void scene_morph_status(SceneMorphStatusPacket *out);
+
+// Main loop: start/stop morphs, interpolate gain stages, commit scene B.
+// Returns true when scene B has just become the live state.
+bool scene_morph_service(void);
+
+// Main loop: crossfade to a cached preset slot over SCENE_MORPH_DEFAULT_MS
+// (a cached REQ_PRESET_LOAD).  Returns SCENE_MORPH_OK if the morph started,
+// else the refusal (nothing changed).  The slot becomes active when the
+// crossfade commits it.
+uint8_t scene_morph_start_preset(uint8_t slot);
+
+// Main loop: abandon a running morph and snap back to scene A.  Called
+// before anything rewrites the live state wholesale (preset load, rate
+// change, factory reset).
+void scene_morph_cancel(void);
+
+// Core 0, once per audio packet before any processing: advance the
+// position and publish this block's weights in scene_morph_block.
+void scene_morph_begin_block(uint32_t sample_count);
+
+// Either core, in place of dsp_process_channel_block() while
+// scene_morph_block.active: run both banks on `ch` and mix.
+#if PICO_RP2350
+void scene_morph_eq_block(uint8_t ch, float *samples, uint32_t count);
+void scene_morph_delay_block(int out, float *samples, uint32_t write_idx, uint32_t count);
+#else
+void scene_morph_eq_block(uint8_t ch, int32_t *samples, uint32_t count);
+void scene_morph_delay_block(int out, int32_t *samples, uint32_t write_idx, uint32_t count);
+#endif
+
+#endif // SCENE_MORPH_H
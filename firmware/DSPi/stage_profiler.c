@@ -0,0 +1,119 @@
+/*
+ * stage_profiler.c — Per-stage cycle profiler for the audio pipeline
+ *
+ * Statistics are kept in cycles.  The mean is sum / count at readout; the
+ * sum is 64-bit, so it cannot wrap within any realistic session.
+ */
+
+#include <string.h>
+#include "stage_profiler.h"
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+
+_Static_assert(PROF_STAGE_COUNT <= 16, "stage masks are 16-bit");
+_Static_assert(sizeof(ProfilerStagePacket) <= 64, "profiler packet exceeds the vendor response buffer");
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint16_t hist[PROFILER_HIST_BINS];
+} StageStats;
+
+volatile bool profiler_enabled = false;
+
+static StageStats stage_stats[PROF_STAGE_COUNT];
+static volatile uint32_t reset_seq = 0;         // Bumped by profiler_control()
+static uint32_t core_reset_seq[2];              // Last reset each core applied
+static bool     core_counter_on[2];
+
+static inline uint8_t stage_core(uint8_t stage) {
+    return stage >= PROF_STAGE_FIRST_CORE1 ? 1 : 0;
+}
+
+// Start the calling core's cycle counter.  Both sources are per-core.
+static void counter_start(void) {
+#if PICO_RP2350
+    m33_hw->demcr |= M33_DEMCR_TRCENA_BITS;
+    m33_hw->dwt_cyccnt = 0;
+    m33_hw->dwt_ctrl |= M33_DWT_CTRL_CYCCNTENA_BITS;
+#else
+    systick_hw->csr = 0;
+    systick_hw->rvr = PROFILER_CYCLE_MASK;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5;                      // ENABLE | CLKSOURCE = processor clock, no IRQ
+#endif
+}
+
+static void __not_in_flash_func(stage_record)(StageStats *s, uint32_t cycles) {
+    if (s->count == 0 || cycles < s->min) s->min = cycles;
+    if (cycles > s->max) s->max = cycles;
+    s->sum += cycles;
+    s->count++;
+
+    int bits = cycles ? 32 - __builtin_clz(cycles) : 0;
+    int bin = bits - PROFILER_HIST_FIRST_BITS;
+    if (bin < 0) bin = 0;
+    if (bin >= PROFILER_HIST_BINS) bin = PROFILER_HIST_BINS - 1;
+    if (s->hist[bin] == UINT16_MAX) {
+        for (int i = 0; i < PROFILER_HIST_BINS; i++) s->hist[i] >>= 1;
+    }
+    s->hist[bin]++;
+}
+
+void __not_in_flash_func(profiler_pass_start)(ProfilerPass *p, uint8_t core) {
+    if (!core_counter_on[core]) {
+        counter_start();
+        core_counter_on[core] = true;
+    }
+
+    // Apply a pending reset to this core's stages
+    uint32_t seq = reset_seq;
+    if (core_reset_seq[core] != seq) {
+        core_reset_seq[core] = seq;
+        for (int st = 0; st < PROF_STAGE_COUNT; st++) {
+            if (stage_core(st) == core) memset(&stage_stats[st], 0, sizeof(StageStats));
+        }
+    }
+
+    p->marked = 0;
+    memset(p->acc, 0, sizeof(p->acc));
+    p->start = p->last = profiler_cycles();
+}
+
+void __not_in_flash_func(profiler_pass_record)(ProfilerPass *p, uint8_t total_stage) {
+    uint32_t total = (profiler_cycles() - p->start) & PROFILER_CYCLE_MASK;
+    for (int st = 0; st < PROF_STAGE_COUNT; st++) {
+        if (p->marked & (1u << st)) stage_record(&stage_stats[st], p->acc[st]);
+    }
+    stage_record(&stage_stats[total_stage], total);
+}
+
+void profiler_control(uint8_t flags) {
+    if (flags & PROFILER_FLAG_RESET) reset_seq++;
+    profiler_enabled = (flags & PROFILER_FLAG_ENABLE) != 0;
+}
+
+bool profiler_get_stage(uint8_t stage, ProfilerStagePacket *out) {
+    if (stage >= PROF_STAGE_COUNT) return false;
+
+    // A reset not yet applied by its core reads as empty
+    bool stale = core_reset_seq[stage_core(stage)] != reset_seq;
+    StageStats s;
+    if (stale) memset(&s, 0, sizeof(s));
+    else memcpy(&s, &stage_stats[stage], sizeof(s));
+
+    memset(out, 0, sizeof(*out));
+    out->stage = stage;
+    out->core = stage_core(stage);
+    out->flags = profiler_enabled ? PROFILER_FLAG_ENABLE : 0;
+    out->stage_count = PROF_STAGE_COUNT;
+    out->count = s.count;
+    out->min_cycles = s.min;
+    out->max_cycles = s.max;
+    out->mean_cycles = s.count ? (uint32_t)(s.sum / s.count) : 0;
+    out->clk_sys_hz = clock_get_hz(clk_sys);
+    memcpy(out->hist, s.hist, sizeof(out->hist));
+    return true;
+}
@@ -0,0 +1,90 @@
+/*
+ * stage_profiler.h — Per-stage cycle profiler for the audio pipeline
+ *
+ * cpu0_load / cpu1_load say how busy each core is; the profiler says where
+ * the time goes.  When enabled, each pass of process_audio_packet() (Core 0)
+ * and eq_worker_loop() (Core 1) reads the core's cycle counter at every
+ * stage boundary and folds the per-stage counts into min / mean / max and a
+ * log2 histogram (PROF_STAGE_* in config.h).
+ *
+ * Cycle source: DWT CYCCNT on RP2350, SysTick (24-bit, clk_sys) on RP2040,
+ * which has no cycle counter.  Each core's counter is started on its first
+ * profiled pass; both are per-core, so no stage ever mixes counters.
+ *
+ * Disabled cost is one flag read per pass plus one branch per mark.  When
+ * enabled, a mark costs a few cycles (charged to the following stage) and
+ * the end-of-pass recording is outside every stage, including the total.
+ *
+ * Each core writes only its own stages.  Control and readout come from the
+ * vendor IRQ: a reset is picked up by each core at the start of its next
+ * pass, and a readout is a plain copy (a pass may tear it; it is a
+ * diagnostic).
+ */
+
+#ifndef STAGE_PROFILER_H
+#define STAGE_PROFILER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+#if PICO_RP2350
+#include "hardware/structs/m33.h"
+#define PROFILER_CYCLE_MASK     0xFFFFFFFFu
+#else
+#include "hardware/structs/systick.h"
+#define PROFILER_CYCLE_MASK     0x00FFFFFFu
+#endif
+
+extern volatile bool profiler_enabled;
+
+// One pass on one core.  Lives on the caller's stack.
+typedef struct {
+    bool     on;
+    uint16_t marked;                    // Bit per stage marked this pass
+    uint32_t start;
+    uint32_t last;
+    uint32_t acc[PROF_STAGE_COUNT];
+} ProfilerPass;
+
+static inline uint32_t profiler_cycles(void) {
+#if PICO_RP2350
+    return m33_hw->dwt_cyccnt;
+#else
+    return ~systick_hw->cvr;            // SysTick counts down; masked by the caller
+#endif
+}
+
+// Out-of-line halves of the inline helpers below
+void profiler_pass_start(ProfilerPass *p, uint8_t core);
+void profiler_pass_record(ProfilerPass *p, uint8_t total_stage);
+
+// Begin a pass on `core`.  No-op unless profiling is enabled.
+static inline void profiler_begin(ProfilerPass *p, uint8_t core) {
+    p->on = profiler_enabled;
+    if (p->on) profiler_pass_start(p, core);
+}
+
+// Charge the cycles since the previous mark to `stage`.  A stage may be
+// marked more than once per pass; its parts add up.
+static inline void profiler_mark(ProfilerPass *p, uint8_t stage) {
+    if (!p->on) return;
+    uint32_t now = profiler_cycles();
+    p->acc[stage] += (now - p->last) & PROFILER_CYCLE_MASK;
+    p->marked |= (uint16_t)(1u << stage);
+    p->last = now;
+}
+
+// End the pass: record every marked stage and the whole pass as total_stage.
+static inline void profiler_end(ProfilerPass *p, uint8_t total_stage) {
+    if (p->on) profiler_pass_record(p, total_stage);
+}
+
+// Apply PROFILER_FLAG_* from REQ_SET_PROFILER.  IRQ-safe.
+void profiler_control(uint8_t flags);
+
+// Statistics for one stage (REQ_GET_PROFILER_STAGE).  False if the stage
+// index is out of range.  IRQ-safe.
+bool profiler_get_stage(uint8_t stage, ProfilerStagePacket *out);
+
+#endif // STAGE_PROFILER_H
@@ -36,6 +36,19 @@
 #include "crossfeed.h"
 #include "leveller.h"
 #include "bulk_params.h"
+#include "config_cost.h"
+#include "vendor_frame.h"
+#include "latency_profile.h"
+#include "rate_lock.h"
+#include "scene_morph.h"
+#include "stage_profiler.h"
+#include "deadline_monitor.h"
+#include "event_trace.h"
+#include "fir_bank.h"
+#include "dyneq.h"
+#include "loopback.h"
+#include "multiband.h"
+#include "limiter.h"
 #include "pico/usb_stream_helper.h"
 #include "usb_audio_ring.h"
 #include "usb_feedback_controller.h"
@@ -45,8 +58,13 @@
 // ----------------------------------------------------------------------------
 
 volatile AudioState audio_state = { .freq = 44100 };
+volatile uint32_t output_rate = 44100;
 volatile bool bypass_master_eq = false;
 volatile SystemStatusPacket global_status = {0};
+volatile BootTimingPacket boot_timing = {0};
+volatile ConfigCostPacket config_cost_report = {0};
+volatile FeatureGatePacket feature_gate_report = {0};
+volatile uint8_t feature_gate = 0;
 
 volatile bool eq_update_pending = false;
 volatile EqParamPacket pending_packet;
@@ -62,8 +80,9 @@ volatile uint8_t pending_output_types[NUM_SPDIF_INSTANCES];     // New type per
 volatile bool stream_restart_resync_pending = false;
 
 // Preset operations — deferred to main loop so that:
-//  1. Flash writes (preset_save/delete/dir_flush) don't run in USB IRQ context,
-//     avoiding a ~45ms interrupt blackout inside an ISR.
+//  1. Flash writes (preset_save/delete/dir_flush) don't run in USB IRQ context.
+//     The background flash writer runs one audio slot between its slices
+//     and must only be entered from the main loop (flash_writer.h).
 //  2. preset_load can be bracketed with prepare_pipeline_reset() /
 //     complete_pipeline_reset() to drain stale consumer buffers and resync
 //     all outputs.  Without this, buffers containing audio processed with the
@@ -75,7 +94,7 @@ volatile uint8_t pending_preset_load_slot = 0;
 volatile bool save_params_pending = false;   // Legacy REQ_SAVE_PARAMS (deferred)
 volatile bool preset_save_pending = false;
 volatile uint8_t pending_preset_save_slot = 0;
-volatile uint16_t preset_delete_mask = 0;  // Bitmask of slots pending delete
+volatile uint32_t preset_delete_mask[PRESET_MASK_WORDS];  // Bitmask of slots pending delete
 volatile bool factory_reset_pending = false;
 
 // SPSC ring buffer: USB audio ISR pushes raw packets, main loop consumes
@@ -107,12 +126,27 @@ uint8_t flash_set_include_pins_val = 0;
 volatile bool flash_set_master_volume_mode_pending = false;
 uint8_t flash_set_master_volume_mode_val = 0;
 
+// Deferred latency profile directory update.  The live re-plan is requested
+// immediately; only the flash write waits for the main loop.
+volatile bool flash_set_latency_profile_pending = false;
+uint8_t flash_set_latency_profile_val = 0;
+
+// Deferred rate lock directory update; applied live by the main loop
+volatile bool flash_set_rate_lock_pending = false;
+uint32_t flash_set_rate_lock_val = 0;
+
 // Deferred REQ_SAVE_MASTER_VOLUME — captures current live master_volume_db
 // into the directory's independent field.  Value is read at dispatch time.
 volatile bool flash_save_master_volume_pending = false;
 
-// 4 KB aligned buffer shared between GET and SET bulk param transfers.
+// 4 KB aligned buffer shared between GET and SET bulk param transfers, on
+// EP0 and the bulk pipe.  Owned by one of them at a time (VBUF_*).
 uint8_t __attribute__((aligned(4))) bulk_param_buf[WIRE_BULK_BUF_SIZE];
+static volatile uint8_t bulk_param_buf_owner = VBUF_FREE;
+
+void bulk_params_release(void) {
+    vbuf_release(&bulk_param_buf_owner, VBUF_MAIN);
+}
 
 // Stream transfer state for multi-packet vendor control transfers.
 static struct usb_stream_transfer _vendor_stream;
@@ -126,13 +160,14 @@ static struct usb_stream_transfer_funcs _vendor_stream_funcs = {
 // GET completion: data sent -> receive status-stage OUT ZLP from host
 static void _vendor_get_complete(__unused struct usb_endpoint *ep,
                                  __unused struct usb_transfer *t) {
+    vbuf_release(&bulk_param_buf_owner, VBUF_EP0);
     usb_start_empty_transfer(usb_get_control_out_endpoint(), &_vendor_ack_transfer, NULL);
 }
 
 // SET status-stage ACK sent -> signal main loop to apply params
 static void _vendor_set_ack_done(__unused struct usb_endpoint *ep,
                                  __unused struct usb_transfer *t) {
-    bulk_params_pending = true;
+    if (vbuf_pass(&bulk_param_buf_owner, VBUF_EP0, VBUF_MAIN)) bulk_params_pending = true;
 }
 
 // SET completion: data received -> send status-stage IN ZLP, then signal main loop
@@ -142,9 +177,10 @@ static void _vendor_set_complete(__unused struct usb_endpoint *ep,
                              _vendor_set_ack_done);
 }
 
-// Per-input-channel preamp gain.  Indexed by input channel (0=USB L, 1=USB R).
-// Arrays sized by NUM_INPUT_CHANNELS so adding future inputs (e.g. S/PDIF)
-// only requires changing that constant.
+// Per-input-channel preamp gain.  Indexed by input channel (0=USB L, 1=USB R,
+// 2+ the multichannel alt's other channels on RP2350).  Arrays sized by
+// NUM_INPUT_CHANNELS so adding future inputs (e.g. S/PDIF) only requires
+// changing that constant.
 volatile float global_preamp_db[NUM_INPUT_CHANNELS]      = {[0 ... NUM_INPUT_CHANNELS-1] = 0.0f};
 volatile int32_t global_preamp_mul[NUM_INPUT_CHANNELS]    = {[0 ... NUM_INPUT_CHANNELS-1] = 268435456};  // Unity = 1<<28 (Q28)
 volatile float global_preamp_linear[NUM_INPUT_CHANNELS]   = {[0 ... NUM_INPUT_CHANNELS-1] = 1.0f};
@@ -270,9 +306,9 @@ static void update_master_volume(float db) {
 
 // Shared output buffer — file scope so Core 1 can access via pointer
 #if PICO_RP2350
-static float buf_out[NUM_OUTPUT_CHANNELS][192];
+static float buf_out[NUM_OUTPUT_CHANNELS][AUDIO_BUFFER_SAMPLES];
 #else
-static int32_t buf_out[NUM_OUTPUT_CHANNELS][192];
+static int32_t buf_out[NUM_OUTPUT_CHANNELS][AUDIO_BUFFER_SAMPLES];
 #endif
 
 // Sync State
@@ -281,6 +317,13 @@ volatile uint64_t start_time_us = 0;
 volatile bool sync_started = false;
 static volatile uint64_t last_packet_time_us = 0;
 static volatile uint8_t usb_input_bit_depth = 16;
+static volatile uint8_t usb_input_channels = 2;    // Channels of the running alt (MC_INPUT_CHANNELS on alt 3)
+#if ENABLE_MC_INPUT
+static volatile uint8_t mc_mix_inputs = NUM_MASTER_INPUTS;     // Inputs that reached the mixer last block
+static volatile uint16_t mc_input_peaks[NUM_INPUT_CHANNELS];   // Inputs 2+: post-preamp, last block
+_Static_assert(sizeof(InputStatusPacket) == 20, "InputStatusPacket is a wire format");
+_Static_assert(NUM_INPUT_CHANNELS <= 8, "InputStatusPacket.peaks holds 8 inputs");
+#endif
 #define AUDIO_GAP_THRESHOLD_US 50000  // 50ms - reset sync if packets stop this long
 
 // Idle-time CPU load metering (Core 0)
@@ -304,6 +347,12 @@ static uint8_t pdm_dma_max_fill_pct = 0;
 static uint8_t pdm_ring_min_fill_pct = 100;
 static uint8_t pdm_ring_max_fill_pct = 0;
 
+// Meter stream — peak hold and block count accumulated per audio packet,
+// consumed by usb_audio_meter_service() when a frame is due.
+static volatile uint8_t meter_stream_hz = 0;   // 0 = off
+static uint16_t meter_peak_hold[NUM_CHANNELS];
+static uint16_t meter_blocks = 0;
+
 // Audio Pools (S/PDIF stereo pairs)
 struct audio_buffer_pool *producer_pool_1 = NULL;  // S/PDIF 1 (Out 1-2)
 struct audio_buffer_pool *producer_pool_2 = NULL;  // S/PDIF 2 (Out 3-4)
@@ -325,6 +374,10 @@ static struct usb_interface ac_interface;
 static struct usb_interface as_op_interface;
 static struct usb_interface vendor_interface;
 static struct usb_endpoint ep_op_out, ep_op_sync;
+#if ENABLE_LOOPBACK
+static struct usb_interface lb_interface;
+static struct usb_endpoint ep_lb_in;
+#endif
 
 // ----------------------------------------------------------------------------
 // SYSTEM STATISTICS HELPERS
@@ -452,7 +505,7 @@ void audio_set_volume(int16_t volume) {
 //
 // The envelope runs in packet context (process_audio_packet) and advances by
 // `sample_count` each call, giving a time-based transition that is consistent
-// across 44.1/48/96 kHz.
+// across every streaming rate.
 #define PRESET_MUTE_TRANSITION_MS 8u
 static float preset_mute_smooth_gain = 1.0f;  // 1.0 = full level, 0.0 = muted
 
@@ -497,8 +550,44 @@ static inline float update_preset_mute_envelope(uint32_t sample_count, uint32_t
     return preset_mute_smooth_gain;
 }
 
+#if PICO_RP2350
+// Matrix mixing kernel: dst = sum of src[k] * gain[k] over the n enabled
+// crosspoints of one output.  Sources are taken two per pass so each pass
+// loads and stores dst once; the first pass writes instead of accumulating.
+static void __not_in_flash_func(mix_sparse)(float *dst, const float *const *src,
+                                            const float *gain, int n, uint32_t count) {
+    if (n == 0) {
+        memset(dst, 0, count * sizeof(float));
+        return;
+    }
+    int k;
+    if (n & 1) {
+        const float *a = src[0];
+        const float ga = gain[0];
+        for (uint32_t i = 0; i < count; i++)
+            dst[i] = a[i] * ga;
+        k = 1;
+    } else {
+        const float *a = src[0], *b = src[1];
+        const float ga = gain[0], gb = gain[1];
+        for (uint32_t i = 0; i < count; i++)
+            dst[i] = a[i] * ga + b[i] * gb;
+        k = 2;
+    }
+    for (; k < n; k += 2) {
+        const float *a = src[k], *b = src[k + 1];
+        const float ga = gain[k], gb = gain[k + 1];
+        for (uint32_t i = 0; i < count; i++)
+            dst[i] += a[i] * ga + b[i] * gb;
+    }
+}
+#endif
+
 static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint16_t data_len) {
     uint32_t packet_start = time_us_32();
+    if (!boot_timing.first_audio_us) boot_timing.first_audio_us = packet_start;
+    ProfilerPass prof;
+    profiler_begin(&prof, 0);
 
     // NOTE: USB packet gap detection has moved to _as_audio_packet() (ISR
     // context) where it measures actual packet arrival timing rather than
@@ -526,16 +615,25 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
     }
 
     const uint8_t bit_depth = usb_input_bit_depth;  // snapshot once — avoid double-read of volatile
-    uint32_t bytes_per_frame = (bit_depth == 24) ? 6 : 4;
-    uint32_t sample_count = data_len / bytes_per_frame;
-    uint32_t sample_rate_hz = audio_state.freq;
+    const uint8_t channels = usb_input_channels;
+    uint32_t bytes_per_frame = channels * ((bit_depth == 24) ? 3 : 2);
+    uint32_t in_count = data_len / bytes_per_frame;
+    uint32_t sample_count = in_count;
+#if ENABLE_ASRC
+    // Samples per channel from here on are ASRC output
+    if (asrc_active) sample_count = rate_lock_begin_block(in_count);
+#endif
+    uint32_t sample_rate_hz = output_rate;
     float preset_mute_gain = update_preset_mute_envelope(sample_count, sample_rate_hz);
+    scene_morph_begin_block(sample_count);
+    const bool morphing = scene_morph_block.active;
 
     for (int b = 0; b < NUM_SPDIF_INSTANCES; b++) {
         if (audio_buf[b]) {
             audio_buf[b]->sample_count = sample_count;
         } else if (!preset_loading && (matrix_mixer.outputs[b*2].enabled || matrix_mixer.outputs[b*2+1].enabled)) {
             spdif_overruns++;
+            trace_burst(TRACE_EVT_SPDIF_OVERRUN, spdif_overruns);
         }
     }
 
@@ -544,6 +642,7 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
     // Detect audio restart after gap - reset sync state and pre-fill pool
     if (sync_started && last_packet_time_us > 0 &&
         (now_us - last_packet_time_us) > AUDIO_GAP_THRESHOLD_US) {
+        trace_event(TRACE_EVT_AUDIO_GAP, (uint32_t)(now_us - last_packet_time_us));
         sync_started = false;
         total_samples_produced = 0;
         cpu0_load_primed = false;
@@ -573,10 +672,13 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
     // Per-input-channel preamp (snapshot for this block)
     float preamp_l = global_preamp_linear[0];
     float preamp_r = global_preamp_linear[1];
-    bool is_bypassed = bypass_master_eq;
+
+    // Stages the feature gate sheds at this rate (config_cost_gate())
+    uint8_t gate = feature_gate;
+    bool is_bypassed = bypass_master_eq || (gate & COST_GATE_MASTER_EQ);
 
     // Snapshot loudness state for this packet
-    bool loud_on = loudness_enabled;
+    bool loud_on = loudness_enabled && !(gate & COST_GATE_LOUDNESS);
     const LoudnessCoeffs *loud_coeffs = current_loudness_coeffs;
 
     float peak_ml = 0, peak_mr = 0;
@@ -585,7 +687,16 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
     const float pdm_scale = (float)(1 << 28);
 
     // Static buffers to avoid stack overflow (~8KB would be too much for stack)
-    static float buf_l[192], buf_r[192];
+    static float buf_l[AUDIO_BUFFER_SAMPLES], buf_r[AUDIO_BUFFER_SAMPLES];
+#if ENABLE_MC_INPUT
+    // Multichannel inputs 2+; they skip the master chain, and the ASRC is
+    // stereo, so they sit out the block while it resamples
+    static float buf_aux[NUM_INPUT_CHANNELS - NUM_MASTER_INPUTS][AUDIO_BUFFER_SAMPLES];
+    bool aux_live = channels > NUM_MASTER_INPUTS;
+#if ENABLE_ASRC
+    if (asrc_active) aux_live = false;
+#endif
+#endif
 
     // ========== PASS 1: Input conversion + Preamp + Loudness ==========
     if (bit_depth == 24) {
@@ -603,7 +714,7 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
         const float gain_r = inv_8388608 * preamp_r;
 
         //unpack 3 32bit words into 4 24 bit l,r,l,r samples
-        for (uint32_t i = 0; i < sample_count/2; i++) {
+        for (uint32_t i = 0; i < in_count/2; i++) {
             int32_t i0 = *in++;
             int32_t i1 = *in++;
             int32_t i2 = *in++;
@@ -648,7 +759,7 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
             *out_r++ = r2 * gain_r;
         }
         //if sample count is not divisible by 2 pick up the remaining l,r sample
-        if(sample_count % 2) {
+        if(in_count % 2) {
             int32_t i0 = *in++;
             int32_t i1 = *in++;
             int32_t temp;
@@ -675,15 +786,52 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
             *out_l++ = l1 * gain_l;
             *out_r++ = r1 * gain_r;
         }
+#if ENABLE_MC_INPUT
+    } else if (channels > NUM_MASTER_INPUTS) {
+        // Multichannel alt (16-bit only): deinterleave one channel at a time
+        const int16_t *in = (const int16_t *)data;
+        float *dst[NUM_INPUT_CHANNELS] = { buf_l, buf_r };
+        float gain[NUM_INPUT_CHANNELS] = { inv_32768 * preamp_l, inv_32768 * preamp_r };
+        int n_ch = aux_live ? NUM_INPUT_CHANNELS : NUM_MASTER_INPUTS;
+        for (int c = NUM_MASTER_INPUTS; c < NUM_INPUT_CHANNELS; c++) {
+            dst[c] = buf_aux[c - NUM_MASTER_INPUTS];
+            gain[c] = inv_32768 * global_preamp_linear[c];
+        }
+        for (int c = 0; c < n_ch; c++) {
+            const int16_t *src = in + c;
+            float *d = dst[c];
+            const float g = gain[c];
+            float peak = 0.0f;
+            for (uint32_t i = 0; i < in_count; i++) {
+                float x = (float)src[i * NUM_INPUT_CHANNELS] * g;
+                d[i] = x;
+                float ax = fabsf(x); if (ax > peak) peak = ax;
+            }
+            mc_input_peaks[c] = (uint16_t)(fminf(1.0f, peak) * 32767.0f);
+        }
+#endif
     } else {
         const int16_t *in = (const int16_t *)data;
         float gain_l = inv_32768 * preamp_l;
         float gain_r = inv_32768 * preamp_r;
-        for (uint32_t i = 0; i < sample_count; i++) {
+        for (uint32_t i = 0; i < in_count; i++) {
             buf_l[i] = (float)in[i*2] * gain_l;
             buf_r[i] = (float)in[i*2+1] * gain_r;
         }
     }
+#if ENABLE_MC_INPUT
+    if (!aux_live) {
+        for (int c = NUM_MASTER_INPUTS; c < NUM_INPUT_CHANNELS; c++) mc_input_peaks[c] = 0;
+    }
+    mc_mix_inputs = aux_live ? NUM_INPUT_CHANNELS : NUM_MASTER_INPUTS;
+#endif
+
+#if ENABLE_ASRC
+    // ========== Rate lock: resample to the output rate ==========
+    if (asrc_active) rate_lock_process(buf_l, buf_r, in_count, sample_count);
+#endif
+
+    profiler_mark(&prof, PROF_STAGE_INPUT);
 
     // Loudness compensation (SVF shelf filters)
     if (loud_on && loud_coeffs) {
@@ -717,8 +865,13 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
         }
     }
 
+    profiler_mark(&prof, PROF_STAGE_LOUDNESS);
+
     // ========== PASS 2: Master EQ (Block-Based) ==========
-    if (!is_bypassed) {
+    if (morphing) {
+        scene_morph_eq_block(CH_MASTER_LEFT, buf_l, sample_count);
+        scene_morph_eq_block(CH_MASTER_RIGHT, buf_r, sample_count);
+    } else if (!is_bypassed) {
         if (!channel_bypassed[CH_MASTER_LEFT]) {
             dsp_process_channel_block(filters[CH_MASTER_LEFT], buf_l, sample_count, CH_MASTER_LEFT);
         }
@@ -727,15 +880,24 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
         }
     }
 
+    profiler_mark(&prof, PROF_STAGE_MASTER_EQ);
+
     // ========== PASS 2.5: Volume Leveller ==========
-    if (!leveller_bypassed) {
+    if (!leveller_bypassed && !(gate & COST_GATE_LEVELLER)) {
         leveller_process_block(&leveller_state, &leveller_coeffs,
                                (const LevellerConfig *)&leveller_config,
                                buf_l, buf_r, sample_count);
     }
 
+#if ENABLE_MULTIBAND
+    // Multiband compressor on the master pair (profiled with the leveller)
+    if (mb_master_active) multiband_process_master(buf_l, buf_r, sample_count);
+#endif
+
+    profiler_mark(&prof, PROF_STAGE_LEVELLER);
+
     // ========== PASS 3: Crossfeed + Master Peaks ==========
-    bool do_crossfeed = !crossfeed_bypassed;
+    bool do_crossfeed = !crossfeed_bypassed && !(gate & COST_GATE_CROSSFEED);
 
     // Crossfeed is sample-by-sample (internal state), combined with peak tracking
     for (uint32_t i = 0; i < sample_count; i++) {
@@ -748,36 +910,47 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
         }
     }
 
-    // ========== PASS 4: Matrix Mixing (block-based, output-major) ==========
-    // Snapshot crosspoint coefficients and process one output at a time
+    profiler_mark(&prof, PROF_STAGE_CROSSFEED);
+
+    // ========== PASS 4: Matrix Mixing (block-based, output-major, sparse) ==========
+    // Each output sums only its enabled crosspoints from inputs that carry
+    // signal this block; crosspoint config is loaded once per output
+    const float *mix_src[NUM_INPUT_CHANNELS] = { buf_l, buf_r };
+    int mix_inputs = NUM_MASTER_INPUTS;
+#if ENABLE_MC_INPUT
+    for (int c = NUM_MASTER_INPUTS; c < NUM_INPUT_CHANNELS; c++) mix_src[c] = buf_aux[c - NUM_MASTER_INPUTS];
+    if (aux_live) mix_inputs = NUM_INPUT_CHANNELS;
+#endif
     for (int out = 0; out < NUM_OUTPUT_CHANNELS; out++) {
         if (!matrix_mixer.outputs[out].enabled) {
             memset(buf_out[out], 0, sample_count * sizeof(float));
             continue;
         }
 
-        // Load crosspoint config once per output (not per sample)
-        float gain_l = 0.0f, gain_r = 0.0f;
-        MatrixCrosspoint *xp_l = &matrix_mixer.crosspoints[0][out];
-        MatrixCrosspoint *xp_r = &matrix_mixer.crosspoints[1][out];
-        if (xp_l->enabled) gain_l = xp_l->phase_invert ? -xp_l->gain_linear : xp_l->gain_linear;
-        if (xp_r->enabled) gain_r = xp_r->phase_invert ? -xp_r->gain_linear : xp_r->gain_linear;
-
-        float *dst = buf_out[out];
-        if (gain_l != 0.0f && gain_r != 0.0f) {
-            for (uint32_t i = 0; i < sample_count; i++)
-                dst[i] = buf_l[i] * gain_l + buf_r[i] * gain_r;
-        } else if (gain_l != 0.0f) {
-            for (uint32_t i = 0; i < sample_count; i++)
-                dst[i] = buf_l[i] * gain_l;
-        } else if (gain_r != 0.0f) {
-            for (uint32_t i = 0; i < sample_count; i++)
-                dst[i] = buf_r[i] * gain_r;
-        } else {
-            memset(dst, 0, sample_count * sizeof(float));
+        const float *src[NUM_INPUT_CHANNELS];
+        float gain[NUM_INPUT_CHANNELS];
+        int n = 0;
+        for (int in = 0; in < mix_inputs; in++) {
+            const MatrixCrosspoint *xp = &matrix_mixer.crosspoints[in][out];
+            if (!xp->enabled || xp->gain_linear == 0.0f) continue;
+            src[n] = mix_src[in];
+            gain[n] = xp->phase_invert ? -xp->gain_linear : xp->gain_linear;
+            n++;
         }
+        mix_sparse(buf_out[out], src, gain, n, sample_count);
     }
 
+    profiler_mark(&prof, PROF_STAGE_MIX);
+
+#if ENABLE_FIR
+    // FIR crossovers run on the mixer output of enabled outputs, ahead of
+    // the output EQ, on whichever core fir_xover_core1_mask assigns
+    uint16_t xover_mask = fir_xover_mask;
+    for (int out = 0; out < NUM_OUTPUT_CHANNELS; out++) {
+        if (!matrix_mixer.outputs[out].enabled) xover_mask &= (uint16_t)~(1u << out);
+    }
+#endif
+
     // ========== PASS 5-7: Per-Output EQ + Gain + Delay + Output ==========
     if (core1_mode == CORE1_MODE_EQ_WORKER) {
         // --- Dual-core path: Core 1 handles EQ+delay+SPDIF for outputs 2-7 ---
@@ -789,20 +962,53 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
         core1_eq_work.spdif_out[0] = audio_buf[1] ? (int32_t *)audio_buf[1]->buffer->bytes : NULL;
         core1_eq_work.spdif_out[1] = audio_buf[2] ? (int32_t *)audio_buf[2]->buffer->bytes : NULL;
         core1_eq_work.spdif_out[2] = audio_buf[3] ? (int32_t *)audio_buf[3]->buffer->bytes : NULL;
+#if ENABLE_FIR
+        uint16_t xover_core1 = xover_mask & fir_xover_core1_mask;
+        core1_eq_work.xover_mask = xover_mask;
+        core1_eq_work.xover_core1_mask = xover_core1;
+        core1_eq_work.xover_done[0] = false;
+        core1_eq_work.xover_done[1] = false;
+#endif
         core1_eq_work.work_done = false;
         __dmb();
         core1_eq_work.work_ready = true;
         __sev();
 
+#if ENABLE_FIR
+        // Core 0's share of the crossovers, then wait for Core 1's share of
+        // outputs 0-1.  Core 1 waits for ours the same way.
+        if (xover_mask) {
+            fir_xover_run(xover_mask & (uint16_t)~xover_core1, buf_out, sample_count);
+            __dmb();
+            core1_eq_work.xover_done[0] = true;
+            __sev();
+            if (xover_core1 & ((1u << CORE1_EQ_FIRST_OUTPUT) - 1)) {
+                while (!core1_eq_work.xover_done[1]) {
+                    __wfe();
+                }
+                __dmb();
+            }
+        }
+#endif
+
         // Core 0: EQ + gain for outputs 0-1
         for (int out = 0; out < CORE1_EQ_FIRST_OUTPUT; out++) {
             if (!matrix_mixer.outputs[out].enabled) continue;
             if (!matrix_mixer.outputs[out].mute) {
                 uint8_t eq_ch = CH_OUT_1 + out;
-                if (!channel_bypassed[eq_ch]) {
+                if (morphing) {
+                    scene_morph_eq_block(eq_ch, buf_out[out], sample_count);
+                } else if (!channel_bypassed[eq_ch]) {
                     dsp_process_channel_block(filters[eq_ch], buf_out[out], sample_count, eq_ch);
                 }
             }
+#if ENABLE_FIR
+            if (fir_active_mask & (1u << out)) fir_bank_process(out, buf_out[out], sample_count);
+#endif
+#if ENABLE_MULTIBAND
+            if ((mb_output_mask & (1u << out)) && !matrix_mixer.outputs[out].mute)
+                multiband_process_output(out, buf_out[out], sample_count);
+#endif
             // Output gain uses vol_mul_master (host vol × master vol)
             float gain = matrix_mixer.outputs[out].mute ? 0.0f
                          : matrix_mixer.outputs[out].gain_linear * vol_mul_master;
@@ -815,10 +1021,22 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
             }
         }
 
+        profiler_mark(&prof, PROF_STAGE_OUTPUT_EQ);
+
         // Core 0: Delay for outputs 0-1
         if (any_delay_active) {
             for (int out = 0; out < CORE1_EQ_FIRST_OUTPUT; out++) {
+                if (morphing) {
+                    scene_morph_delay_block(out, buf_out[out], delay_write_idx, sample_count);
+                    continue;
+                }
                 int32_t dly = channel_delay_samples[out];
+#if ENABLE_LIMITER
+                if (limiter_active_mask & (1u << out)) {
+                    limiter_delay_block(out, buf_out[out], delay_lines[out], delay_write_idx, dly, sample_count);
+                    continue;
+                }
+#endif
                 if (dly <= 0) continue;
                 float *dst = buf_out[out];
                 float *dline = delay_lines[out];
@@ -831,6 +1049,8 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
             }
         }
 
+        profiler_mark(&prof, PROF_STAGE_DELAY);
+
         // Core 0: Peaks for outputs 0..CORE1_EQ_FIRST_OUTPUT-1
         for (int out = 0; out < CORE1_EQ_FIRST_OUTPUT; out++) {
             float peak = 0;
@@ -847,7 +1067,8 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
         // Core 0: S/PDIF for pair 0
         if (audio_buf[0]) {
             int left_ch = 0, right_ch = 1;
-            if (!matrix_mixer.outputs[left_ch].enabled && !matrix_mixer.outputs[right_ch].enabled) {
+            if ((!matrix_mixer.outputs[left_ch].enabled && !matrix_mixer.outputs[right_ch].enabled) ||
+                spdif_slot_rate_muted(gate, 0)) {
                 memset(audio_buf[0]->buffer->bytes, 0, sample_count * 8);
             } else {
                 int32_t *out_ptr = (int32_t *)audio_buf[0]->buffer->bytes;
@@ -860,11 +1081,13 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
             }
         }
 
+        profiler_mark(&prof, PROF_STAGE_PACK);
         // Wait for Core 1 (EQ + delay + S/PDIF for outputs 2-7)
         while (!core1_eq_work.work_done) {
             __wfe();
         }
         __dmb();
+        profiler_mark(&prof, PROF_STAGE_CORE1_WAIT);
 
         // Update shared delay write index (both cores used same base)
         if (any_delay_active) {
@@ -873,15 +1096,28 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
     } else {
         // --- Single-core path: all outputs on Core 0 ---
 
+#if ENABLE_FIR
+        if (xover_mask) fir_xover_run(xover_mask, buf_out, sample_count);
+#endif
+
         // EQ + gain
         for (int out = 0; out < NUM_OUTPUT_CHANNELS; out++) {
             if (!matrix_mixer.outputs[out].enabled) continue;
             if (!matrix_mixer.outputs[out].mute) {
                 uint8_t eq_ch = CH_OUT_1 + out;
-                if (!channel_bypassed[eq_ch]) {
+                if (morphing) {
+                    scene_morph_eq_block(eq_ch, buf_out[out], sample_count);
+                } else if (!channel_bypassed[eq_ch]) {
                     dsp_process_channel_block(filters[eq_ch], buf_out[out], sample_count, eq_ch);
                 }
             }
+#if ENABLE_FIR
+            if (fir_active_mask & (1u << out)) fir_bank_process(out, buf_out[out], sample_count);
+#endif
+#if ENABLE_MULTIBAND
+            if ((mb_output_mask & (1u << out)) && !matrix_mixer.outputs[out].mute)
+                multiband_process_output(out, buf_out[out], sample_count);
+#endif
             // Output gain uses vol_mul_master (host vol × master vol)
             float gain = matrix_mixer.outputs[out].mute ? 0.0f
                          : matrix_mixer.outputs[out].gain_linear * vol_mul_master;
@@ -894,10 +1130,22 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
             }
         }
 
+        profiler_mark(&prof, PROF_STAGE_OUTPUT_EQ);
+
         // Delay
         if (any_delay_active) {
             for (int out = 0; out < NUM_OUTPUT_CHANNELS; out++) {
+                if (morphing) {
+                    scene_morph_delay_block(out, buf_out[out], delay_write_idx, sample_count);
+                    continue;
+                }
                 int32_t dly = channel_delay_samples[out];
+#if ENABLE_LIMITER
+                if (limiter_active_mask & (1u << out)) {
+                    limiter_delay_block(out, buf_out[out], delay_lines[out], delay_write_idx, dly, sample_count);
+                    continue;
+                }
+#endif
                 if (dly <= 0) continue;
                 float *dst = buf_out[out];
                 float *dline = delay_lines[out];
@@ -911,6 +1159,8 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
             delay_write_idx = (delay_write_idx + sample_count) & MAX_DELAY_MASK;
         }
 
+        profiler_mark(&prof, PROF_STAGE_DELAY);
+
         // Peaks for all SPDIF outputs
         for (int out = 0; out < NUM_SPDIF_INSTANCES * 2; out++) {
             float peak = 0;
@@ -927,7 +1177,8 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
             if (!audio_buf[pair]) continue;
             int left_ch = pair * 2;
             int right_ch = pair * 2 + 1;
-            if (!matrix_mixer.outputs[left_ch].enabled && !matrix_mixer.outputs[right_ch].enabled) {
+            if ((!matrix_mixer.outputs[left_ch].enabled && !matrix_mixer.outputs[right_ch].enabled) ||
+                spdif_slot_rate_muted(gate, pair)) {
                 memset(audio_buf[pair]->buffer->bytes, 0, sample_count * 8);
                 continue;
             }
@@ -941,7 +1192,7 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
         }
 
 #if ENABLE_SUB
-        if (matrix_mixer.outputs[NUM_OUTPUT_CHANNELS-1].enabled) {
+        if (matrix_mixer.outputs[NUM_OUTPUT_CHANNELS-1].enabled && !(gate & COST_GATE_PDM)) {
             float peak_sub = 0;
             for (uint32_t i = 0; i < sample_count; i++) {
                 float abs_sub = fabsf(buf_out[NUM_OUTPUT_CHANNELS-1][i]);
@@ -959,6 +1210,11 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
 #endif
     }
 
+#if ENABLE_LOOPBACK
+    // Every output is final here, on both Core 1 modes
+    loopback_push(buf_out, sample_count);
+#endif
+
     // Write input peaks
     global_status.peaks[0] = (uint16_t)(fminf(1.0f, peak_ml) * 32767.0f);
     global_status.peaks[1] = (uint16_t)(fminf(1.0f, peak_mr) * 32767.0f);
@@ -982,16 +1238,20 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
     // Per-input-channel preamp (snapshot for this block)
     int32_t preamp_l = global_preamp_mul[0];
     int32_t preamp_r = global_preamp_mul[1];
-    bool is_bypassed = bypass_master_eq;
+    bool is_bypassed = bypass_master_eq;   // Also skips output EQ
+
+    // Stages the feature gate sheds at this rate (config_cost_gate())
+    uint8_t gate = feature_gate;
+    bool master_eq_on = !is_bypassed && !(gate & COST_GATE_MASTER_EQ);
 
     // Snapshot loudness state for this packet
-    bool loud_on = loudness_enabled;
+    bool loud_on = loudness_enabled && !(gate & COST_GATE_LOUDNESS);
     const LoudnessCoeffs *loud_coeffs = current_loudness_coeffs;
 
     int32_t peak_ml = 0, peak_mr = 0;
 
     // Static buffers for block processing
-    static int32_t buf_l[192], buf_r[192];
+    static int32_t buf_l[AUDIO_BUFFER_SAMPLES], buf_r[AUDIO_BUFFER_SAMPLES];
 
     // ========== PASS 1: Input conversion + Preamp + Loudness ==========
     if (bit_depth == 24) {
@@ -1014,6 +1274,8 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
         }
     }
 
+    profiler_mark(&prof, PROF_STAGE_INPUT);
+
     // Loudness compensation (per-sample — biquad state coupling)
     if (loud_on && loud_coeffs) {
         for (uint32_t i = 0; i < sample_count; i++) {
@@ -1046,32 +1308,44 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
         }
     }
 
+    profiler_mark(&prof, PROF_STAGE_LOUDNESS);
+
     // ========== PASS 2: Master EQ (Block-Based) ==========
-    if (!is_bypassed) {
+    if (morphing) {
+        scene_morph_eq_block(CH_MASTER_LEFT, buf_l, sample_count);
+        scene_morph_eq_block(CH_MASTER_RIGHT, buf_r, sample_count);
+    } else if (master_eq_on) {
         if (!channel_bypassed[CH_MASTER_LEFT])
             dsp_process_channel_block(filters[CH_MASTER_LEFT], buf_l, sample_count, CH_MASTER_LEFT);
         if (!channel_bypassed[CH_MASTER_RIGHT])
             dsp_process_channel_block(filters[CH_MASTER_RIGHT], buf_r, sample_count, CH_MASTER_RIGHT);
     }
 
+    profiler_mark(&prof, PROF_STAGE_MASTER_EQ);
+
     // ========== PASS 2.5: Volume Leveller ==========
-    if (!leveller_bypassed) {
+    if (!leveller_bypassed && !(gate & COST_GATE_LEVELLER)) {
         leveller_process_block(&leveller_state, &leveller_coeffs,
                                (const LevellerConfig *)&leveller_config,
                                buf_l, buf_r, sample_count);
     }
 
+    profiler_mark(&prof, PROF_STAGE_LEVELLER);
+
     // ========== PASS 3: Crossfeed + Master Peaks ==========
+    bool do_crossfeed = !crossfeed_bypassed && !(gate & COST_GATE_CROSSFEED);
     for (uint32_t i = 0; i < sample_count; i++) {
         int32_t ml = buf_l[i], mr = buf_r[i];
         if (abs(ml) > peak_ml) peak_ml = abs(ml);
         if (abs(mr) > peak_mr) peak_mr = abs(mr);
-        if (!crossfeed_bypassed) {
+        if (do_crossfeed) {
             crossfeed_process_stereo(&crossfeed_state, &ml, &mr);
             buf_l[i] = ml; buf_r[i] = mr;
         }
     }
 
+    profiler_mark(&prof, PROF_STAGE_CROSSFEED);
+
     // ========== PASS 4: Matrix Mixing (block-based, output-major) ==========
     for (int out = 0; out < NUM_OUTPUT_CHANNELS; out++) {
         if (!matrix_mixer.outputs[out].enabled) {
@@ -1099,6 +1373,8 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
         }
     }
 
+    profiler_mark(&prof, PROF_STAGE_MIX);
+
     // ========== PASS 5-7: Per-Output EQ + Gain + Delay + Output ==========
     // PDM output index
     int pdm_out = NUM_OUTPUT_CHANNELS - 1;
@@ -1121,7 +1397,9 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
             if (!matrix_mixer.outputs[out].enabled) continue;
             if (!matrix_mixer.outputs[out].mute) {
                 uint8_t eq_ch = CH_OUT_1 + out;
-                if (!is_bypassed && !channel_bypassed[eq_ch])
+                if (morphing)
+                    scene_morph_eq_block(eq_ch, buf_out[out], sample_count);
+                else if (!is_bypassed && !channel_bypassed[eq_ch])
                     dsp_process_channel_block(filters[eq_ch], buf_out[out], sample_count, eq_ch);
             }
             // Output gain uses vol_mul_master (host vol × master vol, Q15)
@@ -1136,9 +1414,15 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
             }
         }
 
+        profiler_mark(&prof, PROF_STAGE_OUTPUT_EQ);
+
         // Core 0: Delay for outputs 0-1
         if (any_delay_active) {
             for (int out = 0; out < CORE1_EQ_FIRST_OUTPUT; out++) {
+                if (morphing) {
+                    scene_morph_delay_block(out, buf_out[out], delay_write_idx, sample_count);
+                    continue;
+                }
                 int32_t dly = channel_delay_samples[out];
                 if (dly <= 0) continue;
                 int32_t *dst = buf_out[out];
@@ -1152,6 +1436,8 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
             }
         }
 
+        profiler_mark(&prof, PROF_STAGE_DELAY);
+
         // Core 0: Peaks for outputs 0..CORE1_EQ_FIRST_OUTPUT-1
         for (int out = 0; out < CORE1_EQ_FIRST_OUTPUT; out++) {
             int32_t peak = 0;
@@ -1167,7 +1453,8 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
 
         // Core 0: S/PDIF conversion for pair 1
         if (audio_buf[0]) {
-            if (!matrix_mixer.outputs[0].enabled && !matrix_mixer.outputs[1].enabled) {
+            if ((!matrix_mixer.outputs[0].enabled && !matrix_mixer.outputs[1].enabled) ||
+                spdif_slot_rate_muted(gate, 0)) {
                 memset(audio_buf[0]->buffer->bytes, 0, sample_count * 8);
             } else {
                 int32_t *out_ptr = (int32_t *)audio_buf[0]->buffer->bytes;
@@ -1178,11 +1465,13 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
             }
         }
 
+        profiler_mark(&prof, PROF_STAGE_PACK);
         // Wait for Core 1 (EQ + delay + S/PDIF for outputs 2-3)
         while (!core1_eq_work.work_done) {
             __wfe();
         }
         __dmb();
+        profiler_mark(&prof, PROF_STAGE_CORE1_WAIT);
 
         // Update shared delay write index
         if (any_delay_active) {
@@ -1197,7 +1486,9 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
             if (!matrix_mixer.outputs[out].enabled) continue;
             if (!matrix_mixer.outputs[out].mute) {
                 uint8_t eq_ch = CH_OUT_1 + out;
-                if (!is_bypassed && !channel_bypassed[eq_ch])
+                if (morphing)
+                    scene_morph_eq_block(eq_ch, buf_out[out], sample_count);
+                else if (!is_bypassed && !channel_bypassed[eq_ch])
                     dsp_process_channel_block(filters[eq_ch], buf_out[out], sample_count, eq_ch);
             }
             // Output gain uses vol_mul_master (host vol × master vol, Q15)
@@ -1212,9 +1503,15 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
             }
         }
 
+        profiler_mark(&prof, PROF_STAGE_OUTPUT_EQ);
+
         // Delay (all outputs use same base write index)
         if (any_delay_active) {
             for (int out = 0; out < NUM_OUTPUT_CHANNELS; out++) {
+                if (morphing) {
+                    scene_morph_delay_block(out, buf_out[out], saved_delay_write_idx, sample_count);
+                    continue;
+                }
                 int32_t dly = channel_delay_samples[out];
                 if (dly <= 0) continue;
                 int32_t *dst = buf_out[out];
@@ -1229,6 +1526,8 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
             delay_write_idx = (saved_delay_write_idx + sample_count) & MAX_DELAY_MASK;
         }
 
+        profiler_mark(&prof, PROF_STAGE_DELAY);
+
         // Peaks for all SPDIF outputs
         for (int out = 0; out < NUM_SPDIF_INSTANCES * 2; out++) {
             int32_t peak = 0;
@@ -1245,7 +1544,8 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
             if (!audio_buf[pair]) continue;
             int left_ch = pair * 2;
             int right_ch = pair * 2 + 1;
-            if (!matrix_mixer.outputs[left_ch].enabled && !matrix_mixer.outputs[right_ch].enabled) {
+            if ((!matrix_mixer.outputs[left_ch].enabled && !matrix_mixer.outputs[right_ch].enabled) ||
+                spdif_slot_rate_muted(gate, pair)) {
                 memset(audio_buf[pair]->buffer->bytes, 0, sample_count * 8);
                 continue;
             }
@@ -1258,7 +1558,7 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
 
 #if ENABLE_SUB
         // PDM sub output
-        if (matrix_mixer.outputs[pdm_out].enabled) {
+        if (matrix_mixer.outputs[pdm_out].enabled && !(gate & COST_GATE_PDM)) {
             int32_t peak_sub = 0;
             for (uint32_t i = 0; i < sample_count; i++) {
                 int32_t abs_sub = abs(buf_out[pdm_out][i]);
@@ -1275,6 +1575,10 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
 #endif
     }
 
+#if ENABLE_LOOPBACK
+    loopback_push(buf_out, sample_count);
+#endif
+
     // Write input peaks
     global_status.peaks[0] = (uint16_t)(peak_ml >> 13);
     global_status.peaks[1] = (uint16_t)(peak_mr >> 13);
@@ -1297,6 +1601,9 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
     if (audio_buf[1]) give_audio_buffer(producer_pool_2, audio_buf[1]);
 #endif
 
+    profiler_mark(&prof, PROF_STAGE_PACK);
+    profiler_end(&prof, PROF_STAGE_CORE0_TOTAL);
+
     uint32_t packet_end = time_us_32();
 
     if (cpu0_load_primed) {
@@ -1314,6 +1621,16 @@ static void __not_in_flash_func(process_audio_packet)(const uint8_t *data, uint1
         cpu0_load_primed = true;
     }
     cpu0_last_packet_end = packet_end;
+
+    deadline_record(0, packet_end - packet_start, sample_count, sample_rate_hz);
+
+    if (meter_stream_hz) {
+        for (int i = 0; i < NUM_CHANNELS; i++) {
+            uint16_t p = global_status.peaks[i];
+            if (p > meter_peak_hold[i]) meter_peak_hold[i] = p;
+        }
+        meter_blocks++;
+    }
 }
 
 // ----------------------------------------------------------------------------
@@ -1331,6 +1648,31 @@ void usb_audio_drain_ring(void) {
     }
 }
 
+// One audio slot for the flash writer's slot hook (flash_writer.h): wait
+// for the next packet, at most one USB frame so a stopped stream does not
+// stall the writer, then process everything queued.
+void usb_audio_run_slot(void) {
+    uint32_t start = time_us_32();
+    while (!usb_audio_ring_peek(&audio_ring) && time_us_32() - start < 1000) {
+        tight_loop_contents();
+    }
+    usb_audio_drain_ring();
+}
+
+// Keep draining until the preset mute envelope has reached silence, so the
+// caller can swap DSP state without an audible step.  Gives up after
+// `timeout_us` (stream stopped: no packets advance the envelope).  Returns
+// true once silent.  The caller must already have engaged the mute.
+bool usb_audio_wait_preset_silence(uint32_t timeout_us) {
+    uint32_t start = time_us_32();
+    for (;;) {
+        usb_audio_drain_ring();
+        if (preset_mute_smooth_gain <= 0.0f) return true;
+        if (time_us_32() - start > timeout_us) return false;
+        tight_loop_contents();
+    }
+}
+
 // Discard all pending ring data and reset gap-detection timestamp.
 // Used on stream stop/start transitions to flush stale packets from a
 // previous stream.
@@ -1359,6 +1701,7 @@ static void __not_in_flash_func(_as_audio_packet)(struct usb_endpoint *ep) {
             uint32_t gap = now - audio_ring_last_push_us;
             if (gap > 2000 && gap < 50000) {
                 spdif_underruns++;
+                trace_burst(TRACE_EVT_SPDIF_UNDERRUN, spdif_underruns);
             }
         }
         audio_ring_last_push_us = now;
@@ -1404,6 +1747,23 @@ static const struct usb_transfer_type as_sync_transfer_type = {
 static struct usb_transfer as_transfer;
 static struct usb_transfer as_sync_transfer;
 
+#if ENABLE_LOOPBACK
+static void __not_in_flash_func(_lb_packet)(struct usb_endpoint *ep) {
+    assert(ep->current_transfer);
+    struct usb_buffer *buffer = usb_current_in_packet_buffer(ep);
+    buffer->data_len = loopback_fill_packet(buffer->data, buffer->data_max);
+    usb_grow_transfer(ep->current_transfer, 1);
+    usb_packet_done(ep);
+}
+
+static const struct usb_transfer_type lb_transfer_type = {
+    .on_packet = _lb_packet,
+    .initial_packet_count = 1,
+};
+
+static struct usb_transfer lb_transfer;
+#endif
+
 // ----------------------------------------------------------------------------
 // UAC1 AUDIO CONTROL REQUEST HANDLERS
 // ----------------------------------------------------------------------------
@@ -1415,6 +1775,7 @@ static struct audio_control_cmd {
     uint8_t cn;
     uint8_t unit;
     uint8_t len;
+    uint8_t ep;         // Endpoint requests: wIndex endpoint address
 } audio_control_cmd_t;
 
 static void _audio_reconfigure(void) {
@@ -1434,6 +1795,12 @@ static bool do_get_current(struct usb_setup_packet *setup) {
         }
     } else if ((setup->bmRequestType & USB_REQ_TYPE_RECIPIENT_MASK) == USB_REQ_TYPE_RECIPIENT_ENDPOINT) {
         if ((setup->wValue >> 8u) == ENDPOINT_FREQ_CONTROL) {
+#if ENABLE_LOOPBACK
+            if ((uint8_t)setup->wIndex == LOOPBACK_ENDPOINT) {
+                usb_start_tiny_control_in_transfer(loopback_get_rate(), 3);
+                return true;
+            }
+#endif
             usb_start_tiny_control_in_transfer(audio_state.freq, 3);
             return true;
         }
@@ -1491,6 +1858,12 @@ static void audio_cmd_packet(struct usb_endpoint *ep) {
         } else if (audio_control_cmd_t.type == USB_REQ_TYPE_RECIPIENT_ENDPOINT) {
             if (audio_control_cmd_t.cs == ENDPOINT_FREQ_CONTROL) {
                 uint32_t new_freq = (*(uint32_t *) buffer->data) & 0x00ffffffu;
+#if ENABLE_LOOPBACK
+                if (audio_control_cmd_t.ep == LOOPBACK_ENDPOINT) {
+                    // Capture rate only; the outputs keep theirs
+                    loopback_set_rate(new_freq);
+                } else
+#endif
                 if (audio_state.freq != new_freq) {
                     audio_state.freq = new_freq;
                     _audio_reconfigure();
@@ -1514,6 +1887,7 @@ static bool do_set_current(struct usb_setup_packet *setup) {
         audio_control_cmd_t.unit = setup->wIndex >> 8u;
         audio_control_cmd_t.cs = setup->wValue >> 8u;
         audio_control_cmd_t.cn = (uint8_t) setup->wValue;
+        audio_control_cmd_t.ep = (uint8_t) setup->wIndex;
         usb_start_control_out_transfer(&_audio_cmd_transfer_type);
         return true;
     }
@@ -1574,19 +1948,27 @@ static bool _as_setup_request_handler(__unused struct usb_endpoint *ep, struct u
 
 static bool as_set_alternate(struct usb_interface *interface, uint alt) {
     assert(interface == &as_op_interface);
+#if ENABLE_MC_INPUT
+    if (alt > 3) return false;
+#else
     if (alt >= 3) return false;
+#endif
 
     uint32_t prev_alt = usb_audio_alt_set;
     usb_audio_alt_set = alt;
+    trace_event(TRACE_EVT_STREAM_ALT, alt | (prev_alt << 8));
     if (alt == 2) {
         usb_input_bit_depth = 24;
     } else {
         usb_input_bit_depth = 16;
     }
+#if ENABLE_MC_INPUT
+    usb_input_channels = (alt == 3) ? MC_INPUT_CHANNELS : 2;
+#endif
 
     // Arm/disarm SPDIF starvation diagnostics with stream state.
-    // Reset only on inactive->active transition so changing 16/24-bit alt
-    // doesn't clear counters mid-stream.
+    // Reset only on inactive->active transition so changing 16/24-bit or
+    // multichannel alt doesn't clear counters mid-stream.
     bool active = (alt > 0);
     audio_spdif_set_starvation_monitoring(active);
 
@@ -1607,6 +1989,13 @@ static bool as_set_alternate(struct usb_interface *interface, uint alt) {
     return true;
 }
 
+#if ENABLE_LOOPBACK
+static bool lb_set_alternate(struct usb_interface *interface, uint alt) {
+    assert(interface == &lb_interface);
+    return loopback_set_alt((uint8_t)alt);
+}
+#endif
+
 // ----------------------------------------------------------------------------
 // VENDOR INTERFACE HANDLER (DSPi commands via EP0 control transfers)
 // ----------------------------------------------------------------------------
@@ -1618,8 +2007,9 @@ static uint16_t vendor_last_wValue = 0;
 
 // Derive Core 1 mode from current output enable state
 Core1Mode derive_core1_mode(void) {
-    // PDM output (last) takes priority — checked first
-    if (matrix_mixer.outputs[NUM_OUTPUT_CHANNELS - 1].enabled)
+    // PDM output (last) takes priority — checked first, unless the feature
+    // gate sheds it at this rate
+    if (matrix_mixer.outputs[NUM_OUTPUT_CHANNELS - 1].enabled && !(feature_gate & COST_GATE_PDM))
         return CORE1_MODE_PDM;
     // Any of outputs 2-7 enabled → EQ worker
     for (int out = CORE1_EQ_FIRST_OUTPUT; out <= CORE1_EQ_LAST_OUTPUT; out++) {
@@ -1629,17 +2019,14 @@ Core1Mode derive_core1_mode(void) {
     return CORE1_MODE_IDLE;
 }
 
-static void vendor_cmd_packet(struct usb_endpoint *ep) {
-    struct usb_buffer *buffer = usb_current_out_packet_buffer(ep);
-
-    if (buffer->data_len > 0 && buffer->data_len <= sizeof(vendor_rx_buf)) {
-        memcpy(vendor_rx_buf, buffer->data, buffer->data_len);
-    }
-
+// Apply a vendor SET request whose payload is already in vendor_rx_buf.
+// Transport-independent: called from the EP0 data stage and from the bulk
+// pipe frame dispatcher, both in USB IRQ context.
+static void vendor_apply_set(uint16_t data_len) {
     // Process command based on saved request info
     switch (vendor_last_request) {
         case REQ_SET_EQ_PARAM:
-            if (buffer->data_len >= sizeof(EqParamPacket)) {
+            if (data_len >= sizeof(EqParamPacket)) {
                 memcpy((void*)&pending_packet, vendor_rx_buf, sizeof(EqParamPacket));
                 if (pending_packet.channel < NUM_CHANNELS &&
                     pending_packet.band < channel_band_counts[pending_packet.channel]) {
@@ -1651,7 +2038,7 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
         case REQ_SET_PREAMP:
             // Legacy: sets ALL input channels to the same preamp value.
             // Payload: 4 bytes (float dB).
-            if (buffer->data_len >= 4) {
+            if (data_len >= 4) {
                 float db;
                 memcpy(&db, vendor_rx_buf, 4);
                 for (int ch = 0; ch < NUM_INPUT_CHANNELS; ch++)
@@ -1660,10 +2047,10 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
             break;
 
         case REQ_SET_PREAMP_CH: {
-            // Per-channel preamp.  wValue = input channel index (0=L, 1=R).
+            // Per-channel preamp.  wValue = input channel index (0=L, 1=R, 2+ multichannel).
             // Payload: 4 bytes (float dB).
             uint8_t ch = vendor_last_wValue & 0xFF;
-            if (ch < NUM_INPUT_CHANNELS && buffer->data_len >= 4) {
+            if (ch < NUM_INPUT_CHANNELS && data_len >= 4) {
                 float db;
                 memcpy(&db, vendor_rx_buf, 4);
                 update_preamp(ch, db);
@@ -1674,7 +2061,7 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
         case REQ_SET_MASTER_VOLUME:
             // Set device-side master volume ceiling.
             // Payload: 4 bytes (float dB).  -128 = mute, -127..0 = attenuation range.
-            if (buffer->data_len >= 4) {
+            if (data_len >= 4) {
                 float db;
                 memcpy(&db, vendor_rx_buf, 4);
                 update_master_volume(db);
@@ -1683,25 +2070,25 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
 
         case REQ_SET_DELAY: {
             uint8_t ch = vendor_last_wValue & 0xFF;
-            if (ch < NUM_CHANNELS && buffer->data_len >= 4) {
+            if (ch < NUM_CHANNELS && data_len >= 4) {
                 float ms;
                 memcpy(&ms, vendor_rx_buf, 4);
                 if (ms < 0) ms = 0;
                 channel_delays_ms[ch] = ms;
-                dsp_update_delay_samples((float)audio_state.freq);
+                dsp_update_delay_samples((float)output_rate);
             }
             break;
         }
 
         case REQ_SET_BYPASS:
-            if (buffer->data_len >= 1) {
+            if (data_len >= 1) {
                 bypass_master_eq = (vendor_rx_buf[0] != 0);
             }
             break;
 
         case REQ_SET_CHANNEL_GAIN: {
             uint8_t ch = vendor_last_wValue & 0xFF;
-            if (ch < 3 && buffer->data_len >= 4) {
+            if (ch < 3 && data_len >= 4) {
                 float db;
                 memcpy(&db, vendor_rx_buf, 4);
                 channel_gain_db[ch] = db;
@@ -1714,14 +2101,14 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
 
         case REQ_SET_CHANNEL_MUTE: {
             uint8_t ch = vendor_last_wValue & 0xFF;
-            if (ch < 3 && buffer->data_len >= 1) {
+            if (ch < 3 && data_len >= 1) {
                 channel_mute[ch] = (vendor_rx_buf[0] != 0);
             }
             break;
         }
 
         case REQ_SET_LOUDNESS:
-            if (buffer->data_len >= 1) {
+            if (data_len >= 1) {
                 loudness_enabled = (vendor_rx_buf[0] != 0);
                 if (loudness_enabled && loudness_active_table) {
                     // Re-select coefficients for current volume
@@ -1736,7 +2123,7 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
             break;
 
         case REQ_SET_LOUDNESS_REF:
-            if (buffer->data_len >= 4) {
+            if (data_len >= 4) {
                 float val;
                 memcpy(&val, vendor_rx_buf, 4);
                 if (val < 40.0f) val = 40.0f;
@@ -1747,7 +2134,7 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
             break;
 
         case REQ_SET_LOUDNESS_INTENSITY:
-            if (buffer->data_len >= 4) {
+            if (data_len >= 4) {
                 float val;
                 memcpy(&val, vendor_rx_buf, 4);
                 if (val < 0.0f) val = 0.0f;
@@ -1758,14 +2145,14 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
             break;
 
         case REQ_SET_CROSSFEED:
-            if (buffer->data_len >= 1) {
+            if (data_len >= 1) {
                 crossfeed_config.enabled = (vendor_rx_buf[0] != 0);
                 crossfeed_update_pending = true;
             }
             break;
 
         case REQ_SET_CROSSFEED_PRESET:
-            if (buffer->data_len >= 1) {
+            if (data_len >= 1) {
                 uint8_t preset = vendor_rx_buf[0];
                 if (preset <= CROSSFEED_PRESET_CUSTOM) {
                     crossfeed_config.preset = preset;
@@ -1775,7 +2162,7 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
             break;
 
         case REQ_SET_CROSSFEED_FREQ:
-            if (buffer->data_len >= 4) {
+            if (data_len >= 4) {
                 float val;
                 memcpy(&val, vendor_rx_buf, 4);
                 if (val < CROSSFEED_FREQ_MIN) val = CROSSFEED_FREQ_MIN;
@@ -1788,7 +2175,7 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
             break;
 
         case REQ_SET_CROSSFEED_FEED:
-            if (buffer->data_len >= 4) {
+            if (data_len >= 4) {
                 float val;
                 memcpy(&val, vendor_rx_buf, 4);
                 if (val < CROSSFEED_FEED_MIN) val = CROSSFEED_FEED_MIN;
@@ -1801,7 +2188,7 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
             break;
 
         case REQ_SET_CROSSFEED_ITD:
-            if (buffer->data_len >= 1) {
+            if (data_len >= 1) {
                 crossfeed_config.itd_enabled = (vendor_rx_buf[0] != 0);
                 crossfeed_update_pending = true;
             }
@@ -1809,7 +2196,7 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
 
         // Volume Leveller Commands
         case REQ_SET_LEVELLER_ENABLE:
-            if (buffer->data_len >= 1) {
+            if (data_len >= 1) {
                 leveller_config.enabled = (vendor_rx_buf[0] != 0);
                 leveller_update_pending = true;
                 leveller_reset_pending = true;  // Reset state when toggling
@@ -1817,7 +2204,7 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
             break;
 
         case REQ_SET_LEVELLER_AMOUNT:
-            if (buffer->data_len >= 4) {
+            if (data_len >= 4) {
                 float val;
                 memcpy(&val, vendor_rx_buf, 4);
                 if (val < LEVELLER_AMOUNT_MIN) val = LEVELLER_AMOUNT_MIN;
@@ -1828,7 +2215,7 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
             break;
 
         case REQ_SET_LEVELLER_SPEED:
-            if (buffer->data_len >= 1) {
+            if (data_len >= 1) {
                 uint8_t spd = vendor_rx_buf[0];
                 if (spd < LEVELLER_SPEED_COUNT) {
                     leveller_config.speed = spd;
@@ -1838,7 +2225,7 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
             break;
 
         case REQ_SET_LEVELLER_MAX_GAIN:
-            if (buffer->data_len >= 4) {
+            if (data_len >= 4) {
                 float val;
                 memcpy(&val, vendor_rx_buf, 4);
                 if (val < LEVELLER_MAX_GAIN_MIN) val = LEVELLER_MAX_GAIN_MIN;
@@ -1848,8 +2235,15 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
             }
             break;
 
+        case REQ_SET_METER_STREAM:
+            if (data_len >= 1) {
+                uint8_t hz = vendor_rx_buf[0];
+                meter_stream_hz = (hz > METER_STREAM_MAX_HZ) ? METER_STREAM_MAX_HZ : hz;
+            }
+            break;
+
         case REQ_SET_LEVELLER_LOOKAHEAD:
-            if (buffer->data_len >= 1) {
+            if (data_len >= 1) {
                 leveller_config.lookahead = (vendor_rx_buf[0] != 0);
                 leveller_update_pending = true;
                 leveller_reset_pending = true;  // Clear delay buffer on toggle
@@ -1857,7 +2251,7 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
             break;
 
         case REQ_SET_LEVELLER_GATE:
-            if (buffer->data_len >= 4) {
+            if (data_len >= 4) {
                 float val;
                 memcpy(&val, vendor_rx_buf, 4);
                 if (val < LEVELLER_GATE_MIN) val = LEVELLER_GATE_MIN;
@@ -1869,7 +2263,7 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
 
         // Matrix Mixer Commands
         case REQ_SET_MATRIX_ROUTE:
-            if (buffer->data_len >= sizeof(MatrixRoutePacket)) {
+            if (data_len >= sizeof(MatrixRoutePacket)) {
                 MatrixRoutePacket pkt;
                 memcpy(&pkt, vendor_rx_buf, sizeof(pkt));
                 if (pkt.input < NUM_INPUT_CHANNELS && pkt.output < NUM_OUTPUT_CHANNELS) {
@@ -1885,7 +2279,7 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
 
         case REQ_SET_OUTPUT_ENABLE: {
             uint8_t out = vendor_last_wValue & 0xFF;
-            if (out < NUM_OUTPUT_CHANNELS && buffer->data_len >= 1) {
+            if (out < NUM_OUTPUT_CHANNELS && data_len >= 1) {
                 bool want_enable = (vendor_rx_buf[0] != 0);
 
                 // Mutual exclusion interlock: PDM vs EQ worker outputs
@@ -1921,7 +2315,7 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
 
         case REQ_SET_OUTPUT_GAIN: {
             uint8_t out = vendor_last_wValue & 0xFF;
-            if (out < NUM_OUTPUT_CHANNELS && buffer->data_len >= 4) {
+            if (out < NUM_OUTPUT_CHANNELS && data_len >= 4) {
                 float db;
                 memcpy(&db, vendor_rx_buf, 4);
                 matrix_mixer.outputs[out].gain_db = db;
@@ -1932,7 +2326,7 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
 
         case REQ_SET_OUTPUT_MUTE: {
             uint8_t out = vendor_last_wValue & 0xFF;
-            if (out < NUM_OUTPUT_CHANNELS && buffer->data_len >= 1) {
+            if (out < NUM_OUTPUT_CHANNELS && data_len >= 1) {
                 matrix_mixer.outputs[out].mute = vendor_rx_buf[0];
             }
             break;
@@ -1940,14 +2334,14 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
 
         case REQ_SET_OUTPUT_DELAY: {
             uint8_t out = vendor_last_wValue & 0xFF;
-            if (out < NUM_OUTPUT_CHANNELS && buffer->data_len >= 4) {
+            if (out < NUM_OUTPUT_CHANNELS && data_len >= 4) {
                 float ms;
                 memcpy(&ms, vendor_rx_buf, 4);
                 if (ms < 0) ms = 0;
                 matrix_mixer.outputs[out].delay_ms = ms;
                 // Update the channel delay used by DSP pipeline
                 channel_delays_ms[CH_OUT_1 + out] = ms;
-                dsp_update_delay_samples((float)audio_state.freq);
+                dsp_update_delay_samples((float)output_rate);
             }
             break;
         }
@@ -1955,13 +2349,13 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
         // --- Preset SET commands ---
 
         case REQ_PRESET_SET_NAME: {
-            // Deferred to main loop — flash write in dir_flush() is too
-            // slow for USB IRQ context.  Copy payload to pending buffer.
+            // Deferred to main loop — flash write in dir_flush() must not
+            // run in USB IRQ context.  Copy payload to pending buffer.
             uint8_t slot = vendor_last_wValue & 0xFF;
-            if (buffer->data_len > 0) {
+            if (data_len > 0) {
                 memset(flash_set_name_buf, 0, sizeof(flash_set_name_buf));
-                size_t copy_len = buffer->data_len < (PRESET_NAME_LEN - 1)
-                                ? buffer->data_len : (PRESET_NAME_LEN - 1);
+                size_t copy_len = data_len < (PRESET_NAME_LEN - 1)
+                                ? data_len : (PRESET_NAME_LEN - 1);
                 memcpy(flash_set_name_buf, vendor_rx_buf, copy_len);
                 flash_set_name_slot = slot;
                 __dmb();
@@ -1972,7 +2366,7 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
 
         case REQ_PRESET_SET_STARTUP: {
             // Deferred to main loop — flash write in dir_flush().
-            if (buffer->data_len >= 2) {
+            if (data_len >= 2) {
                 flash_set_startup_mode = vendor_rx_buf[0];
                 flash_set_startup_slot = vendor_rx_buf[1];
                 __dmb();
@@ -1983,7 +2377,7 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
 
         case REQ_PRESET_SET_INCLUDE_PINS: {
             // Deferred to main loop — flash write in dir_flush().
-            if (buffer->data_len >= 1) {
+            if (data_len >= 1) {
                 flash_set_include_pins_val = vendor_rx_buf[0];
                 __dmb();
                 flash_set_include_pins_pending = true;
@@ -1994,7 +2388,7 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
         case REQ_SET_MASTER_VOLUME_MODE: {
             // Set master-volume persistence mode (0 = independent, 1 = per-preset).
             // Deferred to main loop — flash write in dir_flush().
-            if (buffer->data_len >= 1) {
+            if (data_len >= 1) {
                 uint8_t m = vendor_rx_buf[0];
                 if (m > MASTER_VOLUME_MODE_WITH_PRESET) m = MASTER_VOLUME_MODE_INDEPENDENT;
                 flash_set_master_volume_mode_val = m;
@@ -2004,18 +2398,187 @@ static void vendor_cmd_packet(struct usb_endpoint *ep) {
             break;
         }
 
+        case REQ_SET_LATENCY_PROFILE: {
+            if (data_len >= 1) {
+                uint8_t p = vendor_rx_buf[0];
+                if (p >= LATENCY_PROFILE_COUNT) p = LATENCY_PROFILE_BALANCED;
+                latency_profile_request(p);
+                flash_set_latency_profile_val = p;
+                __dmb();
+                flash_set_latency_profile_pending = true;
+            }
+            break;
+        }
+
+#if ENABLE_ASRC
+        case REQ_SET_RATE_LOCK: {
+            // Unsupported rates store off; REQ_GET_RATE_LOCK shows the result
+            if (data_len >= 4) {
+                uint32_t rate;
+                memcpy(&rate, vendor_rx_buf, 4);
+                rate_lock_request(rate);
+                flash_set_rate_lock_val = rate_lock_get();
+                __dmb();
+                flash_set_rate_lock_pending = true;
+            }
+            break;
+        }
+#endif
+
+        case REQ_SET_SCENE_MORPH: {
+            // Started by the main loop; REQ_GET_SCENE_MORPH reports the result
+            if (data_len >= sizeof(SceneMorphRequestPacket)) {
+                SceneMorphRequestPacket req;
+                memcpy(&req, vendor_rx_buf, sizeof(req));
+                scene_morph_request_start(&req);
+            }
+            break;
+        }
+
+        case REQ_SET_SCENE_POSITION: {
+            if (data_len >= 2) {
+                uint16_t pos;
+                memcpy(&pos, vendor_rx_buf, 2);
+                scene_morph_request_position(pos);
+            }
+            break;
+        }
+
+        case REQ_END_SCENE_MORPH: {
+            if (data_len >= 1) {
+                scene_morph_request_end(vendor_rx_buf[0]);
+            }
+            break;
+        }
+
+        case REQ_SET_PROFILER: {
+            if (data_len >= 1) {
+                profiler_control(vendor_rx_buf[0]);
+            }
+            break;
+        }
+
+#if ENABLE_FIR
+        case REQ_SET_FIR_BEGIN: {
+            // Allocated by the main loop; REQ_GET_FIR_STATUS reports LOADING
+            if (data_len >= sizeof(FirBeginPacket)) {
+                FirBeginPacket req;
+                memcpy(&req, vendor_rx_buf, sizeof(req));
+                fir_request_begin(&req);
+            }
+            break;
+        }
+
+        case REQ_SET_FIR_TAPS: {
+            // wValue = output, payload = uint16_t offset, 2 reserved, float taps
+            fir_request_taps(vendor_last_wValue & 0xFF, vendor_rx_buf, data_len);
+            break;
+        }
+
+        case REQ_SET_FIR_COMMIT: {
+            if (data_len >= 1) {
+                fir_request_commit(vendor_rx_buf[0]);
+            }
+            break;
+        }
+
+        case REQ_SET_FIR_CLEAR: {
+            if (data_len >= 1) {
+                fir_request_clear(vendor_rx_buf[0]);
+            }
+            break;
+        }
+
+        case REQ_SET_FIR_XOVER: {
+            // Designed by the main loop; REQ_GET_FIR_XOVER reports ACTIVE
+            if (data_len >= sizeof(FirXoverPacket)) {
+                FirXoverPacket req;
+                memcpy(&req, vendor_rx_buf, sizeof(req));
+                fir_request_xover(&req);
+            }
+            break;
+        }
+#endif
+
+#if ENABLE_DYNEQ
+        case REQ_SET_DYN_EQ: {
+            // Applied by the main loop; REQ_GET_DYN_EQ shows the slot
+            if (data_len >= sizeof(DynEqPacket)) {
+                DynEqPacket req;
+                memcpy(&req, vendor_rx_buf, sizeof(req));
+                dyneq_request(&req);
+            }
+            break;
+        }
+#endif
+
+#if ENABLE_MULTIBAND
+        case REQ_SET_MB_CONFIG: {
+            // Applied by the main loop; REQ_GET_MB_STATUS shows the result
+            if (data_len >= sizeof(MultibandConfigPacket)) {
+                MultibandConfigPacket req;
+                memcpy(&req, vendor_rx_buf, sizeof(req));
+                multiband_request_config(&req);
+            }
+            break;
+        }
+
+        case REQ_SET_MB_BAND: {
+            if (data_len >= sizeof(MultibandBandPacket)) {
+                MultibandBandPacket req;
+                memcpy(&req, vendor_rx_buf, sizeof(req));
+                multiband_request_band(&req);
+            }
+            break;
+        }
+#endif
+
+#if ENABLE_LIMITER
+        case REQ_SET_OUT_LIMITER: {
+            // Applied by the main loop; REQ_GET_OUT_LIMITER shows the result
+            if (data_len >= sizeof(OutLimiterPacket)) {
+                OutLimiterPacket req;
+                memcpy(&req, vendor_rx_buf, sizeof(req));
+                limiter_request(&req);
+            }
+            break;
+        }
+#endif
+
+#if ENABLE_LOOPBACK
+        case REQ_SET_LOOPBACK_SRC: {
+            // Out-of-range outputs are ignored; REQ_GET_LOOPBACK_STATUS shows the pair
+            if (data_len >= sizeof(LoopbackSrcPacket)) {
+                LoopbackSrcPacket req;
+                memcpy(&req, vendor_rx_buf, sizeof(req));
+                loopback_set_src(&req);
+            }
+            break;
+        }
+#endif
+
         case REQ_SET_CHANNEL_NAME: {
             // wValue = channel index, payload = 1-32 bytes of name
             uint8_t ch = vendor_last_wValue & 0xFF;
-            if (ch < NUM_CHANNELS && buffer->data_len > 0) {
+            if (ch < NUM_CHANNELS && data_len > 0) {
                 memset(channel_names[ch], 0, PRESET_NAME_LEN);
-                size_t copy_len = buffer->data_len < (PRESET_NAME_LEN - 1)
-                                ? buffer->data_len : (PRESET_NAME_LEN - 1);
+                size_t copy_len = data_len < (PRESET_NAME_LEN - 1)
+                                ? data_len : (PRESET_NAME_LEN - 1);
                 memcpy(channel_names[ch], vendor_rx_buf, copy_len);
             }
             break;
         }
     }
+}
+
+static void vendor_cmd_packet(struct usb_endpoint *ep) {
+    struct usb_buffer *buffer = usb_current_out_packet_buffer(ep);
+
+    if (buffer->data_len > 0 && buffer->data_len <= sizeof(vendor_rx_buf)) {
+        memcpy(vendor_rx_buf, buffer->data, buffer->data_len);
+    }
+
+    vendor_apply_set(buffer->data_len);
 
     usb_start_empty_control_in_transfer_null_completion();
 }
@@ -2025,14 +2588,35 @@ static const struct usb_transfer_type _vendor_cmd_transfer_type = {
     .initial_packet_count = 1,
 };
 
+// Bulk pipe response capture.  While a bulk frame is dispatched through the
+// GET handler below, responses are diverted here instead of the control IN
+// endpoint (see vendor_bulk_dispatch).
+static uint8_t *vendor_capture_buf = NULL;
+static uint16_t vendor_capture_len = 0;
+
 // Helper: write data into the control IN buffer and send
 static void vendor_send_response(const void *data, uint len) {
+    if (vendor_capture_buf) {
+        memcpy(vendor_capture_buf, data, len);
+        vendor_capture_len = len;
+        return;
+    }
     struct usb_buffer *buffer = usb_current_in_packet_buffer(usb_get_control_in_endpoint());
     memcpy(buffer->data, data, len);
     buffer->data_len = len;
     usb_start_single_buffer_control_in_transfer();
 }
 
+// Helper: send a little-endian scalar of 1-4 bytes
+static void vendor_send_tiny(uint32_t data, uint len) {
+    if (vendor_capture_buf) {
+        uint8_t b[4] = { data, data >> 8, data >> 16, data >> 24 };
+        vendor_send_response(b, len);
+        return;
+    }
+    usb_start_tiny_control_in_transfer(data, len);
+}
+
 // Runtime pin configuration
 #if PICO_RP2350
 uint8_t output_pins[NUM_PIN_OUTPUTS] = {
@@ -2080,13 +2664,14 @@ static inline uint16_t mck_decode(uint8_t raw)  { return (raw == 1) ? 256 : 128;
 
 // 96 kHz + 256x requires a 24.576 MHz MCK derived from a highly fractional
 // divider on the current fixed sys_clk plan. On real hardware this mode has
-// proven unreliable (lock loss / silence), so clamp to 128x for 96 kHz+.
+// proven unreliable (lock loss / silence), so clamp to 128x from 88.2 kHz
+// (22.5792 MHz, the same kind of divider) up.
 static inline bool is_mck_multiplier_supported_for_rate(uint16_t mult, uint32_t sample_rate_hz) {
-    return !(mult == 256u && sample_rate_hz >= 96000u);
+    return !(mult == 256u && sample_rate_hz >= 88200u);
 }
 
 static void sanitize_mck_multiplier_for_rate(uint32_t sample_rate_hz) {
-    if (sample_rate_hz >= 96000u && i2s_mck_multiplier == 256u) {
+    if (sample_rate_hz >= 88200u && i2s_mck_multiplier == 256u) {
         i2s_mck_multiplier = 128u;
         printf("MCK 256x not supported at %lu Hz; forcing 128x\n",
                (unsigned long)sample_rate_hz);
@@ -2241,6 +2826,9 @@ static void update_buffer_watermarks(void) {
 static bool vendor_setup_request_handler(__unused struct usb_interface *interface, struct usb_setup_packet *setup) {
     setup = __builtin_assume_aligned(setup, 4);
 
+    // A SETUP on EP0 ends any control transfer still in its data stage
+    if (!vendor_capture_buf) vbuf_release(&bulk_param_buf_owner, VBUF_EP0);
+
     if (!(setup->bmRequestType & USB_DIR_IN)) {
         // Host -> Device (SET requests)
         vendor_last_request = setup->bRequest;
@@ -2249,6 +2837,7 @@ static bool vendor_setup_request_handler(__unused struct usb_interface *interfac
         // Large control OUT: bulk parameter SET
         if (setup->bRequest == REQ_SET_ALL_PARAMS &&
             setup->wLength == sizeof(WireBulkParams)) {
+            if (!vbuf_claim(&bulk_param_buf_owner, VBUF_EP0)) return false;
             usb_stream_setup_transfer(&_vendor_stream, &_vendor_stream_funcs,
                                       bulk_param_buf, WIRE_BULK_BUF_SIZE,
                                       sizeof(WireBulkParams), _vendor_set_complete);
@@ -2427,6 +3016,7 @@ static bool vendor_setup_request_handler(__unused struct usb_interface *interfac
             case REQ_GET_STATUS: {
                 if (setup->wValue == 9) {
                     // Combined status: all peaks + CPU load + clip flags
+                    // (+ status flags when wLength allows)
                     // RP2350: 26 bytes (11 peaks × 2 + 2 CPU + 2 clip)
                     // RP2040: 18 bytes (7 peaks × 2 + 2 CPU + 2 clip)
                     for (int i = 0; i < NUM_CHANNELS; i++) {
@@ -2437,6 +3027,12 @@ static bool vendor_setup_request_handler(__unused struct usb_interface *interfac
                     resp_buf[NUM_CHANNELS * 2 + 1] = global_status.cpu1_load;
                     resp_buf[NUM_CHANNELS * 2 + 2] = global_status.clip_flags & 0xFF;
                     resp_buf[NUM_CHANNELS * 2 + 3] = global_status.clip_flags >> 8;
+                    // Hosts asking for more get the deadline status byte too
+                    if (setup->wLength > NUM_CHANNELS * 2 + 4) {
+                        resp_buf[NUM_CHANNELS * 2 + 4] = global_status.status_flags;
+                        vendor_send_response(resp_buf, NUM_CHANNELS * 2 + 5);
+                        return true;
+                    }
                     vendor_send_response(resp_buf, NUM_CHANNELS * 2 + 4);
                     return true;
                 }
@@ -2466,25 +3062,29 @@ static bool vendor_setup_request_handler(__unused struct usb_interface *interfac
                     case 21: resp = audio_spdif_get_dma_starvations_instance(3); break;  // SPDIF instance 3
                     case 22: resp = audio_ring.overrun_count; break;  // USB audio ring overruns
                 }
-                usb_start_tiny_control_in_transfer(resp, 4);
+                vendor_send_tiny(resp, 4);
                 return true;
             }
 
             case REQ_SAVE_PARAMS: {
                 // Legacy command retained for compatibility, but deferred to
-                // main loop to avoid flash write blackout in IRQ context.
+                // main loop: flash writes must not run in IRQ context.
                 save_params_pending = true;
                 __dmb();
-                usb_start_tiny_control_in_transfer(FLASH_OK, 1);  // Accepted
+                vendor_send_tiny(FLASH_OK, 1);  // Accepted
                 return true;
             }
 
             case REQ_LOAD_PARAMS: {
-                // flash_load_params() routes through preset_load(), which
-                // handles filter recalculation, delay updates, and mute
-                // internally — no need to duplicate here.
-                int result = flash_load_params();
-                usb_start_tiny_control_in_transfer(result, 1);
+                // Reload of the active slot, deferred exactly like
+                // REQ_PRESET_LOAD: preset_load() records the active slot in
+                // flash, and the load needs the pipeline reset bracket.
+                // Response means "accepted"; a CRC failure leaves the live
+                // state unchanged.
+                pending_preset_load_slot = preset_get_active();
+                preset_load_pending = true;
+                __dmb();
+                vendor_send_tiny(FLASH_OK, 1);
                 return true;
             }
 
@@ -2494,7 +3094,7 @@ static bool vendor_setup_request_handler(__unused struct usb_interface *interfac
                 // output type switch if the live config had I2S outputs.
                 factory_reset_pending = true;
                 __dmb();
-                usb_start_tiny_control_in_transfer(FLASH_OK, 1);
+                vendor_send_tiny(FLASH_OK, 1);
                 return true;
             }
 
@@ -2510,8 +3110,9 @@ static bool vendor_setup_request_handler(__unused struct usb_interface *interfac
                         case 1: memcpy(&val_to_send, &p->freq, 4); break;
                         case 2: memcpy(&val_to_send, &p->Q, 4); break;
                         case 3: memcpy(&val_to_send, &p->gain_db, 4); break;
+                        case 4: val_to_send = (uint32_t)p->order; break;
                     }
-                    usb_start_tiny_control_in_transfer(val_to_send, 4);
+                    vendor_send_tiny(val_to_send, 4);
                     return true;
                 }
                 return false;
@@ -2683,7 +3284,45 @@ static bool vendor_setup_request_handler(__unused struct usb_interface *interfac
                 // Read-then-clear: return the clip flags that were set, then reset
                 uint16_t flags = global_status.clip_flags;
                 global_status.clip_flags = 0;
-                usb_start_tiny_control_in_transfer(flags, 2);
+                vendor_send_tiny(flags, 2);
+                return true;
+            }
+
+            case REQ_GET_LATENCY_PROFILE: {
+                resp_buf[0] = latency_profile_get();
+                vendor_send_response(resp_buf, 1);
+                return true;
+            }
+
+#if ENABLE_ASRC
+            case REQ_GET_RATE_LOCK: {
+                RateLockStatusPacket pkt;
+                rate_lock_get_status(&pkt);
+                memcpy(resp_buf, &pkt, sizeof(pkt));
+                vendor_send_response(resp_buf, sizeof(pkt));
+                return true;
+            }
+#endif
+
+            case REQ_GET_LATENCY_REPORT: {
+                LatencyReportPacket pkt;
+                latency_profile_report(&pkt, output_rate);
+                memcpy(resp_buf, &pkt, sizeof(pkt));
+                vendor_send_response(resp_buf, sizeof(pkt));
+                return true;
+            }
+
+            case REQ_GET_SCENE_MORPH: {
+                SceneMorphStatusPacket pkt;
+                scene_morph_status(&pkt);
+                memcpy(resp_buf, &pkt, sizeof(pkt));
+                vendor_send_response(resp_buf, sizeof(pkt));
+                return true;
+            }
+
+            case REQ_GET_METER_STREAM: {
+                resp_buf[0] = meter_stream_hz;
+                vendor_send_response(resp_buf, 1);
                 return true;
             }
 
@@ -2691,10 +3330,8 @@ static bool vendor_setup_request_handler(__unused struct usb_interface *interfac
 
             case REQ_PRESET_SAVE: {
                 // Deferred to main loop: flash writes must not run in IRQ
-                // context (45ms interrupt blackout per sector).  The main loop
-                // brackets save with prepare/complete_pipeline_reset() so audio
-                // resumes from a fully resynced output pipeline after blackout.
-                // Response is fire-and-forget: "accepted".
+                // context.  Audio keeps playing during the save (background
+                // flash writer).  Response is fire-and-forget: "accepted".
                 uint8_t slot = (uint8_t)setup->wValue;
                 if (slot >= PRESET_SLOTS) {
                     resp_buf[0] = PRESET_ERR_INVALID_SLOT;
@@ -2730,15 +3367,15 @@ static bool vendor_setup_request_handler(__unused struct usb_interface *interfac
             }
 
             case REQ_PRESET_DELETE: {
-                // Deferred to main loop: flash erase runs with interrupts
-                // disabled for ~45ms.  If the deleted slot is the active slot,
-                // factory defaults are applied — which needs pipeline reset
-                // to flush stale buffers processed with the old parameters.
+                // Deferred to main loop: flash writes must not run in IRQ
+                // context.  If the deleted slot is the active slot, factory
+                // defaults are applied — which needs pipeline reset to flush
+                // stale buffers processed with the old parameters.
                 uint8_t slot = (uint8_t)setup->wValue;
                 if (slot >= PRESET_SLOTS) {
                     resp_buf[0] = PRESET_ERR_INVALID_SLOT;
                 } else {
-                    preset_delete_mask |= (1u << slot);
+                    preset_delete_mask[slot >> 5] |= (1u << (slot & 31));
                     __dmb();
                     resp_buf[0] = PRESET_OK;
                 }
@@ -2761,7 +3398,8 @@ static bool vendor_setup_request_handler(__unused struct usb_interface *interfac
 
             case REQ_PRESET_GET_DIR: {
                 // Returns 7-byte directory summary:
-                //   [0-1] slot_occupied bitmask (little-endian u16)
+                //   [0-1] slot_occupied bitmask, slots 0-15 (little-endian u16;
+                //         REQ_PRESET_GET_STORE covers every slot)
                 //   [2]   startup_mode
                 //   [3]   default_slot
                 //   [4]   last_active_slot
@@ -2805,6 +3443,142 @@ static bool vendor_setup_request_handler(__unused struct usb_interface *interfac
                 return true;
             }
 
+            case REQ_PRESET_GET_STORE: {
+                PresetStoreInfoPacket pkt;
+                preset_get_store_info(&pkt);
+                memcpy(resp_buf, &pkt, sizeof(pkt));
+                vendor_send_response(resp_buf, sizeof(pkt));
+                return true;
+            }
+
+            case REQ_GET_BOOT_TIMING: {
+                memcpy(resp_buf, (const void *)&boot_timing, sizeof(BootTimingPacket));
+                vendor_send_response(resp_buf, sizeof(BootTimingPacket));
+                return true;
+            }
+
+            case REQ_GET_CONFIG_COST: {
+                memcpy(resp_buf, (const void *)&config_cost_report, sizeof(ConfigCostPacket));
+                vendor_send_response(resp_buf, sizeof(ConfigCostPacket));
+                return true;
+            }
+
+            case REQ_GET_FEATURE_GATE: {
+                memcpy(resp_buf, (const void *)&feature_gate_report, sizeof(FeatureGatePacket));
+                vendor_send_response(resp_buf, sizeof(FeatureGatePacket));
+                return true;
+            }
+
+#if ENABLE_MC_INPUT
+            case REQ_GET_INPUT_STATUS: {
+                // The master pair reads as its master peaks (what it feeds the
+                // mixer); inputs 2+ post-preamp
+                InputStatusPacket pkt;
+                memset(&pkt, 0, sizeof(pkt));
+                pkt.num_inputs = NUM_INPUT_CHANNELS;
+                pkt.stream_channels = usb_audio_alt_set ? usb_input_channels : 0;
+                pkt.mix_inputs = mc_mix_inputs;
+                pkt.peaks[0] = global_status.peaks[0];
+                pkt.peaks[1] = global_status.peaks[1];
+                for (int c = NUM_MASTER_INPUTS; c < NUM_INPUT_CHANNELS; c++) pkt.peaks[c] = mc_input_peaks[c];
+                memcpy(resp_buf, &pkt, sizeof(pkt));
+                vendor_send_response(resp_buf, sizeof(pkt));
+                return true;
+            }
+#endif
+
+#if ENABLE_LOOPBACK
+            case REQ_GET_LOOPBACK_STATUS: {
+                LoopbackStatusPacket pkt;
+                loopback_get_status(&pkt);
+                memcpy(resp_buf, &pkt, sizeof(pkt));
+                vendor_send_response(resp_buf, sizeof(pkt));
+                return true;
+            }
+#endif
+
+#if ENABLE_FIR
+            case REQ_GET_FIR_STATUS: {
+                // wValue = output index
+                FirStatusPacket pkt;
+                if (!fir_get_status((uint8_t)setup->wValue, &pkt)) return false;
+                memcpy(resp_buf, &pkt, sizeof(pkt));
+                vendor_send_response(resp_buf, sizeof(pkt));
+                return true;
+            }
+
+            case REQ_GET_FIR_XOVER: {
+                // wValue = output index
+                FirXoverStatusPacket pkt;
+                if (!fir_get_xover_status((uint8_t)setup->wValue, &pkt)) return false;
+                memcpy(resp_buf, &pkt, sizeof(pkt));
+                vendor_send_response(resp_buf, sizeof(pkt));
+                return true;
+            }
+#endif
+
+#if ENABLE_DYNEQ
+            case REQ_GET_DYN_EQ: {
+                // wValue = (channel << 8) | band
+                DynEqStatusPacket pkt;
+                if (!dyneq_get_status((uint8_t)(setup->wValue >> 8), (uint8_t)setup->wValue, &pkt))
+                    return false;
+                memcpy(resp_buf, &pkt, sizeof(pkt));
+                vendor_send_response(resp_buf, sizeof(pkt));
+                return true;
+            }
+#endif
+
+#if ENABLE_MULTIBAND
+            case REQ_GET_MB_STATUS: {
+                // wValue = instance
+                MultibandStatusPacket pkt;
+                if (!multiband_get_status((uint8_t)setup->wValue, &pkt)) return false;
+                memcpy(resp_buf, &pkt, sizeof(pkt));
+                vendor_send_response(resp_buf, sizeof(pkt));
+                return true;
+            }
+
+            case REQ_GET_MB_BAND: {
+                // wValue = (instance << 8) | band
+                MultibandBandPacket pkt;
+                if (!multiband_get_band((uint8_t)(setup->wValue >> 8), (uint8_t)setup->wValue, &pkt))
+                    return false;
+                memcpy(resp_buf, &pkt, sizeof(pkt));
+                vendor_send_response(resp_buf, sizeof(pkt));
+                return true;
+            }
+#endif
+
+#if ENABLE_LIMITER
+            case REQ_GET_OUT_LIMITER: {
+                // wValue = output
+                OutLimiterStatusPacket pkt;
+                if (!limiter_get_status((uint8_t)setup->wValue, &pkt)) return false;
+                memcpy(resp_buf, &pkt, sizeof(pkt));
+                vendor_send_response(resp_buf, sizeof(pkt));
+                return true;
+            }
+#endif
+
+            case REQ_GET_PROFILER_STAGE: {
+                // wValue = stage index (PROF_STAGE_*)
+                ProfilerStagePacket pkt;
+                if (!profiler_get_stage((uint8_t)setup->wValue, &pkt)) return false;
+                memcpy(resp_buf, &pkt, sizeof(pkt));
+                vendor_send_response(resp_buf, sizeof(pkt));
+                return true;
+            }
+
+            case REQ_GET_DEADLINE_STATS: {
+                // wValue bit 0 = clear after reading
+                DeadlineStatsPacket pkt;
+                deadline_get_stats(&pkt, (setup->wValue & 1) != 0);
+                memcpy(resp_buf, &pkt, sizeof(pkt));
+                vendor_send_response(resp_buf, sizeof(pkt));
+                return true;
+            }
+
             case REQ_GET_MASTER_VOLUME_MODE: {
                 // Returns master-volume persistence mode (0 or 1).
                 uint16_t occupied;
@@ -2833,7 +3607,7 @@ static bool vendor_setup_request_handler(__unused struct usb_interface *interfac
                 // write itself is deferred to the main loop.
                 flash_save_master_volume_pending = true;
                 __dmb();
-                usb_start_tiny_control_in_transfer(PRESET_OK, 1);
+                vendor_send_tiny(PRESET_OK, 1);
                 return true;
             }
 
@@ -2853,6 +3627,7 @@ static bool vendor_setup_request_handler(__unused struct usb_interface *interfac
             }
 
             case REQ_GET_ALL_PARAMS: {
+                if (!vbuf_claim(&bulk_param_buf_owner, VBUF_EP0)) return false;
                 bulk_params_collect((WireBulkParams *)bulk_param_buf);
                 uint32_t len = sizeof(WireBulkParams);
                 if (setup->wLength < len) len = setup->wLength;
@@ -2866,6 +3641,22 @@ static bool vendor_setup_request_handler(__unused struct usb_interface *interfac
                 return true;
             }
 
+            case REQ_GET_TRACE: {
+                // Drained into bulk_param_buf and streamed like
+                // REQ_GET_ALL_PARAMS; not while another transfer owns it.
+                if (!vbuf_claim(&bulk_param_buf_owner, VBUF_EP0)) return false;
+                uint16_t max_len = setup->wLength < WIRE_BULK_BUF_SIZE ? setup->wLength : WIRE_BULK_BUF_SIZE;
+                uint32_t len = trace_drain(bulk_param_buf, max_len);
+                usb_stream_setup_transfer(&_vendor_stream, &_vendor_stream_funcs,
+                                          bulk_param_buf, WIRE_BULK_BUF_SIZE, len,
+                                          _vendor_get_complete);
+                bool need_zlp = (len > 0) && (len < setup->wLength) && ((len & 63u) == 0);
+                if (need_zlp) usb_grow_transfer(&_vendor_stream.core, 1);
+                _vendor_stream.ep = usb_get_control_in_endpoint();
+                usb_start_transfer(usb_get_control_in_endpoint(), &_vendor_stream.core);
+                return true;
+            }
+
             case REQ_GET_BUFFER_STATS: {
                 BufferStatsPacket pkt;
                 memset(&pkt, 0, sizeof(pkt));
@@ -3062,8 +3853,8 @@ static bool vendor_setup_request_handler(__unused struct usb_interface *interfac
             case REQ_SET_MCK_ENABLE: {
                 bool enable = (setup->wValue != 0);
                 if (enable && !i2s_mck_enabled) {
-                    sanitize_mck_multiplier_for_rate(audio_state.freq);
-                    audio_i2s_mck_update_frequency(audio_state.freq, i2s_mck_multiplier);
+                    sanitize_mck_multiplier_for_rate(output_rate);
+                    audio_i2s_mck_update_frequency(output_rate, i2s_mck_multiplier);
                     audio_i2s_mck_set_enabled(true);
                     i2s_mck_enabled = true;
                 } else if (!enable && i2s_mck_enabled) {
@@ -3114,16 +3905,16 @@ static bool vendor_setup_request_handler(__unused struct usb_interface *interfac
                 if (raw > 1) { resp_buf[0] = PIN_CONFIG_INVALID_PIN; vendor_send_response(resp_buf, 1); return true; }
                 uint16_t mult = (raw == 1) ? 256 : 128;
 
-                if (!is_mck_multiplier_supported_for_rate(mult, audio_state.freq)) {
+                if (!is_mck_multiplier_supported_for_rate(mult, output_rate)) {
                     printf("Rejected MCK %ux at %lu Hz (unsupported)\n",
-                           (unsigned)mult, (unsigned long)audio_state.freq);
+                           (unsigned)mult, (unsigned long)output_rate);
                     resp_buf[0] = PIN_CONFIG_INVALID_PIN;
                     vendor_send_response(resp_buf, 1);
                     return true;
                 }
                 i2s_mck_multiplier = mult;
                 if (i2s_mck_enabled) {
-                    audio_i2s_mck_update_frequency(audio_state.freq, i2s_mck_multiplier);
+                    audio_i2s_mck_update_frequency(output_rate, i2s_mck_multiplier);
                 }
                 resp_buf[0] = PIN_CONFIG_SUCCESS;
                 vendor_send_response(resp_buf, 1);
@@ -3131,7 +3922,7 @@ static bool vendor_setup_request_handler(__unused struct usb_interface *interfac
             }
 
             case REQ_GET_MCK_MULTIPLIER: {
-                sanitize_mck_multiplier_for_rate(audio_state.freq);
+                sanitize_mck_multiplier_for_rate(output_rate);
                 resp_buf[0] = mck_encode(i2s_mck_multiplier);
                 vendor_send_response(resp_buf, 1);
                 return true;
@@ -3142,6 +3933,368 @@ static bool vendor_setup_request_handler(__unused struct usb_interface *interfac
     }
 }
 
+// ----------------------------------------------------------------------------
+// VENDOR BULK PIPE (framed command protocol, see vendor_frame.h)
+// ----------------------------------------------------------------------------
+//
+// Frames arriving on the bulk OUT endpoint are parsed and dispatched in USB
+// IRQ context, through the same SET/GET handlers as EP0, so both transports
+// share one command implementation.  Responses are queued in command order
+// and streamed on the bulk IN endpoint.
+//
+// Flow control: each dispatched frame may need one response slot.  When the
+// queue is full the current OUT packet is held (not returned to the
+// controller), so the host sees NAKs until IN traffic drains the queue.
+
+#define VENDOR_BULK_TX_DEPTH    16      // Queued response frames
+#define VENDOR_BULK_INLINE_MAX  64      // Largest inline payload (EP0 response size)
+
+typedef struct {
+    uint8_t  data[VFRAME_HEADER_SIZE + VENDOR_BULK_INLINE_MAX];
+    uint16_t len;
+    const uint8_t *ext;         // Optional out-of-line payload (bulk_param_buf)
+    uint16_t ext_len;
+} VendorBulkTxFrame;
+
+static struct usb_endpoint vendor_ep_out, vendor_ep_in;
+static struct usb_transfer vendor_bulk_out_transfer, vendor_bulk_in_transfer;
+
+static VendorFrameParser vendor_bulk_parser;
+static uint8_t vendor_bulk_rx_payload[VENDOR_BULK_INLINE_MAX];
+static bool vendor_bulk_rx_to_param_buf = false;    // Current frame payload lands in bulk_param_buf
+
+static VendorBulkTxFrame vendor_bulk_tx[VENDOR_BULK_TX_DEPTH];
+static uint8_t vendor_bulk_tx_head = 0;     // Next free slot
+static uint8_t vendor_bulk_tx_tail = 0;     // Frame being transmitted
+static uint8_t vendor_bulk_tx_count = 0;
+static uint16_t vendor_bulk_tx_offset = 0;  // Bytes of the tail frame already sent
+static bool vendor_bulk_tx_zlp = false;     // Last packet was full; terminate with a ZLP
+
+static bool vendor_bulk_out_held = false;   // OUT packet not yet fully consumed
+static uint16_t vendor_bulk_out_offset = 0;
+static bool vendor_bulk_in_idle = false;    // IN on_packet deferred (nothing to send)
+
+static bool vendor_bulk_fill_in(struct usb_endpoint *ep) {
+    if (!vendor_bulk_tx_count && !vendor_bulk_tx_zlp) return false;
+
+    struct usb_buffer *buffer = usb_current_in_packet_buffer(ep);
+    uint16_t n = 0;
+
+    while (n < buffer->data_max && vendor_bulk_tx_count) {
+        VendorBulkTxFrame *f = &vendor_bulk_tx[vendor_bulk_tx_tail];
+        uint16_t total = f->len + f->ext_len;
+        uint16_t chunk = total - vendor_bulk_tx_offset;
+        if (chunk > buffer->data_max - n) chunk = buffer->data_max - n;
+
+        for (uint16_t i = 0; i < chunk; i++) {
+            uint16_t pos = vendor_bulk_tx_offset + i;
+            buffer->data[n + i] = (pos < f->len) ? f->data[pos] : f->ext[pos - f->len];
+        }
+        n += chunk;
+        vendor_bulk_tx_offset += chunk;
+
+        if (vendor_bulk_tx_offset == total) {
+            if (f->ext == bulk_param_buf) vbuf_release(&bulk_param_buf_owner, VBUF_BULK_IN);
+            vendor_bulk_tx_offset = 0;
+            vendor_bulk_tx_tail = (vendor_bulk_tx_tail + 1) % VENDOR_BULK_TX_DEPTH;
+            vendor_bulk_tx_count--;
+        }
+    }
+
+    buffer->data_len = n;
+    vendor_bulk_tx_zlp = (n == buffer->data_max) && !vendor_bulk_tx_count;
+    usb_grow_transfer(ep->current_transfer, 1);
+    usb_packet_done(ep);
+    return true;
+}
+
+static void vendor_bulk_queue(const VendorFrameHeader *cmd, uint8_t status,
+                              const void *data, uint16_t len,
+                              const uint8_t *ext, uint16_t ext_len) {
+    VendorBulkTxFrame *f = &vendor_bulk_tx[vendor_bulk_tx_head];
+
+    VendorFrameHeader rsp = {
+        .flags   = VFRAME_FLAG_RESPONSE | (cmd->flags & (VFRAME_FLAG_IN | VFRAME_FLAG_EVENT)),
+        .seq     = cmd->seq,
+        .request = cmd->request,
+        .status  = status,
+        .value   = cmd->value,
+        .length  = len + ext_len,
+    };
+    f->len = vframe_encode_header(f->data, &rsp);
+    if (len) memcpy(f->data + f->len, data, len);
+    f->len += len;
+    f->ext = ext;
+    f->ext_len = ext_len;
+
+    vendor_bulk_tx_head = (vendor_bulk_tx_head + 1) % VENDOR_BULK_TX_DEPTH;
+    vendor_bulk_tx_count++;
+
+    if (vendor_bulk_in_idle) {
+        vendor_bulk_in_idle = false;
+        vendor_bulk_fill_in(&vendor_ep_in);
+    }
+}
+
+static void vendor_bulk_dispatch(const VendorFrameHeader *h, const uint8_t *payload, bool overflow) {
+    if (h->flags & VFRAME_FLAG_IN) {
+        switch (h->request) {
+            case REQ_GET_ALL_PARAMS: {
+                // Streamed straight from bulk_param_buf, which stays claimed
+                // until the last byte is sent (vendor_bulk_fill_in())
+                if (!vbuf_claim(&bulk_param_buf_owner, VBUF_BULK_IN)) {
+                    vendor_bulk_queue(h, VFRAME_STATUS_BUSY, NULL, 0, NULL, 0);
+                    return;
+                }
+                bulk_params_collect((WireBulkParams *)bulk_param_buf);
+                uint16_t len = sizeof(WireBulkParams);
+                if (h->length < len) len = h->length;
+                vendor_bulk_queue(h, VFRAME_STATUS_OK, NULL, 0, bulk_param_buf, len);
+                return;
+            }
+
+            case REQ_GET_TRACE: {
+                if (!vbuf_claim(&bulk_param_buf_owner, VBUF_BULK_IN)) {
+                    vendor_bulk_queue(h, VFRAME_STATUS_BUSY, NULL, 0, NULL, 0);
+                    return;
+                }
+                uint16_t max_len = h->length < WIRE_BULK_BUF_SIZE ? h->length : WIRE_BULK_BUF_SIZE;
+                uint16_t len = trace_drain(bulk_param_buf, max_len);
+                vendor_bulk_queue(h, VFRAME_STATUS_OK, NULL, 0, bulk_param_buf, len);
+                return;
+            }
+
+            case REQ_ENTER_BOOTLOADER:
+                // Reboots from inside the handler — the queued response
+                // could never be sent.  EP0 only.
+                vendor_bulk_queue(h, VFRAME_STATUS_UNSUPPORTED, NULL, 0, NULL, 0);
+                return;
+
+            default: {
+                struct usb_setup_packet __attribute__((aligned(4))) setup = {
+                    .bmRequestType = USB_DIR_IN | USB_REQ_TYPE_TYPE_VENDOR | USB_REQ_TYPE_RECIPIENT_INTERFACE,
+                    .bRequest = h->request,
+                    .wValue = h->value,
+                    .wIndex = VENDOR_INTERFACE_NUMBER,
+                    .wLength = h->length,
+                };
+                static uint8_t capture[VENDOR_BULK_INLINE_MAX];
+                vendor_capture_buf = capture;
+                vendor_capture_len = 0;
+                bool ok = vendor_setup_request_handler(NULL, &setup);
+                vendor_capture_buf = NULL;
+
+                uint16_t len = vendor_capture_len;
+                if (len > h->length) len = h->length;
+                vendor_bulk_queue(h, ok ? VFRAME_STATUS_OK : VFRAME_STATUS_STALL,
+                                  capture, ok ? len : 0, NULL, 0);
+                return;
+            }
+        }
+    }
+
+    uint8_t status = VFRAME_STATUS_OK;
+
+    if (h->request == REQ_SET_ALL_PARAMS) {
+        if (!vendor_bulk_rx_to_param_buf) {
+            status = VFRAME_STATUS_BUSY;
+        } else if (overflow || h->length != sizeof(WireBulkParams)) {
+            status = VFRAME_STATUS_STALL;
+            vbuf_release(&bulk_param_buf_owner, VBUF_BULK_OUT);
+        } else if (vbuf_pass(&bulk_param_buf_owner, VBUF_BULK_OUT, VBUF_MAIN)) {
+            bulk_params_pending = true;
+        }
+        vendor_bulk_rx_to_param_buf = false;
+    } else if (overflow) {
+        status = VFRAME_STATUS_TOO_LONG;
+    } else if (h->length == 0) {
+        status = VFRAME_STATUS_STALL;     // EP0 stalls zero-length SETs too
+    } else {
+        // An EP0 SET may be between its setup and data stages — preserve
+        // the request it latched.
+        uint8_t saved_request = vendor_last_request;
+        uint16_t saved_wValue = vendor_last_wValue;
+        memcpy(vendor_rx_buf, payload, h->length);
+        vendor_last_request = h->request;
+        vendor_last_wValue = h->value;
+        vendor_apply_set(h->length);
+        vendor_last_request = saved_request;
+        vendor_last_wValue = saved_wValue;
+    }
+
+    if (status != VFRAME_STATUS_OK || !(h->flags & VFRAME_FLAG_NO_ACK)) {
+        vendor_bulk_queue(h, status, NULL, 0, NULL, 0);
+    }
+}
+
+static void vendor_bulk_process_out(void) {
+    struct usb_endpoint *ep = &vendor_ep_out;
+    struct usb_buffer *buffer = usb_current_out_packet_buffer(ep);
+
+    while (vendor_bulk_out_held) {
+        // Every frame may need a response slot.  Stop here if none is free;
+        // vendor_bulk_in_packet() resumes once the queue drains.
+        if (vendor_bulk_tx_count >= VENDOR_BULK_TX_DEPTH) return;
+
+        uint16_t used;
+        VendorFrameEvent evt = vframe_parser_feed(&vendor_bulk_parser,
+                                                  buffer->data + vendor_bulk_out_offset,
+                                                  buffer->data_len - vendor_bulk_out_offset,
+                                                  &used);
+        vendor_bulk_out_offset += used;
+
+        if (evt == VFRAME_EVT_HEADER) {
+            const VendorFrameHeader *h = &vendor_bulk_parser.hdr;
+            if (h->request == REQ_SET_ALL_PARAMS && !(h->flags & VFRAME_FLAG_IN) &&
+                vbuf_claim(&bulk_param_buf_owner, VBUF_BULK_OUT)) {
+                vendor_bulk_parser.payload = bulk_param_buf;
+                vendor_bulk_parser.payload_max = WIRE_BULK_BUF_SIZE;
+                vendor_bulk_rx_to_param_buf = true;
+            }
+        } else if (evt == VFRAME_EVT_FRAME) {
+            vendor_bulk_dispatch(&vendor_bulk_parser.hdr, vendor_bulk_parser.payload,
+                                 vendor_bulk_parser.overflow);
+        } else {
+            // Packet fully consumed: hand the buffer back to the controller
+            vendor_bulk_out_held = false;
+            usb_grow_transfer(ep->current_transfer, 1);
+            usb_packet_done(ep);
+        }
+    }
+}
+
+static void vendor_bulk_out_packet(__unused struct usb_endpoint *ep) {
+    vendor_bulk_out_held = true;
+    vendor_bulk_out_offset = 0;
+    vendor_bulk_process_out();
+}
+
+static void vendor_bulk_in_packet(struct usb_endpoint *ep) {
+    if (!vendor_bulk_fill_in(ep)) {
+        vendor_bulk_in_idle = true;     // Completed later by vendor_bulk_queue()
+        return;
+    }
+    if (vendor_bulk_out_held) vendor_bulk_process_out();
+}
+
+// Transfers (re)start on SET_CONFIGURATION and endpoint reset; drop any
+// state tied to the previous transfer.
+static void vendor_bulk_out_init(__unused struct usb_endpoint *ep) {
+    vframe_parser_init(&vendor_bulk_parser, vendor_bulk_rx_payload, sizeof(vendor_bulk_rx_payload));
+    vendor_bulk_rx_to_param_buf = false;
+    vbuf_release(&bulk_param_buf_owner, VBUF_BULK_OUT);
+    vendor_bulk_out_held = false;
+}
+
+static void vendor_bulk_in_init(__unused struct usb_endpoint *ep) {
+    vendor_bulk_tx_head = vendor_bulk_tx_tail = vendor_bulk_tx_count = 0;
+    vendor_bulk_tx_offset = 0;
+    vendor_bulk_tx_zlp = false;
+    vendor_bulk_in_idle = false;
+    vbuf_release(&bulk_param_buf_owner, VBUF_BULK_IN);
+    meter_stream_hz = 0;            // Host must resubscribe after reconfiguration
+}
+
+static const struct usb_transfer_type vendor_bulk_out_transfer_type = {
+    .on_packet = vendor_bulk_out_packet,
+    .on_init = vendor_bulk_out_init,
+    .initial_packet_count = 1,
+};
+
+static const struct usb_transfer_type vendor_bulk_in_transfer_type = {
+    .on_packet = vendor_bulk_in_packet,
+    .on_init = vendor_bulk_in_init,
+    .initial_packet_count = 1,
+};
+
+// ----------------------------------------------------------------------------
+// METER STREAM (pushed telemetry on the vendor bulk IN pipe)
+// ----------------------------------------------------------------------------
+//
+// Replaces REQ_GET_STATUS / REQ_GET_BUFFER_STATS / USB error polling with a
+// single MeterFramePacket pushed at the subscribed rate.  Frames are built in
+// the main loop from values process_audio_packet() already maintains; the
+// only per-packet cost is the peak-hold compare above.
+//
+// Frames are paced by audio blocks (one per 1 ms USB frame) while streaming,
+// and by the wall clock when the host is not sending audio.  A frame is
+// dropped rather than queued if it would eat into the slots reserved for
+// command responses; the event sequence number exposes the gap to the host.
+
+#define METER_TX_RESERVE        4       // Response slots kept free for commands
+
+static uint16_t meter_sequence = 0;
+static uint32_t meter_last_us = 0;
+static uint32_t meter_last_spdif_underruns, meter_last_spdif_overruns;
+static uint32_t meter_last_pdm_underruns, meter_last_pdm_overruns;
+static uint32_t meter_last_usb_ring_overruns, meter_last_usb_errors;
+
+static uint16_t meter_delta(uint32_t now, uint32_t *last) {
+    uint32_t d = now - *last;
+    *last = now;
+    return (d > 0xFFFF) ? 0xFFFF : (uint16_t)d;
+}
+
+void usb_audio_meter_service(void) {
+    extern volatile uint32_t usb_error_count;
+
+    uint8_t hz = meter_stream_hz;
+    uint32_t now = time_us_32();
+    if (!hz) {
+        meter_last_us = now;
+        return;
+    }
+
+    uint32_t period_us = 1000000u / hz;
+    uint16_t blocks_per_frame = 1000u / hz;
+    bool due = sync_started
+        ? (meter_blocks >= blocks_per_frame || (now - meter_last_us) >= 2 * period_us)
+        : ((now - meter_last_us) >= period_us);
+    if (!due) return;
+    meter_last_us = now;
+
+    MeterFramePacket pkt;
+    memset(&pkt, 0, sizeof(pkt));
+    pkt.num_channels = NUM_CHANNELS;
+    pkt.flags = (pdm_enabled ? 0x01 : 0) | (sync_started ? 0x02 : 0);
+    if (global_status.status_flags & STATUS_FLAG_OVERLOAD_WARN) pkt.flags |= 0x04;
+    if (global_status.status_flags & STATUS_FLAG_DEADLINE_MISS) pkt.flags |= 0x08;
+    pkt.blocks = meter_blocks;
+    pkt.clip_flags = global_status.clip_flags;
+    pkt.cpu0_load = global_status.cpu0_load;
+    pkt.cpu1_load = global_status.cpu1_load;
+    for (int i = 0; i < NUM_SPDIF_INSTANCES; i++) {
+        pkt.consumer_fill_pct[i] = (uint8_t)(get_slot_consumer_fill(i) * 100 / SPDIF_CONSUMER_BUFFER_COUNT);
+    }
+    if (pdm_enabled) {
+        pkt.pdm_dma_fill_pct = pdm_get_dma_fill_pct();
+        pkt.pdm_ring_fill_pct = pdm_get_ring_fill_pct();
+    }
+    pkt.spdif_underruns   = meter_delta(spdif_underruns, &meter_last_spdif_underruns);
+    pkt.spdif_overruns    = meter_delta(spdif_overruns, &meter_last_spdif_overruns);
+    pkt.pdm_underruns     = meter_delta(pdm_ring_underruns + pdm_dma_underruns, &meter_last_pdm_underruns);
+    pkt.pdm_overruns      = meter_delta(pdm_ring_overruns + pdm_dma_overruns, &meter_last_pdm_overruns);
+    pkt.usb_ring_overruns = meter_delta(audio_ring.overrun_count, &meter_last_usb_ring_overruns);
+    pkt.usb_errors        = meter_delta(usb_error_count, &meter_last_usb_errors);
+    memcpy(pkt.peaks, meter_peak_hold, sizeof(pkt.peaks));
+
+    memset(meter_peak_hold, 0, sizeof(meter_peak_hold));
+    meter_blocks = 0;
+
+    VendorFrameHeader ev = {
+        .flags   = VFRAME_FLAG_EVENT,
+        .seq     = meter_sequence++,
+        .request = REQ_METER_FRAME,
+    };
+
+    // The TX queue is owned by the USB IRQ
+    uint32_t flags = save_and_disable_interrupts();
+    if (vendor_bulk_tx_count <= VENDOR_BULK_TX_DEPTH - METER_TX_RESERVE) {
+        vendor_bulk_queue(&ev, VFRAME_STATUS_OK, &pkt, sizeof(pkt), NULL, 0);
+    }
+    restore_interrupts(flags);
+}
+
 // ----------------------------------------------------------------------------
 // DEVICE-LEVEL SETUP REQUEST HANDLER (WCID / MS OS descriptors)
 // ----------------------------------------------------------------------------
@@ -3279,11 +4432,11 @@ void usb_sound_card_init(void) {
     reset_buffer_watermarks();
 
     // S/PDIF Setup (this must happen before USB init to claim DMA channels)
-    producer_pool_1 = audio_new_producer_pool(&producer_format, AUDIO_BUFFER_COUNT, 192);
-    producer_pool_2 = audio_new_producer_pool(&producer_format, AUDIO_BUFFER_COUNT, 192);
+    producer_pool_1 = audio_new_producer_pool(&producer_format, AUDIO_BUFFER_COUNT, AUDIO_BUFFER_SAMPLES);
+    producer_pool_2 = audio_new_producer_pool(&producer_format, AUDIO_BUFFER_COUNT, AUDIO_BUFFER_SAMPLES);
 #if PICO_RP2350
-    producer_pool_3 = audio_new_producer_pool(&producer_format, AUDIO_BUFFER_COUNT, 192);
-    producer_pool_4 = audio_new_producer_pool(&producer_format, AUDIO_BUFFER_COUNT, 192);
+    producer_pool_3 = audio_new_producer_pool(&producer_format, AUDIO_BUFFER_COUNT, AUDIO_BUFFER_SAMPLES);
+    producer_pool_4 = audio_new_producer_pool(&producer_format, AUDIO_BUFFER_COUNT, AUDIO_BUFFER_SAMPLES);
 #endif
 
     // Setup S/PDIF instances
@@ -3344,7 +4497,11 @@ void usb_sound_card_init(void) {
     audio_spdif_enable_sync(spdif_all, 2);
 #endif
 
-    // Initialize pico-extras USB device with 3 interfaces: AC, AS, Vendor
+    // Packet ingest DMA: claimed after the S/PDIF instances (fixed channels
+    // 0-3) and before PDM, so it never lands on an I2S channel (8+).
+    usb_audio_ring_init_dma(&audio_ring);
+
+    // Initialize pico-extras USB device: AC, AS, Vendor (+ loopback AS)
 
     // Audio Control interface
     usb_interface_init(&ac_interface, &audio_device_config.ac_interface, NULL, 0, true);
@@ -3362,15 +4519,39 @@ void usb_sound_card_init(void) {
     as_sync_transfer.type = &as_sync_transfer_type;
     usb_set_default_transfer(&ep_op_sync, &as_sync_transfer);
 
-    // Vendor interface (control-only, no endpoints)
-    usb_interface_init(&vendor_interface, &audio_device_config.vendor_interface, NULL, 0, true);
+    // Vendor interface: EP0 commands plus the bulk OUT/IN frame pipe
+    static struct usb_endpoint *const vendor_endpoints[] = {
+        &vendor_ep_out, &vendor_ep_in
+    };
+    usb_interface_init(&vendor_interface, &audio_device_config.vendor_interface, vendor_endpoints, count_of(vendor_endpoints), false);
     vendor_interface.setup_request_handler = vendor_setup_request_handler;
+    vendor_bulk_out_transfer.type = &vendor_bulk_out_transfer_type;
+    usb_set_default_transfer(&vendor_ep_out, &vendor_bulk_out_transfer);
+    vendor_bulk_in_transfer.type = &vendor_bulk_in_transfer_type;
+    usb_set_default_transfer(&vendor_ep_in, &vendor_bulk_in_transfer);
+
+#if ENABLE_LOOPBACK
+    // Loopback capture interface.  Single-buffered: one 512-byte DPRAM
+    // buffer for packets of up to LOOPBACK_PACKET_24
+    static struct usb_endpoint *const lb_endpoints[] = {
+        &ep_lb_in
+    };
+    loopback_init();
+    usb_interface_init(&lb_interface, &audio_device_config.lb_interface, lb_endpoints, count_of(lb_endpoints), false);
+    lb_interface.set_alternate_handler = lb_set_alternate;
+    ep_lb_in.setup_request_handler = _as_setup_request_handler;
+    lb_transfer.type = &lb_transfer_type;
+    usb_set_default_transfer(&ep_lb_in, &lb_transfer);
+#endif
 
     // Initialize USB device
     static struct usb_interface *const boot_device_interfaces[] = {
         &ac_interface,
         &as_op_interface,
         &vendor_interface,
+#if ENABLE_LOOPBACK
+        &lb_interface,
+#endif
     };
     struct usb_device *device = usb_device_init(&boot_device_descriptor, &audio_device_config.descriptor,
         boot_device_interfaces, count_of(boot_device_interfaces),
@@ -3384,6 +4565,20 @@ void usb_sound_card_init(void) {
     audio_set_volume(DEFAULT_VOLUME);
     _audio_reconfigure();
 
+#if ENABLE_FIR
+    fir_bank_init();
+#endif
+#if ENABLE_DYNEQ
+    dyneq_init();
+    multiband_init();
+#endif
+#if ENABLE_LIMITER
+    limiter_init();
+#endif
+#if ENABLE_ASRC
+    rate_lock_init();
+#endif
+
     // Initialize Core 1 EQ worker pointer to shared output buffer
     core1_eq_work.buf_out = buf_out;
 
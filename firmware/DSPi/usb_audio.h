@@ -20,6 +20,11 @@ typedef struct {
 } AudioState;
 
 extern volatile AudioState audio_state;
+
+// Rate the DSP pipeline and outputs run at: the USB rate, or the locked
+// rate while the ASRC runs (rate_lock.h)
+extern volatile uint32_t output_rate;
+
 extern volatile bool bypass_master_eq;
 
 // Per-channel gain and mute (output channels only: L, R, Sub)
@@ -62,9 +67,31 @@ extern volatile uint32_t pending_rate;
 extern volatile bool bulk_params_pending;
 extern volatile bool output_type_switch_in_progress;
 extern uint8_t bulk_param_buf[];
+// Main loop: done with a received SET in bulk_param_buf; EP0 and the bulk
+// pipe may claim the buffer again
+void bulk_params_release(void);
 extern char channel_names[NUM_CHANNELS][PRESET_NAME_LEN];
 void get_default_channel_name(int ch, char *buf);
 
+// Boot timing (filled by core0_init() and the first audio packet)
+extern volatile BootTimingPacket boot_timing;
+
+// Latest configuration cost check (written by the main loop)
+extern volatile ConfigCostPacket config_cost_report;
+
+// COST_GATE_* stages the audio path bypasses (config_cost_gate(), written
+// by the main loop) and the report behind them
+#include "config_cost.h"
+extern volatile uint8_t feature_gate;
+extern volatile FeatureGatePacket feature_gate_report;
+
+// Slot's outputs are packed as silence: an S/PDIF slot while the rate is
+// above SPDIF_RATE_MAX.  gate is the caller's snapshot of feature_gate.
+static inline bool spdif_slot_rate_muted(uint8_t gate, int slot) {
+    extern uint8_t output_types[];
+    return (gate & COST_GATE_SPDIF_RATE) && output_types[slot] == OUTPUT_TYPE_SPDIF;
+}
+
 // Core 1 mode derivation (used by preset load and bulk params)
 Core1Mode derive_core1_mode(void);
 
@@ -77,7 +104,10 @@ void audio_set_volume(int16_t volume);
 
 // USB audio ring buffer — main-loop entry points for decoupled DSP processing
 void usb_audio_drain_ring(void);   // Process all pending USB audio packets
+void usb_audio_run_slot(void);     // Wait for the next packet (up to one frame), then drain
 void usb_audio_flush_ring(void);   // Discard stale ring data + reset gap timestamp
+bool usb_audio_wait_preset_silence(uint32_t timeout_us); // Drain until the preset mute is silent
+void usb_audio_meter_service(void); // Push a meter stream frame when one is due
 
 // Expose serial string buffer for main.c to write unique board ID
 extern char *usb_descriptor_str_serial;
@@ -10,6 +10,14 @@
  * Design follows the PDM ring pattern in pdm_generator.c.  Fixed-slot
  * layout avoids wrap-boundary splits and variable-length allocation.
  *
+ * DMA ingest (usb_audio_ring_init_dma): the ISR programs a DMA copy from
+ * the endpoint's DPRAM buffer into the slot instead of running memcpy, and
+ * publishes the slot immediately.  The consumer waits for the channel to go
+ * idle before reading, which in practice never spins: the copy takes ~1 us
+ * and the main loop is always further behind than that.  The DPRAM buffer
+ * stays valid for the copy because the audio OUT endpoint is double-
+ * buffered — the buffer just handed back is not refilled for another frame.
+ *
  * Memory barriers:
  *   RP2040 (Cortex-M0+): volatile alone is sufficient (in-order single-bus).
  *   RP2350 (Cortex-M33): __dmb() required before publishing index updates
@@ -24,6 +32,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include "hardware/sync.h"   // __dmb()
+#include "hardware/dma.h"
+#include "config.h"            // USB_AUDIO_MAX_PACKET
 
 // Ring geometry.  4 slots = 4ms of jitter absorption at 1 packet/ms.
 // The ring should be nearly empty in steady state; its purpose is
@@ -32,17 +42,22 @@
 #define USB_RING_SLOT_MASK  (USB_RING_SLOTS - 1)
 
 // Maximum payload per slot.  Must accommodate the largest possible USB
-// audio packet: (96kHz/1000 + 1) * 2ch * 3bytes = 582 bytes.
-// The +1 accounts for feedback jitter (host may send 97 samples per frame).
-#define USB_RING_MAX_PKT    582
+// audio packet: (192kHz/1000 + 1) * 2ch * 2bytes = 772 bytes for stereo
+// (the 24-bit alt stops at 96 kHz, 582 bytes), (48kHz/1000 + 1) * 8ch *
+// 2bytes = 784 bytes for the multichannel alt.  The +1 accounts for
+// feedback jitter (host may send 193 samples per frame).
+#define USB_RING_MAX_PKT    USB_AUDIO_MAX_PACKET
+
+// Slot storage rounded up to whole words — DMA ingest copies 32-bit words.
+#define USB_RING_SLOT_BYTES ((USB_RING_MAX_PKT + 3u) & ~3u)
 
 // ---------------------------------------------------------------------------
 // Slot and ring structures
 // ---------------------------------------------------------------------------
 
 typedef struct {
+    uint8_t  data[USB_RING_SLOT_BYTES] __attribute__((aligned(4)));  // Raw USB audio payload
     uint16_t data_len;                  // Actual byte count this packet
-    uint8_t  data[USB_RING_MAX_PKT];   // Raw USB audio payload
 } usb_audio_slot_t;
 
 typedef struct {
@@ -50,8 +65,32 @@ typedef struct {
     volatile uint8_t head;              // Written by USB ISR (producer) only
     volatile uint8_t tail;              // Written by main loop (consumer) only
     volatile uint32_t overrun_count;    // Ring-full drops + oversize drops
+    bool     dma_enabled;               // Producer copies via dma_chan instead of memcpy
+    uint8_t  dma_chan;
 } usb_audio_ring_t;
 
+// ---------------------------------------------------------------------------
+// Setup — called once from usb_sound_card_init(), before the AS interface
+// starts receiving packets
+// ---------------------------------------------------------------------------
+
+// Claim a DMA channel for packet ingest.  Leaves the ring on the memcpy
+// path if no channel is free.  Must run after the fixed-channel S/PDIF
+// instances have claimed theirs and before PDM claims its channel.
+static inline void usb_audio_ring_init_dma(usb_audio_ring_t *ring) {
+    int ch = dma_claim_unused_channel(false);
+    if (ch < 0) return;
+
+    dma_channel_config c = dma_channel_get_default_config(ch);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, true);
+    dma_channel_set_config(ch, &c, false);   // Unpaced memory-to-memory
+
+    ring->dma_chan = (uint8_t)ch;
+    ring->dma_enabled = true;
+}
+
 // ---------------------------------------------------------------------------
 // Producer — called from USB ISR (must be in RAM for flash safety)
 // ---------------------------------------------------------------------------
@@ -81,7 +120,15 @@ static inline bool __not_in_flash_func(usb_audio_ring_push)(
 
     usb_audio_slot_t *slot = &ring->slots[h];
     slot->data_len = len;
-    memcpy(slot->data, data, len);
+    if (ring->dma_enabled && len) {
+        // The previous copy finished long ago (packets are 1 ms apart); the
+        // wait only guards against reprogramming a busy channel.
+        dma_channel_wait_for_finish_blocking(ring->dma_chan);
+        dma_channel_set_write_addr(ring->dma_chan, slot->data, false);
+        dma_channel_transfer_from_buffer_now(ring->dma_chan, data, (len + 3u) >> 2);
+    } else {
+        memcpy(slot->data, data, len);
+    }
 
     // Release barrier: ensure slot data is visible before head advances.
     __dmb();
@@ -103,6 +150,11 @@ static inline usb_audio_slot_t * __not_in_flash_func(usb_audio_ring_peek)(
     if (ring->tail == ring->head)
         return NULL;
 
+    // The newest slot may still be landing; every older slot is complete.
+    if (ring->dma_enabled) {
+        dma_channel_wait_for_finish_blocking(ring->dma_chan);
+    }
+
     // Acquire barrier: ensure we read slot data written before head advanced.
     __dmb();
     return &ring->slots[ring->tail];
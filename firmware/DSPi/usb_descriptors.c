@@ -5,6 +5,18 @@
 
 #include "usb_descriptors.h"
 
+// Periodic bandwidth (usb_descriptors.h).  Every OUT alt declares at most
+// USB_AUDIO_MAX_PACKET, so the largest alt with its feedback endpoint, plus
+// the loopback endpoint while capturing, covers every combination a host can
+// open.
+#if ENABLE_LOOPBACK
+#define PERIODIC_LOOPBACK_NS        FS_ISO_BUS_NS(1, LOOPBACK_PACKET_24)
+#else
+#define PERIODIC_LOOPBACK_NS        0
+#endif
+_Static_assert(FS_ISO_BUS_NS(0, USB_AUDIO_MAX_PACKET) + FS_ISO_BUS_NS(1, 3) + PERIODIC_LOOPBACK_NS
+               <= FS_PERIODIC_BUDGET_NS, "isochronous endpoints exceed the full-speed periodic budget");
+
 // ----------------------------------------------------------------------------
 // STRING DESCRIPTORS
 // ----------------------------------------------------------------------------
@@ -51,14 +63,19 @@ const struct audio_device_config audio_device_config = {
             .bDescriptorSubtype = AUDIO_DSUBTYPE_CSInterface_Header,
             .bcdADC = VERSION_BCD(1, 0, 0),
             .wTotalLength = sizeof(audio_device_config.ac_audio),
+#if ENABLE_LOOPBACK
+            .bInCollection = 2,
+            .bInterfaceNumbers = { ITF_NUM_AUDIO_STREAMING, ITF_NUM_LOOPBACK },
+#else
             .bInCollection = 1,
             .bInterfaceNumbers = ITF_NUM_AUDIO_STREAMING,
+#endif
         },
         .input_terminal = {
             .bLength = sizeof(audio_device_config.ac_audio.input_terminal),
             .bDescriptorType = AUDIO_DTYPE_CSInterface,
             .bDescriptorSubtype = AUDIO_DSUBTYPE_CSInterface_InputTerminal,
-            .bTerminalID = 1,
+            .bTerminalID = AUDIO_TERMINAL_ID_IN,
             .wTerminalType = AUDIO_TERMINAL_STREAMING,
             .bAssocTerminal = 0,
             .bNrChannels = 2,
@@ -70,8 +87,8 @@ const struct audio_device_config audio_device_config = {
             .bLength = sizeof(audio_device_config.ac_audio.feature_unit),
             .bDescriptorType = AUDIO_DTYPE_CSInterface,
             .bDescriptorSubtype = AUDIO_DSUBTYPE_CSInterface_Feature,
-            .bUnitID = 2,
-            .bSourceID = 1,
+            .bUnitID = AUDIO_UNIT_ID_FEATURE,
+            .bSourceID = AUDIO_TERMINAL_ID_IN,
             .bControlSize = 1,
             .bmaControls = {AUDIO_FEATURE_MUTE | AUDIO_FEATURE_VOLUME, 0, 0},
             .iFeature = 0,
@@ -80,12 +97,75 @@ const struct audio_device_config audio_device_config = {
             .bLength = sizeof(audio_device_config.ac_audio.output_terminal),
             .bDescriptorType = AUDIO_DTYPE_CSInterface,
             .bDescriptorSubtype = AUDIO_DSUBTYPE_CSInterface_OutputTerminal,
-            .bTerminalID = 3,
+            .bTerminalID = AUDIO_TERMINAL_ID_OUT,
             .wTerminalType = AUDIO_TERMINAL_OUT_SPEAKER,
             .bAssocTerminal = 0,
-            .bSourceID = 2,
+            .bSourceID = AUDIO_UNIT_ID_FEATURE,
+            .iTerminal = 0,
+        },
+#if ENABLE_MC_INPUT
+        // Multichannel path, linked from alt 3.  Its feature unit drives the
+        // same mute / volume state as the stereo one.
+        .mc_input_terminal = {
+            .bLength = sizeof(audio_device_config.ac_audio.mc_input_terminal),
+            .bDescriptorType = AUDIO_DTYPE_CSInterface,
+            .bDescriptorSubtype = AUDIO_DSUBTYPE_CSInterface_InputTerminal,
+            .bTerminalID = AUDIO_TERMINAL_ID_MC_IN,
+            .wTerminalType = AUDIO_TERMINAL_STREAMING,
+            .bAssocTerminal = 0,
+            .bNrChannels = MC_INPUT_CHANNELS,
+            .wChannelConfig = AUDIO_CHANNEL_LEFT_FRONT | AUDIO_CHANNEL_RIGHT_FRONT |
+                              AUDIO_CHANNEL_CENTER_FRONT | AUDIO_CHANNEL_LOW_FREQ_ENHANCE |
+                              AUDIO_CHANNEL_LEFT_SURROUND | AUDIO_CHANNEL_RIGHT_SURROUND |
+                              AUDIO_CHANNEL_SIDE_LEFT | AUDIO_CHANNEL_SIDE_RIGHT,
+            .iChannelNames = 0,
             .iTerminal = 0,
         },
+        .mc_feature_unit = {
+            .bLength = sizeof(audio_device_config.ac_audio.mc_feature_unit),
+            .bDescriptorType = AUDIO_DTYPE_CSInterface,
+            .bDescriptorSubtype = AUDIO_DSUBTYPE_CSInterface_Feature,
+            .bUnitID = AUDIO_UNIT_ID_MC_FEATURE,
+            .bSourceID = AUDIO_TERMINAL_ID_MC_IN,
+            .bControlSize = 1,
+            .bmaControls = {AUDIO_FEATURE_MUTE | AUDIO_FEATURE_VOLUME},
+            .iFeature = 0,
+        },
+        .mc_output_terminal = {
+            .bLength = sizeof(audio_device_config.ac_audio.mc_output_terminal),
+            .bDescriptorType = AUDIO_DTYPE_CSInterface,
+            .bDescriptorSubtype = AUDIO_DSUBTYPE_CSInterface_OutputTerminal,
+            .bTerminalID = AUDIO_TERMINAL_ID_MC_OUT,
+            .wTerminalType = AUDIO_TERMINAL_OUT_SPEAKER,
+            .bAssocTerminal = 0,
+            .bSourceID = AUDIO_UNIT_ID_MC_FEATURE,
+            .iTerminal = 0,
+        },
+#endif
+#if ENABLE_LOOPBACK
+        .lb_input_terminal = {
+            .bLength = sizeof(audio_device_config.ac_audio.lb_input_terminal),
+            .bDescriptorType = AUDIO_DTYPE_CSInterface,
+            .bDescriptorSubtype = AUDIO_DSUBTYPE_CSInterface_InputTerminal,
+            .bTerminalID = AUDIO_TERMINAL_ID_LB_IN,
+            .wTerminalType = AUDIO_TERMINAL_IN_UNDEFINED,
+            .bAssocTerminal = 0,
+            .bNrChannels = 2,
+            .wChannelConfig = AUDIO_CHANNEL_LEFT_FRONT | AUDIO_CHANNEL_RIGHT_FRONT,
+            .iChannelNames = 0,
+            .iTerminal = 0,
+        },
+        .lb_output_terminal = {
+            .bLength = sizeof(audio_device_config.ac_audio.lb_output_terminal),
+            .bDescriptorType = AUDIO_DTYPE_CSInterface,
+            .bDescriptorSubtype = AUDIO_DSUBTYPE_CSInterface_OutputTerminal,
+            .bTerminalID = AUDIO_TERMINAL_ID_LB_OUT,
+            .wTerminalType = AUDIO_TERMINAL_STREAMING,
+            .bAssocTerminal = 0,
+            .bSourceID = AUDIO_TERMINAL_ID_LB_IN,
+            .iTerminal = 0,
+        },
+#endif
     },
     .as_zero_interface = {
         .bLength            = sizeof(audio_device_config.as_zero_interface),
@@ -114,7 +194,7 @@ const struct audio_device_config audio_device_config = {
             .bLength = sizeof(audio_device_config.as_audio.streaming),
             .bDescriptorType = AUDIO_DTYPE_CSInterface,
             .bDescriptorSubtype = AUDIO_DSUBTYPE_CSInterface_General,
-            .bTerminalLink = 1,
+            .bTerminalLink = AUDIO_TERMINAL_ID_IN,
             .bDelay = 1,
             .wFormatTag = 1, // PCM
         },
@@ -132,7 +212,10 @@ const struct audio_device_config audio_device_config = {
             .freqs = {
                 AUDIO_SAMPLE_FREQ(44100),
                 AUDIO_SAMPLE_FREQ(48000),
+                AUDIO_SAMPLE_FREQ(88200),
                 AUDIO_SAMPLE_FREQ(96000),
+                AUDIO_SAMPLE_FREQ(176400),
+                AUDIO_SAMPLE_FREQ(192000),
             },
         },
     },
@@ -142,7 +225,7 @@ const struct audio_device_config audio_device_config = {
             .bDescriptorType  = DTYPE_Endpoint,
             .bEndpointAddress = AUDIO_OUT_ENDPOINT,
             .bmAttributes     = 5,        // Isochronous, async
-            .wMaxPacketSize   = 582,      // Sized for largest alt (24-bit 96kHz) so DPRAM allocation fits both
+            .wMaxPacketSize   = USB_AUDIO_MAX_PACKET, // The largest alt: DPRAM allocation comes from this descriptor
             .bInterval        = 1,
             .bRefresh         = 0,
             .bSyncAddr        = AUDIO_IN_ENDPOINT,
@@ -183,7 +266,7 @@ const struct audio_device_config audio_device_config = {
             .bLength = sizeof(audio_device_config.as_audio_24.streaming),
             .bDescriptorType = AUDIO_DTYPE_CSInterface,
             .bDescriptorSubtype = AUDIO_DSUBTYPE_CSInterface_General,
-            .bTerminalLink = 1,
+            .bTerminalLink = AUDIO_TERMINAL_ID_IN,
             .bDelay = 1,
             .wFormatTag = 1, // PCM
         },
@@ -198,9 +281,10 @@ const struct audio_device_config audio_device_config = {
                 .bBitResolution = 24,
                 .bSampleFrequencyType = count_of(audio_device_config.as_audio_24.format.freqs),
             },
-            .freqs = {
+            .freqs = {                    // 176.4 / 192 kHz exceed the full-speed iso packet limit
                 AUDIO_SAMPLE_FREQ(44100),
                 AUDIO_SAMPLE_FREQ(48000),
+                AUDIO_SAMPLE_FREQ(88200),
                 AUDIO_SAMPLE_FREQ(96000),
             },
         },
@@ -235,17 +319,232 @@ const struct audio_device_config audio_device_config = {
         .bRefresh         = 2,
         .bSyncAddr        = 0,
     },
+#if ENABLE_MC_INPUT
+    // Alt setting 3: multichannel 16-bit audio
+    .as_op_interface_mc = {
+        .bLength            = sizeof(audio_device_config.as_op_interface_mc),
+        .bDescriptorType    = DTYPE_Interface,
+        .bInterfaceNumber   = ITF_NUM_AUDIO_STREAMING,
+        .bAlternateSetting  = 0x03,
+        .bNumEndpoints      = 0x02,
+        .bInterfaceClass    = AUDIO_CSCP_AudioClass,
+        .bInterfaceSubClass = AUDIO_CSCP_AudioStreamingSubclass,
+        .bInterfaceProtocol = AUDIO_CSCP_ControlProtocol,
+        .iInterface         = 0x00,
+    },
+    .as_audio_mc = {
+        .streaming = {
+            .bLength = sizeof(audio_device_config.as_audio_mc.streaming),
+            .bDescriptorType = AUDIO_DTYPE_CSInterface,
+            .bDescriptorSubtype = AUDIO_DSUBTYPE_CSInterface_General,
+            .bTerminalLink = AUDIO_TERMINAL_ID_MC_IN,
+            .bDelay = 1,
+            .wFormatTag = 1, // PCM
+        },
+        .format = {
+            .core = {
+                .bLength = sizeof(audio_device_config.as_audio_mc.format),
+                .bDescriptorType = AUDIO_DTYPE_CSInterface,
+                .bDescriptorSubtype = AUDIO_DSUBTYPE_CSInterface_FormatType,
+                .bFormatType = 1,
+                .bNrChannels = MC_INPUT_CHANNELS,
+                .bSubFrameSize = 2,
+                .bBitResolution = 16,
+                .bSampleFrequencyType = count_of(audio_device_config.as_audio_mc.format.freqs),
+            },
+            .freqs = {                    // MC_INPUT_RATE_MAX
+                AUDIO_SAMPLE_FREQ(44100),
+                AUDIO_SAMPLE_FREQ(48000),
+            },
+        },
+    },
+    .ep1_mc = {
+        .core = {
+            .bLength          = sizeof(audio_device_config.ep1_mc.core),
+            .bDescriptorType  = DTYPE_Endpoint,
+            .bEndpointAddress = AUDIO_OUT_ENDPOINT,
+            .bmAttributes     = 5,        // Isochronous, async
+            .wMaxPacketSize   = USB_PACKET_MC_16,  // (48kHz/1000 + 1) * 8ch * 2bytes
+            .bInterval        = 1,
+            .bRefresh         = 0,
+            .bSyncAddr        = AUDIO_IN_ENDPOINT,
+        },
+        .audio = {
+            .bLength = sizeof(audio_device_config.ep1_mc.audio),
+            .bDescriptorType = AUDIO_DTYPE_CSEndpoint,
+            .bDescriptorSubtype = AUDIO_DSUBTYPE_CSEndpoint_General,
+            .bmAttributes = 1,            // Sampling frequency control
+            .bLockDelayUnits = 0,
+            .wLockDelay = 0,
+        },
+    },
+    .ep2_mc = {
+        .bLength          = sizeof(audio_device_config.ep2_mc),
+        .bDescriptorType  = 0x05,
+        .bEndpointAddress = AUDIO_IN_ENDPOINT,
+        .bmAttributes     = 0x11,         // Isochronous, feedback
+        .wMaxPacketSize   = 3,
+        .bInterval        = 0x01,
+        .bRefresh         = 2,
+        .bSyncAddr        = 0,
+    },
+#endif
     .vendor_interface = {
         .bLength            = sizeof(audio_device_config.vendor_interface),
         .bDescriptorType    = DTYPE_Interface,
         .bInterfaceNumber   = ITF_NUM_VENDOR,
         .bAlternateSetting  = 0x00,
-        .bNumEndpoints      = 0x00,
+        .bNumEndpoints      = 0x02,
         .bInterfaceClass    = 0xFF,       // Vendor specific
         .bInterfaceSubClass = 0x00,
         .bInterfaceProtocol = 0x00,
         .iInterface         = 0x00,
     },
+    .vendor_ep_out = {
+        .bLength          = sizeof(audio_device_config.vendor_ep_out),
+        .bDescriptorType  = DTYPE_Endpoint,
+        .bEndpointAddress = VENDOR_EP_OUT,
+        .bmAttributes     = 0x02,         // Bulk
+        .wMaxPacketSize   = VENDOR_EP_SIZE,
+        .bInterval        = 0,
+    },
+    .vendor_ep_in = {
+        .bLength          = sizeof(audio_device_config.vendor_ep_in),
+        .bDescriptorType  = DTYPE_Endpoint,
+        .bEndpointAddress = VENDOR_EP_IN,
+        .bmAttributes     = 0x02,         // Bulk
+        .wMaxPacketSize   = VENDOR_EP_SIZE,
+        .bInterval        = 0,
+    },
+#if ENABLE_LOOPBACK
+    // Loopback capture
+    .lb_zero_interface = {
+        .bLength            = sizeof(audio_device_config.lb_zero_interface),
+        .bDescriptorType    = DTYPE_Interface,
+        .bInterfaceNumber   = ITF_NUM_LOOPBACK,
+        .bAlternateSetting  = 0x00,
+        .bNumEndpoints      = 0x00,
+        .bInterfaceClass    = AUDIO_CSCP_AudioClass,
+        .bInterfaceSubClass = AUDIO_CSCP_AudioStreamingSubclass,
+        .bInterfaceProtocol = AUDIO_CSCP_ControlProtocol,
+        .iInterface         = 0x00,
+    },
+    .lb_interface = {
+        .bLength            = sizeof(audio_device_config.lb_interface),
+        .bDescriptorType    = DTYPE_Interface,
+        .bInterfaceNumber   = ITF_NUM_LOOPBACK,
+        .bAlternateSetting  = 0x01,
+        .bNumEndpoints      = 0x01,
+        .bInterfaceClass    = AUDIO_CSCP_AudioClass,
+        .bInterfaceSubClass = AUDIO_CSCP_AudioStreamingSubclass,
+        .bInterfaceProtocol = AUDIO_CSCP_ControlProtocol,
+        .iInterface         = 0x00,
+    },
+    .lb_audio = {
+        .streaming = {
+            .bLength = sizeof(audio_device_config.lb_audio.streaming),
+            .bDescriptorType = AUDIO_DTYPE_CSInterface,
+            .bDescriptorSubtype = AUDIO_DSUBTYPE_CSInterface_General,
+            .bTerminalLink = AUDIO_TERMINAL_ID_LB_OUT,
+            .bDelay = 1,
+            .wFormatTag = 1, // PCM
+        },
+        .format = {
+            .core = {
+                .bLength = sizeof(audio_device_config.lb_audio.format),
+                .bDescriptorType = AUDIO_DTYPE_CSInterface,
+                .bDescriptorSubtype = AUDIO_DSUBTYPE_CSInterface_FormatType,
+                .bFormatType = 1,
+                .bNrChannels = 2,
+                .bSubFrameSize = 2,
+                .bBitResolution = 16,
+                .bSampleFrequencyType = count_of(audio_device_config.lb_audio.format.freqs),
+            },
+            .freqs = {                    // Up to LOOPBACK_RATE_MAX (usb_descriptors.h)
+                AUDIO_SAMPLE_FREQ(44100),
+                AUDIO_SAMPLE_FREQ(48000),
+            },
+        },
+    },
+    .lb_ep = {
+        .core = {
+            .bLength          = sizeof(audio_device_config.lb_ep.core),
+            .bDescriptorType  = DTYPE_Endpoint,
+            .bEndpointAddress = LOOPBACK_ENDPOINT,
+            .bmAttributes     = 5,        // Isochronous, async
+            .wMaxPacketSize   = LOOPBACK_PACKET_24, // The largest alt: DPRAM allocation comes from this descriptor
+            .bInterval        = 1,
+            .bRefresh         = 0,
+            .bSyncAddr        = 0,
+        },
+        .audio = {
+            .bLength = sizeof(audio_device_config.lb_ep.audio),
+            .bDescriptorType = AUDIO_DTYPE_CSEndpoint,
+            .bDescriptorSubtype = AUDIO_DSUBTYPE_CSEndpoint_General,
+            .bmAttributes = 1,            // Sampling frequency control
+            .bLockDelayUnits = 0,
+            .wLockDelay = 0,
+        },
+    },
+    // Alt setting 2: 24-bit
+    .lb_interface_24 = {
+        .bLength            = sizeof(audio_device_config.lb_interface_24),
+        .bDescriptorType    = DTYPE_Interface,
+        .bInterfaceNumber   = ITF_NUM_LOOPBACK,
+        .bAlternateSetting  = 0x02,
+        .bNumEndpoints      = 0x01,
+        .bInterfaceClass    = AUDIO_CSCP_AudioClass,
+        .bInterfaceSubClass = AUDIO_CSCP_AudioStreamingSubclass,
+        .bInterfaceProtocol = AUDIO_CSCP_ControlProtocol,
+        .iInterface         = 0x00,
+    },
+    .lb_audio_24 = {
+        .streaming = {
+            .bLength = sizeof(audio_device_config.lb_audio_24.streaming),
+            .bDescriptorType = AUDIO_DTYPE_CSInterface,
+            .bDescriptorSubtype = AUDIO_DSUBTYPE_CSInterface_General,
+            .bTerminalLink = AUDIO_TERMINAL_ID_LB_OUT,
+            .bDelay = 1,
+            .wFormatTag = 1, // PCM
+        },
+        .format = {
+            .core = {
+                .bLength = sizeof(audio_device_config.lb_audio_24.format),
+                .bDescriptorType = AUDIO_DTYPE_CSInterface,
+                .bDescriptorSubtype = AUDIO_DSUBTYPE_CSInterface_FormatType,
+                .bFormatType = 1,
+                .bNrChannels = 2,
+                .bSubFrameSize = 3,
+                .bBitResolution = 24,
+                .bSampleFrequencyType = count_of(audio_device_config.lb_audio_24.format.freqs),
+            },
+            .freqs = {                    // Up to LOOPBACK_RATE_MAX (usb_descriptors.h)
+                AUDIO_SAMPLE_FREQ(44100),
+                AUDIO_SAMPLE_FREQ(48000),
+            },
+        },
+    },
+    .lb_ep_24 = {
+        .core = {
+            .bLength          = sizeof(audio_device_config.lb_ep_24.core),
+            .bDescriptorType  = DTYPE_Endpoint,
+            .bEndpointAddress = LOOPBACK_ENDPOINT,
+            .bmAttributes     = 5,        // Isochronous, async
+            .wMaxPacketSize   = LOOPBACK_PACKET_24,
+            .bInterval        = 1,
+            .bRefresh         = 0,
+            .bSyncAddr        = 0,
+        },
+        .audio = {
+            .bLength = sizeof(audio_device_config.lb_ep_24.audio),
+            .bDescriptorType = AUDIO_DTYPE_CSEndpoint,
+            .bDescriptorSubtype = AUDIO_DSUBTYPE_CSEndpoint_General,
+            .bmAttributes = 1,            // Sampling frequency control
+            .bLockDelayUnits = 0,
+            .wLockDelay = 0,
+        },
+    },
+#endif
 };
 
 // ----------------------------------------------------------------------------
@@ -23,6 +23,7 @@
 
 #define AUDIO_OUT_ENDPOINT  0x01U
 #define AUDIO_IN_ENDPOINT   0x82U
+#define LOOPBACK_ENDPOINT   0x84U   // Loopback capture (iso IN)
 
 // ----------------------------------------------------------------------------
 // INTERFACE NUMBERS
@@ -31,7 +32,12 @@
 #define ITF_NUM_AUDIO_CONTROL   0
 #define ITF_NUM_AUDIO_STREAMING 1
 #define ITF_NUM_VENDOR          2
+#if ENABLE_LOOPBACK
+#define ITF_NUM_LOOPBACK        3   // After vendor: its number and the WCID function stay put
+#define ITF_NUM_TOTAL           4
+#else
 #define ITF_NUM_TOTAL           3
+#endif
 
 // ----------------------------------------------------------------------------
 // AUDIO SAMPLE FREQUENCY MACRO (for descriptor byte encoding)
@@ -41,17 +47,90 @@
 #define AUDIO_SAMPLE_FREQ(frq) (uint8_t)(frq), (uint8_t)((frq >> 8)), (uint8_t)((frq >> 16))
 
 // ----------------------------------------------------------------------------
-// CONFIGURATION DESCRIPTOR STRUCT (3 interfaces: AC, AS, Vendor)
+// TERMINAL / UNIT IDS
+// ----------------------------------------------------------------------------
+
+#define AUDIO_TERMINAL_ID_IN        1   // Stereo streaming input
+#define AUDIO_UNIT_ID_FEATURE       2
+#define AUDIO_TERMINAL_ID_OUT       3
+#define AUDIO_TERMINAL_ID_MC_IN     4   // Multichannel streaming input (alt 3)
+#define AUDIO_UNIT_ID_MC_FEATURE    5
+#define AUDIO_TERMINAL_ID_MC_OUT    6
+#define AUDIO_TERMINAL_ID_LB_IN     7   // Processed outputs tapped for loopback
+#define AUDIO_TERMINAL_ID_LB_OUT    8   // Loopback streaming output
+
+// Full-speed periodic budget.  Hosts admit isochronous endpoints while the
+// wMaxPacketSize reservations of everything open stay within 90% of the
+// frame, 900 µs.  Per-packet bus time as Linux accounts it
+// (usb_calc_bus_time(): worst-case bit stuffing plus token and host delay).
+// usb_descriptors.c checks every combination the device can be asked for.
+#define FS_PERIODIC_BUDGET_NS       900000
+#define FS_ISO_BUS_NS(is_in, bytes) \
+    (((is_in) ? 7268 : 6265) + 1000 + 8354 * (31 + 10 * (7 * 8 * (bytes) / 6)) / 1000)
+
+// Loopback endpoint sizes.  Capture runs next to a streaming OUT alt, so
+// both must fit the budget together.  The largest OUT alt
+// (USB_AUDIO_MAX_PACKET, 784) and its feedback endpoint take 630 µs; a
+// 294-byte loopback packet adds 238 µs (867 µs total), while a 96 kHz
+// 16-bit one (388 bytes) would need 941 µs.  Loopback therefore stops at
+// 48 kHz.
+#define LOOPBACK_RATE_MAX           48000
+#define LOOPBACK_PACKET_16          ((LOOPBACK_RATE_MAX / 1000 + 1) * 2 * 2)   // 196
+#define LOOPBACK_PACKET_24          ((LOOPBACK_RATE_MAX / 1000 + 1) * 2 * 3)   // 294
+
+#if ENABLE_LOOPBACK
+// AC header listing both streaming interfaces (LUFA's struct holds one)
+typedef struct __packed {
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+    uint8_t bDescriptorSubtype;
+    uint16_t bcdADC;
+    uint16_t wTotalLength;
+    uint8_t bInCollection;
+    uint8_t bInterfaceNumbers[2];
+} audio_ac_header_2_t;
+#endif
+
+#if ENABLE_MC_INPUT
+// Feature unit for the multichannel path: master + one control byte per
+// channel (LUFA's struct is sized for stereo)
+typedef struct __packed {
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+    uint8_t bDescriptorSubtype;
+    uint8_t bUnitID;
+    uint8_t bSourceID;
+    uint8_t bControlSize;
+    uint8_t bmaControls[MC_INPUT_CHANNELS + 1];
+    uint8_t iFeature;
+} audio_feature_unit_mc_t;
+#endif
+
+// ----------------------------------------------------------------------------
+// CONFIGURATION DESCRIPTOR STRUCT (AC, AS, Vendor + bulk pair, loopback AS)
 // ----------------------------------------------------------------------------
 
 struct audio_device_config {
     struct usb_configuration_descriptor descriptor;
     struct usb_interface_descriptor ac_interface;
     struct __packed {
+#if ENABLE_LOOPBACK
+        audio_ac_header_2_t core;
+#else
         USB_Audio_StdDescriptor_Interface_AC_t core;
+#endif
         USB_Audio_StdDescriptor_InputTerminal_t input_terminal;
         USB_Audio_StdDescriptor_FeatureUnit_t feature_unit;
         USB_Audio_StdDescriptor_OutputTerminal_t output_terminal;
+#if ENABLE_MC_INPUT
+        USB_Audio_StdDescriptor_InputTerminal_t mc_input_terminal;
+        audio_feature_unit_mc_t mc_feature_unit;
+        USB_Audio_StdDescriptor_OutputTerminal_t mc_output_terminal;
+#endif
+#if ENABLE_LOOPBACK
+        USB_Audio_StdDescriptor_InputTerminal_t lb_input_terminal;
+        USB_Audio_StdDescriptor_OutputTerminal_t lb_output_terminal;
+#endif
     } ac_audio;
     struct usb_interface_descriptor as_zero_interface;
     struct usb_interface_descriptor as_op_interface;
@@ -59,7 +138,7 @@ struct audio_device_config {
         USB_Audio_StdDescriptor_Interface_AS_t streaming;
         struct __packed {
             USB_Audio_StdDescriptor_Format_t core;
-            USB_Audio_SampleFreq_t freqs[3];
+            USB_Audio_SampleFreq_t freqs[6];
         } format;
     } as_audio;
     struct __packed {
@@ -74,7 +153,7 @@ struct audio_device_config {
         USB_Audio_StdDescriptor_Interface_AS_t streaming;
         struct __packed {
             USB_Audio_StdDescriptor_Format_t core;
-            USB_Audio_SampleFreq_t freqs[3];
+            USB_Audio_SampleFreq_t freqs[4];
         } format;
     } as_audio_24;
     struct __packed {
@@ -83,9 +162,64 @@ struct audio_device_config {
     } ep1_24;
     struct usb_endpoint_descriptor_long ep2_24;
 
+#if ENABLE_MC_INPUT
+    // Alt setting 3: multichannel 16-bit audio
+    struct usb_interface_descriptor as_op_interface_mc;
+    struct __packed {
+        USB_Audio_StdDescriptor_Interface_AS_t streaming;
+        struct __packed {
+            USB_Audio_StdDescriptor_Format_t core;
+            USB_Audio_SampleFreq_t freqs[2];
+        } format;
+    } as_audio_mc;
+    struct __packed {
+        struct usb_endpoint_descriptor_long core;
+        USB_Audio_StdDescriptor_StreamEndpoint_Spc_t audio;
+    } ep1_mc;
+    struct usb_endpoint_descriptor_long ep2_mc;
+#endif
+
     struct usb_interface_descriptor vendor_interface;
+    struct usb_endpoint_descriptor vendor_ep_out;
+    struct usb_endpoint_descriptor vendor_ep_in;
+
+#if ENABLE_LOOPBACK
+    // Loopback capture: alt 0 idle, alt 1 16-bit, alt 2 24-bit
+    struct usb_interface_descriptor lb_zero_interface;
+    struct usb_interface_descriptor lb_interface;
+    struct __packed {
+        USB_Audio_StdDescriptor_Interface_AS_t streaming;
+        struct __packed {
+            USB_Audio_StdDescriptor_Format_t core;
+            USB_Audio_SampleFreq_t freqs[2];
+        } format;
+    } lb_audio;
+    struct __packed {
+        struct usb_endpoint_descriptor_long core;
+        USB_Audio_StdDescriptor_StreamEndpoint_Spc_t audio;
+    } lb_ep;
+    struct usb_interface_descriptor lb_interface_24;
+    struct __packed {
+        USB_Audio_StdDescriptor_Interface_AS_t streaming;
+        struct __packed {
+            USB_Audio_StdDescriptor_Format_t core;
+            USB_Audio_SampleFreq_t freqs[2];
+        } format;
+    } lb_audio_24;
+    struct __packed {
+        struct usb_endpoint_descriptor_long core;
+        USB_Audio_StdDescriptor_StreamEndpoint_Spc_t audio;
+    } lb_ep_24;
+#endif
 };
 
+// pico-extras copies the whole configuration descriptor (wTotalLength) into
+// its PICO_USBDEV_MAX_DESCRIPTOR_SIZE buffer; the copy is unchecked in
+// release builds.  The multichannel alt alone took it to 310 bytes; with
+// the loopback interface it is 341 bytes on RP2040 and 433 on RP2350.
+_Static_assert(sizeof(struct audio_device_config) <= PICO_USBDEV_MAX_DESCRIPTOR_SIZE,
+               "configuration descriptor exceeds PICO_USBDEV_MAX_DESCRIPTOR_SIZE (CMakeLists.txt)");
+
 // ----------------------------------------------------------------------------
 // DESCRIPTOR INSTANCES
 // ----------------------------------------------------------------------------
@@ -15,6 +15,7 @@ void fb_ctrl_init(usb_feedback_ctrl_t *ctrl) {
     ctrl->rate_estimate_q16     = 0;
     ctrl->nominal_rate_q16      = 0;
     ctrl->fill_error_filtered   = 0;
+    ctrl->fill_target           = FB_FILL_TARGET;
     ctrl->feedback_out_q16      = 0;
     ctrl->holdoff_remaining     = 0;
     ctrl->rate_valid            = false;
@@ -36,6 +37,10 @@ void fb_ctrl_reset(usb_feedback_ctrl_t *ctrl, uint32_t nominal_rate_q16) {
     ctrl->sof_count             = 0;
 }
 
+void fb_ctrl_set_fill_target(usb_feedback_ctrl_t *ctrl, uint8_t target) {
+    ctrl->fill_target           = target;
+}
+
 void fb_ctrl_stream_stop(usb_feedback_ctrl_t *ctrl) {
     ctrl->stream_active         = false;
     ctrl->rate_valid            = false;
@@ -96,7 +101,7 @@ void fb_ctrl_sof_update(usb_feedback_ctrl_t *ctrl,
     } else {
         // Fill error in Q16.16 buffer-counts for smooth IIR filtering.
         // Positive error = overfull, negative = underfull.
-        int32_t fill_error_q16 = ((int32_t)consumer_fill - FB_FILL_TARGET) << 16;
+        int32_t fill_error_q16 = ((int32_t)consumer_fill - (int32_t)ctrl->fill_target) << 16;
 
         // IIR filter: same α=1/16 as rate path
         int32_t fe_delta = fill_error_q16 - ctrl->fill_error_filtered;
@@ -138,3 +143,35 @@ uint32_t fb_ctrl_get_10_14(const usb_feedback_ctrl_t *ctrl) {
     // Rounded shift: (q16 + 2) >> 2
     return (q16 + 2) >> 2;
 }
+
+// ---------------------------------------------------------------------------
+// Capture pacer (called every IN packet from USB IRQ)
+// ---------------------------------------------------------------------------
+
+void fb_pace_reset(usb_capture_pacer_t *pace, uint32_t fill_target) {
+    pace->frac_q16              = 0;
+    pace->fill_error_filtered   = 0;
+    pace->fill_target           = fill_target;
+}
+
+uint32_t fb_pace_packet(usb_capture_pacer_t *pace, uint32_t rate_q16, uint32_t fill) {
+    // Loop B, turned around: overfull → positive correction → send more
+    int32_t fill_error_q16 = ((int32_t)fill - (int32_t)pace->fill_target) << 16;
+    int32_t fe_delta = fill_error_q16 - pace->fill_error_filtered;
+    pace->fill_error_filtered += round_div_pow2_s32(fe_delta, FB_IIR_SHIFT);
+
+    int32_t servo = (int32_t)((int64_t)FB_PACE_KP_Q16 * pace->fill_error_filtered >> 16);
+    if (servo > FB_SERVO_CLAMP_Q16)
+        servo = FB_SERVO_CLAMP_Q16;
+    if (servo < -FB_SERVO_CLAMP_Q16)
+        servo = -FB_SERVO_CLAMP_Q16;
+
+    int32_t step = (int32_t)rate_q16 + servo;
+    if (step < 0)
+        step = 0;
+
+    pace->frac_q16 += (uint32_t)step;
+    uint32_t n = pace->frac_q16 >> 16;
+    pace->frac_q16 &= 0xFFFFu;
+    return n;
+}
@@ -4,6 +4,11 @@
  * Pure module with no Pico SDK dependencies.
  * Loop A: rounded IIR rate estimator (α=1/16, Q16.16).
  * Loop B: proportional fill-level servo using direct consumer fill measurement.
+ *
+ * Capture pacer: the same two loops turned around for a device → host
+ * stream.  Loop A's estimate sets the samples per packet and a Loop B
+ * servo on the capture ring's fill trims it, so the stream follows the
+ * output clock the way the feedback value does.
  */
 
 #ifndef USB_FEEDBACK_CONTROLLER_H
@@ -29,7 +34,9 @@ static inline int32_t round_div_pow2_s32(int32_t x, uint32_t n) {
 // Constants
 // ---------------------------------------------------------------------------
 
-// Fill servo: direct consumer buffer fill (0-16 buffers)
+// Fill servo: direct consumer buffer fill (0-16 buffers).  The set point is
+// per-controller (fill_target) so latency profiles can move it at runtime;
+// this is the power-on default.
 #define FB_FILL_TARGET             8       // 50% of 16 consumer buffers
 #define FB_FILL_KP_Q16             4096    // old Kp=1024 in 10.14 → 1024<<2 in Q16.16
 
@@ -45,6 +52,10 @@ static inline int32_t round_div_pow2_s32(int32_t x, uint32_t n) {
 // Holdoff: number of valid 4ms updates required before servo is armed
 #define FB_HOLDOFF_UPDATES         2
 
+// Capture pacer servo: 1/64 sample/packet per ring frame of fill error,
+// clamped to FB_SERVO_CLAMP_Q16
+#define FB_PACE_KP_Q16             1024
+
 // ---------------------------------------------------------------------------
 // Controller state
 // ---------------------------------------------------------------------------
@@ -56,6 +67,7 @@ typedef struct {
 
     // Fill servo (Loop B) — direct measurement
     int32_t  fill_error_filtered;   // IIR-filtered fill error (in buffer counts, Q16.16)
+    uint8_t  fill_target;           // Consumer buffers the servo holds (latency set point)
 
     // Output
     uint32_t feedback_out_q16;      // Final feedback value (Q16.16)
@@ -71,6 +83,13 @@ typedef struct {
     uint32_t last_total_words;      // Previous DMA word total for delta
 } usb_feedback_ctrl_t;
 
+// Capture pacer state
+typedef struct {
+    uint32_t frac_q16;              // Sample fraction carried to the next packet
+    int32_t  fill_error_filtered;   // IIR-filtered ring fill error (frames, Q16.16)
+    uint32_t fill_target;           // Ring frames the servo holds
+} usb_capture_pacer_t;
+
 // ---------------------------------------------------------------------------
 // API
 // ---------------------------------------------------------------------------
@@ -81,6 +100,11 @@ void fb_ctrl_init(usb_feedback_ctrl_t *ctrl);
 // Reset controller state and reseed at nominal rate.
 void fb_ctrl_reset(usb_feedback_ctrl_t *ctrl, uint32_t nominal_rate_q16);
 
+// Move the fill servo set point.  Takes effect on the next update; the servo
+// walks the fill to the new target within its ±0.5 sample/frame clamp, so no
+// stream reset is needed.  Survives fb_ctrl_reset().
+void fb_ctrl_set_fill_target(usb_feedback_ctrl_t *ctrl, uint8_t target);
+
 // Mark stream as deactivated (alt setting 0).
 void fb_ctrl_stream_stop(usb_feedback_ctrl_t *ctrl);
 
@@ -97,4 +121,11 @@ void fb_ctrl_sof_update(usb_feedback_ctrl_t *ctrl,
 // Returns 0 if the controller has never been reset (caller should use nominal).
 uint32_t fb_ctrl_get_10_14(const usb_feedback_ctrl_t *ctrl);
 
+// Reset the pacer: no carried fraction, servo at rest.
+void fb_pace_reset(usb_capture_pacer_t *pace, uint32_t fill_target);
+
+// Samples to send in the next 1 ms packet.  rate_q16: Loop A estimate of
+// output samples per host frame; fill: ring frames queued now.
+uint32_t fb_pace_packet(usb_capture_pacer_t *pace, uint32_t rate_q16, uint32_t fill);
+
 #endif // USB_FEEDBACK_CONTROLLER_H
@@ -0,0 +1,153 @@
+/*
+ * vendor_frame.c — Framed command protocol for the vendor bulk endpoints
+ *
+ * Byte-stream parser and header codec.  No SDK dependencies: the firmware
+ * feeds it from the bulk OUT packet handler, and a host build can feed it
+ * from a loopback buffer.
+ */
+
+#include <string.h>
+#include "vendor_frame.h"
+
+enum {
+    PARSE_HEADER = 0,
+    PARSE_PAYLOAD,
+};
+
+static uint16_t header_check(const uint8_t *b) {
+    uint32_t sum = 0;
+    for (int i = 0; i < VFRAME_HEADER_SIZE - 2; i += 2) {
+        sum += (uint32_t)b[i] | ((uint32_t)b[i + 1] << 8);
+    }
+    while (sum >> 16) sum = (sum & 0xFFFF) + (sum >> 16);
+    return (uint16_t)~sum;
+}
+
+uint16_t vframe_encode_header(uint8_t *out, const VendorFrameHeader *h) {
+    out[0] = VFRAME_MAGIC;
+    out[1] = h->flags;
+    out[2] = h->seq & 0xFF;
+    out[3] = h->seq >> 8;
+    out[4] = h->request;
+    out[5] = h->status;
+    out[6] = h->value & 0xFF;
+    out[7] = h->value >> 8;
+    out[8] = h->length & 0xFF;
+    out[9] = h->length >> 8;
+    uint16_t check = header_check(out);
+    out[10] = check & 0xFF;
+    out[11] = check >> 8;
+    return VFRAME_HEADER_SIZE;
+}
+
+bool vframe_decode_header(const uint8_t *in, VendorFrameHeader *h) {
+    if (in[0] != VFRAME_MAGIC) return false;
+    uint16_t check = (uint16_t)in[10] | ((uint16_t)in[11] << 8);
+    if (check != header_check(in)) return false;
+
+    h->flags   = in[1];
+    h->seq     = (uint16_t)in[2] | ((uint16_t)in[3] << 8);
+    h->request = in[4];
+    h->status  = in[5];
+    h->value   = (uint16_t)in[6] | ((uint16_t)in[7] << 8);
+    h->length  = (uint16_t)in[8] | ((uint16_t)in[9] << 8);
+    return true;
+}
+
+void vframe_parser_init(VendorFrameParser *p, uint8_t *payload_buf, uint16_t payload_max) {
+    memset(p, 0, sizeof(*p));
+    p->default_payload = payload_buf;
+    p->default_payload_max = payload_max;
+    p->payload = payload_buf;
+    p->payload_max = payload_max;
+    p->state = PARSE_HEADER;
+}
+
+// GET commands carry no payload: their length field is the response limit
+static uint16_t payload_bytes(const VendorFrameHeader *h) {
+    return (h->flags & VFRAME_FLAG_IN) ? 0 : h->length;
+}
+
+VendorFrameEvent vframe_parser_feed(VendorFrameParser *p, const uint8_t *data,
+                                    uint16_t len, uint16_t *consumed) {
+    uint16_t i = 0;
+
+    while (i < len) {
+        if (p->state == PARSE_HEADER) {
+            // Hunt for the magic byte at the start of a header
+            if (p->pos == 0 && data[i] != VFRAME_MAGIC) {
+                p->resync_bytes++;
+                i++;
+                continue;
+            }
+            p->raw[p->pos++] = data[i++];
+            if (p->pos < VFRAME_HEADER_SIZE) continue;
+
+            if (!vframe_decode_header(p->raw, &p->hdr)) {
+                // Bad header: drop the leading byte and rescan the rest for
+                // another magic.  Header is tiny, so the memmove is cheap.
+                p->resync_bytes++;
+                uint16_t keep = VFRAME_HEADER_SIZE - 1;
+                memmove(p->raw, p->raw + 1, keep);
+                p->pos = 0;
+                for (uint16_t k = 0; k < keep; k++) {
+                    if (p->raw[k] == VFRAME_MAGIC) {
+                        memmove(p->raw, p->raw + k, keep - k);
+                        p->pos = keep - k;
+                        break;
+                    }
+                    p->resync_bytes++;
+                }
+                continue;
+            }
+
+            p->payload = p->default_payload;
+            p->payload_max = p->default_payload_max;
+            p->overflow = false;
+            p->pos = 0;
+            p->state = PARSE_PAYLOAD;
+            *consumed = i;
+            return VFRAME_EVT_HEADER;
+        }
+
+        // PARSE_PAYLOAD
+        uint16_t want = payload_bytes(&p->hdr);
+        if (p->pos >= want) break;
+        uint16_t n = want - p->pos;
+        if (n > len - i) n = len - i;
+
+        if (want > p->payload_max) {
+            p->overflow = true;     // Discard, but stay in sync with the stream
+        } else {
+            memcpy(p->payload + p->pos, data + i, n);
+        }
+        p->pos += n;
+        i += n;
+    }
+
+    if (p->state == PARSE_PAYLOAD && p->pos >= payload_bytes(&p->hdr)) {
+        p->state = PARSE_HEADER;
+        p->pos = 0;
+        *consumed = i;
+        return VFRAME_EVT_FRAME;
+    }
+
+    *consumed = i;
+    return VFRAME_EVT_NONE;
+}
+
+bool vbuf_claim(volatile uint8_t *owner, uint8_t who) {
+    if (*owner != VBUF_FREE) return false;
+    *owner = who;
+    return true;
+}
+
+bool vbuf_pass(volatile uint8_t *owner, uint8_t from, uint8_t to) {
+    if (*owner != from) return false;
+    *owner = to;
+    return true;
+}
+
+void vbuf_release(volatile uint8_t *owner, uint8_t who) {
+    if (*owner == who) *owner = VBUF_FREE;
+}
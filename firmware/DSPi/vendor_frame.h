@@ -0,0 +1,124 @@
+/*
+ * vendor_frame.h — Framed command protocol for the vendor bulk endpoints
+ *
+ * The vendor interface exposes a bulk OUT/IN pair alongside EP0.  Both pipes
+ * carry a byte stream of frames; a frame may span several USB packets and a
+ * USB packet may carry several frames.  Commands reuse the EP0 REQ_* codes
+ * and wValue encodings, so every existing vendor command is reachable over
+ * either transport.
+ *
+ * Frame layout (little-endian):
+ *   [0]     magic     VFRAME_MAGIC
+ *   [1]     flags     VFRAME_FLAG_*
+ *   [2-3]   seq       Host-chosen tag, echoed unchanged in the response
+ *   [4]     request   REQ_* code
+ *   [5]     status    Response: VFRAME_STATUS_*.  Command: 0
+ *   [6-7]   value     wValue equivalent
+ *   [8-9]   length    Payload bytes that follow the header.  For GET
+ *                     commands (VFRAME_FLAG_IN, no payload) this is the
+ *                     maximum response length, like wLength.
+ *   [10-11] check     Ones' complement of the 16-bit sum of bytes 0-9
+ *
+ * Responses are sent in command order.  The host may keep any number of
+ * commands in flight; the device applies back-pressure by NAKing the OUT
+ * pipe while its response queue is full.
+ *
+ * This file and vendor_frame.c are plain C with no SDK dependencies so the
+ * parser can be built and exercised on a host.
+ */
+
+#ifndef VENDOR_FRAME_H
+#define VENDOR_FRAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define VFRAME_MAGIC            0xD5
+#define VFRAME_HEADER_SIZE      12
+
+// Flags
+#define VFRAME_FLAG_IN          0x01    // GET semantics: device returns data
+#define VFRAME_FLAG_NO_ACK      0x02    // SET only: suppress the empty response frame
+#define VFRAME_FLAG_EVENT       0x40    // Unsolicited device->host frame (seq is device-owned)
+#define VFRAME_FLAG_RESPONSE    0x80    // Set on every device->host frame
+
+// Response status codes
+#define VFRAME_STATUS_OK            0x00
+#define VFRAME_STATUS_STALL         0x01    // Handler rejected the request (EP0 would STALL)
+#define VFRAME_STATUS_TOO_LONG      0x02    // Payload exceeded the receive buffer
+#define VFRAME_STATUS_BUSY          0x03    // Shared resource in use, retry later
+#define VFRAME_STATUS_UNSUPPORTED   0x04    // Request not available on the bulk pipe
+
+typedef struct {
+    uint8_t  flags;
+    uint16_t seq;
+    uint8_t  request;
+    uint8_t  status;
+    uint16_t value;
+    uint16_t length;
+} VendorFrameHeader;
+
+// Parser events returned by vframe_parser_feed()
+typedef enum {
+    VFRAME_EVT_NONE = 0,    // All input consumed, frame incomplete
+    VFRAME_EVT_HEADER,      // Header validated; caller may redirect payload storage
+    VFRAME_EVT_FRAME,       // Frame complete; header and payload valid until next feed
+} VendorFrameEvent;
+
+typedef struct {
+    // Payload storage.  Reset to the default buffer at the start of every
+    // frame; may be redirected on VFRAME_EVT_HEADER for oversized payloads.
+    uint8_t  *payload;
+    uint16_t payload_max;
+    uint8_t  *default_payload;
+    uint16_t default_payload_max;
+
+    VendorFrameHeader hdr;
+    bool     overflow;          // Payload did not fit and was discarded
+
+    uint8_t  raw[VFRAME_HEADER_SIZE];
+    uint16_t pos;               // Bytes of header or payload received so far
+    uint8_t  state;
+
+    uint32_t resync_bytes;      // Bytes discarded while hunting for a header
+} VendorFrameParser;
+
+void vframe_parser_init(VendorFrameParser *p, uint8_t *payload_buf, uint16_t payload_max);
+
+// Feed up to len bytes.  Consumes input until an event occurs and stores the
+// number of bytes used in *consumed.  Call again with the remainder.
+VendorFrameEvent vframe_parser_feed(VendorFrameParser *p, const uint8_t *data,
+                                    uint16_t len, uint16_t *consumed);
+
+// Serialize a header (computes the check field).  Returns VFRAME_HEADER_SIZE.
+uint16_t vframe_encode_header(uint8_t *out, const VendorFrameHeader *h);
+
+// Parse and validate a serialized header.  Returns false on bad magic/check.
+bool vframe_decode_header(const uint8_t *in, VendorFrameHeader *h);
+
+// Ownership of a payload buffer shared by several transfers (bulk_param_buf:
+// EP0 data stages, bulk IN responses and bulk OUT SET payloads).  Each path
+// claims the buffer before filling or streaming from it and refuses (EP0
+// STALL, VFRAME_STATUS_BUSY) while another owner holds it.  A completed SET
+// is passed to VBUF_MAIN, and the main loop releases it once applied.
+// Claims and passes run in the USB IRQ; the main loop only releases its own
+// ownership, which no IRQ path can take from it, so no lock is needed.
+enum {
+    VBUF_FREE = 0,
+    VBUF_EP0,           // EP0 GET or SET data stage in flight
+    VBUF_BULK_IN,       // Bulk response streaming from the buffer
+    VBUF_BULK_OUT,      // Bulk SET payload landing in the buffer
+    VBUF_MAIN,          // SET received; main loop has not applied it yet
+};
+
+// Take a free buffer.  Returns false if it is held.
+bool vbuf_claim(volatile uint8_t *owner, uint8_t who);
+
+// Move the buffer from one owner to the next.  Returns false (and changes
+// nothing) if from no longer holds it.
+bool vbuf_pass(volatile uint8_t *owner, uint8_t from, uint8_t to);
+
+// Free the buffer if who holds it; no-op otherwise.
+void vbuf_release(volatile uint8_t *owner, uint8_t who);
+
+#endif // VENDOR_FRAME_H
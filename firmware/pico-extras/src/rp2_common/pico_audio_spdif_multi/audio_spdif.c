@@ -251,7 +251,10 @@ static void update_pio_frequency(audio_spdif_instance_t *inst, uint32_t sample_f
     switch (sample_freq) {
         case 44100: spdif_channel_status[3] = 0x00; break;  // IEC958_AES3_CON_FS_44100
         case 48000: spdif_channel_status[3] = 0x02; break;  // IEC958_AES3_CON_FS_48000
+        case 88200: spdif_channel_status[3] = 0x08; break;  // IEC958_AES3_CON_FS_88200
         case 96000: spdif_channel_status[3] = 0x0A; break;  // IEC958_AES3_CON_FS_96000
+        case 176400: spdif_channel_status[3] = 0x0C; break; // IEC958_AES3_CON_FS_176400
+        case 192000: spdif_channel_status[3] = 0x0E; break; // IEC958_AES3_CON_FS_192000
         default:    spdif_channel_status[3] = 0x01; break;  // not indicated
     }
 }
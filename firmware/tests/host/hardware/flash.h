@@ -0,0 +1,4 @@
+// Host stand-in for the SDK header: the constants flash_writer.c uses
+#pragma once
+#define FLASH_PAGE_SIZE     (1u << 8)
+#define FLASH_SECTOR_SIZE   (1u << 12)
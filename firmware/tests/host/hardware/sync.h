@@ -0,0 +1,6 @@
+// Host stand-in for the SDK header: no interrupts to mask on the host
+#pragma once
+#include <stdint.h>
+static inline void __dmb(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline uint32_t save_and_disable_interrupts(void) { return 0; }
+static inline void restore_interrupts(uint32_t flags) { (void)flags; }
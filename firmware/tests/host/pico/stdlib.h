@@ -0,0 +1,6 @@
+// Host stand-in for the SDK header: what fir_bank.c uses (one core)
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#define __not_in_flash_func(f) f
+static inline unsigned int get_core_num(void) { return 0; }
@@ -0,0 +1,4 @@
+// Host stand-in for the SDK header: the test supplies a simulated clock
+#pragma once
+#include <stdint.h>
+uint64_t time_us_64(void);
@@ -0,0 +1,199 @@
+/*
+ * test_asrc.c — ASRC kernel and control loop on a host
+ *
+ * Runs the rate lock's signal path end to end: a 1 kHz tone at the USB rate
+ * goes through the kernel one host frame at a time, the ratio comes from
+ * the control loop fed with a simulated output clock (offset in ppm plus
+ * SOF timing jitter in DMA words) and consumer fill, the way usb_sof_irq
+ * feeds it.  Reports per rate pair:
+ *
+ *   THD+N   — residual against the ideal tone at each output's exact input
+ *             position (taken from the kernel state), after the loop settles
+ *   jitter  — peak-to-peak of the ratio deviation over the settled part
+ *
+ * and checks the ratio boundary: pairs at ASRC_MAX_RATIO or above are
+ * refused, and a saturated ratio still advances the read position.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "asrc.h"
+
+#define PI_D            3.14159265358979323846
+#define TONE_HZ         1000.0
+#define TONE_AMP        0.5
+#define SIM_FRAMES      60000           // 60 s of host frames
+#define SETTLE_FRAMES   40000           // Loop A: α = 1/8 per ~1 s window
+#define BUFFER_SAMPLES  48              // Consumer buffer (PICO_AUDIO_SPDIF_DMA_SAMPLE_COUNT)
+#define POOL_BUFFERS    16
+
+static AsrcKernel kernel;
+static AsrcState state;
+static asrc_ctrl_t ctrl;
+
+static int failures;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { printf("FAIL: "); printf(__VA_ARGS__); printf("\n"); failures++; } \
+} while (0)
+
+// Deterministic jitter in [-j, j]
+static uint32_t lcg = 12345;
+static int32_t jitter(int32_t j) {
+    if (j == 0) return 0;
+    lcg = lcg * 1664525u + 1013904223u;
+    return (int32_t)(lcg >> 8) % (2 * j + 1) - j;
+}
+
+typedef struct {
+    double thdn_db;
+    int32_t ppm_min, ppm_max;
+    int32_t ppm_expected;
+    uint32_t xruns;
+    bool locked;
+} SimResult;
+
+static SimResult simulate(uint32_t in_rate, uint32_t out_rate, double clock_ppm, int32_t jitter_words) {
+    SimResult res = { .ppm_min = INT32_MAX, .ppm_max = INT32_MIN };
+    asrc_kernel_design(&kernel, in_rate, out_rate);
+    asrc_reset(&state);
+    asrc_ctrl_init(&ctrl);
+    asrc_ctrl_reset(&ctrl, in_rate, out_rate);
+
+    // Input index of hist[0]: the reset history is ASRC_TAPS - 1 zeros
+    int64_t base = -(ASRC_TAPS - 1);
+    uint64_t in_total = 0;
+    double consumed = 0.0;
+    uint64_t produced = (uint64_t)ctrl.fill_target * BUFFER_SAMPLES + BUFFER_SAMPLES / 2;
+    const double out_per_frame = out_rate * (1.0 + clock_ppm * 1e-6) / 1000.0;
+    const double w = 2.0 * PI_D * TONE_HZ / in_rate;
+
+    static float in_l[ASRC_MAX_BLOCK], in_r[ASRC_MAX_BLOCK];
+    static float out_l[ASRC_MAX_BLOCK], out_r[ASRC_MAX_BLOCK];
+    double sig = 0.0, err = 0.0;
+
+    for (uint32_t k = 0; k < SIM_FRAMES; k++) {
+        uint32_t n_in = (uint32_t)((uint64_t)(k + 1) * in_rate / 1000 - (uint64_t)k * in_rate / 1000);
+        for (uint32_t i = 0; i < n_in; i++) {
+            float x = (float)(TONE_AMP * sin(w * (double)(in_total + i)));
+            in_l[i] = x;
+            in_r[i] = -x;
+        }
+
+        uint32_t n_out = asrc_begin_block(&state, n_in, ctrl.ratio_q30);
+        uint64_t at = ((uint64_t)state.pos << 32) | state.frac;
+        uint64_t step = (uint64_t)state.ratio_q30 << 2;
+        uint32_t fill_before = state.fill;
+        asrc_process(&kernel, &state, in_l, in_r, n_in, out_l, out_r, n_out);
+
+        if (k >= SETTLE_FRAMES) {
+            for (uint32_t n = 0; n < n_out; n++) {
+                uint64_t a = at + (uint64_t)n * step;
+                double t = (double)base + (double)(a >> 32) + (ASRC_TAPS / 2 - 1)
+                         + (double)(uint32_t)a / 4294967296.0;
+                if (t < 0) continue;
+                double ref = TONE_AMP * sin(w * t);
+                sig += ref * ref;
+                err += (out_l[n] - ref) * (out_l[n] - ref);
+            }
+        }
+        base += (int64_t)(fill_before + n_in - state.dropped) - state.fill;
+        in_total += n_in;
+
+        // Output side: the device clock drains the consumer pool
+        produced += n_out;
+        consumed += out_per_frame;
+        int64_t backlog = (int64_t)produced - (int64_t)consumed;
+        if (backlog < 0 || backlog > POOL_BUFFERS * BUFFER_SAMPLES) res.xruns++;
+        int64_t buffers = backlog / BUFFER_SAMPLES;
+        if (buffers < 0) buffers = 0;
+        if (buffers > POOL_BUFFERS) buffers = POOL_BUFFERS;
+
+        uint32_t words = (uint32_t)consumed + (uint32_t)jitter(jitter_words);
+        asrc_ctrl_sof_update(&ctrl, words, 14, (uint8_t)buffers);
+
+        if (k >= SETTLE_FRAMES) {
+            int32_t ppm = asrc_ctrl_ratio_ppm(&ctrl);
+            if (ppm < res.ppm_min) res.ppm_min = ppm;
+            if (ppm > res.ppm_max) res.ppm_max = ppm;
+        }
+    }
+
+    CHECK(state.dropped == 0, "%u -> %u: %u input samples dropped", in_rate, out_rate, state.dropped);
+    res.thdn_db = 10.0 * log10(err / sig);
+    res.ppm_expected = (int32_t)lround(-clock_ppm);
+    res.locked = asrc_ctrl_locked(&ctrl);
+    return res;
+}
+
+#define COUNT_OF(a) (sizeof(a) / sizeof((a)[0]))
+
+// Every pair among 44.1 / 48 / 96 / 192 kHz the ratio limit allows
+static void test_pairs(void) {
+    static const uint32_t rates[] = { 44100, 48000, 96000, 192000 };
+    static const double offsets_ppm[] = { -80.0, 150.0 };
+    const int32_t jitter_words = 2;   // ~40 us of SOF IRQ latency at 48 kHz
+
+    printf("%7s %7s %6s %9s %10s %7s\n", "in", "out", "clock", "THD+N dB", "ratio ppm", "p-p");
+    for (size_t i = 0; i < COUNT_OF(rates); i++) {
+        for (size_t o = 0; o < COUNT_OF(rates); o++) {
+            if (i == o || !asrc_ratio_supported(rates[i], rates[o])) continue;
+            for (size_t c = 0; c < COUNT_OF(offsets_ppm); c++) {
+                SimResult r = simulate(rates[i], rates[o], offsets_ppm[c], jitter_words);
+                int32_t mid = (r.ppm_min + r.ppm_max) / 2;
+                printf("%7u %7u %+6.0f %9.1f %10d %7d\n", rates[i], rates[o], offsets_ppm[c],
+                       r.thdn_db, mid, r.ppm_max - r.ppm_min);
+                CHECK(r.thdn_db < -80.0, "%u -> %u: THD+N %.1f dB", rates[i], rates[o], r.thdn_db);
+                CHECK(r.xruns == 0, "%u -> %u: %u consumer xruns", rates[i], rates[o], r.xruns);
+                CHECK(r.locked, "%u -> %u: fill servo not locked", rates[i], rates[o]);
+                CHECK(abs(mid - r.ppm_expected) <= 20, "%u -> %u: ratio %d ppm, clock %d ppm",
+                      rates[i], rates[o], mid, r.ppm_expected);
+                CHECK(r.ppm_max - r.ppm_min <= 20, "%u -> %u: ratio jitter %d ppm p-p",
+                      rates[i], rates[o], r.ppm_max - r.ppm_min);
+            }
+        }
+    }
+}
+
+// Q2.30 holds ratios below 4: pairs at or above it are refused, and a
+// saturated ratio must still move the read position
+static void test_ratio_boundary(void) {
+    CHECK(!asrc_ratio_supported(192000, 48000), "192k -> 48k (4.0) accepted");
+    CHECK(!asrc_ratio_supported(176400, 44100), "176.4k -> 44.1k (4.0) accepted");
+    CHECK(!asrc_ratio_supported(192000, 44100), "192k -> 44.1k (4.35) accepted");
+    CHECK(asrc_ratio_supported(191999, 48000), "just below 4.0 refused");
+    CHECK(asrc_ratio_supported(192000, 88200), "192k -> 88.2k refused");
+    CHECK(asrc_ratio_supported(44100, 192000), "44.1k -> 192k refused");
+    CHECK(!asrc_ratio_supported(48000, 0), "zero output rate accepted");
+
+    asrc_ctrl_init(&ctrl);
+    asrc_ctrl_reset(&ctrl, 192000, 48000);
+    CHECK(ctrl.ratio_q30 == UINT32_MAX, "4.0 ratio did not saturate: 0x%08x", ctrl.ratio_q30);
+
+    asrc_reset(&state);
+    static float l[ASRC_MAX_BLOCK], r[ASRC_MAX_BLOCK];
+    memset(l, 0, sizeof(l));
+    memset(r, 0, sizeof(r));
+    uint32_t total = 0;
+    for (int k = 0; k < 100; k++) {
+        uint32_t n = asrc_begin_block(&state, 192, ctrl.ratio_q30);
+        asrc_process(&kernel, &state, l, r, 192, l, r, n);
+        total += n;
+    }
+    CHECK(total >= 4700 && total <= 4900, "saturated ratio produced %u outputs from 19200 inputs", total);
+    CHECK(state.dropped == 0, "saturated ratio dropped %u inputs", state.dropped);
+    CHECK(asrc_begin_block(&state, 192, 0) == 0, "zero ratio produced output");
+}
+
+int main(void) {
+    test_ratio_boundary();
+    test_pairs();
+    if (failures) {
+        printf("%d failure(s)\n", failures);
+        return 1;
+    }
+    printf("asrc: all passed\n");
+    return 0;
+}
@@ -0,0 +1,131 @@
+/*
+ * test_fir_bank.c — FIR load sequence and error read-back
+ *
+ * Drives fir_bank.c the way the vendor interface does (begin, taps,
+ * commit, with the main loop's fir_bank_service() in between) and checks
+ * what REQ_GET_FIR_STATUS would report:
+ *
+ *   - a full load reaches ACTIVE with every tap received
+ *   - taps before begin, a short tap payload and taps out of order are
+ *     rejected with FIR_ERR_SEQUENCE, not dropped
+ *   - taps sent to a running filter are rejected and the filter keeps
+ *     running
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "fir_bank.h"
+
+#define TAPS            100
+
+static int failures;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { printf("FAIL: "); printf(__VA_ARGS__); printf("\n"); failures++; } \
+} while (0)
+
+// One core on the host: nothing to wait for
+void core1_wait_block(void) {}
+
+static FirStatusPacket status(uint8_t out) {
+    FirStatusPacket pkt;
+    fir_get_status(out, &pkt);
+    return pkt;
+}
+
+static void service(void) {
+    for (int i = 0; i < 64; i++) fir_bank_service(48000);
+}
+
+static void begin(uint8_t out, uint16_t taps) {
+    FirBeginPacket req = { .output = out, .taps = taps };
+    fir_request_begin(&req);
+    service();
+}
+
+// One REQ_SET_FIR_TAPS packet: offset, reserved, then `n` float taps
+static void send_taps(uint8_t out, uint16_t offset, uint16_t n) {
+    uint8_t payload[4 + 4 * FIR_TAPS_PER_PACKET];
+    memset(payload, 0, sizeof(payload));
+    memcpy(payload, &offset, 2);
+    for (uint16_t i = 0; i < n; i++) {
+        float t = (offset + i == 0) ? 1.0f : 0.0f;
+        memcpy(payload + 4 + 4 * i, &t, 4);
+    }
+    fir_request_taps(out, payload, (uint16_t)(4 + 4 * n));
+}
+
+static void load(uint8_t out, uint16_t taps) {
+    begin(out, taps);
+    for (uint16_t off = 0; off < taps; off += FIR_TAPS_PER_PACKET) {
+        uint16_t n = taps - off < FIR_TAPS_PER_PACKET ? taps - off : FIR_TAPS_PER_PACKET;
+        send_taps(out, off, n);
+    }
+    fir_request_commit(out);
+    service();
+}
+
+static void test_load(void) {
+    load(0, TAPS);
+    FirStatusPacket s = status(0);
+    CHECK(s.state == FIR_STATE_ACTIVE, "load: state %u, want ACTIVE", s.state);
+    CHECK(s.error == FIR_ERR_NONE, "load: error %u", s.error);
+    CHECK(s.received == TAPS, "load: received %u of %u", s.received, TAPS);
+    fir_request_clear(0);
+    service();
+    CHECK(status(0).state == FIR_STATE_EMPTY, "clear: state %u", status(0).state);
+}
+
+static void test_taps_before_begin(void) {
+    send_taps(1, 0, FIR_TAPS_PER_PACKET);
+    FirStatusPacket s = status(1);
+    CHECK(s.error == FIR_ERR_SEQUENCE, "taps before begin: error %u", s.error);
+    CHECK(s.state == FIR_STATE_ERROR, "taps before begin: state %u", s.state);
+    CHECK(s.received == 0, "taps before begin: received %u", s.received);
+}
+
+static void test_short_payload(void) {
+    begin(2, TAPS);
+    CHECK(status(2).state == FIR_STATE_LOADING, "begin: state %u", status(2).state);
+    uint8_t payload[7] = { 0 };
+    for (uint16_t len = 0; len < sizeof(payload); len++) {
+        begin(2, TAPS);
+        fir_request_taps(2, payload, len);
+        FirStatusPacket s = status(2);
+        CHECK(s.error == FIR_ERR_SEQUENCE, "%u-byte payload: error %u", len, s.error);
+        CHECK(s.state == FIR_STATE_ERROR, "%u-byte payload: state %u", len, s.state);
+    }
+}
+
+static void test_out_of_order(void) {
+    begin(3, TAPS);
+    send_taps(3, 0, FIR_TAPS_PER_PACKET);
+    send_taps(3, 2 * FIR_TAPS_PER_PACKET, FIR_TAPS_PER_PACKET);
+    FirStatusPacket s = status(3);
+    CHECK(s.error == FIR_ERR_SEQUENCE, "gap: error %u", s.error);
+    CHECK(s.state == FIR_STATE_ERROR, "gap: state %u", s.state);
+}
+
+static void test_taps_while_active(void) {
+    load(4, TAPS);
+    send_taps(4, 0, FIR_TAPS_PER_PACKET);
+    FirStatusPacket s = status(4);
+    CHECK(s.error == FIR_ERR_SEQUENCE, "taps while active: error %u", s.error);
+    CHECK(s.state == FIR_STATE_ACTIVE, "taps while active: state %u, want ACTIVE", s.state);
+    CHECK(fir_active_mask & (1u << 4), "taps while active: filter stopped");
+}
+
+int main(void) {
+    fir_bank_init();
+    test_load();
+    test_taps_before_begin();
+    test_short_payload();
+    test_out_of_order();
+    test_taps_while_active();
+    if (failures) {
+        printf("%d failure(s)\n", failures);
+        return 1;
+    }
+    printf("fir_bank: all passed\n");
+    return 0;
+}
@@ -0,0 +1,192 @@
+/*
+ * test_fir_convolver.c — Partitioned convolver against direct-form convolution
+ *
+ * Loads filters the way fir_bank.c does (stage taps, prepare one partition
+ * at a time, reset) and checks fir_conv_process() against a double
+ * precision direct-form convolution of the same input, delayed by the
+ * engine's FIR_PARTITION samples:
+ *
+ *   - lengths from one tap to the full pool, across partition boundaries
+ *   - calls of 1, 37, 48 (one packet at 48 kHz) and 200 samples
+ *   - an impulse reproduces the taps exactly where they belong
+ *
+ * Then a benchmark: host time per sample for 1..11 partitions, fitted to
+ * fixed + per-partition cost, and the taps one M33 core can run at 48 and
+ * 96 kHz under the RP2350 cost kernels (fir_output / fir_partition) that
+ * the firmware gates configurations with.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "fir_convolver.h"
+#include "config_cost.h"
+#include "config.h"
+
+#define N               FIR_PARTITION
+#define MAX_PARTITIONS  (FIR_POOL_UNITS - 1)
+#define MAX_TAPS        (MAX_PARTITIONS * N)
+#define SIGNAL_LEN      (MAX_TAPS + 4 * N + 333)
+#define CLK_HZ          307200000u  // main.c set_sys_clock_hz()
+#define MAX_ERROR_DB    (-100.0)    // Peak error against the peak output
+
+static float mem[(1 + MAX_PARTITIONS) * FIR_UNIT_FLOATS];
+static float scratch[FIR_SCRATCH_FLOATS];
+static FirConvolver conv;
+
+static float taps[MAX_TAPS];
+static float input[SIGNAL_LEN];
+static float output[SIGNAL_LEN];
+
+static int failures;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { printf("FAIL: "); printf(__VA_ARGS__); printf("\n"); failures++; } \
+} while (0)
+
+// Deterministic noise in [-1, 1)
+static uint32_t lcg = 12345;
+static float noise(void) {
+    lcg = lcg * 1664525u + 1013904223u;
+    return (float)(int32_t)lcg / 2147483648.0f;
+}
+
+// As fir_bank.c: stage, prepare partition by partition, reset
+static void load(const float *h, uint32_t count) {
+    uint16_t partitions = (uint16_t)((count + N - 1) / N);
+    fir_conv_bind(&conv, mem, partitions);
+    fir_conv_clear_staging(&conv);
+    for (uint32_t i = 0; i < count; i++) fir_conv_staging(&conv, (uint16_t)(i / N))[i % N] = h[i];
+    for (uint16_t p = 0; p < partitions; p++) fir_conv_prepare(&conv, p, scratch);
+    fir_conv_reset(&conv);
+}
+
+static void run(uint32_t chunk) {
+    memcpy(output, input, sizeof(output));
+    for (uint32_t i = 0; i < SIGNAL_LEN; i += chunk) {
+        uint32_t n = SIGNAL_LEN - i < chunk ? SIGNAL_LEN - i : chunk;
+        fir_conv_process(&conv, output + i, n, scratch);
+    }
+}
+
+// Peak error against direct form, dB relative to the peak reference output
+static double error_db(uint32_t count) {
+    double peak = 0.0, err = 0.0;
+    for (uint32_t n = 0; n < SIGNAL_LEN; n++) {
+        double ref = 0.0;
+        if (n >= N) {
+            uint32_t m = n - N;
+            uint32_t k_max = m < count - 1 ? m : count - 1;
+            for (uint32_t k = 0; k <= k_max; k++) ref += (double)taps[k] * input[m - k];
+        }
+        if (fabs(ref) > peak) peak = fabs(ref);
+        double e = fabs(output[n] - ref);
+        if (e > err) err = e;
+    }
+    return 20.0 * log10(err / peak + 1e-30);
+}
+
+static void test_direct_form(void) {
+    static const uint32_t lengths[] = { 1, 2, 127, 128, 129, 1000, MAX_TAPS };
+    static const uint32_t chunks[] = { 1, 37, 48, 200 };
+
+    for (uint32_t i = 0; i < SIGNAL_LEN; i++) input[i] = noise();
+    printf("%6s %6s %10s\n", "taps", "chunk", "error dB");
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+        uint32_t count = lengths[l];
+        // Decaying noise, like a measured room response
+        for (uint32_t k = 0; k < count; k++) taps[k] = noise() * expf(-4.0f * (float)k / (float)count);
+        load(taps, count);
+        for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+            fir_conv_reset(&conv);
+            run(chunks[c]);
+            double db = error_db(count);
+            if (c == 0 || count == MAX_TAPS) printf("%6u %6u %10.1f\n", count, chunks[c], db);
+            CHECK(db < MAX_ERROR_DB, "%u taps, %u-sample calls: error %.1f dB", count, chunks[c], db);
+        }
+    }
+}
+
+static void test_impulse(void) {
+    const uint32_t count = 3 * N + 5;
+    for (uint32_t k = 0; k < count; k++) taps[k] = noise();
+    load(taps, count);
+    memset(input, 0, sizeof(input));
+    input[7] = 1.0f;
+    run(48);
+    double err = 0.0;
+    for (uint32_t n = 0; n < SIGNAL_LEN; n++) {
+        double want = (n >= N + 7 && n < N + 7 + count) ? taps[n - N - 7] : 0.0;
+        if (fabs(output[n] - want) > err) err = fabs(output[n] - want);
+    }
+    CHECK(err < 1e-5, "impulse response off by %g", err);
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Host ns per sample with `partitions` partitions, 48-sample calls
+static double host_ns_per_sample(uint16_t partitions) {
+    for (uint32_t k = 0; k < (uint32_t)partitions * N; k++) taps[k] = noise();
+    load(taps, (uint32_t)partitions * N);
+    static float block[48];
+    for (int i = 0; i < 48; i++) block[i] = noise();
+
+    uint64_t samples = 0;
+    double t0 = now_s(), t;
+    do {
+        for (int k = 0; k < 1000; k++) fir_conv_process(&conv, block, 48, scratch);
+        samples += 48000;
+        t = now_s() - t0;
+    } while (t < 0.05);
+    return t * 1e9 / (double)samples;
+}
+
+static void benchmark(void) {
+    static const uint16_t parts[] = { 1, 2, 3, 4, 6, 8, MAX_PARTITIONS };
+    const size_t n = sizeof(parts) / sizeof(parts[0]);
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+
+    printf("\n%10s %6s %14s\n", "partitions", "taps", "host ns/sample");
+    for (size_t i = 0; i < n; i++) {
+        double y = host_ns_per_sample(parts[i]);
+        printf("%10u %6u %14.1f\n", parts[i], parts[i] * N, y);
+        sx += parts[i]; sy += y; sxx += (double)parts[i] * parts[i]; sxy += parts[i] * y;
+    }
+    double per_part = (n * sxy - sx * sy) / (n * sxx - sx * sx);
+    double fixed = (sy - per_part * sx) / n;
+
+    const CostKernels *k = config_cost_kernels(WIRE_PLATFORM_RP2350);
+    printf("host fit: %.1f ns fixed + %.2f ns per partition (ratio %.1f; cost kernels %u + %u cycles, ratio %.1f)\n",
+           fixed, per_part, fixed / per_part, k->fir_output, k->fir_partition,
+           (double)k->fir_output / k->fir_partition);
+
+    // One core with nothing else to do, and the pool's limit
+    printf("\n%7s %14s %16s %12s\n", "rate", "cycles/sample", "taps (one core)", "pool limit");
+    static const uint32_t rates[] = { 48000, 96000 };
+    for (size_t r = 0; r < 2; r++) {
+        uint32_t budget = CLK_HZ / rates[r];
+        uint32_t p = (budget - k->fir_output) / k->fir_partition;
+        printf("%7u %14u %16u %12u\n", rates[r], budget, p * N, MAX_TAPS);
+        CHECK(p >= MAX_PARTITIONS, "%u Hz: one core runs %u partitions, pool holds %u",
+              rates[r], p, MAX_PARTITIONS);
+    }
+}
+
+int main(void) {
+    fir_conv_init();
+    test_impulse();
+    test_direct_form();
+    benchmark();
+    if (failures) {
+        printf("%d failure(s)\n", failures);
+        return 1;
+    }
+    printf("fir_convolver: all passed\n");
+    return 0;
+}
@@ -0,0 +1,261 @@
+/*
+ * test_flash_writer.c — Flash writer scheduling on a host flash emulator
+ *
+ * flash_writer.c runs against an emulated SPI NOR chip (write enable latch,
+ * busy status, sector erase, page program with AND semantics) on a simulated
+ * clock.  Every dspi_flash_do_cmd() is one XIP-off window: its length is a
+ * fixed XIP exit/re-entry cost plus the bytes clocked.  The slot hook stands
+ * in for usb_audio_run_slot() and moves the clock to the next 1 ms audio slot.
+ *
+ * Checks:
+ *   - data lands intact; blank pages cost no command
+ *   - at most one page program per slot, and the XIP-off time per slot and
+ *     per window stays small
+ *   - no command other than a status read ever reaches a busy chip
+ *   - an erase spreads over its ~45 ms as one poll per slot
+ *   - a flash that never goes idle times out, is traced, and frees the writer
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "flash_writer.h"
+#include "event_trace.h"
+#include "hardware/flash.h"
+
+#define FLASH_BYTES         (64 * 1024)
+#define SLOT_US             1000        // One USB frame
+#define XIP_EXIT_US         8           // connect + exit_xip + flush + restore
+#define SPI_NS_PER_BYTE     313         // 25.6 MHz serial clock
+#define PROGRAM_US          450
+#define ERASE_US            45000
+
+// Limits the writer must keep to
+#define MAX_WINDOW_US       100         // Longest single XIP-off window
+#define MAX_XIP_OFF_PER_SLOT_US 150
+
+static int failures;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { printf("FAIL: "); printf(__VA_ARGS__); printf("\n"); failures++; } \
+} while (0)
+
+// ---------------------------------------------------------------------------
+// Simulated clock and flash chip
+// ---------------------------------------------------------------------------
+
+static uint64_t now_ns;
+
+uint64_t time_us_64(void) {
+    return now_ns / 1000;
+}
+
+static struct {
+    uint8_t  mem[FLASH_BYTES];
+    bool     wel;
+    uint64_t busy_until_ns;
+    bool     stuck;             // Never goes idle
+    uint32_t violations;        // Commands sent to a busy chip, or without WEL
+    uint32_t programs, erases, polls;
+} chip;
+
+static struct {
+    uint32_t slots;
+    uint32_t programs_this_slot, max_programs_per_slot;
+    uint32_t polls_this_slot, max_polls_per_slot;
+    uint64_t xip_off_this_slot_ns, max_xip_off_per_slot_ns;
+    uint64_t max_window_ns;
+} sched;
+
+static bool chip_busy(void) {
+    return chip.stuck || now_ns < chip.busy_until_ns;
+}
+
+void dspi_flash_do_cmd(const uint8_t *tx, uint8_t *rx, size_t count) {
+    uint64_t window = XIP_EXIT_US * 1000ull + count * SPI_NS_PER_BYTE;
+    now_ns += window;
+    sched.xip_off_this_slot_ns += window;
+    if (window > sched.max_window_ns) sched.max_window_ns = window;
+
+    memset(rx, 0, count);
+    uint8_t opcode = tx[0];
+    uint32_t addr = count >= 4 ? ((uint32_t)tx[1] << 16 | (uint32_t)tx[2] << 8 | tx[3]) : 0;
+
+    if (opcode == 0x05) {
+        chip.polls++;
+        sched.polls_this_slot++;
+        if (count > 1) rx[1] = (chip_busy() ? 0x01 : 0) | (chip.wel ? 0x02 : 0);
+        return;
+    }
+    if (chip_busy()) {
+        chip.violations++;
+        return;
+    }
+    switch (opcode) {
+        case 0x06:
+            chip.wel = true;
+            break;
+        case 0x20:
+            if (!chip.wel || addr % FLASH_SECTOR_SIZE || addr >= FLASH_BYTES) { chip.violations++; break; }
+            memset(chip.mem + addr, 0xFF, FLASH_SECTOR_SIZE);
+            chip.busy_until_ns = now_ns + ERASE_US * 1000ull;
+            chip.wel = false;
+            chip.erases++;
+            break;
+        case 0x02:
+            if (!chip.wel || addr % FLASH_PAGE_SIZE || count != 4 + FLASH_PAGE_SIZE || addr >= FLASH_BYTES) {
+                chip.violations++;
+                break;
+            }
+            for (size_t i = 0; i < FLASH_PAGE_SIZE; i++) chip.mem[addr + i] &= tx[4 + i];
+            chip.busy_until_ns = now_ns + PROGRAM_US * 1000ull;
+            chip.wel = false;
+            chip.programs++;
+            sched.programs_this_slot++;
+            break;
+        default:
+            chip.violations++;
+            break;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Firmware stand-ins
+// ---------------------------------------------------------------------------
+
+static uint8_t last_trace_type;
+static uint32_t last_trace_arg;
+
+void trace_event(uint8_t type, uint32_t arg) {
+    last_trace_type = type;
+    last_trace_arg = arg;
+}
+
+static void end_slot_stats(void) {
+    if (sched.programs_this_slot > sched.max_programs_per_slot) sched.max_programs_per_slot = sched.programs_this_slot;
+    if (sched.polls_this_slot > sched.max_polls_per_slot) sched.max_polls_per_slot = sched.polls_this_slot;
+    if (sched.xip_off_this_slot_ns > sched.max_xip_off_per_slot_ns) sched.max_xip_off_per_slot_ns = sched.xip_off_this_slot_ns;
+    sched.programs_this_slot = sched.polls_this_slot = 0;
+    sched.xip_off_this_slot_ns = 0;
+}
+
+// usb_audio_run_slot(): the rest of the slot goes to audio
+static void audio_slot(void) {
+    end_slot_stats();
+    now_ns = (now_ns / (SLOT_US * 1000ull) + 1) * SLOT_US * 1000ull;
+    sched.slots++;
+}
+
+static void reset_stats(void) {
+    memset(&sched, 0, sizeof(sched));
+    chip.programs = chip.erases = chip.polls = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+static uint8_t data[FLASH_SECTOR_SIZE];
+
+static void test_erase(void) {
+    memset(chip.mem, 0x00, sizeof(chip.mem));
+    reset_stats();
+    CHECK(flash_writer_erase_sector(FLASH_SECTOR_SIZE) == 0, "erase failed");
+    bool erased = true;
+    for (uint32_t i = 0; i < FLASH_SECTOR_SIZE; i++) erased &= chip.mem[FLASH_SECTOR_SIZE + i] == 0xFF;
+    CHECK(erased, "sector not erased");
+    CHECK(chip.mem[0] == 0x00 && chip.mem[2 * FLASH_SECTOR_SIZE] == 0x00, "erase touched a neighbour");
+    CHECK(sched.slots >= ERASE_US / SLOT_US && sched.slots <= ERASE_US / SLOT_US + 2,
+          "erase took %u slots", sched.slots);
+    CHECK(sched.max_polls_per_slot <= 1, "%u status polls in one slot", sched.max_polls_per_slot);
+    CHECK(last_trace_type == TRACE_EVT_FLASH_ERASE && last_trace_arg == FLASH_SECTOR_SIZE, "erase not traced");
+    printf("erase:   %u slots, %u polls, longest window %.1f us\n",
+           sched.slots, chip.polls, sched.max_window_ns / 1000.0);
+}
+
+static void test_program(void) {
+    for (size_t i = 0; i < sizeof(data); i++) data[i] = (uint8_t)(i * 13 + 1);
+    memset(data + 3 * FLASH_PAGE_SIZE, 0xFF, FLASH_PAGE_SIZE);
+    memset(data + 7 * FLASH_PAGE_SIZE, 0xFF, FLASH_PAGE_SIZE);
+    const uint32_t pages = FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE - 2;
+
+    CHECK(flash_writer_erase_sector(0) == 0, "erase before program failed");
+    reset_stats();
+    CHECK(flash_writer_program(0, data, sizeof(data)) == 0, "program failed");
+    end_slot_stats();
+    CHECK(memcmp(chip.mem, data, sizeof(data)) == 0, "programmed data differs");
+    CHECK(chip.programs == pages, "%u page programs for %u non-blank pages", chip.programs, pages);
+    CHECK(sched.max_programs_per_slot <= 1, "%u page programs in one slot", sched.max_programs_per_slot);
+    CHECK(sched.slots <= pages + 1, "program took %u slots for %u pages", sched.slots, pages);
+    CHECK(sched.max_window_ns <= MAX_WINDOW_US * 1000ull, "XIP-off window %.1f us", sched.max_window_ns / 1000.0);
+    CHECK(sched.max_xip_off_per_slot_ns <= MAX_XIP_OFF_PER_SLOT_US * 1000ull,
+          "XIP off %.1f us in one slot", sched.max_xip_off_per_slot_ns / 1000.0);
+    CHECK(last_trace_type == TRACE_EVT_FLASH_PROGRAM && last_trace_arg == 0, "program not traced");
+    printf("program: %u pages in %u slots, longest window %.1f us, XIP off per slot %.1f us\n",
+           chip.programs, sched.slots, sched.max_window_ns / 1000.0,
+           sched.max_xip_off_per_slot_ns / 1000.0);
+}
+
+// The main loop can also drive the writer itself, one step per pass
+static void test_stepping(void) {
+    memset(data, 0x5A, sizeof(data));
+    CHECK(flash_writer_erase_sector(2 * FLASH_SECTOR_SIZE) == 0, "erase failed");
+    reset_stats();
+    CHECK(flash_writer_start_program(2 * FLASH_SECTOR_SIZE, data, 4 * FLASH_PAGE_SIZE), "start refused");
+    CHECK(flash_writer_busy(), "writer idle after start");
+    CHECK(!flash_writer_start_erase(0), "second operation accepted while busy");
+    int rc, passes = 0;
+    while ((rc = flash_writer_step()) == 1 && passes < 100) {
+        audio_slot();
+        passes++;
+    }
+    CHECK(rc == 0, "stepped program failed");
+    CHECK(passes >= 4 && passes <= 5, "4 pages took %d passes", passes);
+    CHECK(memcmp(chip.mem + 2 * FLASH_SECTOR_SIZE, data, 4 * FLASH_PAGE_SIZE) == 0, "stepped data differs");
+    CHECK(!flash_writer_busy(), "writer busy after finishing");
+}
+
+// Boot: no slot hook, slices back to back
+static void test_back_to_back(void) {
+    flash_writer_set_slot_hook(NULL);
+    memset(data, 0x11, sizeof(data));
+    reset_stats();
+    CHECK(flash_writer_erase_sector(3 * FLASH_SECTOR_SIZE) == 0, "boot erase failed");
+    CHECK(flash_writer_program(3 * FLASH_SECTOR_SIZE, data, sizeof(data)) == 0, "boot program failed");
+    CHECK(memcmp(chip.mem + 3 * FLASH_SECTOR_SIZE, data, sizeof(data)) == 0, "boot data differs");
+    CHECK(sched.slots == 0, "slot hook ran before it was set");
+    flash_writer_set_slot_hook(audio_slot);
+}
+
+static void test_timeout(void) {
+    memset(data, 0x00, FLASH_PAGE_SIZE);
+    chip.stuck = true;
+    reset_stats();
+    CHECK(flash_writer_program(FLASH_PAGE_SIZE, data, FLASH_PAGE_SIZE) == -1, "stuck flash did not time out");
+    CHECK(sched.slots >= 15 && sched.slots <= 17, "program timeout after %u slots", sched.slots);
+    CHECK(last_trace_type == TRACE_EVT_FLASH_TIMEOUT && last_trace_arg == FLASH_PAGE_SIZE, "timeout not traced");
+    CHECK(!flash_writer_busy(), "writer still busy after a timeout");
+    chip.stuck = false;
+    chip.busy_until_ns = 0;
+    chip.violations = 0;    // The stuck chip is not the writer's fault
+    CHECK(flash_writer_erase_sector(0) == 0, "writer unusable after a timeout");
+}
+
+int main(void) {
+    memset(chip.mem, 0xFF, sizeof(chip.mem));
+    flash_writer_set_slot_hook(audio_slot);
+
+    test_erase();
+    test_program();
+    test_stepping();
+    test_back_to_back();
+    CHECK(chip.violations == 0, "%u commands reached a busy chip or lacked write enable", chip.violations);
+    test_timeout();
+
+    if (failures) {
+        printf("%d failure(s)\n", failures);
+        return 1;
+    }
+    printf("flash_writer: all passed\n");
+    return 0;
+}
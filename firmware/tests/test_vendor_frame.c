@@ -0,0 +1,315 @@
+/*
+ * test_vendor_frame.c — Vendor bulk pipe on a host
+ *
+ * Loopback stand-in for the bulk OUT/IN endpoints: frames are encoded into
+ * one byte stream, cut into bulk packets and fed to the parser the way
+ * vendor_bulk_process_out() feeds it.  A small device model mirrors the
+ * bulk_param_buf ownership rules of usb_audio.c (EP0 data stages, bulk IN
+ * responses, bulk OUT SET payloads, main loop apply) so the cross-transport
+ * cases can be run without a USB controller:
+ *
+ *   - header codec and resync after garbage and corrupted headers
+ *   - frames split across packets and packets carrying several frames
+ *   - a bulk SET_ALL_PARAMS while EP0 streams a GET is refused BUSY, and
+ *     its payload is discarded without losing frame sync
+ *   - every transport is refused while the main loop owns a received SET
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vendor_frame.h"
+
+#define PACKET_SIZE     64              // Full-speed bulk max packet
+#define BIG_BUF_SIZE    4096            // WIRE_BULK_BUF_SIZE
+#define BIG_PAYLOAD     2000            // Stands in for sizeof(WireBulkParams)
+#define INLINE_MAX      64              // VENDOR_BULK_INLINE_MAX
+
+// REQ_* codes the model treats specially (values are arbitrary here)
+#define REQ_SET_INLINE  0x10
+#define REQ_GET_INLINE  0x11
+#define REQ_SET_BIG     0x20
+#define REQ_GET_BIG     0x21
+
+static int failures;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { printf("FAIL: "); printf(__VA_ARGS__); printf("\n"); failures++; } \
+} while (0)
+
+// ---------------------------------------------------------------------------
+// Device model
+// ---------------------------------------------------------------------------
+
+static VendorFrameParser parser;
+static uint8_t inline_payload[INLINE_MAX];
+static uint8_t big_buf[BIG_BUF_SIZE];
+static volatile uint8_t big_owner = VBUF_FREE;
+static bool rx_to_big;
+static bool main_pending;
+
+typedef struct {
+    VendorFrameHeader hdr;
+    uint8_t payload[INLINE_MAX];
+    bool big;                   // Response streams from big_buf
+} Response;
+
+static Response responses[64];
+static int n_responses;
+
+static void respond(const VendorFrameHeader *cmd, uint8_t status, bool big) {
+    Response *r = &responses[n_responses++];
+    r->hdr = *cmd;
+    r->hdr.status = status;
+    r->big = big;
+}
+
+static void dispatch(const VendorFrameHeader *h, const uint8_t *payload, bool overflow) {
+    if (h->flags & VFRAME_FLAG_IN) {
+        if (h->request == REQ_GET_BIG) {
+            if (!vbuf_claim(&big_owner, VBUF_BULK_IN)) {
+                respond(h, VFRAME_STATUS_BUSY, false);
+                return;
+            }
+            respond(h, VFRAME_STATUS_OK, true);
+            return;
+        }
+        respond(h, VFRAME_STATUS_OK, false);
+        return;
+    }
+
+    uint8_t status = VFRAME_STATUS_OK;
+    if (h->request == REQ_SET_BIG) {
+        if (!rx_to_big) {
+            status = VFRAME_STATUS_BUSY;
+        } else if (overflow || h->length != BIG_PAYLOAD) {
+            status = VFRAME_STATUS_STALL;
+            vbuf_release(&big_owner, VBUF_BULK_OUT);
+        } else if (vbuf_pass(&big_owner, VBUF_BULK_OUT, VBUF_MAIN)) {
+            main_pending = true;
+        }
+        rx_to_big = false;
+    } else if (overflow) {
+        status = VFRAME_STATUS_TOO_LONG;
+    }
+    if (status == VFRAME_STATUS_OK && h->request == REQ_SET_INLINE) {
+        Response *r = &responses[n_responses];
+        memcpy(r->payload, payload, h->length);
+    }
+    respond(h, status, false);
+}
+
+static void feed_packet(const uint8_t *pkt, uint16_t len) {
+    uint16_t off = 0;
+    for (;;) {
+        uint16_t used;
+        VendorFrameEvent evt = vframe_parser_feed(&parser, pkt + off, len - off, &used);
+        off += used;
+        if (evt == VFRAME_EVT_HEADER) {
+            const VendorFrameHeader *h = &parser.hdr;
+            if (h->request == REQ_SET_BIG && !(h->flags & VFRAME_FLAG_IN) &&
+                vbuf_claim(&big_owner, VBUF_BULK_OUT)) {
+                parser.payload = big_buf;
+                parser.payload_max = BIG_BUF_SIZE;
+                rx_to_big = true;
+            }
+        } else if (evt == VFRAME_EVT_FRAME) {
+            dispatch(&parser.hdr, parser.payload, parser.overflow);
+        } else {
+            return;
+        }
+    }
+}
+
+// Bulk IN drained: responses streamed from big_buf release it
+static void drain_in(void) {
+    for (int i = 0; i < n_responses; i++) {
+        if (responses[i].big) vbuf_release(&big_owner, VBUF_BULK_IN);
+    }
+}
+
+static void device_reset(void) {
+    vframe_parser_init(&parser, inline_payload, sizeof(inline_payload));
+    big_owner = VBUF_FREE;
+    rx_to_big = false;
+    main_pending = false;
+    n_responses = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Host side
+// ---------------------------------------------------------------------------
+
+static uint8_t stream[3 * BIG_BUF_SIZE];
+static uint32_t stream_len;
+
+static void put_frame(uint8_t flags, uint16_t seq, uint8_t request, uint16_t length,
+                      const uint8_t *payload) {
+    VendorFrameHeader h = { .flags = flags, .seq = seq, .request = request, .length = length };
+    stream_len += vframe_encode_header(stream + stream_len, &h);
+    if (payload && !(flags & VFRAME_FLAG_IN)) {
+        memcpy(stream + stream_len, payload, length);
+        stream_len += length;
+    }
+}
+
+// Send the stream as bulk packets: PACKET_SIZE each, or random short
+// packets to move the frame boundaries around
+static void send_stream(bool random_split) {
+    uint32_t off = 0;
+    while (off < stream_len) {
+        uint32_t n = random_split ? 1 + (uint32_t)rand() % PACKET_SIZE : PACKET_SIZE;
+        if (n > stream_len - off) n = stream_len - off;
+        feed_packet(stream + off, (uint16_t)n);
+        off += n;
+    }
+    stream_len = 0;
+}
+
+static const Response *find_response(uint16_t seq) {
+    for (int i = 0; i < n_responses; i++) {
+        if (responses[i].hdr.seq == seq) return &responses[i];
+    }
+    return NULL;
+}
+
+static uint8_t big_payload[BIG_PAYLOAD];
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+static void test_header_codec(void) {
+    VendorFrameHeader in = { .flags = VFRAME_FLAG_IN, .seq = 0xBEEF, .request = 0x42,
+                             .status = 0, .value = 0x1234, .length = 513 };
+    uint8_t raw[VFRAME_HEADER_SIZE];
+    CHECK(vframe_encode_header(raw, &in) == VFRAME_HEADER_SIZE, "header size");
+
+    VendorFrameHeader out;
+    CHECK(vframe_decode_header(raw, &out), "valid header rejected");
+    CHECK(out.seq == in.seq && out.request == in.request && out.value == in.value &&
+          out.length == in.length && out.flags == in.flags, "header fields changed in round trip");
+
+    for (int i = 1; i < VFRAME_HEADER_SIZE; i++) {
+        uint8_t bad[VFRAME_HEADER_SIZE];
+        memcpy(bad, raw, sizeof(bad));
+        bad[i] ^= 0x01;
+        CHECK(!vframe_decode_header(bad, &out), "bit flip in byte %d accepted", i);
+    }
+}
+
+// Mixed traffic with garbage between frames, cut at every packet size
+static void test_stream(bool random_split) {
+    device_reset();
+    static const uint8_t garbage[] = { 0x00, 0xD5, 0x13, 0xFF, 0xD5, 0xD5, 0x01 };
+    uint8_t small[4] = { 1, 2, 3, 4 };
+    uint16_t seq = 1;
+
+    for (int k = 0; k < 8; k++) {
+        put_frame(0, seq++, REQ_SET_INLINE, sizeof(small), small);
+        memcpy(stream + stream_len, garbage, sizeof(garbage));
+        stream_len += sizeof(garbage);
+        put_frame(VFRAME_FLAG_IN, seq++, REQ_GET_INLINE, 64, NULL);
+        // Oversized inline payload: discarded, stream stays in sync
+        put_frame(0, seq++, REQ_SET_INLINE, 100, big_payload);
+    }
+    // Corrupted header: must not swallow the frame after it
+    size_t bad_at = stream_len;
+    put_frame(0, 0x7777, REQ_SET_INLINE, sizeof(small), small);
+    stream[bad_at + 10] ^= 0xFF;
+    put_frame(0, seq++, REQ_SET_INLINE, sizeof(small), small);
+    send_stream(random_split);
+
+    CHECK(n_responses == 8 * 3 + 1, "%s: %d responses for %d frames",
+          random_split ? "random" : "64-byte", n_responses, 8 * 3 + 1);
+    CHECK(find_response(0x7777) == NULL, "corrupted frame dispatched");
+    for (uint16_t s = 1; s < seq; s++) {
+        const Response *r = find_response(s);
+        CHECK(r != NULL, "seq %u lost", s);
+        if (!r) continue;
+        if (r->hdr.request == REQ_SET_INLINE && r->hdr.length == 100) {
+            CHECK(r->hdr.status == VFRAME_STATUS_TOO_LONG, "seq %u: oversized status %u", s, r->hdr.status);
+        } else {
+            CHECK(r->hdr.status == VFRAME_STATUS_OK, "seq %u: status %u", s, r->hdr.status);
+        }
+        if (r->hdr.request == REQ_SET_INLINE && r->hdr.status == VFRAME_STATUS_OK) {
+            CHECK(memcmp(r->payload, small, sizeof(small)) == 0, "seq %u: payload corrupted", s);
+        }
+    }
+    CHECK(parser.resync_bytes > 0, "garbage not counted");
+}
+
+// bulk_param_buf ownership across EP0, the bulk pipe and the main loop
+static void test_ownership(void) {
+    device_reset();
+
+    // EP0 GET data stage in flight: a bulk SET must not land in the buffer
+    CHECK(vbuf_claim(&big_owner, VBUF_EP0), "EP0 claim of a free buffer failed");
+    memset(big_buf, 0xAA, BIG_BUF_SIZE);
+    put_frame(0, 1, REQ_SET_BIG, BIG_PAYLOAD, big_payload);
+    put_frame(0, 2, REQ_SET_INLINE, 1, big_payload);
+    send_stream(false);
+    CHECK(find_response(1) && find_response(1)->hdr.status == VFRAME_STATUS_BUSY,
+          "bulk SET during EP0 GET not refused");
+    CHECK(find_response(2) && find_response(2)->hdr.status == VFRAME_STATUS_OK,
+          "frame after refused SET lost");
+    CHECK(big_buf[0] == 0xAA && big_buf[BIG_PAYLOAD - 1] == 0xAA,
+          "refused SET wrote into the EP0 GET's buffer");
+    CHECK(!main_pending, "refused SET reached the main loop");
+
+    // Bulk GET is refused too; EP0 completes and releases
+    put_frame(VFRAME_FLAG_IN, 3, REQ_GET_BIG, BIG_PAYLOAD, NULL);
+    send_stream(false);
+    CHECK(find_response(3) && find_response(3)->hdr.status == VFRAME_STATUS_BUSY,
+          "bulk GET during EP0 GET not refused");
+    vbuf_release(&big_owner, VBUF_EP0);
+    CHECK(big_owner == VBUF_FREE, "EP0 release failed");
+
+    // Bulk SET now lands and passes to the main loop
+    put_frame(0, 4, REQ_SET_BIG, BIG_PAYLOAD, big_payload);
+    send_stream(true);
+    CHECK(find_response(4) && find_response(4)->hdr.status == VFRAME_STATUS_OK, "bulk SET refused");
+    CHECK(main_pending && big_owner == VBUF_MAIN, "bulk SET not handed to the main loop");
+    CHECK(memcmp(big_buf, big_payload, BIG_PAYLOAD) == 0, "bulk SET payload corrupted");
+
+    // Nothing may touch it until the main loop is done
+    CHECK(!vbuf_claim(&big_owner, VBUF_EP0), "EP0 claimed a buffer the main loop owns");
+    put_frame(VFRAME_FLAG_IN, 5, REQ_GET_BIG, BIG_PAYLOAD, NULL);
+    put_frame(0, 6, REQ_SET_BIG, BIG_PAYLOAD, big_payload);
+    send_stream(false);
+    CHECK(find_response(5) && find_response(5)->hdr.status == VFRAME_STATUS_BUSY,
+          "bulk GET while main loop applies not refused");
+    CHECK(find_response(6) && find_response(6)->hdr.status == VFRAME_STATUS_BUSY,
+          "second bulk SET while main loop applies not refused");
+    vbuf_release(&big_owner, VBUF_BULK_IN);     // Endpoint reset: not its buffer
+    CHECK(big_owner == VBUF_MAIN, "bulk IN reset freed the main loop's buffer");
+    vbuf_release(&big_owner, VBUF_MAIN);
+    main_pending = false;
+
+    // Bulk GET holds it until the response is sent
+    put_frame(VFRAME_FLAG_IN, 7, REQ_GET_BIG, BIG_PAYLOAD, NULL);
+    send_stream(false);
+    CHECK(find_response(7) && find_response(7)->hdr.status == VFRAME_STATUS_OK, "bulk GET refused");
+    CHECK(!vbuf_claim(&big_owner, VBUF_EP0), "EP0 claimed a buffer the bulk GET streams from");
+    drain_in();
+    CHECK(vbuf_claim(&big_owner, VBUF_EP0), "buffer not freed after the bulk GET was sent");
+    CHECK(!vbuf_pass(&big_owner, VBUF_BULK_OUT, VBUF_MAIN), "pass from a non-owner succeeded");
+    CHECK(big_owner == VBUF_EP0, "failed pass changed the owner");
+}
+
+int main(void) {
+    for (int i = 0; i < BIG_PAYLOAD; i++) big_payload[i] = (uint8_t)(i * 7 + 3);
+    srand(1);
+
+    test_header_codec();
+    test_stream(false);
+    for (int i = 0; i < 50; i++) test_stream(true);
+    test_ownership();
+
+    if (failures) {
+        printf("%d failure(s)\n", failures);
+        return 1;
+    }
+    printf("vendor_frame: all passed\n");
+    return 0;
+}